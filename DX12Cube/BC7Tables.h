@@ -0,0 +1,131 @@
+#pragma once
+#ifndef _BC7TABLES_H_
+#define _BC7TABLES_H_
+
+#include <cstdint>
+
+// BC7 모드 정보, 분할/기준 픽셀(anchor) 표, 보간 가중치. BCDecoder와 BCEncoder가 함께 쓴다.
+
+struct BC7ModeInfo
+{
+	uint8_t Subsets;
+	uint8_t PartitionBits;
+	uint8_t RotationBits;
+	uint8_t IndexSelectionBits;
+	uint8_t ColorBits;
+	uint8_t AlphaBits;
+	uint8_t EndpointPBits;
+	uint8_t SharedPBits;
+	uint8_t IndexBits;
+	uint8_t SecondaryIndexBits;
+};
+
+inline constexpr BC7ModeInfo gBC7Modes[8] =
+{
+	{ 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+	{ 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+	{ 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+	{ 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+	{ 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+	{ 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+	{ 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+	{ 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 },
+};
+
+// 2개 부분집합 분할. 비트 i가 픽셀 i의 부분집합
+inline constexpr uint16_t gBC7Partitions2[64] =
+{
+	0xcccc, 0x8888, 0xeeee, 0xecc8, 0xc880, 0xfeec, 0xfec8, 0xec80,
+	0xc800, 0xffec, 0xfe80, 0xe800, 0xffe8, 0xff00, 0xfff0, 0xf000,
+	0xf710, 0x008e, 0x7100, 0x08ce, 0x008c, 0x7310, 0x3100, 0x8cce,
+	0x088c, 0x3110, 0x6666, 0x366c, 0x17e8, 0x0ff0, 0x718e, 0x399c,
+	0xaaaa, 0xf0f0, 0x5a5a, 0x33cc, 0x3c3c, 0x55aa, 0x9696, 0xa55a,
+	0x73ce, 0x13c8, 0x324c, 0x3bdc, 0x6996, 0xc33c, 0x9966, 0x0660,
+	0x0272, 0x04e4, 0x4e40, 0x2720, 0xc936, 0x936c, 0x39c6, 0x639c,
+	0x9336, 0x9cc6, 0x817e, 0xe718, 0xccf0, 0x0fcc, 0x7744, 0xee22,
+};
+
+// 3개 부분집합 분할. 픽셀 i의 부분집합
+inline constexpr uint8_t gBC7Partitions3[64][16] =
+{
+	{ 0,0,1,1,0,0,1,1,0,2,2,1,2,2,2,2 }, { 0,0,0,1,0,0,1,1,2,2,1,1,2,2,2,1 },
+	{ 0,0,0,0,2,0,0,1,2,2,1,1,2,2,1,1 }, { 0,2,2,2,0,0,2,2,0,0,1,1,0,1,1,1 },
+	{ 0,0,0,0,0,0,0,0,1,1,2,2,1,1,2,2 }, { 0,0,1,1,0,0,1,1,0,0,2,2,0,0,2,2 },
+	{ 0,0,2,2,0,0,2,2,1,1,1,1,1,1,1,1 }, { 0,0,1,1,0,0,1,1,2,2,1,1,2,2,1,1 },
+	{ 0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2 }, { 0,0,0,0,1,1,1,1,1,1,1,1,2,2,2,2 },
+	{ 0,0,0,0,1,1,1,1,2,2,2,2,2,2,2,2 }, { 0,0,1,2,0,0,1,2,0,0,1,2,0,0,1,2 },
+	{ 0,1,1,2,0,1,1,2,0,1,1,2,0,1,1,2 }, { 0,1,2,2,0,1,2,2,0,1,2,2,0,1,2,2 },
+	{ 0,0,1,1,0,1,1,2,1,1,2,2,1,2,2,2 }, { 0,0,1,1,2,0,0,1,2,2,0,0,2,2,2,0 },
+	{ 0,0,0,1,0,0,1,1,0,1,1,2,1,1,2,2 }, { 0,1,1,1,0,0,1,1,2,0,0,1,2,2,0,0 },
+	{ 0,0,0,0,1,1,2,2,1,1,2,2,1,1,2,2 }, { 0,0,2,2,0,0,2,2,0,0,2,2,1,1,1,1 },
+	{ 0,1,1,1,0,1,1,1,0,2,2,2,0,2,2,2 }, { 0,0,0,1,0,0,0,1,2,2,2,1,2,2,2,1 },
+	{ 0,0,0,0,0,0,1,1,0,1,2,2,0,1,2,2 }, { 0,0,0,0,1,1,0,0,2,2,1,0,2,2,1,0 },
+	{ 0,1,2,2,0,1,2,2,0,0,1,1,0,0,0,0 }, { 0,0,1,2,0,0,1,2,1,1,2,2,2,2,2,2 },
+	{ 0,1,1,0,1,2,2,1,1,2,2,1,0,1,1,0 }, { 0,0,0,0,0,1,1,0,1,2,2,1,1,2,2,1 },
+	{ 0,0,2,2,1,1,0,2,1,1,0,2,0,0,2,2 }, { 0,1,1,0,0,1,1,0,2,0,0,2,2,2,2,2 },
+	{ 0,0,1,1,0,1,2,2,0,1,2,2,0,0,1,1 }, { 0,0,0,0,2,0,0,0,2,2,1,1,2,2,2,1 },
+	{ 0,0,0,0,0,0,0,2,1,1,2,2,1,2,2,2 }, { 0,2,2,2,0,0,2,2,0,0,1,2,0,0,1,1 },
+	{ 0,0,1,1,0,0,1,2,0,0,2,2,0,2,2,2 }, { 0,1,2,0,0,1,2,0,0,1,2,0,0,1,2,0 },
+	{ 0,0,0,0,1,1,1,1,2,2,2,2,0,0,0,0 }, { 0,1,2,0,1,2,0,1,2,0,1,2,0,1,2,0 },
+	{ 0,1,2,0,2,0,1,2,1,2,0,1,0,1,2,0 }, { 0,0,1,1,2,2,0,0,1,1,2,2,0,0,1,1 },
+	{ 0,0,1,1,1,1,2,2,2,2,0,0,0,0,1,1 }, { 0,1,0,1,0,1,0,1,2,2,2,2,2,2,2,2 },
+	{ 0,0,0,0,0,0,0,0,2,1,2,1,2,1,2,1 }, { 0,0,2,2,1,1,2,2,0,0,2,2,1,1,2,2 },
+	{ 0,0,2,2,0,0,1,1,0,0,2,2,0,0,1,1 }, { 0,2,2,0,1,2,2,1,0,2,2,0,1,2,2,1 },
+	{ 0,1,0,1,2,2,2,2,2,2,2,2,0,1,0,1 }, { 0,0,0,0,2,1,2,1,2,1,2,1,2,1,2,1 },
+	{ 0,1,0,1,0,1,0,1,0,1,0,1,2,2,2,2 }, { 0,2,2,2,0,1,1,1,0,2,2,2,0,1,1,1 },
+	{ 0,0,0,2,1,1,1,2,0,0,0,2,1,1,1,2 }, { 0,0,0,0,2,1,1,2,2,1,1,2,2,1,1,2 },
+	{ 0,2,2,2,0,1,1,1,0,1,1,1,0,2,2,2 }, { 0,0,0,2,1,1,1,2,1,1,1,2,0,0,0,2 },
+	{ 0,1,1,0,0,1,1,0,0,1,1,0,2,2,2,2 }, { 0,0,0,0,0,0,0,0,2,1,1,2,2,1,1,2 },
+	{ 0,1,1,0,0,1,1,0,2,2,2,2,2,2,2,2 }, { 0,0,2,2,0,0,1,1,0,0,1,1,0,0,2,2 },
+	{ 0,0,2,2,1,1,2,2,1,1,2,2,0,0,2,2 }, { 0,0,0,0,0,0,0,0,0,0,0,0,2,1,1,2 },
+	{ 0,0,0,2,0,0,0,1,0,0,0,2,0,0,0,1 }, { 0,2,2,2,1,2,2,2,0,2,2,2,1,2,2,2 },
+	{ 0,1,0,1,2,2,2,2,2,2,2,2,2,2,2,2 }, { 0,1,1,1,2,0,1,1,2,2,0,1,2,2,2,0 },
+};
+
+// 부분집합마다 인덱스 최상위 비트를 생략하는 기준 픽셀(anchor). 0번 부분집합은 항상 픽셀 0
+inline constexpr uint8_t gBC7Anchors2[64] =
+{
+	15,15,15,15,15,15,15,15, 15,15,15,15,15,15,15,15,
+	15, 2, 8, 2, 2, 8, 8,15,  2, 8, 2, 2, 8, 8, 2, 2,
+	15,15, 6, 8, 2, 8,15,15,  2, 8, 2, 2, 2,15,15, 6,
+	 6, 2, 6, 8,15,15, 2, 2, 15,15,15,15,15, 2, 2,15,
+};
+
+inline constexpr uint8_t gBC7Anchors3Second[64] =
+{
+	 3, 3,15,15, 8, 3,15,15,  8, 8, 6, 6, 6, 5, 3, 3,
+	 3, 3, 8,15, 3, 3, 6,10,  5, 8, 8, 6, 8, 5,15,15,
+	 8,15, 3, 5, 6,10, 8,15, 15, 3,15, 5,15,15,15,15,
+	 3,15, 5, 5, 5, 8, 5,10,  5,10, 8,13,15,12, 3, 3,
+};
+
+inline constexpr uint8_t gBC7Anchors3Third[64] =
+{
+	15, 8, 8, 3,15,15, 3, 8, 15,15,15,15,15,15,15, 8,
+	15, 8,15, 3,15, 8,15, 8,  3,15, 6,10,15,15,10, 8,
+	15, 3,15,10,10, 8, 9,10,  6,15, 8,15, 3, 6, 6, 8,
+	15, 3,15,15,15,15,15,15, 15,15,15,15, 3,15,15, 8,
+};
+
+inline constexpr uint8_t gBC7Weights2[4] = { 0, 21, 43, 64 };
+inline constexpr uint8_t gBC7Weights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+inline constexpr uint8_t gBC7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+inline const uint8_t* GetBC7Weights(uint32_t indexBits)
+{
+	return (indexBits == 2) ? gBC7Weights2 : (indexBits == 3) ? gBC7Weights3 : gBC7Weights4;
+}
+
+inline uint32_t BC7ExpandBits(uint32_t value, uint32_t bits)
+{
+	// 상위 비트를 하위에 반복해서 8비트로 늘린다.
+	value <<= (8 - bits);
+	return value | (value >> bits);
+}
+
+inline uint8_t BC7Interpolate(uint32_t e0, uint32_t e1, uint32_t weight)
+{
+	return static_cast<uint8_t>(((64 - weight) * e0 + weight * e1 + 32) >> 6);
+}
+
+#endif
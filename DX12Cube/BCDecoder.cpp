@@ -0,0 +1,849 @@
+#include "BCDecoder.h"
+#include "JobSystem.h"
+#include "BC7Tables.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define BC_DECODER_SSE 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC는 /arch 설정과 상관없이 내장 함수를 쓸 수 있지만 GCC/Clang은 함수 단위로 허용해야 한다.
+#if defined(BC_DECODER_SSE) && defined(__GNUC__) && !defined(__SSE4_1__)
+#define BC_SSE41_TARGET __attribute__((target("sse4.1")))
+#else
+#define BC_SSE41_TARGET
+#endif
+
+namespace
+{
+	enum class BCKind
+	{
+		None,
+		BC1,
+		BC2,
+		BC3,
+		BC4U,
+		BC4S,
+		BC5U,
+		BC5S,
+		BC6H,
+		BC7,
+	};
+
+	BCKind GetBCKind(DXGI_FORMAT format)
+	{
+		switch (format)
+		{
+		case DXGI_FORMAT_BC1_TYPELESS:
+		case DXGI_FORMAT_BC1_UNORM:
+		case DXGI_FORMAT_BC1_UNORM_SRGB:
+			return BCKind::BC1;
+
+		case DXGI_FORMAT_BC2_TYPELESS:
+		case DXGI_FORMAT_BC2_UNORM:
+		case DXGI_FORMAT_BC2_UNORM_SRGB:
+			return BCKind::BC2;
+
+		case DXGI_FORMAT_BC3_TYPELESS:
+		case DXGI_FORMAT_BC3_UNORM:
+		case DXGI_FORMAT_BC3_UNORM_SRGB:
+			return BCKind::BC3;
+
+		case DXGI_FORMAT_BC4_TYPELESS:
+		case DXGI_FORMAT_BC4_UNORM:
+			return BCKind::BC4U;
+		case DXGI_FORMAT_BC4_SNORM:
+			return BCKind::BC4S;
+
+		case DXGI_FORMAT_BC5_TYPELESS:
+		case DXGI_FORMAT_BC5_UNORM:
+			return BCKind::BC5U;
+		case DXGI_FORMAT_BC5_SNORM:
+			return BCKind::BC5S;
+
+		case DXGI_FORMAT_BC6H_TYPELESS:
+		case DXGI_FORMAT_BC6H_UF16:
+		case DXGI_FORMAT_BC6H_SF16:
+			return BCKind::BC6H;
+
+		case DXGI_FORMAT_BC7_TYPELESS:
+		case DXGI_FORMAT_BC7_UNORM:
+		case DXGI_FORMAT_BC7_UNORM_SRGB:
+			return BCKind::BC7;
+
+		default:
+			return BCKind::None;
+		}
+	}
+
+	//--------------------------------------------------------------------------------------
+	// CPU 기능 확인
+	//--------------------------------------------------------------------------------------
+	bool DetectSSE41()
+	{
+#if defined(BC_DECODER_SSE) && defined(_MSC_VER)
+		int info[4] = {};
+		__cpuid(info, 1);
+		return (info[2] & (1 << 19)) != 0;
+#elif defined(BC_DECODER_SSE) && defined(__GNUC__)
+		return __builtin_cpu_supports("sse4.1") != 0;
+#else
+		return false;
+#endif
+	}
+
+	const bool gSimdAvailable = DetectSSE41();
+	bool gSimdEnabled = gSimdAvailable;
+
+	//--------------------------------------------------------------------------------------
+	// 팔레트 만들기 (스칼라/SIMD 공통)
+	//--------------------------------------------------------------------------------------
+	inline uint32_t PackRGBA(uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+	{
+		return r | (g << 8) | (b << 16) | (a << 24);
+	}
+
+	// BC1 색 블록의 4색 팔레트. BC2/BC3의 색 블록은 항상 4색 모드로 푼다.
+	inline void BuildColorPalette(const uint8_t* block, bool allowPunchThrough, uint32_t palette[4])
+	{
+		const uint32_t c0 = block[0] | (block[1] << 8);
+		const uint32_t c1 = block[2] | (block[3] << 8);
+
+		uint32_t r0 = (c0 >> 11) & 31, g0 = (c0 >> 5) & 63, b0 = c0 & 31;
+		uint32_t r1 = (c1 >> 11) & 31, g1 = (c1 >> 5) & 63, b1 = c1 & 31;
+		r0 = (r0 << 3) | (r0 >> 2); g0 = (g0 << 2) | (g0 >> 4); b0 = (b0 << 3) | (b0 >> 2);
+		r1 = (r1 << 3) | (r1 >> 2); g1 = (g1 << 2) | (g1 >> 4); b1 = (b1 << 3) | (b1 >> 2);
+
+		palette[0] = PackRGBA(r0, g0, b0, 255);
+		palette[1] = PackRGBA(r1, g1, b1, 255);
+
+		if (c0 > c1 || !allowPunchThrough)
+		{
+			palette[2] = PackRGBA((2 * r0 + r1) / 3, (2 * g0 + g1) / 3, (2 * b0 + b1) / 3, 255);
+			palette[3] = PackRGBA((r0 + 2 * r1) / 3, (g0 + 2 * g1) / 3, (b0 + 2 * b1) / 3, 255);
+		}
+		else
+		{
+			palette[2] = PackRGBA((r0 + r1) / 2, (g0 + g1) / 2, (b0 + b1) / 2, 255);
+			palette[3] = 0;
+		}
+	}
+
+	// BC4 한 채널(BC3 알파, BC5 각 채널)의 8단계 팔레트
+	inline void BuildChannelPalette(const uint8_t* block, bool snorm, uint8_t palette[8])
+	{
+		// SNORM은 -127 ~ 127을 0 ~ 254로 옮겨서 같은 식으로 보간한 뒤 0 ~ 255로 늘린다.
+		int e0, e1, maxValue;
+		if (snorm)
+		{
+			e0 = std::max<int>(static_cast<int8_t>(block[0]), -127) + 127;
+			e1 = std::max<int>(static_cast<int8_t>(block[1]), -127) + 127;
+			maxValue = 254;
+		}
+		else
+		{
+			e0 = block[0];
+			e1 = block[1];
+			maxValue = 255;
+		}
+
+		int values[8];
+		values[0] = e0;
+		values[1] = e1;
+		if (e0 > e1)
+		{
+			for (int i = 1; i <= 6; i++)
+			{
+				values[i + 1] = ((7 - i) * e0 + i * e1 + 3) / 7;
+			}
+		}
+		else
+		{
+			for (int i = 1; i <= 4; i++)
+			{
+				values[i + 1] = ((5 - i) * e0 + i * e1 + 2) / 5;
+			}
+			values[6] = 0;
+			values[7] = maxValue;
+		}
+
+		for (int i = 0; i < 8; i++)
+		{
+			palette[i] = static_cast<uint8_t>(snorm ? (values[i] * 255 + 127) / 254 : values[i]);
+		}
+	}
+
+	// 3비트 인덱스 16개(48비트)를 바이트 하나씩으로 편다.
+	inline void UnpackChannelIndices(const uint8_t* block, uint8_t indices[16])
+	{
+		uint64_t bits = 0;
+		for (int i = 0; i < 6; i++)
+		{
+			bits |= static_cast<uint64_t>(block[2 + i]) << (8 * i);
+		}
+		for (int i = 0; i < 16; i++)
+		{
+			indices[i] = static_cast<uint8_t>((bits >> (3 * i)) & 7);
+		}
+	}
+
+	//--------------------------------------------------------------------------------------
+	// 스칼라 디코더
+	//--------------------------------------------------------------------------------------
+	void DecodeColorBlockScalar(const uint8_t* block, bool allowPunchThrough, uint8_t rgba[64])
+	{
+		uint32_t palette[4];
+		BuildColorPalette(block, allowPunchThrough, palette);
+
+		const uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | (static_cast<uint32_t>(block[7]) << 24);
+		for (int i = 0; i < 16; i++)
+		{
+			memcpy(rgba + i * 4, &palette[(indices >> (2 * i)) & 3], 4);
+		}
+	}
+
+	void DecodeChannelScalar(const uint8_t* block, bool snorm, uint8_t rgba[64], int channel)
+	{
+		uint8_t palette[8];
+		uint8_t indices[16];
+		BuildChannelPalette(block, snorm, palette);
+		UnpackChannelIndices(block, indices);
+		for (int i = 0; i < 16; i++)
+		{
+			rgba[i * 4 + channel] = palette[indices[i]];
+		}
+	}
+
+	void DecodeExplicitAlphaScalar(const uint8_t* block, uint8_t rgba[64])
+	{
+		for (int i = 0; i < 16; i++)
+		{
+			uint32_t a = (block[i / 2] >> ((i & 1) * 4)) & 15;
+			rgba[i * 4 + 3] = static_cast<uint8_t>(a * 17);
+		}
+	}
+
+	void FillChannels(uint8_t rgba[64], uint32_t value)
+	{
+		for (int i = 0; i < 16; i++)
+		{
+			memcpy(rgba + i * 4, &value, 4);
+		}
+	}
+
+	//--------------------------------------------------------------------------------------
+	// BC7
+	//--------------------------------------------------------------------------------------
+	// 128비트 블록을 낮은 비트부터 읽는다.
+	class BlockBitReader
+	{
+	public:
+		explicit BlockBitReader(const uint8_t* block)
+		{
+			memcpy(&mLow, block, 8);
+			memcpy(&mHigh, block + 8, 8);
+		}
+
+		uint32_t Read(uint32_t count)
+		{
+			if (count == 0)
+			{
+				return 0;
+			}
+
+			uint64_t value;
+			if (mPosition >= 64)
+			{
+				value = mHigh >> (mPosition - 64);
+			}
+			else if (mPosition + count <= 64)
+			{
+				value = mLow >> mPosition;
+			}
+			else
+			{
+				value = (mLow >> mPosition) | (mHigh << (64 - mPosition));
+			}
+			mPosition += count;
+			return static_cast<uint32_t>(value & ((1ull << count) - 1));
+		}
+
+	private:
+		uint64_t mLow = 0;
+		uint64_t mHigh = 0;
+		uint32_t mPosition = 0;
+	};
+
+	void DecodeBC7Block(const uint8_t* block, uint8_t rgba[64])
+	{
+		uint32_t mode = 0;
+		while (mode < 8 && !(block[0] & (1u << mode)))
+		{
+			mode++;
+		}
+		if (mode == 8)
+		{
+			// 예약된 모드는 0으로 채운다.
+			memset(rgba, 0, 64);
+			return;
+		}
+
+		const BC7ModeInfo& info = gBC7Modes[mode];
+		BlockBitReader reader(block);
+		reader.Read(mode + 1);
+
+		const uint32_t partition = reader.Read(info.PartitionBits);
+		const uint32_t rotation = reader.Read(info.RotationBits);
+		const uint32_t indexSelection = reader.Read(info.IndexSelectionBits);
+
+		// [부분집합][끝점][채널]
+		uint32_t endpoints[3][2][4] = {};
+		for (uint32_t c = 0; c < 3; c++)
+		{
+			for (uint32_t s = 0; s < info.Subsets; s++)
+			{
+				endpoints[s][0][c] = reader.Read(info.ColorBits);
+				endpoints[s][1][c] = reader.Read(info.ColorBits);
+			}
+		}
+		if (info.AlphaBits)
+		{
+			for (uint32_t s = 0; s < info.Subsets; s++)
+			{
+				endpoints[s][0][3] = reader.Read(info.AlphaBits);
+				endpoints[s][1][3] = reader.Read(info.AlphaBits);
+			}
+		}
+
+		uint32_t pBits[3][2] = {};
+		const bool hasPBits = info.EndpointPBits || info.SharedPBits;
+		if (info.EndpointPBits)
+		{
+			for (uint32_t s = 0; s < info.Subsets; s++)
+			{
+				pBits[s][0] = reader.Read(1);
+				pBits[s][1] = reader.Read(1);
+			}
+		}
+		else if (info.SharedPBits)
+		{
+			for (uint32_t s = 0; s < info.Subsets; s++)
+			{
+				pBits[s][0] = pBits[s][1] = reader.Read(1);
+			}
+		}
+
+		const uint32_t colorBits = info.ColorBits + (hasPBits ? 1 : 0);
+		const uint32_t alphaBits = info.AlphaBits ? info.AlphaBits + (hasPBits ? 1 : 0) : 0;
+		for (uint32_t s = 0; s < info.Subsets; s++)
+		{
+			for (uint32_t e = 0; e < 2; e++)
+			{
+				for (uint32_t c = 0; c < 4; c++)
+				{
+					if (c == 3 && !alphaBits)
+					{
+						endpoints[s][e][c] = 255;
+						continue;
+					}
+					uint32_t value = endpoints[s][e][c];
+					if (hasPBits)
+					{
+						value = (value << 1) | pBits[s][e];
+					}
+					endpoints[s][e][c] = BC7ExpandBits(value, (c == 3) ? alphaBits : colorBits);
+				}
+			}
+		}
+
+		uint8_t subsets[16] = {};
+		uint32_t anchorSecond = 16, anchorThird = 16;
+		if (info.Subsets == 2)
+		{
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				subsets[i] = (gBC7Partitions2[partition] >> i) & 1;
+			}
+			anchorSecond = gBC7Anchors2[partition];
+		}
+		else if (info.Subsets == 3)
+		{
+			memcpy(subsets, gBC7Partitions3[partition], 16);
+			anchorSecond = gBC7Anchors3Second[partition];
+			anchorThird = gBC7Anchors3Third[partition];
+		}
+
+		uint8_t indices[16];
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			const bool anchor = (i == 0 || i == anchorSecond || i == anchorThird);
+			indices[i] = static_cast<uint8_t>(reader.Read(info.IndexBits - (anchor ? 1 : 0)));
+		}
+
+		uint8_t secondaryIndices[16] = {};
+		if (info.SecondaryIndexBits)
+		{
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				secondaryIndices[i] = static_cast<uint8_t>(reader.Read(info.SecondaryIndexBits - (i == 0 ? 1 : 0)));
+			}
+		}
+
+		// 모드 4는 indexSelection이 1이면 색과 알파의 인덱스 크기를 바꾼다.
+		const uint8_t* colorIndices = indices;
+		const uint8_t* alphaIndices = indices;
+		uint32_t colorIndexBits = info.IndexBits;
+		uint32_t alphaIndexBits = info.IndexBits;
+		if (info.SecondaryIndexBits)
+		{
+			if (indexSelection)
+			{
+				colorIndices = secondaryIndices;
+				colorIndexBits = info.SecondaryIndexBits;
+			}
+			else
+			{
+				alphaIndices = secondaryIndices;
+				alphaIndexBits = info.SecondaryIndexBits;
+			}
+		}
+		const uint8_t* colorWeights = GetBC7Weights(colorIndexBits);
+		const uint8_t* alphaWeights = GetBC7Weights(alphaIndexBits);
+
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			const uint32_t (&e)[2][4] = endpoints[subsets[i]];
+			const uint32_t cw = colorWeights[colorIndices[i]];
+			const uint32_t aw = alphaWeights[alphaIndices[i]];
+
+			uint8_t* pixel = rgba + i * 4;
+			pixel[0] = BC7Interpolate(e[0][0], e[1][0], cw);
+			pixel[1] = BC7Interpolate(e[0][1], e[1][1], cw);
+			pixel[2] = BC7Interpolate(e[0][2], e[1][2], cw);
+			pixel[3] = BC7Interpolate(e[0][3], e[1][3], aw);
+
+			if (rotation)
+			{
+				std::swap(pixel[3], pixel[rotation - 1]);
+			}
+		}
+	}
+
+	void DecodeBlockScalar(BCKind kind, const uint8_t* block, uint8_t rgba[64])
+	{
+		switch (kind)
+		{
+		case BCKind::BC1:
+			DecodeColorBlockScalar(block, true, rgba);
+			break;
+
+		case BCKind::BC2:
+			DecodeColorBlockScalar(block + 8, false, rgba);
+			DecodeExplicitAlphaScalar(block, rgba);
+			break;
+
+		case BCKind::BC3:
+			DecodeColorBlockScalar(block + 8, false, rgba);
+			DecodeChannelScalar(block, false, rgba, 3);
+			break;
+
+		case BCKind::BC4U:
+		case BCKind::BC4S:
+			FillChannels(rgba, PackRGBA(0, 0, 0, 255));
+			DecodeChannelScalar(block, kind == BCKind::BC4S, rgba, 0);
+			break;
+
+		case BCKind::BC5U:
+		case BCKind::BC5S:
+			FillChannels(rgba, PackRGBA(0, 0, 0, 255));
+			DecodeChannelScalar(block, kind == BCKind::BC5S, rgba, 0);
+			DecodeChannelScalar(block + 8, kind == BCKind::BC5S, rgba, 1);
+			break;
+
+		case BCKind::BC7:
+			DecodeBC7Block(block, rgba);
+			break;
+
+		default:
+			memset(rgba, 0, 64);
+			break;
+		}
+	}
+
+#ifdef BC_DECODER_SSE
+	//--------------------------------------------------------------------------------------
+	// SSE4.1 디코더
+	// 팔레트(4바이트 x 4색, 또는 1바이트 x 8단계)를 레지스터 하나에 넣고 pshufb로 16픽셀을 한 번에 고른다.
+	//--------------------------------------------------------------------------------------
+
+	// 2비트 인덱스 4개(블록 한 줄)를 색 팔레트 셔플 마스크로 바꾸는 표
+	struct ColorShuffleTable
+	{
+		alignas(16) uint8_t Masks[256][16];
+
+		ColorShuffleTable()
+		{
+			for (uint32_t bits = 0; bits < 256; bits++)
+			{
+				for (uint32_t p = 0; p < 4; p++)
+				{
+					uint32_t index = (bits >> (2 * p)) & 3;
+					for (uint32_t k = 0; k < 4; k++)
+					{
+						Masks[bits][p * 4 + k] = static_cast<uint8_t>(index * 4 + k);
+					}
+				}
+			}
+		}
+	};
+
+	const ColorShuffleTable gColorShuffles;
+
+	// 블록 한 줄의 채널 값(바이트 4개)을 픽셀의 channel 바이트로 펼치는 마스크
+	BC_SSE41_TARGET inline __m128i ChannelSpreadMask(uint32_t row, uint32_t channel)
+	{
+		alignas(16) uint8_t mask[16];
+		memset(mask, 0x80, sizeof(mask));
+		for (uint32_t p = 0; p < 4; p++)
+		{
+			mask[p * 4 + channel] = static_cast<uint8_t>(row * 4 + p);
+		}
+		return _mm_load_si128(reinterpret_cast<const __m128i*>(mask));
+	}
+
+	struct ChannelSpreadMasks
+	{
+		__m128i Masks[4][4];
+
+		BC_SSE41_TARGET ChannelSpreadMasks()
+		{
+			for (uint32_t row = 0; row < 4; row++)
+			{
+				for (uint32_t channel = 0; channel < 4; channel++)
+				{
+					Masks[row][channel] = ChannelSpreadMask(row, channel);
+				}
+			}
+		}
+	};
+
+	BC_SSE41_TARGET const ChannelSpreadMasks& GetChannelSpreadMasks()
+	{
+		static const ChannelSpreadMasks masks;
+		return masks;
+	}
+
+	// 색 블록 4줄을 rows[4]에 푼다. 각 줄은 4픽셀 RGBA
+	BC_SSE41_TARGET inline void DecodeColorRowsSSE(const uint8_t* block, bool allowPunchThrough, __m128i rows[4])
+	{
+		alignas(16) uint32_t palette[4];
+		BuildColorPalette(block, allowPunchThrough, palette);
+		const __m128i paletteVector = _mm_load_si128(reinterpret_cast<const __m128i*>(palette));
+
+		for (uint32_t row = 0; row < 4; row++)
+		{
+			const __m128i mask = _mm_load_si128(reinterpret_cast<const __m128i*>(gColorShuffles.Masks[block[4 + row]]));
+			rows[row] = _mm_shuffle_epi8(paletteVector, mask);
+		}
+	}
+
+	// BC4 채널 하나의 16픽셀 값
+	BC_SSE41_TARGET inline __m128i DecodeChannelSSE(const uint8_t* block, bool snorm)
+	{
+		alignas(16) uint8_t palette[16] = {};
+		alignas(16) uint8_t indices[16];
+		BuildChannelPalette(block, snorm, palette);
+		UnpackChannelIndices(block, indices);
+
+		const __m128i paletteVector = _mm_load_si128(reinterpret_cast<const __m128i*>(palette));
+		const __m128i indexVector = _mm_load_si128(reinterpret_cast<const __m128i*>(indices));
+		return _mm_shuffle_epi8(paletteVector, indexVector);
+	}
+
+	BC_SSE41_TARGET inline __m128i DecodeExplicitAlphaSSE(const uint8_t* block)
+	{
+		// 4비트 16개 -> 바이트 16개, x17
+		const __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(block));
+		const __m128i low = _mm_and_si128(packed, _mm_set1_epi8(0x0f));
+		const __m128i high = _mm_and_si128(_mm_srli_epi16(packed, 4), _mm_set1_epi8(0x0f));
+		const __m128i nibbles = _mm_unpacklo_epi8(low, high);
+		return _mm_or_si128(nibbles, _mm_slli_epi16(nibbles, 4));
+	}
+
+	BC_SSE41_TARGET void DecodeBlockSSE(BCKind kind, const uint8_t* block, __m128i rows[4])
+	{
+		const ChannelSpreadMasks& spread = GetChannelSpreadMasks();
+		const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xff000000u));
+
+		switch (kind)
+		{
+		case BCKind::BC1:
+			DecodeColorRowsSSE(block, true, rows);
+			break;
+
+		case BCKind::BC2:
+		case BCKind::BC3:
+		{
+			DecodeColorRowsSSE(block + 8, false, rows);
+			const __m128i alpha = (kind == BCKind::BC2) ? DecodeExplicitAlphaSSE(block) : DecodeChannelSSE(block, false);
+			for (uint32_t row = 0; row < 4; row++)
+			{
+				rows[row] = _mm_blendv_epi8(rows[row], _mm_shuffle_epi8(alpha, spread.Masks[row][3]), alphaMask);
+			}
+			break;
+		}
+
+		case BCKind::BC4U:
+		case BCKind::BC4S:
+		{
+			const __m128i red = DecodeChannelSSE(block, kind == BCKind::BC4S);
+			for (uint32_t row = 0; row < 4; row++)
+			{
+				rows[row] = _mm_or_si128(_mm_shuffle_epi8(red, spread.Masks[row][0]), alphaMask);
+			}
+			break;
+		}
+
+		case BCKind::BC5U:
+		case BCKind::BC5S:
+		{
+			const __m128i red = DecodeChannelSSE(block, kind == BCKind::BC5S);
+			const __m128i green = DecodeChannelSSE(block + 8, kind == BCKind::BC5S);
+			for (uint32_t row = 0; row < 4; row++)
+			{
+				rows[row] = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(red, spread.Masks[row][0]),
+					_mm_shuffle_epi8(green, spread.Masks[row][1])), alphaMask);
+			}
+			break;
+		}
+
+		default:
+		{
+			alignas(16) uint8_t rgba[64];
+			DecodeBlockScalar(kind, block, rgba);
+			for (uint32_t row = 0; row < 4; row++)
+			{
+				rows[row] = _mm_load_si128(reinterpret_cast<const __m128i*>(rgba + row * 16));
+			}
+			break;
+		}
+		}
+	}
+
+	BC_SSE41_TARGET void DecodeBlockRowSSE(BCKind kind, size_t blockBytes, const BCSurface& surface, uint32_t blockRow)
+	{
+		const uint32_t blocksWide = (surface.Width + 3) / 4;
+		const uint8_t* source = surface.Source + blockRow * surface.SourceRowPitch;
+		const uint32_t y0 = blockRow * 4;
+		const uint32_t rowCount = std::min(4u, surface.Height - y0);
+
+		for (uint32_t bx = 0; bx < blocksWide; bx++, source += blockBytes)
+		{
+			__m128i rows[4];
+			DecodeBlockSSE(kind, source, rows);
+
+			const uint32_t x0 = bx * 4;
+			const uint32_t columnCount = std::min(4u, surface.Width - x0);
+			for (uint32_t row = 0; row < rowCount; row++)
+			{
+				uint8_t* destination = surface.Destination + (y0 + row) * surface.DestinationRowPitch + x0 * 4;
+				if (columnCount == 4)
+				{
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(destination), rows[row]);
+				}
+				else
+				{
+					alignas(16) uint8_t pixels[16];
+					_mm_store_si128(reinterpret_cast<__m128i*>(pixels), rows[row]);
+					memcpy(destination, pixels, columnCount * 4);
+				}
+			}
+		}
+	}
+#endif
+
+	void DecodeBlockRowScalar(BCKind kind, size_t blockBytes, const BCSurface& surface, uint32_t blockRow)
+	{
+		const uint32_t blocksWide = (surface.Width + 3) / 4;
+		const uint8_t* source = surface.Source + blockRow * surface.SourceRowPitch;
+		const uint32_t y0 = blockRow * 4;
+		const uint32_t rowCount = std::min(4u, surface.Height - y0);
+
+		uint8_t rgba[64];
+		for (uint32_t bx = 0; bx < blocksWide; bx++, source += blockBytes)
+		{
+			DecodeBlockScalar(kind, source, rgba);
+
+			const uint32_t x0 = bx * 4;
+			const uint32_t columnCount = std::min(4u, surface.Width - x0);
+			for (uint32_t row = 0; row < rowCount; row++)
+			{
+				memcpy(surface.Destination + (y0 + row) * surface.DestinationRowPitch + x0 * 4, rgba + row * 16, columnCount * 4);
+			}
+		}
+	}
+
+	void DecodeBlockRow(BCKind kind, size_t blockBytes, const BCSurface& surface, uint32_t blockRow)
+	{
+#ifdef BC_DECODER_SSE
+		// BC7은 비트 단위 파싱이 대부분이라 스칼라와 차이가 없다.
+		if (gSimdEnabled && kind != BCKind::BC7)
+		{
+			DecodeBlockRowSSE(kind, blockBytes, surface, blockRow);
+			return;
+		}
+#endif
+		DecodeBlockRowScalar(kind, blockBytes, surface, blockRow);
+	}
+
+	bool IsDecodableKind(BCKind kind)
+	{
+		// BC6H는 HDR(반정밀도) 형식이라 RGBA8로 풀지 않는다.
+		return kind != BCKind::None && kind != BCKind::BC6H;
+	}
+}
+
+double BCDecodeStats::GetMegaPixelsPerSecond() const
+{
+	if (Seconds <= 0.0)
+	{
+		return 0.0;
+	}
+	return (Pixels / 1000000.0) / Seconds;
+}
+
+size_t GetBCBlockBytes(DXGI_FORMAT format)
+{
+	switch (GetBCKind(format))
+	{
+	case BCKind::BC1:
+	case BCKind::BC4U:
+	case BCKind::BC4S:
+		return 8;
+
+	case BCKind::None:
+		return 0;
+
+	default:
+		return 16;
+	}
+}
+
+bool IsBCDecodeSupported(DXGI_FORMAT format)
+{
+	return IsDecodableKind(GetBCKind(format));
+}
+
+DXGI_FORMAT GetBCDecodedFormat(DXGI_FORMAT format)
+{
+	switch (format)
+	{
+	case DXGI_FORMAT_BC1_UNORM_SRGB:
+	case DXGI_FORMAT_BC2_UNORM_SRGB:
+	case DXGI_FORMAT_BC3_UNORM_SRGB:
+	case DXGI_FORMAT_BC7_UNORM_SRGB:
+		return DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+
+	default:
+		return IsBCDecodeSupported(format) ? DXGI_FORMAT_R8G8B8A8_UNORM : DXGI_FORMAT_UNKNOWN;
+	}
+}
+
+bool IsBCDecodeSimdAvailable()
+{
+	return gSimdAvailable;
+}
+
+void SetBCDecodeSimdEnabled(bool enabled)
+{
+	gSimdEnabled = enabled && gSimdAvailable;
+}
+
+bool DecodeBCBlock(DXGI_FORMAT format, const uint8_t* block, uint8_t rgba[64])
+{
+	BCKind kind = GetBCKind(format);
+	if (!IsDecodableKind(kind) || !block || !rgba)
+	{
+		return false;
+	}
+
+	DecodeBlockScalar(kind, block, rgba);
+	return true;
+}
+
+bool DecodeBCSurface(DXGI_FORMAT format, const BCSurface& surface)
+{
+	return DecodeBCSurfaces(nullptr, format, &surface, 1);
+}
+
+bool DecodeBCSurfaces(JobSystem* jobs, DXGI_FORMAT format, const BCSurface* surfaces, size_t surfaceCount,
+	BCDecodeStats* stats)
+{
+	const BCKind kind = GetBCKind(format);
+	if (!IsDecodableKind(kind) || (!surfaces && surfaceCount))
+	{
+		return false;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	const size_t blockBytes = GetBCBlockBytes(format);
+
+	// 모든 면의 블록 줄을 한 줄로 세운다. rowStarts[i]는 i번 면의 첫 블록 줄 번호
+	std::vector<size_t> rowStarts(surfaceCount + 1, 0);
+	uint64_t totalBlocks = 0;
+	uint64_t totalPixels = 0;
+	for (size_t i = 0; i < surfaceCount; i++)
+	{
+		const BCSurface& surface = surfaces[i];
+		if (!surface.Source || !surface.Destination)
+		{
+			return false;
+		}
+
+		const size_t blocksWide = (surface.Width + 3) / 4;
+		const size_t blocksHigh = (surface.Height + 3) / 4;
+		rowStarts[i + 1] = rowStarts[i] + blocksHigh;
+		totalBlocks += blocksWide * blocksHigh;
+		totalPixels += static_cast<uint64_t>(surface.Width) * surface.Height;
+	}
+
+	auto decodeRows = [&](size_t begin, size_t end)
+	{
+		size_t s = std::upper_bound(rowStarts.begin(), rowStarts.end(), begin) - rowStarts.begin() - 1;
+		for (size_t row = begin; row < end; row++)
+		{
+			while (row >= rowStarts[s + 1])
+			{
+				s++;
+			}
+			DecodeBlockRow(kind, blockBytes, surfaces[s], static_cast<uint32_t>(row - rowStarts[s]));
+		}
+	};
+
+	const size_t totalRows = rowStarts[surfaceCount];
+	if (jobs && jobs->GetConcurrency() > 1 && totalBlocks > 256)
+	{
+		// 스레드당 몇 덩어리씩 돌아가도록 나눈다. 줄마다 블록 수가 다르므로 평균으로 잡는다.
+		const size_t chunkCount = jobs->GetConcurrency() * 4;
+		const size_t grain = std::max<size_t>(1, (totalRows + chunkCount - 1) / chunkCount);
+		jobs->ParallelFor(totalRows, grain, decodeRows);
+	}
+	else
+	{
+		decodeRows(0, totalRows);
+	}
+
+	if (stats)
+	{
+		stats->Blocks = totalBlocks;
+		stats->Pixels = totalPixels;
+		stats->Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+	return true;
+}
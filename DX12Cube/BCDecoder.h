@@ -0,0 +1,65 @@
+#pragma once
+#ifndef _BCDECODER_H_
+#define _BCDECODER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <dxgiformat.h>
+
+class JobSystem;
+
+// BC1~BC7 블록 압축 텍스쳐를 CPU에서 RGBA8로 풀어내는 디코더
+// GPU 없이 텍스쳐 내용을 확인하거나 검증할 때, BC를 지원하지 않는 장치에서 대체 경로로 쓸 때 사용한다.
+// BC1/BC2/BC3/BC4/BC5는 SSE4.1이 있으면 팔레트 조회를 pshufb 한 번으로 처리하고, BC7은 스칼라로 푼다.
+// 출력은 항상 픽셀당 4바이트 RGBA이다. BC4는 (R, 0, 0, 255), BC5는 (R, G, 0, 255)로 하드웨어 샘플링 결과와 같다.
+// SNORM 형식은 [-1, 1]을 [0, 255]로 옮겨서 내보낸다.
+// 사용법:
+//   std::vector<BCSurface> surfaces = { { src, srcRowPitch, width, height, dst, width * 4 }, ... };
+//   DecodeBCSurfaces(&jobs, DXGI_FORMAT_BC1_UNORM, surfaces.data(), surfaces.size());
+
+struct BCSurface
+{
+	// 블록 한 줄(4픽셀 높이) 단위의 행 간격
+	const uint8_t* Source = nullptr;
+	size_t SourceRowPitch = 0;
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+
+	// RGBA8
+	uint8_t* Destination = nullptr;
+	size_t DestinationRowPitch = 0;
+};
+
+struct BCDecodeStats
+{
+	uint64_t Blocks = 0;
+	uint64_t Pixels = 0;
+	double Seconds = 0.0;
+
+	double GetMegaPixelsPerSecond() const;
+};
+
+// BC 형식이면 블록 하나의 바이트 수(8 또는 16), 아니면 0
+size_t GetBCBlockBytes(DXGI_FORMAT format);
+bool IsBCDecodeSupported(DXGI_FORMAT format);
+
+// BC를 풀었을 때 쓸 RGBA8 형식. _SRGB 형식은 R8G8B8A8_UNORM_SRGB
+DXGI_FORMAT GetBCDecodedFormat(DXGI_FORMAT format);
+
+// 실행 중인 CPU에서 SIMD 경로를 쓸 수 있는지. SetBCDecodeSimdEnabled(false)로 끌 수 있다(비교 측정용).
+bool IsBCDecodeSimdAvailable();
+void SetBCDecodeSimdEnabled(bool enabled);
+
+// 4x4 블록 하나를 풀어서 rgba[64]에 행 우선으로 쓴다.
+bool DecodeBCBlock(DXGI_FORMAT format, const uint8_t* block, uint8_t rgba[64]);
+
+// 한 면(밉 하나, 배열 원소 하나)을 호출 스레드에서 푼다.
+bool DecodeBCSurface(DXGI_FORMAT format, const BCSurface& surface);
+
+// 여러 면(보통 밉 체인 전체)을 블록 줄 단위로 나눠서 jobs에서 병렬로 푼다. jobs가 nullptr이면 호출 스레드에서 푼다.
+// 작은 밉은 블록 줄이 적으므로 면 경계를 넘어서 일을 나눈다.
+bool DecodeBCSurfaces(JobSystem* jobs, DXGI_FORMAT format, const BCSurface* surfaces, size_t surfaceCount,
+	BCDecodeStats* stats = nullptr);
+
+#endif
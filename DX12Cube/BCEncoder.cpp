@@ -0,0 +1,1081 @@
+#include "BCEncoder.h"
+#include "BC7Tables.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+// x64는 SSE2가 기본이므로 실행 중 확인 없이 쓴다.
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define BC_ENCODER_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	enum class EncodeKind
+	{
+		None,
+		BC1,
+		BC3,
+		BC7,
+	};
+
+	EncodeKind GetEncodeKind(DXGI_FORMAT format)
+	{
+		switch (format)
+		{
+		case DXGI_FORMAT_BC1_TYPELESS:
+		case DXGI_FORMAT_BC1_UNORM:
+		case DXGI_FORMAT_BC1_UNORM_SRGB:
+			return EncodeKind::BC1;
+
+		case DXGI_FORMAT_BC3_TYPELESS:
+		case DXGI_FORMAT_BC3_UNORM:
+		case DXGI_FORMAT_BC3_UNORM_SRGB:
+			return EncodeKind::BC3;
+
+		case DXGI_FORMAT_BC7_TYPELESS:
+		case DXGI_FORMAT_BC7_UNORM:
+		case DXGI_FORMAT_BC7_UNORM_SRGB:
+			return EncodeKind::BC7;
+
+		default:
+			return EncodeKind::None;
+		}
+	}
+
+	const uint32_t AllPixels = 0xffff;
+
+	// 4x4 블록 픽셀. 채널마다 16개씩 모아 두어(SoA) 4픽셀씩 SIMD로 처리한다.
+	struct BlockPixels
+	{
+		alignas(16) float Channels[4][16];
+		bool Opaque = true;
+	};
+
+	void LoadBlock(const uint8_t rgba[64], BlockPixels& pixels)
+	{
+		pixels.Opaque = true;
+		for (int i = 0; i < 16; i++)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				pixels.Channels[c][i] = rgba[i * 4 + c];
+			}
+			pixels.Opaque = pixels.Opaque && rgba[i * 4 + 3] == 255;
+		}
+	}
+
+	//--------------------------------------------------------------------------------------
+	// 인덱스 고르기: 픽셀마다 [firstChannel, lastChannel) 채널 거리로 가장 가까운 팔레트 항목
+	// palette[k][c]는 디코더가 만드는 값과 같아야 한다. errors[i]는 픽셀별 제곱 오차
+	//--------------------------------------------------------------------------------------
+	void SelectIndices(const BlockPixels& pixels, const float (*palette)[4], uint32_t entries,
+		uint32_t firstChannel, uint32_t lastChannel, uint8_t indices[16], float errors[16])
+	{
+#ifdef BC_ENCODER_SSE
+		for (uint32_t group = 0; group < 16; group += 4)
+		{
+			__m128 bestError = _mm_set1_ps(FLT_MAX);
+			__m128i bestIndex = _mm_setzero_si128();
+			for (uint32_t k = 0; k < entries; k++)
+			{
+				__m128 distance = _mm_setzero_ps();
+				for (uint32_t c = firstChannel; c < lastChannel; c++)
+				{
+					__m128 diff = _mm_sub_ps(_mm_load_ps(&pixels.Channels[c][group]), _mm_set1_ps(palette[k][c]));
+					distance = _mm_add_ps(distance, _mm_mul_ps(diff, diff));
+				}
+				__m128i closer = _mm_castps_si128(_mm_cmplt_ps(distance, bestError));
+				bestError = _mm_min_ps(distance, bestError);
+				bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(static_cast<int>(k))), _mm_andnot_si128(closer, bestIndex));
+			}
+
+			alignas(16) int32_t lanes[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(lanes), bestIndex);
+			_mm_storeu_ps(&errors[group], bestError);
+			for (uint32_t i = 0; i < 4; i++)
+			{
+				indices[group + i] = static_cast<uint8_t>(lanes[i]);
+			}
+		}
+#else
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			float bestError = FLT_MAX;
+			uint8_t bestIndex = 0;
+			for (uint32_t k = 0; k < entries; k++)
+			{
+				float distance = 0.0f;
+				for (uint32_t c = firstChannel; c < lastChannel; c++)
+				{
+					float diff = pixels.Channels[c][i] - palette[k][c];
+					distance += diff * diff;
+				}
+				if (distance < bestError)
+				{
+					bestError = distance;
+					bestIndex = static_cast<uint8_t>(k);
+				}
+			}
+			indices[i] = bestIndex;
+			errors[i] = bestError;
+		}
+#endif
+	}
+
+	float SumErrors(const float errors[16], uint32_t mask)
+	{
+		float sum = 0.0f;
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			if (mask & (1u << i))
+			{
+				sum += errors[i];
+			}
+		}
+		return sum;
+	}
+
+	//--------------------------------------------------------------------------------------
+	// 끝점 찾기: mask에 속한 픽셀의 주성분 축을 구해서 축 위로 투영한 최소/최대를 끝점으로 쓴다(range fit).
+	//--------------------------------------------------------------------------------------
+	void FitRange(const BlockPixels& pixels, uint32_t mask, uint32_t firstChannel, uint32_t lastChannel,
+		float lo[4], float hi[4])
+	{
+		float mean[4] = {};
+		float count = 0.0f;
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			if (mask & (1u << i))
+			{
+				for (uint32_t c = firstChannel; c < lastChannel; c++)
+				{
+					mean[c] += pixels.Channels[c][i];
+				}
+				count += 1.0f;
+			}
+		}
+		if (count == 0.0f)
+		{
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				lo[c] = hi[c] = 0.0f;
+			}
+			return;
+		}
+		for (uint32_t c = firstChannel; c < lastChannel; c++)
+		{
+			mean[c] /= count;
+		}
+
+		float covariance[4][4] = {};
+		float boxMin[4] = { FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX };
+		float boxMax[4] = { -FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX };
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			if (!(mask & (1u << i)))
+			{
+				continue;
+			}
+			for (uint32_t a = firstChannel; a < lastChannel; a++)
+			{
+				float da = pixels.Channels[a][i] - mean[a];
+				for (uint32_t b = a; b < lastChannel; b++)
+				{
+					covariance[a][b] += da * (pixels.Channels[b][i] - mean[b]);
+				}
+				boxMin[a] = std::min(boxMin[a], pixels.Channels[a][i]);
+				boxMax[a] = std::max(boxMax[a], pixels.Channels[a][i]);
+			}
+		}
+
+		// 거듭제곱법. 경계 상자의 대각선에서 시작하면 몇 번이면 충분히 수렴한다.
+		float axis[4] = {};
+		for (uint32_t c = firstChannel; c < lastChannel; c++)
+		{
+			axis[c] = boxMax[c] - boxMin[c];
+		}
+		for (int iteration = 0; iteration < 4; iteration++)
+		{
+			float next[4] = {};
+			for (uint32_t a = firstChannel; a < lastChannel; a++)
+			{
+				for (uint32_t b = firstChannel; b < lastChannel; b++)
+				{
+					next[a] += ((a <= b) ? covariance[a][b] : covariance[b][a]) * axis[b];
+				}
+			}
+			float length = 0.0f;
+			for (uint32_t c = firstChannel; c < lastChannel; c++)
+			{
+				length = std::max(length, std::fabs(next[c]));
+			}
+			if (length < 1e-6f)
+			{
+				break;
+			}
+			for (uint32_t c = firstChannel; c < lastChannel; c++)
+			{
+				axis[c] = next[c] / length;
+			}
+		}
+
+		float lengthSquared = 0.0f;
+		for (uint32_t c = firstChannel; c < lastChannel; c++)
+		{
+			lengthSquared += axis[c] * axis[c];
+		}
+		if (lengthSquared < 1e-12f)
+		{
+			// 한 가지 색뿐
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				lo[c] = hi[c] = mean[c];
+			}
+			return;
+		}
+		const float inverseLength = 1.0f / std::sqrt(lengthSquared);
+		for (uint32_t c = firstChannel; c < lastChannel; c++)
+		{
+			axis[c] *= inverseLength;
+		}
+
+		float tMin = FLT_MAX, tMax = -FLT_MAX;
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			if (!(mask & (1u << i)))
+			{
+				continue;
+			}
+			float t = 0.0f;
+			for (uint32_t c = firstChannel; c < lastChannel; c++)
+			{
+				t += (pixels.Channels[c][i] - mean[c]) * axis[c];
+			}
+			tMin = std::min(tMin, t);
+			tMax = std::max(tMax, t);
+		}
+
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			lo[c] = std::clamp(mean[c] + axis[c] * tMin, 0.0f, 255.0f);
+			hi[c] = std::clamp(mean[c] + axis[c] * tMax, 0.0f, 255.0f);
+		}
+	}
+
+	// RGB 1차/2차 모멘트. 분할 후보를 빠르게 평가할 때 픽셀을 다시 돌지 않고 더하고 빼서 쓴다.
+	struct ColorMoments
+	{
+		float Count = 0.0f;
+		float Sum[3] = {};
+		// rr, rg, rb, gg, gb, bb
+		float Products[6] = {};
+
+		ColorMoments() = default;
+		ColorMoments(const BlockPixels& pixels, uint32_t i)
+		{
+			const float r = pixels.Channels[0][i], g = pixels.Channels[1][i], b = pixels.Channels[2][i];
+			Count = 1.0f;
+			Sum[0] = r; Sum[1] = g; Sum[2] = b;
+			Products[0] = r * r; Products[1] = r * g; Products[2] = r * b;
+			Products[3] = g * g; Products[4] = g * b; Products[5] = b * b;
+		}
+
+		ColorMoments& operator+=(const ColorMoments& other)
+		{
+			Count += other.Count;
+			for (int i = 0; i < 3; i++) Sum[i] += other.Sum[i];
+			for (int i = 0; i < 6; i++) Products[i] += other.Products[i];
+			return *this;
+		}
+
+		ColorMoments& operator-=(const ColorMoments& other)
+		{
+			Count -= other.Count;
+			for (int i = 0; i < 3; i++) Sum[i] -= other.Sum[i];
+			for (int i = 0; i < 6; i++) Products[i] -= other.Products[i];
+			return *this;
+		}
+
+		// 주성분 축으로 이은 직선에서 벗어난 제곱 거리 합 = 분산 합 - 최대 고유값
+		float EstimateLineError() const
+		{
+			if (Count < 1.0f)
+			{
+				return 0.0f;
+			}
+
+			const float inverseCount = 1.0f / Count;
+			const float c00 = Products[0] - Sum[0] * Sum[0] * inverseCount;
+			const float c01 = Products[1] - Sum[0] * Sum[1] * inverseCount;
+			const float c02 = Products[2] - Sum[0] * Sum[2] * inverseCount;
+			const float c11 = Products[3] - Sum[1] * Sum[1] * inverseCount;
+			const float c12 = Products[4] - Sum[1] * Sum[2] * inverseCount;
+			const float c22 = Products[5] - Sum[2] * Sum[2] * inverseCount;
+			const float trace = c00 + c11 + c22;
+
+			float v[3] = { c00 + c01 + c02, c01 + c11 + c12, c02 + c12 + c22 };
+			for (int iteration = 0; iteration < 3; iteration++)
+			{
+				float next[3] =
+				{
+					c00 * v[0] + c01 * v[1] + c02 * v[2],
+					c01 * v[0] + c11 * v[1] + c12 * v[2],
+					c02 * v[0] + c12 * v[1] + c22 * v[2],
+				};
+				float length = std::max(std::fabs(next[0]), std::max(std::fabs(next[1]), std::fabs(next[2])));
+				if (length < 1e-6f)
+				{
+					return std::max(trace, 0.0f);
+				}
+				v[0] = next[0] / length; v[1] = next[1] / length; v[2] = next[2] / length;
+			}
+
+			const float lengthSquared = v[0] * v[0] + v[1] * v[1] + v[2] * v[2];
+			const float cv[3] =
+			{
+				c00 * v[0] + c01 * v[1] + c02 * v[2],
+				c01 * v[0] + c11 * v[1] + c12 * v[2],
+				c02 * v[0] + c12 * v[1] + c22 * v[2],
+			};
+			const float eigenvalue = (v[0] * cv[0] + v[1] * cv[1] + v[2] * cv[2]) / lengthSquared;
+			return std::max(trace - eigenvalue, 0.0f);
+		}
+	};
+
+	// 정해진 인덱스(가중치 weights[index], 0 ~ 1)에서 오차가 가장 작은 끝점을 최소제곱으로 다시 구한다.
+	bool RefineEndpoints(const BlockPixels& pixels, uint32_t mask, const uint8_t indices[16], const float* weights,
+		uint32_t firstChannel, uint32_t lastChannel, float lo[4], float hi[4])
+	{
+		float a = 0.0f, b = 0.0f, c = 0.0f;
+		float x0[4] = {}, x1[4] = {};
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			if (!(mask & (1u << i)))
+			{
+				continue;
+			}
+			const float w = weights[indices[i]];
+			const float v = 1.0f - w;
+			a += v * v;
+			b += v * w;
+			c += w * w;
+			for (uint32_t ch = firstChannel; ch < lastChannel; ch++)
+			{
+				x0[ch] += v * pixels.Channels[ch][i];
+				x1[ch] += w * pixels.Channels[ch][i];
+			}
+		}
+
+		const float determinant = a * c - b * b;
+		if (std::fabs(determinant) < 1e-6f)
+		{
+			return false;
+		}
+		const float inverse = 1.0f / determinant;
+		for (uint32_t ch = firstChannel; ch < lastChannel; ch++)
+		{
+			lo[ch] = std::clamp((c * x0[ch] - b * x1[ch]) * inverse, 0.0f, 255.0f);
+			hi[ch] = std::clamp((a * x1[ch] - b * x0[ch]) * inverse, 0.0f, 255.0f);
+		}
+		return true;
+	}
+
+	// 블록을 낮은 비트부터 채운다.
+	class BlockBitWriter
+	{
+	public:
+		void Write(uint32_t value, uint32_t count)
+		{
+			if (count == 0)
+			{
+				return;
+			}
+
+			const uint64_t bits = value & ((1ull << count) - 1);
+			if (mPosition < 64)
+			{
+				mLow |= bits << mPosition;
+				if (mPosition + count > 64)
+				{
+					mHigh |= bits >> (64 - mPosition);
+				}
+			}
+			else
+			{
+				mHigh |= bits << (mPosition - 64);
+			}
+			mPosition += count;
+		}
+
+		void Store(uint8_t* block) const
+		{
+			memcpy(block, &mLow, 8);
+			memcpy(block + 8, &mHigh, 8);
+		}
+
+	private:
+		uint64_t mLow = 0;
+		uint64_t mHigh = 0;
+		uint32_t mPosition = 0;
+	};
+
+	//--------------------------------------------------------------------------------------
+	// BC1 / BC3
+	//--------------------------------------------------------------------------------------
+	inline uint32_t Expand5(uint32_t v) { return (v << 3) | (v >> 2); }
+	inline uint32_t Expand6(uint32_t v) { return (v << 2) | (v >> 4); }
+
+	uint16_t QuantizeRGB565(const float color[4])
+	{
+		uint32_t r = static_cast<uint32_t>(color[0] * (31.0f / 255.0f) + 0.5f);
+		uint32_t g = static_cast<uint32_t>(color[1] * (63.0f / 255.0f) + 0.5f);
+		uint32_t b = static_cast<uint32_t>(color[2] * (31.0f / 255.0f) + 0.5f);
+		return static_cast<uint16_t>((std::min(r, 31u) << 11) | (std::min(g, 63u) << 5) | std::min(b, 31u));
+	}
+
+	struct ColorBlockCandidate
+	{
+		uint16_t Color0 = 0;
+		uint16_t Color1 = 0;
+		uint8_t Indices[16] = {};
+		float Error = FLT_MAX;
+	};
+
+	// BCDecoder의 BuildColorPalette와 같은 값을 float로 만든다.
+	uint32_t BuildColorPalette(uint16_t c0, uint16_t c1, bool fourColors, float palette[4][4])
+	{
+		const uint32_t r0 = Expand5((c0 >> 11) & 31), g0 = Expand6((c0 >> 5) & 63), b0 = Expand5(c0 & 31);
+		const uint32_t r1 = Expand5((c1 >> 11) & 31), g1 = Expand6((c1 >> 5) & 63), b1 = Expand5(c1 & 31);
+		const uint32_t colors[4][3] =
+		{
+			{ r0, g0, b0 },
+			{ r1, g1, b1 },
+			{ (2 * r0 + r1) / 3, (2 * g0 + g1) / 3, (2 * b0 + b1) / 3 },
+			{ (r0 + 2 * r1) / 3, (g0 + 2 * g1) / 3, (b0 + 2 * b1) / 3 },
+		};
+		for (uint32_t k = 0; k < 4; k++)
+		{
+			for (uint32_t c = 0; c < 3; c++)
+			{
+				palette[k][c] = static_cast<float>(colors[k][c]);
+			}
+			palette[k][3] = 255.0f;
+		}
+		if (!fourColors)
+		{
+			palette[2][0] = static_cast<float>((r0 + r1) / 2);
+			palette[2][1] = static_cast<float>((g0 + g1) / 2);
+			palette[2][2] = static_cast<float>((b0 + b1) / 2);
+			return 3;
+		}
+		return 4;
+	}
+
+	// fourColors면 Color0 > Color1(4색 모드), 아니면 Color0 <= Color1(3색 + 투명)
+	void EvaluateColorBlock(const BlockPixels& pixels, uint32_t mask, bool fourColors, const float lo[4], const float hi[4],
+		ColorBlockCandidate& best)
+	{
+		ColorBlockCandidate candidate;
+		candidate.Color0 = QuantizeRGB565(hi);
+		candidate.Color1 = QuantizeRGB565(lo);
+		if ((candidate.Color0 < candidate.Color1) == fourColors)
+		{
+			std::swap(candidate.Color0, candidate.Color1);
+		}
+
+		float palette[4][4];
+		const bool paletteFourColors = fourColors && candidate.Color0 != candidate.Color1;
+		const uint32_t entries = BuildColorPalette(candidate.Color0, candidate.Color1, paletteFourColors, palette);
+
+		float errors[16];
+		SelectIndices(pixels, palette, entries, 0, 3, candidate.Indices, errors);
+		candidate.Error = SumErrors(errors, mask);
+
+		if (candidate.Error < best.Error)
+		{
+			best = candidate;
+		}
+	}
+
+	void EncodeColorBlock(const BlockPixels& pixels, uint32_t mask, bool fourColors, uint8_t* block)
+	{
+		ColorBlockCandidate best;
+		if (mask)
+		{
+			float lo[4], hi[4];
+			FitRange(pixels, mask, 0, 3, lo, hi);
+			EvaluateColorBlock(pixels, mask, fourColors, lo, hi, best);
+
+			// 인덱스 -> 보간 가중치(Color0 = 0, Color1 = 1)
+			const float fourColorWeights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+			const float threeColorWeights[4] = { 0.0f, 1.0f, 0.5f, 0.0f };
+			const bool paletteFourColors = fourColors && best.Color0 != best.Color1;
+			const float* weights = paletteFourColors ? fourColorWeights : threeColorWeights;
+
+			float refinedLo[4], refinedHi[4];
+			if (RefineEndpoints(pixels, mask, best.Indices, weights, 0, 3, refinedHi, refinedLo))
+			{
+				// RefineEndpoints의 lo는 가중치 0(Color0) 쪽이다. EvaluateColorBlock은 hi를 Color0로 쓴다.
+				EvaluateColorBlock(pixels, mask, fourColors, refinedLo, refinedHi, best);
+			}
+		}
+		else
+		{
+			best.Color0 = best.Color1 = 0;
+			best.Error = 0.0f;
+		}
+
+		uint32_t indices = 0;
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			// mask 밖은 투명(3색 모드의 3번)
+			uint32_t index = (mask & (1u << i)) ? best.Indices[i] : 3;
+			indices |= index << (2 * i);
+		}
+
+		block[0] = static_cast<uint8_t>(best.Color0);
+		block[1] = static_cast<uint8_t>(best.Color0 >> 8);
+		block[2] = static_cast<uint8_t>(best.Color1);
+		block[3] = static_cast<uint8_t>(best.Color1 >> 8);
+		memcpy(block + 4, &indices, 4);
+	}
+
+	void EncodeBC1Block(const BlockPixels& pixels, uint8_t alphaThreshold, uint8_t* block)
+	{
+		uint32_t mask = AllPixels;
+		if (alphaThreshold)
+		{
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				if (pixels.Channels[3][i] < alphaThreshold)
+				{
+					mask &= ~(1u << i);
+				}
+			}
+		}
+		EncodeColorBlock(pixels, mask, mask == AllPixels, block);
+	}
+
+	// BC3 알파 (BC4와 같은 8단계)
+	void EncodeAlphaBlock(const BlockPixels& pixels, uint8_t* block)
+	{
+		float alphaMin = 255.0f, alphaMax = 0.0f;
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			alphaMin = std::min(alphaMin, pixels.Channels[3][i]);
+			alphaMax = std::max(alphaMax, pixels.Channels[3][i]);
+		}
+
+		const uint32_t a0 = static_cast<uint32_t>(alphaMax);
+		const uint32_t a1 = static_cast<uint32_t>(alphaMin);
+		uint64_t indexBits = 0;
+		if (a0 > a1)
+		{
+			// BCDecoder의 BuildChannelPalette와 같은 반올림
+			float palette[8][4] = {};
+			palette[0][3] = static_cast<float>(a0);
+			palette[1][3] = static_cast<float>(a1);
+			for (uint32_t k = 1; k <= 6; k++)
+			{
+				palette[k + 1][3] = static_cast<float>(((7 - k) * a0 + k * a1 + 3) / 7);
+			}
+
+			uint8_t indices[16];
+			float errors[16];
+			SelectIndices(pixels, palette, 8, 3, 4, indices, errors);
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				indexBits |= static_cast<uint64_t>(indices[i]) << (3 * i);
+			}
+		}
+
+		block[0] = static_cast<uint8_t>(a0);
+		block[1] = static_cast<uint8_t>(a1);
+		for (uint32_t i = 0; i < 6; i++)
+		{
+			block[2 + i] = static_cast<uint8_t>(indexBits >> (8 * i));
+		}
+	}
+
+	//--------------------------------------------------------------------------------------
+	// BC7
+	//--------------------------------------------------------------------------------------
+	enum class PBitMode
+	{
+		None,
+		Shared,
+		PerEndpoint,
+	};
+
+	struct SubsetFormat
+	{
+		uint32_t ColorBits;
+		uint32_t AlphaBits;
+		PBitMode PBits;
+		uint32_t IndexBits;
+		uint32_t FirstChannel;
+		uint32_t LastChannel;
+	};
+
+	struct SubsetCandidate
+	{
+		uint32_t Codes[2][4] = {};
+		uint32_t PBits[2] = {};
+		uint8_t Indices[16] = {};
+		float Error = FLT_MAX;
+	};
+
+	// v(0 ~ 255)를 bits비트로 양자화한다. pBit >= 0이면 최하위에 붙는 p비트까지 고려한다. 복원 값을 돌려준다.
+	uint32_t QuantizeEndpoint(float v, uint32_t bits, int pBit, uint32_t& code)
+	{
+		if (pBit < 0)
+		{
+			const float scale = static_cast<float>((1u << bits) - 1);
+			code = std::min(static_cast<uint32_t>(v / 255.0f * scale + 0.5f), (1u << bits) - 1);
+			return BC7ExpandBits(code, bits);
+		}
+
+		const float scale = static_cast<float>((1u << (bits + 1)) - 1);
+		const float x = (v / 255.0f * scale - pBit) * 0.5f;
+		code = static_cast<uint32_t>(std::clamp(x + 0.5f, 0.0f, static_cast<float>((1u << bits) - 1)));
+		return BC7ExpandBits((code << 1) | pBit, bits + 1);
+	}
+
+	void EvaluateSubset(const BlockPixels& pixels, uint32_t mask, const SubsetFormat& format,
+		const float lo[4], const float hi[4], SubsetCandidate& best)
+	{
+		const float* endpoints[2] = { lo, hi };
+		const uint32_t pBitCombos = (format.PBits == PBitMode::None) ? 1 : (format.PBits == PBitMode::Shared) ? 2 : 4;
+		const uint8_t* weights = GetBC7Weights(format.IndexBits);
+		const uint32_t entries = 1u << format.IndexBits;
+
+		// 불투명 블록에서 알파까지 p비트를 공유하는 형식(모드 6)은 두 p비트가 모두 1이어야 알파가 255로 복원된다.
+		// 다른 조합은 RGB 오차가 조금 더 작아도 알파가 254로 떨어지므로 고르지 않는다.
+		const bool keepOpaque = pixels.Opaque && format.LastChannel == 4 && format.PBits == PBitMode::PerEndpoint;
+		for (uint32_t combo = keepOpaque ? 3 : 0; combo < pBitCombos; combo++)
+		{
+			SubsetCandidate candidate;
+			uint32_t values[2][4] = {};
+			for (uint32_t e = 0; e < 2; e++)
+			{
+				int pBit = -1;
+				if (format.PBits == PBitMode::Shared)
+				{
+					pBit = combo & 1;
+				}
+				else if (format.PBits == PBitMode::PerEndpoint)
+				{
+					pBit = (combo >> e) & 1;
+				}
+				candidate.PBits[e] = std::max(pBit, 0);
+
+				for (uint32_t c = format.FirstChannel; c < format.LastChannel; c++)
+				{
+					const uint32_t bits = (c == 3) ? format.AlphaBits : format.ColorBits;
+					values[e][c] = QuantizeEndpoint(endpoints[e][c], bits, pBit, candidate.Codes[e][c]);
+				}
+			}
+
+			float palette[16][4];
+			for (uint32_t k = 0; k < entries; k++)
+			{
+				for (uint32_t c = format.FirstChannel; c < format.LastChannel; c++)
+				{
+					palette[k][c] = BC7Interpolate(values[0][c], values[1][c], weights[k]);
+				}
+			}
+
+			float errors[16];
+			SelectIndices(pixels, palette, entries, format.FirstChannel, format.LastChannel, candidate.Indices, errors);
+			candidate.Error = SumErrors(errors, mask);
+			if (candidate.Error < best.Error)
+			{
+				best = candidate;
+			}
+		}
+	}
+
+	SubsetCandidate EncodeSubset(const BlockPixels& pixels, uint32_t mask, const SubsetFormat& format, int refineIterations)
+	{
+		SubsetCandidate best;
+		float lo[4] = {}, hi[4] = {};
+		FitRange(pixels, mask, format.FirstChannel, format.LastChannel, lo, hi);
+		EvaluateSubset(pixels, mask, format, lo, hi, best);
+
+		float weights[16];
+		const uint8_t* integerWeights = GetBC7Weights(format.IndexBits);
+		for (uint32_t k = 0; k < (1u << format.IndexBits); k++)
+		{
+			weights[k] = integerWeights[k] / 64.0f;
+		}
+
+		for (int iteration = 0; iteration < refineIterations; iteration++)
+		{
+			const float previousError = best.Error;
+			if (!RefineEndpoints(pixels, mask, best.Indices, weights, format.FirstChannel, format.LastChannel, lo, hi))
+			{
+				break;
+			}
+			EvaluateSubset(pixels, mask, format, lo, hi, best);
+			if (best.Error >= previousError)
+			{
+				break;
+			}
+		}
+		return best;
+	}
+
+	// 기준 픽셀(anchor)의 인덱스 최상위 비트는 저장하지 않으므로 0이어야 한다. 아니면 끝점을 바꾸고 인덱스를 뒤집는다.
+	void FixAnchor(SubsetCandidate& subset, uint32_t mask, uint32_t anchor, uint32_t indexBits, bool swapPBits)
+	{
+		const uint32_t highest = (1u << indexBits) - 1;
+		if (subset.Indices[anchor] <= highest / 2)
+		{
+			return;
+		}
+
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			std::swap(subset.Codes[0][c], subset.Codes[1][c]);
+		}
+		if (swapPBits)
+		{
+			std::swap(subset.PBits[0], subset.PBits[1]);
+		}
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			if (mask & (1u << i))
+			{
+				subset.Indices[i] = static_cast<uint8_t>(highest - subset.Indices[i]);
+			}
+		}
+	}
+
+	struct BC7Candidate
+	{
+		uint8_t Block[16] = {};
+		float Error = FLT_MAX;
+	};
+
+	void EncodeBC7Mode6(const BlockPixels& pixels, int refineIterations, BC7Candidate& best)
+	{
+		const SubsetFormat format = { 7, 7, PBitMode::PerEndpoint, 4, 0, 4 };
+		SubsetCandidate subset = EncodeSubset(pixels, AllPixels, format, refineIterations);
+		if (subset.Error >= best.Error)
+		{
+			return;
+		}
+		FixAnchor(subset, AllPixels, 0, 4, true);
+
+		BlockBitWriter writer;
+		writer.Write(1u << 6, 7);
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			writer.Write(subset.Codes[0][c], 7);
+			writer.Write(subset.Codes[1][c], 7);
+		}
+		writer.Write(subset.PBits[0], 1);
+		writer.Write(subset.PBits[1], 1);
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			writer.Write(subset.Indices[i], (i == 0) ? 3 : 4);
+		}
+
+		writer.Store(best.Block);
+		best.Error = subset.Error;
+	}
+
+	void EncodeBC7Mode1(const BlockPixels& pixels, uint32_t partitionCandidates, int refineIterations, BC7Candidate& best)
+	{
+		// 분할마다 두 부분집합이 각자의 주성분 축에서 얼마나 벗어나는지로 후보를 고른다.
+		// 0번 부분집합의 모멘트는 전체에서 1번을 빼서 구한다.
+		ColorMoments pixelMoments[16];
+		ColorMoments total;
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			pixelMoments[i] = ColorMoments(pixels, i);
+			total += pixelMoments[i];
+		}
+
+		std::pair<float, uint32_t> estimates[64];
+		for (uint32_t p = 0; p < 64; p++)
+		{
+			ColorMoments subset1;
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				if (gBC7Partitions2[p] & (1u << i))
+				{
+					subset1 += pixelMoments[i];
+				}
+			}
+			ColorMoments subset0 = total;
+			subset0 -= subset1;
+			estimates[p] = { subset0.EstimateLineError() + subset1.EstimateLineError(), p };
+		}
+		partitionCandidates = std::min(partitionCandidates, 64u);
+		std::partial_sort(estimates, estimates + partitionCandidates, estimates + 64);
+
+		const SubsetFormat format = { 6, 0, PBitMode::Shared, 3, 0, 3 };
+		for (uint32_t n = 0; n < partitionCandidates; n++)
+		{
+			const uint32_t partition = estimates[n].second;
+			const uint32_t masks[2] = { ~gBC7Partitions2[partition] & AllPixels, gBC7Partitions2[partition] };
+
+			SubsetCandidate subsets[2];
+			float error = 0.0f;
+			for (uint32_t s = 0; s < 2 && error < best.Error; s++)
+			{
+				subsets[s] = EncodeSubset(pixels, masks[s], format, refineIterations);
+				error += subsets[s].Error;
+			}
+			if (error >= best.Error)
+			{
+				continue;
+			}
+
+			FixAnchor(subsets[0], masks[0], 0, 3, false);
+			FixAnchor(subsets[1], masks[1], gBC7Anchors2[partition], 3, false);
+
+			BlockBitWriter writer;
+			writer.Write(1u << 1, 2);
+			writer.Write(partition, 6);
+			for (uint32_t c = 0; c < 3; c++)
+			{
+				for (uint32_t s = 0; s < 2; s++)
+				{
+					writer.Write(subsets[s].Codes[0][c], 6);
+					writer.Write(subsets[s].Codes[1][c], 6);
+				}
+			}
+			writer.Write(subsets[0].PBits[0], 1);
+			writer.Write(subsets[1].PBits[0], 1);
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				const uint32_t s = (masks[1] >> i) & 1;
+				const bool anchor = (i == 0 || i == gBC7Anchors2[partition]);
+				writer.Write(subsets[s].Indices[i], anchor ? 2 : 3);
+			}
+
+			writer.Store(best.Block);
+			best.Error = error;
+		}
+	}
+
+	void EncodeBC7Mode5(const BlockPixels& pixels, int refineIterations, BC7Candidate& best)
+	{
+		// 회전 없이 색(7비트)과 알파(8비트)를 각자의 2비트 인덱스로
+		const SubsetFormat colorFormat = { 7, 0, PBitMode::None, 2, 0, 3 };
+		const SubsetFormat alphaFormat = { 0, 8, PBitMode::None, 2, 3, 4 };
+		SubsetCandidate color = EncodeSubset(pixels, AllPixels, colorFormat, refineIterations);
+		SubsetCandidate alpha = EncodeSubset(pixels, AllPixels, alphaFormat, refineIterations);
+		const float error = color.Error + alpha.Error;
+		if (error >= best.Error)
+		{
+			return;
+		}
+		FixAnchor(color, AllPixels, 0, 2, false);
+		FixAnchor(alpha, AllPixels, 0, 2, false);
+
+		BlockBitWriter writer;
+		writer.Write(1u << 5, 6);
+		writer.Write(0, 2);
+		for (uint32_t c = 0; c < 3; c++)
+		{
+			writer.Write(color.Codes[0][c], 7);
+			writer.Write(color.Codes[1][c], 7);
+		}
+		writer.Write(alpha.Codes[0][3], 8);
+		writer.Write(alpha.Codes[1][3], 8);
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			writer.Write(color.Indices[i], (i == 0) ? 1 : 2);
+		}
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			writer.Write(alpha.Indices[i], (i == 0) ? 1 : 2);
+		}
+
+		writer.Store(best.Block);
+		best.Error = error;
+	}
+
+	void EncodeBC7Block(const BlockPixels& pixels, BC7Quality quality, uint8_t* block)
+	{
+		BC7Candidate best;
+		switch (quality)
+		{
+		case BC7Quality::Fast:
+			EncodeBC7Mode6(pixels, 0, best);
+			break;
+
+		case BC7Quality::Normal:
+			EncodeBC7Mode6(pixels, 1, best);
+			if (pixels.Opaque)
+			{
+				EncodeBC7Mode1(pixels, 1, 1, best);
+			}
+			else
+			{
+				EncodeBC7Mode5(pixels, 1, best);
+			}
+			break;
+
+		case BC7Quality::High:
+			EncodeBC7Mode6(pixels, 3, best);
+			if (pixels.Opaque)
+			{
+				EncodeBC7Mode1(pixels, 8, 3, best);
+			}
+			EncodeBC7Mode5(pixels, 3, best);
+			break;
+		}
+		memcpy(block, best.Block, 16);
+	}
+
+	void EncodeBlock(EncodeKind kind, const uint8_t rgba[64], const BCEncodeOptions& options, uint8_t* block)
+	{
+		BlockPixels pixels;
+		LoadBlock(rgba, pixels);
+
+		switch (kind)
+		{
+		case EncodeKind::BC1:
+			EncodeBC1Block(pixels, options.BC1AlphaThreshold, block);
+			break;
+
+		case EncodeKind::BC3:
+			EncodeAlphaBlock(pixels, block);
+			EncodeColorBlock(pixels, AllPixels, true, block + 8);
+			break;
+
+		case EncodeKind::BC7:
+			EncodeBC7Block(pixels, options.Quality, block);
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	void EncodeBlockRow(EncodeKind kind, size_t blockBytes, const BCEncodeSurface& surface, uint32_t blockRow,
+		const BCEncodeOptions& options)
+	{
+		const uint32_t blocksWide = (surface.Width + 3) / 4;
+		uint8_t* destination = surface.Destination + blockRow * surface.DestinationRowPitch;
+
+		uint8_t rgba[64];
+		for (uint32_t bx = 0; bx < blocksWide; bx++, destination += blockBytes)
+		{
+			// 가장자리 블록은 마지막 행/열을 반복
+			for (uint32_t y = 0; y < 4; y++)
+			{
+				const uint32_t sy = std::min(blockRow * 4 + y, surface.Height - 1);
+				const uint8_t* row = surface.Source + sy * surface.SourceRowPitch;
+				for (uint32_t x = 0; x < 4; x++)
+				{
+					const uint32_t sx = std::min(bx * 4 + x, surface.Width - 1);
+					memcpy(rgba + (y * 4 + x) * 4, row + sx * 4, 4);
+				}
+			}
+			EncodeBlock(kind, rgba, options, destination);
+		}
+	}
+}
+
+double BCEncodeStats::GetMegaPixelsPerSecond() const
+{
+	if (Seconds <= 0.0)
+	{
+		return 0.0;
+	}
+	return (Pixels / 1000000.0) / Seconds;
+}
+
+bool IsBCEncodeSupported(DXGI_FORMAT format)
+{
+	return GetEncodeKind(format) != EncodeKind::None;
+}
+
+bool EncodeBCBlock(DXGI_FORMAT format, const uint8_t rgba[64], uint8_t* block, const BCEncodeOptions& options)
+{
+	const EncodeKind kind = GetEncodeKind(format);
+	if (kind == EncodeKind::None || !rgba || !block)
+	{
+		return false;
+	}
+
+	EncodeBlock(kind, rgba, options, block);
+	return true;
+}
+
+bool EncodeBCSurfaces(JobSystem* jobs, DXGI_FORMAT format, const BCEncodeSurface* surfaces, size_t surfaceCount,
+	const BCEncodeOptions& options, BCEncodeStats* stats)
+{
+	const EncodeKind kind = GetEncodeKind(format);
+	if (kind == EncodeKind::None || (!surfaces && surfaceCount))
+	{
+		return false;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	const size_t blockBytes = (kind == EncodeKind::BC1) ? 8 : 16;
+
+	// 모든 면의 블록 줄을 한 줄로 세운다. rowStarts[i]는 i번 면의 첫 블록 줄 번호
+	std::vector<size_t> rowStarts(surfaceCount + 1, 0);
+	uint64_t totalBlocks = 0;
+	uint64_t totalPixels = 0;
+	for (size_t i = 0; i < surfaceCount; i++)
+	{
+		const BCEncodeSurface& surface = surfaces[i];
+		if (!surface.Source || !surface.Destination || !surface.Width || !surface.Height)
+		{
+			return false;
+		}
+
+		const size_t blocksWide = (surface.Width + 3) / 4;
+		const size_t blocksHigh = (surface.Height + 3) / 4;
+		rowStarts[i + 1] = rowStarts[i] + blocksHigh;
+		totalBlocks += blocksWide * blocksHigh;
+		totalPixels += static_cast<uint64_t>(surface.Width) * surface.Height;
+	}
+
+	auto encodeRows = [&](size_t begin, size_t end)
+	{
+		size_t s = std::upper_bound(rowStarts.begin(), rowStarts.end(), begin) - rowStarts.begin() - 1;
+		for (size_t row = begin; row < end; row++)
+		{
+			while (row >= rowStarts[s + 1])
+			{
+				s++;
+			}
+			EncodeBlockRow(kind, blockBytes, surfaces[s], static_cast<uint32_t>(row - rowStarts[s]), options);
+		}
+	};
+
+	const size_t totalRows = rowStarts[surfaceCount];
+	if (jobs && jobs->GetConcurrency() > 1 && totalBlocks > 64)
+	{
+		// 인코딩은 블록당 비용이 커서 디코더보다 잘게 나눈다.
+		const size_t chunkCount = jobs->GetConcurrency() * 8;
+		const size_t grain = std::max<size_t>(1, (totalRows + chunkCount - 1) / chunkCount);
+		jobs->ParallelFor(totalRows, grain, encodeRows);
+	}
+	else
+	{
+		encodeRows(0, totalRows);
+	}
+
+	if (stats)
+	{
+		stats->Blocks = totalBlocks;
+		stats->Pixels = totalPixels;
+		stats->Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+	return true;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#ifndef _BCENCODER_H_
+#define _BCENCODER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <dxgiformat.h>
+
+class JobSystem;
+
+// RGBA8 이미지를 BC1/BC3/BC7 블록으로 압축하는 인코더
+// BC1/BC3는 주성분 축 위의 최소/최대(range fit)로 끝점을 잡고 최소제곱으로 한 번 다듬는다.
+// BC7은 품질 단계에 따라 시도하는 모드와 다듬는 횟수가 달라진다.
+// 인덱스 고르기(픽셀마다 가장 가까운 팔레트 찾기)는 SSE2로 4픽셀씩 처리한다.
+// 결과는 BCDecoder로 풀었을 때와 같은 식(팔레트 반올림 포함)으로 오차를 계산해서 고른다.
+// 사용법:
+//   BCEncodeSurface surface = { rgba, width * 4, width, height, blocks, ((width + 3) / 4) * 16 };
+//   EncodeBCSurfaces(&jobs, DXGI_FORMAT_BC7_UNORM, &surface, 1, options);
+
+enum class BC7Quality
+{
+	// 모드 6만, 다듬기 없음
+	Fast,
+	// 모드 6 + (불투명) 모드 1 최적 분할 하나 / (반투명) 모드 5
+	Normal,
+	// 모드 6 + 모드 1 분할 후보 여러 개 + 모드 5, 다듬기 반복
+	High,
+};
+
+struct BCEncodeOptions
+{
+	BC7Quality Quality = BC7Quality::Normal;
+	// BC1에서 알파가 이 값보다 작으면 투명(3색 모드)으로 뺀다. 0이면 알파를 무시
+	uint8_t BC1AlphaThreshold = 128;
+};
+
+struct BCEncodeSurface
+{
+	// RGBA8
+	const uint8_t* Source = nullptr;
+	size_t SourceRowPitch = 0;
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+
+	// 블록 한 줄(4픽셀 높이) 단위의 행 간격
+	uint8_t* Destination = nullptr;
+	size_t DestinationRowPitch = 0;
+};
+
+struct BCEncodeStats
+{
+	uint64_t Blocks = 0;
+	uint64_t Pixels = 0;
+	double Seconds = 0.0;
+
+	double GetMegaPixelsPerSecond() const;
+};
+
+// BC1, BC3, BC7 (UNORM/_SRGB/TYPELESS)
+bool IsBCEncodeSupported(DXGI_FORMAT format);
+
+// rgba[64]의 4x4 블록 하나를 압축한다.
+bool EncodeBCBlock(DXGI_FORMAT format, const uint8_t rgba[64], uint8_t* block, const BCEncodeOptions& options = {});
+
+// 여러 면(보통 밉 체인)을 블록 줄 단위로 나눠서 jobs에서 병렬로 압축한다. jobs가 nullptr이면 호출 스레드에서 압축한다.
+// 가장자리의 4픽셀이 안 되는 블록은 마지막 행/열을 반복해서 채운다.
+bool EncodeBCSurfaces(JobSystem* jobs, DXGI_FORMAT format, const BCEncodeSurface* surfaces, size_t surfaceCount,
+	const BCEncodeOptions& options = {}, BCEncodeStats* stats = nullptr);
+
+#endif
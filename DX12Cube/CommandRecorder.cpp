@@ -0,0 +1,200 @@
+#include "CommandRecorder.h"
+#include <cstring>
+#include <format>
+
+namespace
+{
+	const wchar_t* GetCallName(RecordedCall call)
+	{
+		switch (call)
+		{
+		case RecordedCall::PipelineState: return L"pso";
+		case RecordedCall::RootSignature: return L"root signature";
+		case RecordedCall::DescriptorHeaps: return L"heaps";
+		case RecordedCall::RootConstantBufferView: return L"root cbv";
+		case RecordedCall::RootShaderResourceView: return L"root srv";
+		case RecordedCall::RootDescriptorTable: return L"root table";
+		case RecordedCall::PrimitiveTopology: return L"topology";
+		case RecordedCall::VertexBuffer: return L"vb";
+		case RecordedCall::IndexBuffer: return L"ib";
+		case RecordedCall::StencilRef: return L"stencil ref";
+		case RecordedCall::Draw: return L"draw";
+		default: return L"?";
+		}
+	}
+}
+
+UINT64 CommandRecorderStats::GetTotalEmitted() const
+{
+	UINT64 total = 0;
+	for (auto count : Emitted)
+	{
+		total += count;
+	}
+	return total;
+}
+
+UINT64 CommandRecorderStats::GetTotalElided() const
+{
+	UINT64 total = 0;
+	for (auto count : Elided)
+	{
+		total += count;
+	}
+	return total;
+}
+
+CommandRecorderStats& CommandRecorderStats::operator+=(const CommandRecorderStats& other)
+{
+	for (size_t i = 0; i < static_cast<size_t>(RecordedCall::Count); i++)
+	{
+		Emitted[i] += other.Emitted[i];
+		Elided[i] += other.Elided[i];
+	}
+	return *this;
+}
+
+std::wstring CommandRecorderStats::ToString() const
+{
+	auto s = std::format(L"CommandRecorder: {} calls emitted, {} elided", GetTotalEmitted(), GetTotalElided());
+	for (size_t i = 0; i < static_cast<size_t>(RecordedCall::Count); i++)
+	{
+		if (Emitted[i] || Elided[i])
+		{
+			s += std::format(L", {} {}/{}", GetCallName(static_cast<RecordedCall>(i)), Emitted[i], Elided[i]);
+		}
+	}
+	s += L"\n";
+	return s;
+}
+
+void CommandRecorder::Begin(ID3D12GraphicsCommandList* cmdList, ID3D12PipelineState* initialPipelineState)
+{
+	mCmdList = cmdList;
+
+	// Reset한 리스트는 PSO 말고는 아무 상태도 없다.
+	mPipelineState = initialPipelineState;
+	mPipelineStateValid = true;
+	mRootSignatureValid = false;
+	mDescriptorHeapValid = false;
+	mTopologyValid = false;
+	mVertexBufferValid = false;
+	mIndexBufferValid = false;
+	mStencilRefValid = false;
+	ForgetRootParameters();
+}
+
+template <typename T>
+bool CommandRecorder::Track(RecordedCall call, T& current, const T& value, bool& valid)
+{
+	// 뷰 구조체는 == 가 없으므로 바이트로 비교한다. (패딩 없는 POD)
+	if (valid && std::memcmp(&current, &value, sizeof(T)) == 0)
+	{
+		mStats.Elided[static_cast<size_t>(call)]++;
+		return false;
+	}
+
+	current = value;
+	valid = true;
+	mStats.Emitted[static_cast<size_t>(call)]++;
+	return true;
+}
+
+void CommandRecorder::ForgetRootParameters()
+{
+	for (auto& valid : mRootParameterValid)
+	{
+		valid = false;
+	}
+}
+
+void CommandRecorder::SetPipelineState(ID3D12PipelineState* pipelineState)
+{
+	if (Track(RecordedCall::PipelineState, mPipelineState, pipelineState, mPipelineStateValid))
+	{
+		mCmdList->SetPipelineState(pipelineState);
+	}
+}
+
+void CommandRecorder::SetGraphicsRootSignature(ID3D12RootSignature* rootSignature)
+{
+	if (Track(RecordedCall::RootSignature, mRootSignature, rootSignature, mRootSignatureValid))
+	{
+		mCmdList->SetGraphicsRootSignature(rootSignature);
+		// 루트 서명을 바꾸면 이전 바인딩은 모두 없어진다.
+		ForgetRootParameters();
+	}
+}
+
+void CommandRecorder::SetDescriptorHeap(ID3D12DescriptorHeap* heap)
+{
+	if (Track(RecordedCall::DescriptorHeaps, mDescriptorHeap, heap, mDescriptorHeapValid))
+	{
+		mCmdList->SetDescriptorHeaps(1, &heap);
+	}
+}
+
+void CommandRecorder::SetGraphicsRootConstantBufferView(UINT rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS address)
+{
+	if (rootParameterIndex >= MaxRootParameters ||
+		Track(RecordedCall::RootConstantBufferView, mRootParameters[rootParameterIndex], static_cast<UINT64>(address), mRootParameterValid[rootParameterIndex]))
+	{
+		mCmdList->SetGraphicsRootConstantBufferView(rootParameterIndex, address);
+	}
+}
+
+void CommandRecorder::SetGraphicsRootShaderResourceView(UINT rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS address)
+{
+	if (rootParameterIndex >= MaxRootParameters ||
+		Track(RecordedCall::RootShaderResourceView, mRootParameters[rootParameterIndex], static_cast<UINT64>(address), mRootParameterValid[rootParameterIndex]))
+	{
+		mCmdList->SetGraphicsRootShaderResourceView(rootParameterIndex, address);
+	}
+}
+
+void CommandRecorder::SetGraphicsRootDescriptorTable(UINT rootParameterIndex, D3D12_GPU_DESCRIPTOR_HANDLE baseDescriptor)
+{
+	if (rootParameterIndex >= MaxRootParameters ||
+		Track(RecordedCall::RootDescriptorTable, mRootParameters[rootParameterIndex], static_cast<UINT64>(baseDescriptor.ptr), mRootParameterValid[rootParameterIndex]))
+	{
+		mCmdList->SetGraphicsRootDescriptorTable(rootParameterIndex, baseDescriptor);
+	}
+}
+
+void CommandRecorder::IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology)
+{
+	if (Track(RecordedCall::PrimitiveTopology, mTopology, topology, mTopologyValid))
+	{
+		mCmdList->IASetPrimitiveTopology(topology);
+	}
+}
+
+void CommandRecorder::IASetVertexBuffer(const D3D12_VERTEX_BUFFER_VIEW& view)
+{
+	if (Track(RecordedCall::VertexBuffer, mVertexBuffer, view, mVertexBufferValid))
+	{
+		mCmdList->IASetVertexBuffers(0, 1, &view);
+	}
+}
+
+void CommandRecorder::IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW& view)
+{
+	if (Track(RecordedCall::IndexBuffer, mIndexBuffer, view, mIndexBufferValid))
+	{
+		mCmdList->IASetIndexBuffer(&view);
+	}
+}
+
+void CommandRecorder::OMSetStencilRef(UINT stencilRef)
+{
+	if (Track(RecordedCall::StencilRef, mStencilRef, stencilRef, mStencilRefValid))
+	{
+		mCmdList->OMSetStencilRef(stencilRef);
+	}
+}
+
+void CommandRecorder::DrawIndexedInstanced(UINT indexCountPerInstance, UINT instanceCount, UINT startIndexLocation, INT baseVertexLocation, UINT startInstanceLocation)
+{
+	mStats.Emitted[static_cast<size_t>(RecordedCall::Draw)]++;
+	mCmdList->DrawIndexedInstanced(indexCountPerInstance, instanceCount, startIndexLocation, baseVertexLocation, startInstanceLocation);
+}
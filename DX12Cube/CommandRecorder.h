@@ -0,0 +1,109 @@
+#pragma once
+#ifndef _COMMANDRECORDER_H_
+#define _COMMANDRECORDER_H_
+
+#include <string>
+#include <d3d12.h>
+
+// 커맨드 리스트에 마지막으로 넣은 상태를 기억했다가 같은 값을 다시 넣는 호출은 거르는 기록기
+// 커맨드 리스트 하나에 기록기 하나. 리스트를 Reset한 뒤 Begin으로 기억한 상태를 지운다. (리스트끼리 상태는 이어지지 않는다)
+// 루트 서명이 바뀌면 루트 파라미터 바인딩도 모두 잊는다.
+// 배리어, 클리어처럼 거를 것이 없는 호출은 Get()으로 직접 한다.
+// 사용법:
+//   cmdList->Reset(allocator, pso);
+//   recorder.Begin(cmdList, pso);
+//   recorder.SetGraphicsRootSignature(rootSignature);
+//   recorder.IASetVertexBuffer(vbv); // 같은 버퍼면 건너뜀
+//   recorder.DrawIndexedInstanced(...);
+//   stats += recorder.GetStats();
+
+enum class RecordedCall
+{
+	PipelineState,
+	RootSignature,
+	DescriptorHeaps,
+	RootConstantBufferView,
+	RootShaderResourceView,
+	RootDescriptorTable,
+	PrimitiveTopology,
+	VertexBuffer,
+	IndexBuffer,
+	StencilRef,
+	Draw,
+	Count,
+};
+
+struct CommandRecorderStats
+{
+	// 실제로 커맨드 리스트에 넣은 호출과 같은 값이라 거른 호출
+	UINT64 Emitted[static_cast<size_t>(RecordedCall::Count)] = { };
+	UINT64 Elided[static_cast<size_t>(RecordedCall::Count)] = { };
+
+	UINT64 GetTotalEmitted() const;
+	UINT64 GetTotalElided() const;
+
+	CommandRecorderStats& operator+=(const CommandRecorderStats& other);
+	std::wstring ToString() const;
+};
+
+class CommandRecorder
+{
+public:
+	// 루트 서명 1.0 최대 크기 (64 DWORD)를 넘는 파라미터 수는 쓰지 않는다.
+	static constexpr UINT MaxRootParameters = 16;
+
+	// Reset 직후에 호출. initialPipelineState는 Reset에 넘긴 PSO
+	void Begin(ID3D12GraphicsCommandList* cmdList, ID3D12PipelineState* initialPipelineState);
+
+	void SetPipelineState(ID3D12PipelineState* pipelineState);
+	void SetGraphicsRootSignature(ID3D12RootSignature* rootSignature);
+	// CBV/SRV/UAV 힙 하나만 쓴다. (힙을 바꾸면 일부 드라이버는 하드웨어 상태를 비운다)
+	void SetDescriptorHeap(ID3D12DescriptorHeap* heap);
+	void SetGraphicsRootConstantBufferView(UINT rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS address);
+	void SetGraphicsRootShaderResourceView(UINT rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS address);
+	void SetGraphicsRootDescriptorTable(UINT rootParameterIndex, D3D12_GPU_DESCRIPTOR_HANDLE baseDescriptor);
+	void IASetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology);
+	// 0번 슬롯
+	void IASetVertexBuffer(const D3D12_VERTEX_BUFFER_VIEW& view);
+	void IASetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW& view);
+	void OMSetStencilRef(UINT stencilRef);
+
+	void DrawIndexedInstanced(UINT indexCountPerInstance, UINT instanceCount, UINT startIndexLocation, INT baseVertexLocation, UINT startInstanceLocation);
+
+	ID3D12GraphicsCommandList* Get() const { return mCmdList; }
+
+	const CommandRecorderStats& GetStats() const { return mStats; }
+	void ResetStats() { mStats = CommandRecorderStats(); }
+
+private:
+	// 값이 같으면 false를 돌려주고 거른 호출로 센다.
+	template <typename T>
+	bool Track(RecordedCall call, T& current, const T& value, bool& valid);
+
+	void ForgetRootParameters();
+
+	ID3D12GraphicsCommandList* mCmdList = nullptr;
+
+	ID3D12PipelineState* mPipelineState = nullptr;
+	ID3D12RootSignature* mRootSignature = nullptr;
+	ID3D12DescriptorHeap* mDescriptorHeap = nullptr;
+	D3D12_PRIMITIVE_TOPOLOGY mTopology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+	D3D12_VERTEX_BUFFER_VIEW mVertexBuffer = { };
+	D3D12_INDEX_BUFFER_VIEW mIndexBuffer = { };
+	UINT mStencilRef = 0;
+	// 루트 파라미터마다 마지막으로 넣은 주소 (CBV/SRV는 GPU 주소, 테이블은 디스크립터 핸들 값)
+	UINT64 mRootParameters[MaxRootParameters] = { };
+
+	bool mPipelineStateValid = false;
+	bool mRootSignatureValid = false;
+	bool mDescriptorHeapValid = false;
+	bool mTopologyValid = false;
+	bool mVertexBufferValid = false;
+	bool mIndexBufferValid = false;
+	bool mStencilRefValid = false;
+	bool mRootParameterValid[MaxRootParameters] = { };
+
+	CommandRecorderStats mStats;
+};
+
+#endif
@@ -0,0 +1,100 @@
+#include "ContentHash.h"
+#include <cstring>
+
+namespace
+{
+	inline uint64_t Rotl64(uint64_t x, int r)
+	{
+		return (x << r) | (x >> (64 - r));
+	}
+
+	inline uint64_t Fmix64(uint64_t k)
+	{
+		k ^= k >> 33;
+		k *= 0xff51afd7ed558ccdull;
+		k ^= k >> 33;
+		k *= 0xc4ceb9fe1a85ec53ull;
+		k ^= k >> 33;
+		return k;
+	}
+
+	inline uint64_t ReadU64(const uint8_t* p)
+	{
+		// 정렬되지 않은 주소에서도 안전하게 읽는다. (리틀 엔디언 가정)
+		uint64_t v;
+		memcpy(&v, p, sizeof(v));
+		return v;
+	}
+}
+
+Hash128 ComputeHash128(const void* data, size_t size, uint64_t seed)
+{
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	const size_t blockCount = size / 16;
+
+	uint64_t h1 = seed;
+	uint64_t h2 = seed;
+
+	const uint64_t c1 = 0x87c37b91114253d5ull;
+	const uint64_t c2 = 0x4cf5ad432745937full;
+
+	// 16바이트 블록
+	for (size_t i = 0; i < blockCount; i++)
+	{
+		uint64_t k1 = ReadU64(bytes + i * 16);
+		uint64_t k2 = ReadU64(bytes + i * 16 + 8);
+
+		k1 *= c1; k1 = Rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+		h1 = Rotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+
+		k2 *= c2; k2 = Rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+		h2 = Rotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+	}
+
+	// 남은 바이트
+	const uint8_t* tail = bytes + blockCount * 16;
+	uint64_t k1 = 0;
+	uint64_t k2 = 0;
+
+	switch (size & 15)
+	{
+	case 15: k2 ^= static_cast<uint64_t>(tail[14]) << 48; [[fallthrough]];
+	case 14: k2 ^= static_cast<uint64_t>(tail[13]) << 40; [[fallthrough]];
+	case 13: k2 ^= static_cast<uint64_t>(tail[12]) << 32; [[fallthrough]];
+	case 12: k2 ^= static_cast<uint64_t>(tail[11]) << 24; [[fallthrough]];
+	case 11: k2 ^= static_cast<uint64_t>(tail[10]) << 16; [[fallthrough]];
+	case 10: k2 ^= static_cast<uint64_t>(tail[9]) << 8; [[fallthrough]];
+	case 9:
+		k2 ^= static_cast<uint64_t>(tail[8]);
+		k2 *= c2; k2 = Rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+		[[fallthrough]];
+	case 8: k1 ^= static_cast<uint64_t>(tail[7]) << 56; [[fallthrough]];
+	case 7: k1 ^= static_cast<uint64_t>(tail[6]) << 48; [[fallthrough]];
+	case 6: k1 ^= static_cast<uint64_t>(tail[5]) << 40; [[fallthrough]];
+	case 5: k1 ^= static_cast<uint64_t>(tail[4]) << 32; [[fallthrough]];
+	case 4: k1 ^= static_cast<uint64_t>(tail[3]) << 24; [[fallthrough]];
+	case 3: k1 ^= static_cast<uint64_t>(tail[2]) << 16; [[fallthrough]];
+	case 2: k1 ^= static_cast<uint64_t>(tail[1]) << 8; [[fallthrough]];
+	case 1:
+		k1 ^= static_cast<uint64_t>(tail[0]);
+		k1 *= c1; k1 = Rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+		break;
+	}
+
+	h1 ^= size;
+	h2 ^= size;
+
+	h1 += h2;
+	h2 += h1;
+
+	h1 = Fmix64(h1);
+	h2 = Fmix64(h2);
+
+	h1 += h2;
+	h2 += h1;
+
+	Hash128 result;
+	result.Low = h1;
+	result.High = h2;
+	return result;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#ifndef _CONTENTHASH_H_
+#define _CONTENTHASH_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// 내용 기반 캐시용 128비트 해시 (MurmurHash3 x64_128)
+// 암호학적 해시가 아니므로 보안 용도로 쓰면 안 된다.
+// 사용법: Hash128 h = ComputeHash128(data, size);
+
+struct Hash128
+{
+	uint64_t Low = 0;
+	uint64_t High = 0;
+
+	bool operator==(const Hash128& other) const { return Low == other.Low && High == other.High; }
+	bool operator!=(const Hash128& other) const { return !(*this == other); }
+};
+
+// std::unordered_map 키로 쓰기 위한 해셔. 이미 고르게 섞인 값이므로 하위 64비트만 쓴다.
+struct Hash128Hasher
+{
+	size_t operator()(const Hash128& h) const { return static_cast<size_t>(h.Low); }
+};
+
+Hash128 ComputeHash128(const void* data, size_t size, uint64_t seed = 0);
+
+#endif
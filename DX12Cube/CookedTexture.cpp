@@ -0,0 +1,296 @@
+#include "CookedTexture.h"
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <vector>
+#include "d3dx12.h"
+#include "CopyableFootprints.h"
+
+using Microsoft::WRL::ComPtr;
+
+static_assert(sizeof(CookedTextureHeader) == 80, "CookedTextureHeader layout changed; bump VERSION");
+
+namespace
+{
+	struct HandleCloser
+	{
+		void operator()(HANDLE handle) const
+		{
+			if (handle && handle != INVALID_HANDLE_VALUE)
+			{
+				CloseHandle(handle);
+			}
+		}
+	};
+	using ScopedFileHandle = std::unique_ptr<void, HandleCloser>;
+
+	// ReadFile 한 번에 읽는 최대 크기 (버퍼링 없는 읽기의 섹터 정렬을 지키도록 4096의 배수)
+	const DWORD READ_CHUNK_BYTES = 64u * 1024 * 1024;
+
+	// 페이로드를 dest로 바로 읽는다. unbuffered면 dest와 읽는 크기가 4096 정렬이어야 한다.
+	HRESULT ReadCookedPayload(const std::filesystem::path& cookedPath, const CookedTextureHeader& header, void* dest, bool unbuffered)
+	{
+		const DWORD flags = FILE_FLAG_SEQUENTIAL_SCAN | (unbuffered ? FILE_FLAG_NO_BUFFERING : 0);
+		ScopedFileHandle file(CreateFileW(cookedPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr));
+		if (!file || file.get() == INVALID_HANDLE_VALUE)
+		{
+			return HRESULT_FROM_WIN32(GetLastError());
+		}
+
+		LARGE_INTEGER position;
+		position.QuadPart = static_cast<LONGLONG>(header.PayloadOffset);
+		if (!SetFilePointerEx(file.get(), position, nullptr, FILE_BEGIN))
+		{
+			return HRESULT_FROM_WIN32(GetLastError());
+		}
+
+		// 버퍼링 없는 읽기는 끝을 섹터 크기로 올려서 읽는다. (파일 끝에서는 실제 남은 만큼만 읽힌다)
+		const uint64_t readSize = unbuffered
+			? AlignFootprintValue(header.PayloadSize, CookedTextureHeader::PAYLOAD_ALIGNMENT)
+			: header.PayloadSize;
+
+		auto bytes = static_cast<uint8_t*>(dest);
+		uint64_t done = 0;
+		while (done < readSize)
+		{
+			const DWORD request = static_cast<DWORD>(std::min<uint64_t>(readSize - done, READ_CHUNK_BYTES));
+			DWORD bytesRead = 0;
+			if (!ReadFile(file.get(), bytes + done, request, &bytesRead, nullptr))
+			{
+				return HRESULT_FROM_WIN32(GetLastError());
+			}
+			done += bytesRead;
+			if (bytesRead < request)
+			{
+				break;
+			}
+		}
+
+		return done >= header.PayloadSize ? S_OK : HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+	}
+}
+
+D3D12_RESOURCE_DESC CookedTextureHeader::GetResourceDesc() const
+{
+	return CD3DX12_RESOURCE_DESC::Tex2D(static_cast<DXGI_FORMAT>(Format), Width, Height, DepthOrArraySize, MipLevels);
+}
+
+bool GetCookedTextureSourceInfo(const std::filesystem::path& ddsPath, uint64_t& size, int64_t& writeTime)
+{
+	std::error_code ec;
+	size = std::filesystem::file_size(ddsPath, ec);
+	if (ec)
+	{
+		return false;
+	}
+	writeTime = static_cast<int64_t>(std::filesystem::last_write_time(ddsPath, ec).time_since_epoch().count());
+	return !ec;
+}
+
+std::filesystem::path GetCookedTexturePath(const std::filesystem::path& ddsPath)
+{
+	std::filesystem::path cookedPath = ddsPath;
+	cookedPath += L".cooked";
+	return cookedPath;
+}
+
+HRESULT WriteCookedTexture(const std::filesystem::path& cookedPath, const std::filesystem::path& ddsPath,
+	const DirectX::DDS_TEXTURE_DATA12& textureData)
+{
+	if (!textureData.initData || !textureData.ddsData)
+	{
+		return E_INVALIDARG;
+	}
+	// 잘라낸 밉 체인이나 2D가 아닌 텍스쳐는 DDS 경로와 같은 리소스를 만들 수 없다.
+	if (textureData.skipMip != 0 || textureData.resDim != D3D12_RESOURCE_DIMENSION_TEXTURE2D)
+	{
+		return E_INVALIDARG;
+	}
+
+	CookedTextureHeader header;
+	if (!GetCookedTextureSourceInfo(ddsPath, header.SourceSize, header.SourceWriteTime))
+	{
+		return E_FAIL;
+	}
+	header.SourceHash = ComputeHash128(textureData.ddsData.get(), textureData.ddsDataSize);
+	header.Format = static_cast<uint32_t>(textureData.format);
+	header.Width = textureData.width;
+	header.Height = static_cast<uint32_t>(textureData.height);
+	header.DepthOrArraySize = static_cast<uint16_t>(textureData.depth > 1 ? textureData.depth : textureData.arraySize);
+	header.MipLevels = static_cast<uint16_t>(textureData.mipCount);
+	header.SubresourceCount = static_cast<uint32_t>(header.DepthOrArraySize) * header.MipLevels;
+	header.PayloadOffset = CookedTextureHeader::PAYLOAD_ALIGNMENT;
+
+	const D3D12_RESOURCE_DESC desc = header.GetResourceDesc();
+	std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts(header.SubresourceCount);
+	std::vector<UINT> numRows(header.SubresourceCount);
+	std::vector<UINT64> rowSizes(header.SubresourceCount);
+	if (!ComputeCopyableFootprints(desc, 0, header.SubresourceCount, 0, layouts.data(), numRows.data(), rowSizes.data(),
+		&header.PayloadSize))
+	{
+		return E_FAIL;
+	}
+
+	// UpdateSubresources가 업로드 버퍼에 하는 것과 같은 복사를 미리 해 둔다.
+	std::vector<uint8_t> payload(static_cast<size_t>(header.PayloadSize));
+	for (UINT i = 0; i < header.SubresourceCount; i++)
+	{
+		const D3D12_MEMCPY_DEST dest = { payload.data() + layouts[i].Offset, layouts[i].Footprint.RowPitch,
+			SIZE_T(layouts[i].Footprint.RowPitch) * numRows[i] };
+		MemcpySubresource(&dest, &textureData.initData[i], static_cast<SIZE_T>(rowSizes[i]), numRows[i], layouts[i].Footprint.Depth);
+	}
+
+	std::ofstream file(cookedPath, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		return E_ACCESSDENIED;
+	}
+	std::vector<char> headerBlock(static_cast<size_t>(header.PayloadOffset), 0);
+	memcpy(headerBlock.data(), &header, sizeof(header));
+	file.write(headerBlock.data(), static_cast<std::streamsize>(headerBlock.size()));
+	file.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+
+	return file ? S_OK : E_FAIL;
+}
+
+HRESULT OpenCookedTexture(const std::filesystem::path& cookedPath, const std::filesystem::path& ddsPath,
+	CookedTextureHeader& header)
+{
+	std::ifstream file(cookedPath, std::ios::binary);
+	if (!file)
+	{
+		return S_FALSE;
+	}
+
+	CookedTextureHeader read;
+	if (!file.read(reinterpret_cast<char*>(&read), sizeof(read)))
+	{
+		return E_FAIL;
+	}
+	if (read.Magic != CookedTextureHeader::MAGIC || read.PayloadOffset % CookedTextureHeader::PAYLOAD_ALIGNMENT != 0)
+	{
+		return E_FAIL;
+	}
+	if (read.Version != CookedTextureHeader::VERSION)
+	{
+		return S_FALSE;
+	}
+
+	uint64_t sourceSize = 0;
+	int64_t sourceWriteTime = 0;
+	if (!GetCookedTextureSourceInfo(ddsPath, sourceSize, sourceWriteTime)
+		|| sourceSize != read.SourceSize || sourceWriteTime != read.SourceWriteTime)
+	{
+		return S_FALSE;
+	}
+
+	header = read;
+	return S_OK;
+}
+
+bool CanUseCookedTexture(const CookedTextureHeader& header, size_t maxsize)
+{
+	// FillInitData12와 같은 조건: 밉이 하나뿐이거나 최상위 밉이 maxsize 안에 들어가면 자르지 않는다.
+	return header.MipLevels <= 1 || maxsize == 0 || (header.Width <= maxsize && header.Height <= maxsize);
+}
+
+HRESULT CreateTextureFromCookedFile12(ID3D12Device* device, ID3D12GraphicsCommandList* cmdList,
+	const std::filesystem::path& cookedPath, const CookedTextureHeader& header,
+	ComPtr<ID3D12Resource>& texture, ComPtr<ID3D12Resource>& textureUploadHeap,
+	ResourceHeapAllocator* heapAllocator, HeapAllocation* allocation)
+{
+	texture = nullptr;
+	textureUploadHeap = nullptr;
+
+	if (!device || !cmdList || (heapAllocator && !allocation))
+	{
+		return E_INVALIDARG;
+	}
+
+	const D3D12_RESOURCE_DESC desc = header.GetResourceDesc();
+
+	// 쿡할 때 계산한 배치가 이 장치에서도 같아야 페이로드를 그대로 복사 원본으로 쓸 수 있다.
+	std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts(header.SubresourceCount);
+	std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> cookedLayouts(header.SubresourceCount);
+	UINT64 totalBytes = 0;
+	UINT64 cookedTotalBytes = 0;
+	device->GetCopyableFootprints(&desc, 0, header.SubresourceCount, 0, layouts.data(), nullptr, nullptr, &totalBytes);
+	ComputeCopyableFootprints(desc, 0, header.SubresourceCount, 0, cookedLayouts.data(), nullptr, nullptr, &cookedTotalBytes);
+	if (totalBytes != header.PayloadSize || cookedTotalBytes != header.PayloadSize
+		|| memcmp(layouts.data(), cookedLayouts.data(), layouts.size() * sizeof(layouts[0])) != 0)
+	{
+		return E_FAIL;
+	}
+
+	HRESULT hr = S_OK;
+	if (heapAllocator)
+	{
+		hr = heapAllocator->CreateResource(desc, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COMMON, nullptr, texture, *allocation);
+	}
+	else
+	{
+		auto defaultHeapProp = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+		hr = device->CreateCommittedResource(&defaultHeapProp, D3D12_HEAP_FLAG_NONE, &desc,
+			D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&texture));
+	}
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	auto releaseTexture = [&]
+	{
+		texture = nullptr;
+		if (heapAllocator)
+		{
+			heapAllocator->Free(*allocation);
+		}
+	};
+
+	// 버퍼링 없는 읽기가 섹터 단위로 넘쳐 써도 되도록 크기를 올린다.
+	auto uploadHeapProp = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+	auto uploadDesc = CD3DX12_RESOURCE_DESC::Buffer(AlignFootprintValue(header.PayloadSize, CookedTextureHeader::PAYLOAD_ALIGNMENT));
+	hr = device->CreateCommittedResource(&uploadHeapProp, D3D12_HEAP_FLAG_NONE, &uploadDesc,
+		D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&textureUploadHeap));
+	if (FAILED(hr))
+	{
+		releaseTexture();
+		return hr;
+	}
+
+	void* mapped = nullptr;
+	const D3D12_RANGE noRead = { 0, 0 };
+	hr = textureUploadHeap->Map(0, &noRead, &mapped);
+	if (SUCCEEDED(hr))
+	{
+		// 매핑된 업로드 버퍼는 64KB 정렬이므로 버퍼링 없이 디스크에서 바로 읽을 수 있다.
+		// 볼륨 섹터가 4096보다 크거나 해서 실패하면 일반 읽기로 한 번 더 시도한다.
+		hr = ReadCookedPayload(cookedPath, header, mapped, true);
+		if (FAILED(hr))
+		{
+			hr = ReadCookedPayload(cookedPath, header, mapped, false);
+		}
+		textureUploadHeap->Unmap(0, nullptr);
+	}
+	if (FAILED(hr))
+	{
+		releaseTexture();
+		textureUploadHeap = nullptr;
+		return hr;
+	}
+
+	auto toCopyDest = CD3DX12_RESOURCE_BARRIER::Transition(texture.Get(), D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST);
+	cmdList->ResourceBarrier(1, &toCopyDest);
+
+	for (UINT i = 0; i < header.SubresourceCount; i++)
+	{
+		CD3DX12_TEXTURE_COPY_LOCATION dst(texture.Get(), i);
+		CD3DX12_TEXTURE_COPY_LOCATION src(textureUploadHeap.Get(), layouts[i]);
+		cmdList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+	}
+
+	auto toShaderResource = CD3DX12_RESOURCE_BARRIER::Transition(texture.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	cmdList->ResourceBarrier(1, &toShaderResource);
+
+	return S_OK;
+}
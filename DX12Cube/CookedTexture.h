@@ -0,0 +1,77 @@
+#pragma once
+#ifndef _COOKEDTEXTURE_H_
+#define _COOKEDTEXTURE_H_
+
+#include <cstdint>
+#include <filesystem>
+#include <d3d12.h>
+#include <wrl.h>
+#include "ContentHash.h"
+#include "DDSTextureLoader.h"
+#include "ResourceHeapAllocator.h"
+
+// DDS 옆에 두는 '쿡' 파일 (bricks.dds -> bricks.dds.cooked)
+// 페이로드가 이미 업로드 버퍼 배치(D3D12_PLACED_SUBRESOURCE_FOOTPRINT 순서, 256바이트 행 간격, 512바이트 서브리소스 정렬)로
+// 들어 있어서, 로드할 때 행 단위로 다시 옮기지 않고 파일에서 매핑한 업로드 버퍼로 바로 읽는다.
+// 페이로드는 파일 안에서 4096바이트에 정렬되어 있어 버퍼링 없는(FILE_FLAG_NO_BUFFERING) 읽기가 가능하다.
+// 원본 DDS의 크기/수정 시각이 헤더와 다르면 쿡 파일을 쓰지 않는다. (DxTool cook으로 다시 만든다)
+// 사용법:
+//   CookedTextureHeader header;
+//   if (OpenCookedTexture(GetCookedTexturePath(ddsPath), ddsPath, header) == S_OK)
+//       CreateTextureFromCookedFile12(device, cmdList, GetCookedTexturePath(ddsPath), header, texture, uploadHeap);
+
+struct CookedTextureHeader
+{
+	static constexpr uint32_t MAGIC = 0x31585443; // "CTX1"
+	static constexpr uint32_t VERSION = 1;
+	static constexpr uint64_t PAYLOAD_ALIGNMENT = 4096;
+
+	uint32_t Magic = MAGIC;
+	uint32_t Version = VERSION;
+
+	// 원본 DDS 확인용
+	uint64_t SourceSize = 0;
+	int64_t SourceWriteTime = 0;
+	// 원본 DDS 파일 전체 바이트의 해시. TextureContentCache 키로 그대로 쓸 수 있다.
+	Hash128 SourceHash;
+
+	// CreateDDSTextureFromData12가 만드는 것과 같은 2D 텍스쳐
+	uint32_t Format = 0;
+	uint32_t Height = 0;
+	uint64_t Width = 0;
+	uint16_t DepthOrArraySize = 0;
+	uint16_t MipLevels = 0;
+	uint32_t SubresourceCount = 0;
+
+	// 파일 안에서의 페이로드 위치와 크기(ComputeRequiredIntermediateSize)
+	uint64_t PayloadOffset = 0;
+	uint64_t PayloadSize = 0;
+
+	D3D12_RESOURCE_DESC GetResourceDesc() const;
+};
+
+// 원본 DDS의 크기와 마지막 수정 시각
+bool GetCookedTextureSourceInfo(const std::filesystem::path& ddsPath, uint64_t& size, int64_t& writeTime);
+
+std::filesystem::path GetCookedTexturePath(const std::filesystem::path& ddsPath);
+
+// PrepareDDSTextureData12(maxsize 0)로 준비한 데이터를 업로드 배치로 다시 써서 저장한다. 2D 텍스쳐만 지원한다.
+HRESULT WriteCookedTexture(const std::filesystem::path& cookedPath, const std::filesystem::path& ddsPath,
+	const DirectX::DDS_TEXTURE_DATA12& textureData);
+
+// 헤더를 읽고 원본 DDS와 맞는지 확인한다. 쿡 파일이 없거나 원본이 바뀌었으면 S_FALSE.
+HRESULT OpenCookedTexture(const std::filesystem::path& cookedPath, const std::filesystem::path& ddsPath,
+	CookedTextureHeader& header);
+
+// maxsize로 밉을 잘라야 하면 쿡 파일을 그대로 쓸 수 없다. (DDS 경로로 읽어야 함)
+bool CanUseCookedTexture(const CookedTextureHeader& header, size_t maxsize);
+
+// 텍스쳐와 업로드 버퍼를 만들고, 페이로드를 매핑한 업로드 버퍼로 바로 읽은 뒤 복사 명령을 기록한다.
+// 장치의 GetCopyableFootprints 결과가 쿡할 때 계산한 배치와 다르면 E_FAIL (DDS 경로로 다시 읽어야 함)
+// heapAllocator가 있으면 텍스쳐를 그 힙에 놓고 위치를 allocation에 돌려준다. 텍스쳐를 놓은 뒤 heapAllocator->Free로 돌려준다.
+HRESULT CreateTextureFromCookedFile12(ID3D12Device* device, ID3D12GraphicsCommandList* cmdList,
+	const std::filesystem::path& cookedPath, const CookedTextureHeader& header,
+	Microsoft::WRL::ComPtr<ID3D12Resource>& texture, Microsoft::WRL::ComPtr<ID3D12Resource>& textureUploadHeap,
+	ResourceHeapAllocator* heapAllocator = nullptr, HeapAllocation* allocation = nullptr);
+
+#endif
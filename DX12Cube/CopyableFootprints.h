@@ -0,0 +1,461 @@
+#pragma once
+#ifndef _COPYABLEFOOTPRINTS_H_
+#define _COPYABLEFOOTPRINTS_H_
+
+#ifndef _WIN32
+// DxCheck: DirectX-Headers의 d3d12.h를 Windows 형 정의 없이 쓴다.
+#include <wsl/winadapter.h>
+#endif
+#include <d3d12.h>
+
+// ID3D12Device::GetCopyableFootprints를 장치 없이 CPU에서 계산한다.
+// 오프라인 쿠커나 장치가 없는 환경에서 업로드 버퍼 배치를 미리 계산하기 위한 것으로, 모두 constexpr이다.
+// 배치 규칙:
+//   - 행 간격(RowPitch)은 D3D12_TEXTURE_DATA_PITCH_ALIGNMENT(256) 배수
+//   - 서브리소스 시작(Offset)은 D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT(512) 배수 (baseOffset 기준)
+//   - BC/패킹된 422 포맷은 블록 단위로 행을 센다. Footprint의 Width/Height는 블록 크기로 올림한다.
+//   - 평면(planar) 포맷(NV12, P010, D24S8 등)은 plane마다 서브리소스가 따로 있다.
+//     서브리소스 번호 = mip + array * MipLevels + plane * MipLevels * ArraySize (D3D12CalcSubresource와 같음)
+//   - totalBytes는 마지막 서브리소스의 마지막 행을 RowPitch가 아닌 RowSize까지만 센다.
+// 장치 결과와의 비교는 하드웨어에서 DxTool footprint-check로 손으로 한다. (--record로 기록, --compare로 비교)
+// DxCheck footprint-test가 읽는 DxTool/footprint-record.txt는 아직 합성 기록이라 장치 검증이 아니다.
+// 아래 static_assert는 손으로 계산한 알려진 배치(BC1 256x256 밉 체인, NV12 1920x1080, RGBA8 3x5)다.
+// 사용법:
+//   UINT64 uploadSize = ComputeRequiredIntermediateSize(desc, 0, desc.MipLevels);
+//   ComputeCopyableFootprints(desc, 0, count, 0, layouts, numRows, rowSizes, &totalBytes);
+
+// 포맷 한 plane의 복사 단위
+struct CopyablePlaneInfo
+{
+	// Footprint.Format에 들어가는 포맷. 평면 포맷이면 plane별 포맷(NV12의 plane 1은 R8G8_UNORM 등)
+	DXGI_FORMAT Format = DXGI_FORMAT_UNKNOWN;
+	UINT BlockWidth = 1;
+	UINT BlockHeight = 1;
+	// 0이면 복사할 수 없는(지원하지 않는) 포맷
+	UINT BytesPerBlock = 0;
+	// 크로마 plane의 크기 축소 (NV12 UV plane은 가로/세로 모두 1)
+	UINT WidthShift = 0;
+	UINT HeightShift = 0;
+};
+
+constexpr UINT GetCopyablePlaneCount(DXGI_FORMAT format)
+{
+	switch (format)
+	{
+	case DXGI_FORMAT_NV12:
+	case DXGI_FORMAT_P010:
+	case DXGI_FORMAT_P016:
+	case DXGI_FORMAT_420_OPAQUE:
+	case DXGI_FORMAT_NV11:
+	case DXGI_FORMAT_P208:
+	case DXGI_FORMAT_R32G8X24_TYPELESS:
+	case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+	case DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS:
+	case DXGI_FORMAT_X32_TYPELESS_G8X24_UINT:
+	case DXGI_FORMAT_R24G8_TYPELESS:
+	case DXGI_FORMAT_D24_UNORM_S8_UINT:
+	case DXGI_FORMAT_R24_UNORM_X8_TYPELESS:
+	case DXGI_FORMAT_X24_TYPELESS_G8_UINT:
+		return 2;
+
+	case DXGI_FORMAT_V208:
+	case DXGI_FORMAT_V408:
+		return 3;
+
+	default:
+		return 1;
+	}
+}
+
+constexpr CopyablePlaneInfo GetCopyablePlaneInfo(DXGI_FORMAT format, UINT plane)
+{
+	// 평면 포맷
+	switch (format)
+	{
+	case DXGI_FORMAT_NV12:
+	case DXGI_FORMAT_420_OPAQUE:
+		return plane == 0 ? CopyablePlaneInfo{ DXGI_FORMAT_R8_TYPELESS, 1, 1, 1, 0, 0 }
+			: CopyablePlaneInfo{ DXGI_FORMAT_R8G8_TYPELESS, 1, 1, 2, 1, 1 };
+
+	case DXGI_FORMAT_P010:
+	case DXGI_FORMAT_P016:
+		return plane == 0 ? CopyablePlaneInfo{ DXGI_FORMAT_R16_TYPELESS, 1, 1, 2, 0, 0 }
+			: CopyablePlaneInfo{ DXGI_FORMAT_R16G16_TYPELESS, 1, 1, 4, 1, 1 };
+
+	case DXGI_FORMAT_NV11:
+		return plane == 0 ? CopyablePlaneInfo{ DXGI_FORMAT_R8_TYPELESS, 1, 1, 1, 0, 0 }
+			: CopyablePlaneInfo{ DXGI_FORMAT_R8G8_TYPELESS, 1, 1, 2, 2, 0 };
+
+	case DXGI_FORMAT_P208:
+		return plane == 0 ? CopyablePlaneInfo{ DXGI_FORMAT_R8_TYPELESS, 1, 1, 1, 0, 0 }
+			: CopyablePlaneInfo{ DXGI_FORMAT_R8G8_TYPELESS, 1, 1, 2, 1, 0 };
+
+	case DXGI_FORMAT_V208:
+		return CopyablePlaneInfo{ DXGI_FORMAT_R8_TYPELESS, 1, 1, 1, 0, plane == 0 ? 0u : 1u };
+
+	case DXGI_FORMAT_V408:
+		return CopyablePlaneInfo{ DXGI_FORMAT_R8_TYPELESS, 1, 1, 1, 0, 0 };
+
+	// 깊이/스텐실: plane 0이 깊이, plane 1이 스텐실
+	case DXGI_FORMAT_R32G8X24_TYPELESS:
+	case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+	case DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS:
+	case DXGI_FORMAT_X32_TYPELESS_G8X24_UINT:
+	case DXGI_FORMAT_R24G8_TYPELESS:
+	case DXGI_FORMAT_D24_UNORM_S8_UINT:
+	case DXGI_FORMAT_R24_UNORM_X8_TYPELESS:
+	case DXGI_FORMAT_X24_TYPELESS_G8_UINT:
+		return plane == 0 ? CopyablePlaneInfo{ DXGI_FORMAT_R32_TYPELESS, 1, 1, 4, 0, 0 }
+			: CopyablePlaneInfo{ DXGI_FORMAT_R8_TYPELESS, 1, 1, 1, 0, 0 };
+
+	default:
+		break;
+	}
+
+	if (plane != 0)
+	{
+		return {};
+	}
+
+	// 단일 plane 포맷: 블록(또는 텍셀) 크기만 다르다.
+	switch (format)
+	{
+	case DXGI_FORMAT_R32G32B32A32_TYPELESS:
+	case DXGI_FORMAT_R32G32B32A32_FLOAT:
+	case DXGI_FORMAT_R32G32B32A32_UINT:
+	case DXGI_FORMAT_R32G32B32A32_SINT:
+		return { format, 1, 1, 16, 0, 0 };
+
+	case DXGI_FORMAT_R32G32B32_TYPELESS:
+	case DXGI_FORMAT_R32G32B32_FLOAT:
+	case DXGI_FORMAT_R32G32B32_UINT:
+	case DXGI_FORMAT_R32G32B32_SINT:
+		return { format, 1, 1, 12, 0, 0 };
+
+	case DXGI_FORMAT_R16G16B16A16_TYPELESS:
+	case DXGI_FORMAT_R16G16B16A16_FLOAT:
+	case DXGI_FORMAT_R16G16B16A16_UNORM:
+	case DXGI_FORMAT_R16G16B16A16_UINT:
+	case DXGI_FORMAT_R16G16B16A16_SNORM:
+	case DXGI_FORMAT_R16G16B16A16_SINT:
+	case DXGI_FORMAT_R32G32_TYPELESS:
+	case DXGI_FORMAT_R32G32_FLOAT:
+	case DXGI_FORMAT_R32G32_UINT:
+	case DXGI_FORMAT_R32G32_SINT:
+	case DXGI_FORMAT_Y416:
+		return { format, 1, 1, 8, 0, 0 };
+
+	case DXGI_FORMAT_R10G10B10A2_TYPELESS:
+	case DXGI_FORMAT_R10G10B10A2_UNORM:
+	case DXGI_FORMAT_R10G10B10A2_UINT:
+	case DXGI_FORMAT_R11G11B10_FLOAT:
+	case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+	case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+	case DXGI_FORMAT_R8G8B8A8_UINT:
+	case DXGI_FORMAT_R8G8B8A8_SNORM:
+	case DXGI_FORMAT_R8G8B8A8_SINT:
+	case DXGI_FORMAT_R16G16_TYPELESS:
+	case DXGI_FORMAT_R16G16_FLOAT:
+	case DXGI_FORMAT_R16G16_UNORM:
+	case DXGI_FORMAT_R16G16_UINT:
+	case DXGI_FORMAT_R16G16_SNORM:
+	case DXGI_FORMAT_R16G16_SINT:
+	case DXGI_FORMAT_R32_TYPELESS:
+	case DXGI_FORMAT_D32_FLOAT:
+	case DXGI_FORMAT_R32_FLOAT:
+	case DXGI_FORMAT_R32_UINT:
+	case DXGI_FORMAT_R32_SINT:
+	case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
+	case DXGI_FORMAT_B8G8R8A8_UNORM:
+	case DXGI_FORMAT_B8G8R8X8_UNORM:
+	case DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM:
+	case DXGI_FORMAT_B8G8R8A8_TYPELESS:
+	case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+	case DXGI_FORMAT_B8G8R8X8_TYPELESS:
+	case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+	case DXGI_FORMAT_AYUV:
+	case DXGI_FORMAT_Y410:
+		return { format, 1, 1, 4, 0, 0 };
+
+	case DXGI_FORMAT_R8G8_TYPELESS:
+	case DXGI_FORMAT_R8G8_UNORM:
+	case DXGI_FORMAT_R8G8_UINT:
+	case DXGI_FORMAT_R8G8_SNORM:
+	case DXGI_FORMAT_R8G8_SINT:
+	case DXGI_FORMAT_R16_TYPELESS:
+	case DXGI_FORMAT_R16_FLOAT:
+	case DXGI_FORMAT_D16_UNORM:
+	case DXGI_FORMAT_R16_UNORM:
+	case DXGI_FORMAT_R16_UINT:
+	case DXGI_FORMAT_R16_SNORM:
+	case DXGI_FORMAT_R16_SINT:
+	case DXGI_FORMAT_B5G6R5_UNORM:
+	case DXGI_FORMAT_B5G5R5A1_UNORM:
+	case DXGI_FORMAT_B4G4R4A4_UNORM:
+	case DXGI_FORMAT_A8P8:
+		return { format, 1, 1, 2, 0, 0 };
+
+	case DXGI_FORMAT_R8_TYPELESS:
+	case DXGI_FORMAT_R8_UNORM:
+	case DXGI_FORMAT_R8_UINT:
+	case DXGI_FORMAT_R8_SNORM:
+	case DXGI_FORMAT_R8_SINT:
+	case DXGI_FORMAT_A8_UNORM:
+	case DXGI_FORMAT_AI44:
+	case DXGI_FORMAT_IA44:
+	case DXGI_FORMAT_P8:
+		return { format, 1, 1, 1, 0, 0 };
+
+	// 가로 2픽셀이 한 블록인 패킹 422 포맷
+	case DXGI_FORMAT_R8G8_B8G8_UNORM:
+	case DXGI_FORMAT_G8R8_G8B8_UNORM:
+	case DXGI_FORMAT_YUY2:
+		return { format, 2, 1, 4, 0, 0 };
+
+	case DXGI_FORMAT_Y210:
+	case DXGI_FORMAT_Y216:
+		return { format, 2, 1, 8, 0, 0 };
+
+	case DXGI_FORMAT_BC1_TYPELESS:
+	case DXGI_FORMAT_BC1_UNORM:
+	case DXGI_FORMAT_BC1_UNORM_SRGB:
+	case DXGI_FORMAT_BC4_TYPELESS:
+	case DXGI_FORMAT_BC4_UNORM:
+	case DXGI_FORMAT_BC4_SNORM:
+		return { format, 4, 4, 8, 0, 0 };
+
+	case DXGI_FORMAT_BC2_TYPELESS:
+	case DXGI_FORMAT_BC2_UNORM:
+	case DXGI_FORMAT_BC2_UNORM_SRGB:
+	case DXGI_FORMAT_BC3_TYPELESS:
+	case DXGI_FORMAT_BC3_UNORM:
+	case DXGI_FORMAT_BC3_UNORM_SRGB:
+	case DXGI_FORMAT_BC5_TYPELESS:
+	case DXGI_FORMAT_BC5_UNORM:
+	case DXGI_FORMAT_BC5_SNORM:
+	case DXGI_FORMAT_BC6H_TYPELESS:
+	case DXGI_FORMAT_BC6H_UF16:
+	case DXGI_FORMAT_BC6H_SF16:
+	case DXGI_FORMAT_BC7_TYPELESS:
+	case DXGI_FORMAT_BC7_UNORM:
+	case DXGI_FORMAT_BC7_UNORM_SRGB:
+		return { format, 4, 4, 16, 0, 0 };
+
+	// R1_UNORM, 샘플러 피드백 등은 D3D12에서 복사할 수 없다.
+	default:
+		return {};
+	}
+}
+
+constexpr UINT64 AlignFootprintValue(UINT64 value, UINT64 alignment)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// GetCopyableFootprints와 같은 인자와 결과. 잘못된 입력이면 장치처럼 모든 출력을 UINT64(-1)/UINT(-1)로 채우고 false를 돌려준다.
+constexpr bool ComputeCopyableFootprints(
+	const D3D12_RESOURCE_DESC& desc,
+	UINT firstSubresource,
+	UINT numSubresources,
+	UINT64 baseOffset,
+	D3D12_PLACED_SUBRESOURCE_FOOTPRINT* layouts,
+	UINT* numRows,
+	UINT64* rowSizes,
+	UINT64* totalBytes)
+{
+	auto fail = [&]()
+	{
+		for (UINT i = 0; i < numSubresources; i++)
+		{
+			if (layouts)
+			{
+				layouts[i].Offset = UINT64(-1);
+				layouts[i].Footprint = { DXGI_FORMAT_UNKNOWN, UINT(-1), UINT(-1), UINT(-1), UINT(-1) };
+			}
+			if (numRows)
+			{
+				numRows[i] = UINT(-1);
+			}
+			if (rowSizes)
+			{
+				rowSizes[i] = UINT64(-1);
+			}
+		}
+		if (totalBytes)
+		{
+			*totalBytes = UINT64(-1);
+		}
+		return false;
+	};
+
+	// 버퍼는 행 하나짜리 footprint
+	if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+	{
+		if (firstSubresource != 0 || numSubresources > 1)
+		{
+			return fail();
+		}
+		if (numSubresources == 1)
+		{
+			if (layouts)
+			{
+				layouts[0].Offset = baseOffset;
+				layouts[0].Footprint = { DXGI_FORMAT_UNKNOWN, static_cast<UINT>(desc.Width), 1, 1,
+					static_cast<UINT>(AlignFootprintValue(desc.Width, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT)) };
+			}
+			if (numRows)
+			{
+				numRows[0] = 1;
+			}
+			if (rowSizes)
+			{
+				rowSizes[0] = desc.Width;
+			}
+		}
+		if (totalBytes)
+		{
+			*totalBytes = numSubresources ? desc.Width : 0;
+		}
+		return true;
+	}
+
+	const bool is3D = desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D;
+	const UINT mipLevels = desc.MipLevels;
+	const UINT arraySize = is3D ? 1u : desc.DepthOrArraySize;
+	const UINT planeCount = GetCopyablePlaneCount(desc.Format);
+	if (mipLevels == 0 || arraySize == 0 || desc.Width == 0 || desc.Height == 0
+		|| UINT64(firstSubresource) + numSubresources > UINT64(mipLevels) * arraySize * planeCount)
+	{
+		return fail();
+	}
+
+	UINT64 total = 0;
+	for (UINT i = 0; i < numSubresources; i++)
+	{
+		const UINT subresource = firstSubresource + i;
+		const UINT mip = subresource % mipLevels;
+		const UINT plane = subresource / (mipLevels * arraySize);
+
+		const CopyablePlaneInfo info = GetCopyablePlaneInfo(desc.Format, plane);
+		if (info.BytesPerBlock == 0)
+		{
+			return fail();
+		}
+
+		UINT64 mipWidth = desc.Width >> mip;
+		UINT mipHeight = desc.Height >> mip;
+		UINT mipDepth = is3D ? static_cast<UINT>(desc.DepthOrArraySize) >> mip : 1u;
+		mipWidth = (mipWidth ? mipWidth : 1) >> info.WidthShift;
+		mipHeight = (mipHeight ? mipHeight : 1) >> info.HeightShift;
+		mipWidth = mipWidth ? mipWidth : 1;
+		mipHeight = mipHeight ? mipHeight : 1;
+		mipDepth = mipDepth ? mipDepth : 1;
+
+		const UINT64 blocksWide = (mipWidth + info.BlockWidth - 1) / info.BlockWidth;
+		const UINT blocksHigh = (mipHeight + info.BlockHeight - 1) / info.BlockHeight;
+		const UINT64 rowSize = blocksWide * info.BytesPerBlock;
+		const UINT64 rowPitch = AlignFootprintValue(rowSize, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
+		if (rowPitch > UINT(-1))
+		{
+			return fail();
+		}
+
+		const UINT64 offset = AlignFootprintValue(total, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+		if (layouts)
+		{
+			layouts[i].Offset = baseOffset + offset;
+			layouts[i].Footprint = { info.Format, static_cast<UINT>(blocksWide * info.BlockWidth), blocksHigh * info.BlockHeight,
+				mipDepth, static_cast<UINT>(rowPitch) };
+		}
+		if (numRows)
+		{
+			numRows[i] = blocksHigh;
+		}
+		if (rowSizes)
+		{
+			rowSizes[i] = rowSize;
+		}
+
+		// 마지막 행은 RowPitch만큼 채우지 않는다.
+		total = offset + rowPitch * (UINT64(blocksHigh) * mipDepth - 1) + rowSize;
+	}
+
+	if (totalBytes)
+	{
+		*totalBytes = total;
+	}
+	return true;
+}
+
+// GetRequiredIntermediateSize의 장치 없는 버전
+constexpr UINT64 ComputeRequiredIntermediateSize(const D3D12_RESOURCE_DESC& desc, UINT firstSubresource, UINT numSubresources)
+{
+	UINT64 totalBytes = 0;
+	ComputeCopyableFootprints(desc, firstSubresource, numSubresources, 0, nullptr, nullptr, nullptr, &totalBytes);
+	return totalBytes;
+}
+
+// 알려진 배치. 규칙을 고치다가 어긋나면 컴파일되지 않는다.
+namespace CopyableFootprintsCheck
+{
+	struct SubresourceLayout
+	{
+		UINT64 Offset;
+		DXGI_FORMAT Format;
+		UINT Width;
+		UINT Height;
+		UINT RowPitch;
+		UINT NumRows;
+		UINT64 RowSize;
+
+		constexpr bool operator==(const SubresourceLayout&) const = default;
+	};
+
+	constexpr D3D12_RESOURCE_DESC Texture2D(DXGI_FORMAT format, UINT64 width, UINT height, UINT16 mipLevels)
+	{
+		D3D12_RESOURCE_DESC desc = {};
+		desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+		desc.Width = width;
+		desc.Height = height;
+		desc.DepthOrArraySize = 1;
+		desc.MipLevels = mipLevels;
+		desc.Format = format;
+		desc.SampleDesc.Count = 1;
+		return desc;
+	}
+
+	// 앞의 서브리소스부터 차례로 놓으므로 [0, subresource]를 모두 계산한다.
+	constexpr SubresourceLayout GetLayout(const D3D12_RESOURCE_DESC& desc, UINT subresource)
+	{
+		D3D12_PLACED_SUBRESOURCE_FOOTPRINT layouts[16] = {};
+		UINT numRows[16] = {};
+		UINT64 rowSizes[16] = {};
+		ComputeCopyableFootprints(desc, 0, subresource + 1, 0, layouts, numRows, rowSizes, nullptr);
+		const auto& footprint = layouts[subresource].Footprint;
+		return { layouts[subresource].Offset, footprint.Format, footprint.Width, footprint.Height, footprint.RowPitch,
+			numRows[subresource], rowSizes[subresource] };
+	}
+
+	// BC1 256x256, 밉 9단계: 블록 64x64개 x 8바이트. 4x4보다 작은 밉도 블록 하나(8바이트)를 차지한다.
+	constexpr D3D12_RESOURCE_DESC Bc1MipChain = Texture2D(DXGI_FORMAT_BC1_UNORM, 256, 256, 9);
+	static_assert(GetLayout(Bc1MipChain, 0) == SubresourceLayout{ 0, DXGI_FORMAT_BC1_UNORM, 256, 256, 512, 64, 512 });
+	static_assert(GetLayout(Bc1MipChain, 1) == SubresourceLayout{ 32768, DXGI_FORMAT_BC1_UNORM, 128, 128, 256, 32, 256 });
+	static_assert(GetLayout(Bc1MipChain, 2) == SubresourceLayout{ 40960, DXGI_FORMAT_BC1_UNORM, 64, 64, 256, 16, 128 });
+	static_assert(GetLayout(Bc1MipChain, 3) == SubresourceLayout{ 45056, DXGI_FORMAT_BC1_UNORM, 32, 32, 256, 8, 64 });
+	static_assert(GetLayout(Bc1MipChain, 7) == SubresourceLayout{ 49152, DXGI_FORMAT_BC1_UNORM, 4, 4, 256, 1, 8 });
+	static_assert(GetLayout(Bc1MipChain, 8) == SubresourceLayout{ 49664, DXGI_FORMAT_BC1_UNORM, 4, 4, 256, 1, 8 });
+	static_assert(ComputeRequiredIntermediateSize(Bc1MipChain, 0, 9) == 49672);
+
+	// NV12 1920x1080: plane 0은 Y(R8), plane 1은 가로/세로 절반인 UV(R8G8). plane 1은 512바이트 경계에서 시작한다.
+	constexpr D3D12_RESOURCE_DESC Nv12 = Texture2D(DXGI_FORMAT_NV12, 1920, 1080, 1);
+	static_assert(GetCopyablePlaneCount(DXGI_FORMAT_NV12) == 2);
+	static_assert(GetLayout(Nv12, 0) == SubresourceLayout{ 0, DXGI_FORMAT_R8_TYPELESS, 1920, 1080, 2048, 1080, 1920 });
+	static_assert(GetLayout(Nv12, 1) == SubresourceLayout{ 2211840, DXGI_FORMAT_R8G8_TYPELESS, 960, 540, 2048, 540, 1920 });
+	static_assert(ComputeRequiredIntermediateSize(Nv12, 0, 2) == 3317632);
+
+	// 마지막 행은 RowPitch가 아니라 RowSize까지만 센다: 256 * 4 + 12
+	static_assert(ComputeRequiredIntermediateSize(Texture2D(DXGI_FORMAT_R8G8B8A8_UNORM, 3, 5, 1), 0, 1) == 1036);
+}
+
+#endif
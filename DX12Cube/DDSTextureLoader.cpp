@@ -21,9 +21,12 @@
 #include <assert.h>
 #include <algorithm>
 #include <memory>
+#include <vector>
 #include <wrl.h>
 
 #include "DDSTextureLoader.h" 
+#include "BCDecoder.h"
+#include "ResourceHeapAllocator.h"
 
 using namespace Microsoft::WRL;
 
@@ -144,14 +147,12 @@ inline void SetDebugObjectName(_In_ ID3D11DeviceChild* resource, _In_ const char
 };
 
 //--------------------------------------------------------------------------------------
-static HRESULT LoadTextureDataFromFile( _In_z_ const wchar_t* fileName,
-                                        std::unique_ptr<uint8_t[]>& ddsData,
-                                        DDS_HEADER** header,
-                                        uint8_t** bitData,
-                                        size_t* bitSize
-                                      )
+static HRESULT ReadTextureFile( _In_z_ const wchar_t* fileName,
+                                std::unique_ptr<uint8_t[]>& ddsData,
+                                size_t* ddsDataSize
+                              )
 {
-    if (!header || !bitData || !bitSize)
+    if (!ddsDataSize)
     {
         return E_POINTER;
     }
@@ -228,14 +229,39 @@ static HRESULT LoadTextureDataFromFile( _In_z_ const wchar_t* fileName,
         return E_FAIL;
     }
 
+    *ddsDataSize = FileSize.LowPart;
+
+    return S_OK;
+}
+
+
+//--------------------------------------------------------------------------------------
+static HRESULT ParseDDSHeader( _In_reads_bytes_(ddsDataSize) uint8_t* ddsData,
+                               _In_ size_t ddsDataSize,
+                               DDS_HEADER** header,
+                               uint8_t** bitData,
+                               size_t* bitSize
+                             )
+{
+    if (!ddsData || !header || !bitData || !bitSize)
+    {
+        return E_POINTER;
+    }
+
+    // Need at least enough data to fill the header and magic number to be a valid DDS
+    if (ddsDataSize < ( sizeof(DDS_HEADER) + sizeof(uint32_t) ) )
+    {
+        return E_FAIL;
+    }
+
     // DDS files always start with the same magic number ("DDS ")
-    uint32_t dwMagicNumber = *( const uint32_t* )( ddsData.get() );
+    uint32_t dwMagicNumber = *( const uint32_t* )( ddsData );
     if (dwMagicNumber != DDS_MAGIC)
     {
         return E_FAIL;
     }
 
-    auto hdr = reinterpret_cast<DDS_HEADER*>( ddsData.get() + sizeof( uint32_t ) );
+    auto hdr = reinterpret_cast<DDS_HEADER*>( ddsData + sizeof( uint32_t ) );
 
     // Verify header to validate DDS file
     if (hdr->size != sizeof(DDS_HEADER) ||
@@ -250,7 +276,7 @@ static HRESULT LoadTextureDataFromFile( _In_z_ const wchar_t* fileName,
         (MAKEFOURCC( 'D', 'X', '1', '0' ) == hdr->ddspf.fourCC))
     {
         // Must be long enough for both headers and magic value
-        if (FileSize.LowPart < ( sizeof(DDS_HEADER) + sizeof(uint32_t) + sizeof(DDS_HEADER_DXT10) ) )
+        if (ddsDataSize < ( sizeof(DDS_HEADER) + sizeof(uint32_t) + sizeof(DDS_HEADER_DXT10) ) )
         {
             return E_FAIL;
         }
@@ -262,13 +288,37 @@ static HRESULT LoadTextureDataFromFile( _In_z_ const wchar_t* fileName,
     *header = hdr;
     ptrdiff_t offset = sizeof( uint32_t ) + sizeof( DDS_HEADER )
                        + (bDXT10Header ? sizeof( DDS_HEADER_DXT10 ) : 0);
-    *bitData = ddsData.get() + offset;
-    *bitSize = FileSize.LowPart - offset;
+    *bitData = ddsData + offset;
+    *bitSize = ddsDataSize - offset;
 
     return S_OK;
 }
 
 
+//--------------------------------------------------------------------------------------
+static HRESULT LoadTextureDataFromFile( _In_z_ const wchar_t* fileName,
+                                        std::unique_ptr<uint8_t[]>& ddsData,
+                                        DDS_HEADER** header,
+                                        uint8_t** bitData,
+                                        size_t* bitSize
+                                      )
+{
+    if (!header || !bitData || !bitSize)
+    {
+        return E_POINTER;
+    }
+
+    size_t ddsDataSize = 0;
+    HRESULT hr = ReadTextureFile( fileName, ddsData, &ddsDataSize );
+    if (FAILED(hr))
+    {
+        return hr;
+    }
+
+    return ParseDDSHeader( ddsData.get(), ddsDataSize, header, bitData, bitSize );
+}
+
+
 //--------------------------------------------------------------------------------------
 // Return the BPP for a particular format
 //--------------------------------------------------------------------------------------
@@ -1241,7 +1291,9 @@ static HRESULT CreateD3DResources12(
 	_In_ bool isCubeMap,
 	_In_reads_opt_(mipCount*arraySize) D3D12_SUBRESOURCE_DATA* initData,
 	ComPtr<ID3D12Resource>& texture,
-	ComPtr<ID3D12Resource>& textureUploadHeap
+	ComPtr<ID3D12Resource>& textureUploadHeap,
+	_In_opt_ ResourceHeapAllocator* heapAllocator,
+	_Out_opt_ HeapAllocation* allocation
 	)
 {
 	if (device == nullptr)
@@ -1269,16 +1321,24 @@ static HRESULT CreateD3DResources12(
 		texDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
 		texDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
 
-        auto defHeapProp = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+		if (heapAllocator)
+		{
+			// 커밋 리소스 대신 할당기의 힙 블록에 놓는다. 작은 텍스쳐는 4KB 정렬을 받는다.
+			hr = heapAllocator->CreateResource(texDesc, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COMMON, nullptr, texture, *allocation);
+		}
+		else
+		{
+			auto defHeapProp = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
 
-		hr = device->CreateCommittedResource(
-			&defHeapProp,
-			D3D12_HEAP_FLAG_NONE,
-			&texDesc,
-			D3D12_RESOURCE_STATE_COMMON,
-			nullptr,
-			IID_PPV_ARGS(&texture)
-			);
+			hr = device->CreateCommittedResource(
+				&defHeapProp,
+				D3D12_HEAP_FLAG_NONE,
+				&texDesc,
+				D3D12_RESOURCE_STATE_COMMON,
+				nullptr,
+				IID_PPV_ARGS(&texture)
+				);
+		}
 
 		if (FAILED(hr))
 		{
@@ -1303,6 +1363,10 @@ static HRESULT CreateD3DResources12(
 			if (FAILED(hr))
 			{
 				texture = nullptr;
+				if (heapAllocator)
+				{
+					heapAllocator->Free(*allocation);
+				}
 				return hr;
 			}
 			else
@@ -1674,16 +1738,15 @@ static HRESULT CreateTextureFromDDS( _In_ ID3D11Device* d3dDevice,
     return hr;
 }
 
-static HRESULT CreateTextureFromDDS12(
-	_In_ ID3D12Device* device,
-	_In_opt_ ID3D12GraphicsCommandList* cmdList,
+static DDS_ALPHA_MODE GetAlphaMode( _In_ const DDS_HEADER* header );
+
+// 헤더 검증과 서브리소스 레이아웃 계산만 한다. 장치를 쓰지 않으므로 워커 스레드에서 호출해도 된다.
+static HRESULT PrepareTextureFromDDS12(
 	_In_ const DDS_HEADER* header,
 	_In_reads_bytes_(bitSize) const uint8_t* bitData,
 	_In_ size_t bitSize,
 	_In_ size_t maxsize,
-	_In_ bool forceSRGB,
-	ComPtr<ID3D12Resource>& texture,
-	ComPtr<ID3D12Resource>& textureUploadHeap)
+	DDS_TEXTURE_DATA12& textureData)
 {
 	HRESULT hr = S_OK;
 
@@ -1862,22 +1925,53 @@ static HRESULT CreateTextureFromDDS12(
 
 	if (SUCCEEDED(hr))
 	{
-		hr = CreateD3DResources12(
-			device, cmdList,
-			resDim, twidth, theight, tdepth,
-			mipCount - skipMip,
-			arraySize,
-			format,
-			false, // forceSRGB
-			isCubeMap,
-			initData.get(),
-			texture, 
-			textureUploadHeap);
+		textureData.resDim = resDim;
+		textureData.width = twidth;
+		textureData.height = theight;
+		textureData.depth = tdepth;
+		textureData.mipCount = mipCount - skipMip;
+		textureData.arraySize = arraySize;
+		textureData.format = format;
+		textureData.isCubeMap = isCubeMap;
+		textureData.initData = std::move(initData);
+		textureData.alphaMode = GetAlphaMode(header);
+		textureData.skipMip = skipMip;
+		textureData.fullWidth = width;
+		textureData.fullHeight = height;
 	}
 
 	return hr;
 }
 
+static HRESULT CreateTextureFromDDS12(
+	_In_ ID3D12Device* device,
+	_In_opt_ ID3D12GraphicsCommandList* cmdList,
+	_In_ const DDS_TEXTURE_DATA12& textureData,
+	ComPtr<ID3D12Resource>& texture,
+	ComPtr<ID3D12Resource>& textureUploadHeap,
+	ResourceHeapAllocator* heapAllocator = nullptr,
+	HeapAllocation* allocation = nullptr)
+{
+	if (!textureData.initData)
+	{
+		return E_INVALIDARG;
+	}
+
+	return CreateD3DResources12(
+		device, cmdList,
+		textureData.resDim, textureData.width, textureData.height, textureData.depth,
+		textureData.mipCount,
+		textureData.arraySize,
+		textureData.format,
+		false, // forceSRGB
+		textureData.isCubeMap,
+		textureData.initData.get(),
+		texture,
+		textureUploadHeap,
+		heapAllocator,
+		allocation);
+}
+
 //--------------------------------------------------------------------------------------
 static DDS_ALPHA_MODE GetAlphaMode( _In_ const DDS_HEADER* header )
 {
@@ -1975,18 +2069,26 @@ HRESULT DirectX::CreateDDSTextureFromMemory12(
 		+ sizeof(DDS_HEADER)
 		+ (bDXT10Header ? sizeof(DDS_HEADER_DXT10) : 0);
 
-	HRESULT hr = CreateTextureFromDDS12(
-		device,
-		cmdList,
+	DDS_TEXTURE_DATA12 textureData;
+	HRESULT hr = PrepareTextureFromDDS12(
 		header,
 		ddsData + offset,
 		ddsDataSize - offset,
 		maxsize,
-		false,
-		texture,
-		textureUploadHeap
+		textureData
 		);
 
+	if (SUCCEEDED(hr))
+	{
+		hr = CreateTextureFromDDS12(
+			device,
+			cmdList,
+			textureData,
+			texture,
+			textureUploadHeap
+			);
+	}
+
 	if (SUCCEEDED(hr))
 	{
 		if (alphaMode)
@@ -2139,6 +2241,168 @@ HRESULT DirectX::CreateDDSTextureFromFile( ID3D11Device* d3dDevice,
                                        texture, textureView, alphaMode );
 }
 
+_Use_decl_annotations_
+HRESULT DirectX::LoadDDSFileData12(
+	const wchar_t* szFileName,
+	std::unique_ptr<uint8_t[]>& ddsData,
+	size_t& ddsDataSize)
+{
+	ddsDataSize = 0;
+
+	if (!szFileName)
+	{
+		return E_INVALIDARG;
+	}
+
+	return ReadTextureFile(szFileName, ddsData, &ddsDataSize);
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::PrepareDDSTextureData12(
+	std::unique_ptr<uint8_t[]> ddsData,
+	size_t ddsDataSize,
+	size_t maxsize,
+	DDS_TEXTURE_DATA12& textureData)
+{
+	textureData = DDS_TEXTURE_DATA12();
+
+	if (!ddsData || !ddsDataSize)
+	{
+		return E_INVALIDARG;
+	}
+
+	DDS_HEADER* header = nullptr;
+	uint8_t* bitData = nullptr;
+	size_t bitSize = 0;
+
+	HRESULT hr = ParseDDSHeader(ddsData.get(), ddsDataSize, &header, &bitData, &bitSize);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	hr = PrepareTextureFromDDS12(header, bitData, bitSize, maxsize, textureData);
+	if (FAILED(hr))
+	{
+		textureData = DDS_TEXTURE_DATA12();
+		return hr;
+	}
+
+	// initData가 가리키는 원본 버퍼의 소유권을 함께 넘긴다.
+	textureData.ddsData = std::move(ddsData);
+	textureData.ddsDataSize = ddsDataSize;
+
+	return S_OK;
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::CreateDDSTextureFromData12(
+	ID3D12Device* device,
+	ID3D12GraphicsCommandList* cmdList,
+	const DDS_TEXTURE_DATA12& textureData,
+	ComPtr<ID3D12Resource>& texture,
+	ComPtr<ID3D12Resource>& textureUploadHeap,
+	ResourceHeapAllocator* heapAllocator,
+	HeapAllocation* allocation)
+{
+	if (texture)
+	{
+		texture = nullptr;
+	}
+	if (textureUploadHeap)
+	{
+		textureUploadHeap = nullptr;
+	}
+
+	if (!device || !cmdList || (heapAllocator && !allocation))
+	{
+		return E_INVALIDARG;
+	}
+
+	return CreateTextureFromDDS12(device, cmdList, textureData, texture, textureUploadHeap, heapAllocator, allocation);
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::DecompressDDSTextureData12(
+	DDS_TEXTURE_DATA12& textureData,
+	JobSystem* jobs)
+{
+	if (!textureData.initData)
+	{
+		return E_INVALIDARG;
+	}
+
+	if (!IsBCDecodeSupported(textureData.format))
+	{
+		return S_FALSE;
+	}
+
+	// 3D 텍스쳐는 깊이 조각마다 면 하나
+	const size_t depthSlices = (textureData.resDim == D3D12_RESOURCE_DIMENSION_TEXTURE3D) ? textureData.depth : 1;
+
+	size_t totalBytes = 0;
+	for (size_t i = 0; i < textureData.mipCount; i++)
+	{
+		size_t w = std::max<size_t>(textureData.width >> i, 1);
+		size_t h = std::max<size_t>(textureData.height >> i, 1);
+		size_t d = std::max<size_t>(depthSlices >> i, 1);
+		totalBytes += w * h * 4 * d;
+	}
+	totalBytes *= textureData.arraySize;
+
+	std::unique_ptr<uint8_t[]> pixels(new (std::nothrow) uint8_t[totalBytes]);
+	std::unique_ptr<D3D12_SUBRESOURCE_DATA[]> initData(new (std::nothrow) D3D12_SUBRESOURCE_DATA[textureData.mipCount * textureData.arraySize]);
+	if (!pixels || !initData)
+	{
+		return E_OUTOFMEMORY;
+	}
+
+	std::vector<BCSurface> surfaces;
+	uint8_t* dest = pixels.get();
+	for (size_t j = 0; j < textureData.arraySize; j++)
+	{
+		for (size_t i = 0; i < textureData.mipCount; i++)
+		{
+			const size_t index = j * textureData.mipCount + i;
+			const D3D12_SUBRESOURCE_DATA& source = textureData.initData[index];
+			size_t w = std::max<size_t>(textureData.width >> i, 1);
+			size_t h = std::max<size_t>(textureData.height >> i, 1);
+			size_t d = std::max<size_t>(depthSlices >> i, 1);
+
+			initData[index].pData = dest;
+			initData[index].RowPitch = static_cast<LONG_PTR>(w * 4);
+			initData[index].SlicePitch = static_cast<LONG_PTR>(w * h * 4);
+
+			for (size_t z = 0; z < d; z++)
+			{
+				BCSurface surface;
+				surface.Source = static_cast<const uint8_t*>(source.pData) + z * source.SlicePitch;
+				surface.SourceRowPitch = static_cast<size_t>(source.RowPitch);
+				surface.Width = static_cast<uint32_t>(w);
+				surface.Height = static_cast<uint32_t>(h);
+				surface.Destination = dest;
+				surface.DestinationRowPitch = w * 4;
+				surfaces.push_back(surface);
+
+				dest += w * h * 4;
+			}
+		}
+	}
+
+	if (!DecodeBCSurfaces(jobs, textureData.format, surfaces.data(), surfaces.size()))
+	{
+		return E_FAIL;
+	}
+
+	// 원본 BC 데이터는 더 이상 가리키는 곳이 없으므로 풀린 픽셀로 바꿔 든다.
+	textureData.format = GetBCDecodedFormat(textureData.format);
+	textureData.ddsData = std::move(pixels);
+	textureData.ddsDataSize = totalBytes;
+	textureData.initData = std::move(initData);
+
+	return S_OK;
+}
+
 HRESULT DirectX::CreateDDSTextureFromFile12(_In_ ID3D12Device* device,
 	_In_ ID3D12GraphicsCommandList* cmdList,
 	_In_z_ const wchar_t* szFileName,
@@ -2176,8 +2440,13 @@ HRESULT DirectX::CreateDDSTextureFromFile12(_In_ ID3D12Device* device,
 		return hr;
 	}
 
-	hr = CreateTextureFromDDS12(device, cmdList, header,
-		bitData, bitSize, maxsize, false, texture, textureUploadHeap);
+	DDS_TEXTURE_DATA12 textureData;
+	hr = PrepareTextureFromDDS12(header, bitData, bitSize, maxsize, textureData);
+
+	if (SUCCEEDED(hr))
+	{
+		hr = CreateTextureFromDDS12(device, cmdList, textureData, texture, textureUploadHeap);
+	}
 
 	if (SUCCEEDED(hr))
 	{
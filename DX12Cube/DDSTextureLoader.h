@@ -24,8 +24,13 @@
 
 #include <wrl.h>
 #include <d3d11_1.h>
+#include <memory>
 #include "d3dx12.h"
 
+class JobSystem;
+class ResourceHeapAllocator;
+struct HeapAllocation;
+
 #pragma warning(push)
 #pragma warning(disable : 4005)
 #include <stdint.h>
@@ -92,6 +97,63 @@ namespace DirectX
 		                               _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr
 		                               );
 
+	// 여러 스레드에서 나눠 처리하기 위한 단계별 API
+	// 1) LoadDDSFileData12: 디스크 I/O만 한다.
+	// 2) PrepareDDSTextureData12: 헤더 검증(GetDXGIFormat, 크기 제한)과 FillInitData12 레이아웃 계산. 장치가 필요 없다.
+	// 3) CreateDDSTextureFromData12: 리소스 생성 및 업로드 명령 기록. 커맨드 리스트를 기록하는 스레드에서만 호출.
+	//    heapAllocator가 있으면 헤더로 만든 desc의 텍스쳐를 그 힙에 놓고 위치를 allocation에 돌려준다. (CreateTextureFromCookedFile12와 같음)
+	struct DDS_TEXTURE_DATA12
+	{
+		// 파일 내용 전체. initData의 pData가 이 버퍼 안을 가리키므로 업로드가 기록될 때까지 유지해야 한다.
+		std::unique_ptr<uint8_t[]> ddsData;
+		size_t ddsDataSize = 0;
+
+		uint32_t resDim = 0;
+		size_t width = 0;
+		size_t height = 0;
+		size_t depth = 0;
+		size_t mipCount = 0;
+		size_t arraySize = 0;
+		DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+		bool isCubeMap = false;
+		DDS_ALPHA_MODE alphaMode = DDS_ALPHA_MODE_UNKNOWN;
+		// maxsize 때문에 건너뛴 상위 밉 수. width/height/mipCount는 건너뛴 뒤의 값이다.
+		size_t skipMip = 0;
+		// DDS 헤더의 원래 크기. 2의 거듭제곱이 아니면 width << skipMip과 다를 수 있다.
+		size_t fullWidth = 0;
+		size_t fullHeight = 0;
+
+		// mipCount * arraySize개
+		std::unique_ptr<D3D12_SUBRESOURCE_DATA[]> initData;
+	};
+
+	HRESULT LoadDDSFileData12(_In_z_ const wchar_t* szFileName,
+		                      _Out_ std::unique_ptr<uint8_t[]>& ddsData,
+		                      _Out_ size_t& ddsDataSize
+		                      );
+
+	HRESULT PrepareDDSTextureData12(_In_ std::unique_ptr<uint8_t[]> ddsData,
+		                            _In_ size_t ddsDataSize,
+		                            _In_ size_t maxsize,
+		                            _Out_ DDS_TEXTURE_DATA12& textureData
+		                            );
+
+	HRESULT CreateDDSTextureFromData12(_In_ ID3D12Device* device,
+		                               _In_ ID3D12GraphicsCommandList* cmdList,
+		                               _In_ const DDS_TEXTURE_DATA12& textureData,
+		                               _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& texture,
+		                               _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& textureUploadHeap,
+		                               _In_opt_ ResourceHeapAllocator* heapAllocator = nullptr,
+		                               _Out_opt_ HeapAllocation* allocation = nullptr
+		                               );
+
+	// Prepare가 끝난 BC 텍스쳐를 CPU에서 R8G8B8A8로 풀어서 textureData를 바꾼다. (BCDecoder)
+	// 내용 확인이나 BC를 못 쓰는 경우의 대체 경로용. jobs가 있으면 밉 체인 전체를 블록 줄 단위로 나눠 병렬로 푼다.
+	// BC 형식이 아니면 아무것도 하지 않고 S_FALSE를 돌려준다.
+	HRESULT DecompressDDSTextureData12(_Inout_ DDS_TEXTURE_DATA12& textureData,
+		                               _In_opt_ JobSystem* jobs = nullptr
+		                               );
+
     // Standard version with optional auto-gen mipmap support
     HRESULT CreateDDSTextureFromMemory( _In_ ID3D11Device* d3dDevice,
                                         _In_opt_ ID3D11DeviceContext* d3dContext,
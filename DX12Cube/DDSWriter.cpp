@@ -0,0 +1,181 @@
+#include "DDSWriter.h"
+#include <fstream>
+
+namespace
+{
+	const uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+
+	const uint32_t DDSD_CAPS = 0x00000001;
+	const uint32_t DDSD_HEIGHT = 0x00000002;
+	const uint32_t DDSD_WIDTH = 0x00000004;
+	const uint32_t DDSD_PITCH = 0x00000008;
+	const uint32_t DDSD_PIXELFORMAT = 0x00001000;
+	const uint32_t DDSD_MIPMAPCOUNT = 0x00020000;
+	const uint32_t DDSD_LINEARSIZE = 0x00080000;
+
+	const uint32_t DDPF_ALPHAPIXELS = 0x00000001;
+	const uint32_t DDPF_FOURCC = 0x00000004;
+	const uint32_t DDPF_RGB = 0x00000040;
+
+	const uint32_t DDSCAPS_COMPLEX = 0x00000008;
+	const uint32_t DDSCAPS_TEXTURE = 0x00001000;
+	const uint32_t DDSCAPS_MIPMAP = 0x00400000;
+
+	// D3D10_RESOURCE_DIMENSION_TEXTURE2D
+	const uint32_t DDS_DIMENSION_TEXTURE2D = 3;
+
+	constexpr uint32_t MakeFourCC(char a, char b, char c, char d)
+	{
+		return static_cast<uint32_t>(static_cast<uint8_t>(a)) | (static_cast<uint32_t>(static_cast<uint8_t>(b)) << 8) |
+			(static_cast<uint32_t>(static_cast<uint8_t>(c)) << 16) | (static_cast<uint32_t>(static_cast<uint8_t>(d)) << 24);
+	}
+
+	// DDSTextureLoader.cpp의 DDS_PIXELFORMAT / DDS_HEADER / DDS_HEADER_DXT10과 같은 배치
+	struct PixelFormat
+	{
+		uint32_t Size = 32;
+		uint32_t Flags = 0;
+		uint32_t FourCC = 0;
+		uint32_t RGBBitCount = 0;
+		uint32_t RBitMask = 0;
+		uint32_t GBitMask = 0;
+		uint32_t BBitMask = 0;
+		uint32_t ABitMask = 0;
+	};
+
+	struct Header
+	{
+		uint32_t Size = 124;
+		uint32_t Flags = 0;
+		uint32_t Height = 0;
+		uint32_t Width = 0;
+		uint32_t PitchOrLinearSize = 0;
+		uint32_t Depth = 0;
+		uint32_t MipMapCount = 0;
+		uint32_t Reserved1[11] = {};
+		PixelFormat Format;
+		uint32_t Caps = 0;
+		uint32_t Caps2 = 0;
+		uint32_t Caps3 = 0;
+		uint32_t Caps4 = 0;
+		uint32_t Reserved2 = 0;
+	};
+
+	struct HeaderDXT10
+	{
+		uint32_t Format = 0;
+		uint32_t ResourceDimension = DDS_DIMENSION_TEXTURE2D;
+		uint32_t MiscFlag = 0;
+		uint32_t ArraySize = 1;
+		uint32_t MiscFlags2 = 0;
+	};
+
+	static_assert(sizeof(Header) == 124, "DDS header size mismatch");
+	static_assert(sizeof(HeaderDXT10) == 20, "DDS DX10 header size mismatch");
+
+	bool IsBlockCompressed(DXGI_FORMAT format)
+	{
+		return (format >= DXGI_FORMAT_BC1_TYPELESS && format <= DXGI_FORMAT_BC5_SNORM)
+			|| (format >= DXGI_FORMAT_BC6H_TYPELESS && format <= DXGI_FORMAT_BC7_UNORM_SRGB);
+	}
+
+	bool IsEightByteBlock(DXGI_FORMAT format)
+	{
+		return (format >= DXGI_FORMAT_BC1_TYPELESS && format <= DXGI_FORMAT_BC1_UNORM_SRGB)
+			|| (format >= DXGI_FORMAT_BC4_TYPELESS && format <= DXGI_FORMAT_BC4_SNORM);
+	}
+}
+
+bool SaveDDSFile(const std::filesystem::path& path, DXGI_FORMAT format, uint32_t width, uint32_t height,
+	const std::vector<std::vector<uint8_t>>& mips)
+{
+	if (!width || !height || mips.empty())
+	{
+		return false;
+	}
+
+	const bool compressed = IsBlockCompressed(format);
+	if (!compressed && format != DXGI_FORMAT_R8G8B8A8_UNORM && format != DXGI_FORMAT_R8G8B8A8_UNORM_SRGB)
+	{
+		return false;
+	}
+
+	Header header;
+	header.Flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT;
+	header.Height = height;
+	header.Width = width;
+	header.Caps = DDSCAPS_TEXTURE;
+	if (mips.size() > 1)
+	{
+		header.Flags |= DDSD_MIPMAPCOUNT;
+		header.MipMapCount = static_cast<uint32_t>(mips.size());
+		header.Caps |= DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+	}
+
+	if (compressed)
+	{
+		const uint32_t blockBytes = IsEightByteBlock(format) ? 8 : 16;
+		header.Flags |= DDSD_LINEARSIZE;
+		header.PitchOrLinearSize = ((width + 3) / 4) * ((height + 3) / 4) * blockBytes;
+	}
+	else
+	{
+		header.Flags |= DDSD_PITCH;
+		header.PitchOrLinearSize = width * 4;
+	}
+
+	bool writeDXT10 = false;
+	switch (format)
+	{
+	case DXGI_FORMAT_BC1_UNORM:
+		header.Format.Flags = DDPF_FOURCC;
+		header.Format.FourCC = MakeFourCC('D', 'X', 'T', '1');
+		break;
+
+	case DXGI_FORMAT_BC2_UNORM:
+		header.Format.Flags = DDPF_FOURCC;
+		header.Format.FourCC = MakeFourCC('D', 'X', 'T', '3');
+		break;
+
+	case DXGI_FORMAT_BC3_UNORM:
+		header.Format.Flags = DDPF_FOURCC;
+		header.Format.FourCC = MakeFourCC('D', 'X', 'T', '5');
+		break;
+
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+		header.Format.Flags = DDPF_RGB | DDPF_ALPHAPIXELS;
+		header.Format.RGBBitCount = 32;
+		header.Format.RBitMask = 0x000000ff;
+		header.Format.GBitMask = 0x0000ff00;
+		header.Format.BBitMask = 0x00ff0000;
+		header.Format.ABitMask = 0xff000000;
+		break;
+
+	default:
+		header.Format.Flags = DDPF_FOURCC;
+		header.Format.FourCC = MakeFourCC('D', 'X', '1', '0');
+		writeDXT10 = true;
+		break;
+	}
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(&DDS_MAGIC), sizeof(DDS_MAGIC));
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	if (writeDXT10)
+	{
+		HeaderDXT10 extension;
+		extension.Format = static_cast<uint32_t>(format);
+		file.write(reinterpret_cast<const char*>(&extension), sizeof(extension));
+	}
+	for (const auto& mip : mips)
+	{
+		file.write(reinterpret_cast<const char*>(mip.data()), static_cast<std::streamsize>(mip.size()));
+	}
+
+	return static_cast<bool>(file);
+}
@@ -0,0 +1,18 @@
+#pragma once
+#ifndef _DDSWRITER_H_
+#define _DDSWRITER_H_
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+#include <dxgiformat.h>
+
+// 2D 텍스쳐 밉 체인을 DDS 파일로 저장한다. DDSTextureLoader가 그대로 읽을 수 있는 형식으로 쓴다.
+// BC1/BC2/BC3(UNORM)와 R8G8B8A8_UNORM은 예전 헤더(FourCC/RGB 마스크)로, 나머지(BC7, _SRGB 등)는 DX10 확장 헤더로 쓴다.
+// mips[i]는 i번 밉의 데이터로, 행 사이 여백 없이 GetSurfaceInfo가 계산하는 크기와 같아야 한다.
+// 사용법:
+//   SaveDDSFile(L"grass.dds", DXGI_FORMAT_BC7_UNORM, 512, 512, mips);
+bool SaveDDSFile(const std::filesystem::path& path, DXGI_FORMAT format, uint32_t width, uint32_t height,
+	const std::vector<std::vector<uint8_t>>& mips);
+
+#endif
@@ -0,0 +1,109 @@
+#include "DrawQueue.h"
+#include <cstring>
+#include <utility>
+
+namespace DrawSortKey
+{
+	uint32_t QuantizeDepth(float viewDepth)
+	{
+		if (!(viewDepth > 0.0f))
+		{
+			return 0;
+		}
+
+		// 양수 float의 비트는 값과 같은 순서로 커진다. 상위 비트만 쓴다. (지수 전체 + 가수 상위 15비트)
+		uint32_t bits;
+		std::memcpy(&bits, &viewDepth, sizeof(bits));
+		return bits >> (32 - DepthBits);
+	}
+
+	namespace
+	{
+		uint64_t Field(uint32_t value, unsigned bits, unsigned shift)
+		{
+			return (static_cast<uint64_t>(value) & ((1ull << bits) - 1)) << shift;
+		}
+	}
+
+	uint64_t MakeFrontToBack(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, float viewDepth)
+	{
+		unsigned shift = 64;
+		uint64_t key = 0;
+		key |= Field(pass, PassBits, shift -= PassBits);
+		key |= Field(pipeline, PipelineBits, shift -= PipelineBits);
+		key |= Field(material, MaterialBits, shift -= MaterialBits);
+		key |= Field(mesh, MeshBits, shift -= MeshBits);
+		key |= Field(QuantizeDepth(viewDepth), DepthBits, shift -= DepthBits);
+		return key;
+	}
+
+	uint64_t MakeBackToFront(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, float viewDepth)
+	{
+		unsigned shift = 64;
+		uint64_t key = 0;
+		key |= Field(pass, PassBits, shift -= PassBits);
+		// 먼 것이 작은 키가 되도록 뒤집는다.
+		key |= Field(~QuantizeDepth(viewDepth), DepthBits, shift -= DepthBits);
+		key |= Field(pipeline, PipelineBits, shift -= PipelineBits);
+		key |= Field(material, MaterialBits, shift -= MaterialBits);
+		key |= Field(mesh, MeshBits, shift -= MeshBits);
+		return key;
+	}
+}
+
+void DrawQueue::Sort()
+{
+	mLastSortPasses = 0;
+	const size_t count = mEntries.size();
+	if (count < 2)
+	{
+		return;
+	}
+
+	// 8개 바이트의 히스토그램을 한 번 훑어서 같이 센다.
+	size_t histograms[8][256] = { };
+	for (const auto& entry : mEntries)
+	{
+		for (unsigned byte = 0; byte < 8; byte++)
+		{
+			histograms[byte][(entry.Key >> (byte * 8)) & 0xFF]++;
+		}
+	}
+
+	mScratch.resize(count);
+	DrawQueueEntry* src = mEntries.data();
+	DrawQueueEntry* dst = mScratch.data();
+
+	for (unsigned byte = 0; byte < 8; byte++)
+	{
+		auto& histogram = histograms[byte];
+
+		// 모든 키가 이 바이트에서 같으면 순서가 바뀌지 않는다.
+		if (histogram[(src[0].Key >> (byte * 8)) & 0xFF] == count)
+		{
+			continue;
+		}
+
+		size_t offsets[256];
+		size_t sum = 0;
+		for (size_t bucket = 0; bucket < 256; bucket++)
+		{
+			offsets[bucket] = sum;
+			sum += histogram[bucket];
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			dst[offsets[(src[i].Key >> (byte * 8)) & 0xFF]++] = src[i];
+		}
+
+		std::swap(src, dst);
+		mLastSortPasses++;
+	}
+
+	// 홀수 번 돌았으면 결과가 mScratch에 있다.
+	if (src != mEntries.data())
+	{
+		mEntries.swap(mScratch);
+	}
+}
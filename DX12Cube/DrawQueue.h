@@ -0,0 +1,67 @@
+#pragma once
+#ifndef _DRAWQUEUE_H_
+#define _DRAWQUEUE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 그리기 순서를 정하는 64비트 정렬 키
+// 앞을 먼저 그린다. 불투명: 패스 | PSO | 재질 | 메쉬 | 깊이(가까운 것부터, early-Z)
+//                  반투명: 패스 | 깊이(먼 것부터) | PSO | 재질 | 메쉬
+// 같은 패스 안에서 불투명은 상태 변경이 적은 순서가 먼저이고, 반투명은 블렌딩 순서가 먼저다.
+// 각 번호는 비트 수를 넘으면 잘린다. (재질, 메쉬는 16384개까지 구분)
+namespace DrawSortKey
+{
+	constexpr unsigned PassBits = 4;
+	constexpr unsigned PipelineBits = 8;
+	constexpr unsigned MaterialBits = 14;
+	constexpr unsigned MeshBits = 14;
+	constexpr unsigned DepthBits = 24;
+	static_assert(PassBits + PipelineBits + MaterialBits + MeshBits + DepthBits == 64, "sort key must fill 64 bits");
+
+	// 뷰 공간 z(0 이상)를 크기 순서가 유지되는 DepthBits 정수로. 음수는 0
+	uint32_t QuantizeDepth(float viewDepth);
+
+	uint64_t MakeFrontToBack(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, float viewDepth);
+	uint64_t MakeBackToFront(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, float viewDepth);
+
+	inline uint32_t GetPass(uint64_t key) { return static_cast<uint32_t>(key >> (64 - PassBits)); }
+}
+
+struct DrawQueueEntry
+{
+	uint64_t Key;
+	// 호출하는 쪽 배열에서의 번호
+	uint32_t Index;
+};
+
+// 프레임마다 키를 모아서 기수 정렬(LSD, 8비트씩 8번)하는 그리기 목록
+// 모든 키에서 같은 바이트는 건너뛴다. 정렬은 안정적이라 키가 같으면 넣은 순서를 지킨다.
+// 사용법:
+//   queue.Clear();
+//   queue.Add(DrawSortKey::MakeFrontToBack(pass, pso, material, mesh, depth), itemIndex);
+//   queue.Sort();
+//   for (const auto& entry : queue.GetEntries()) Draw(items[entry.Index]);
+class DrawQueue
+{
+public:
+	void Clear() { mEntries.clear(); }
+	void Reserve(size_t count) { mEntries.reserve(count); }
+	void Add(uint64_t key, uint32_t index) { mEntries.push_back({ key, index }); }
+
+	void Sort();
+
+	const std::vector<DrawQueueEntry>& GetEntries() const { return mEntries; }
+	size_t GetSize() const { return mEntries.size(); }
+	// 마지막 Sort에서 실제로 돈 바이트 패스 수 (0~8)
+	unsigned GetLastSortPasses() const { return mLastSortPasses; }
+
+private:
+	std::vector<DrawQueueEntry> mEntries;
+	// 정렬할 때 번갈아 쓰는 버퍼. 프레임마다 새로 잡지 않는다.
+	std::vector<DrawQueueEntry> mScratch;
+	unsigned mLastSortPasses = 0;
+};
+
+#endif
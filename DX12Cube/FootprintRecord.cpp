@@ -0,0 +1,207 @@
+#include "FootprintRecord.h"
+#include <algorithm>
+#include <format>
+#include <istream>
+#include <limits>
+#include <ostream>
+
+namespace
+{
+	UINT16 GetFullMipCount(UINT64 width, UINT height, UINT depth)
+	{
+		UINT16 count = 1;
+		while (width > 1 || height > 1 || depth > 1)
+		{
+			width = std::max<UINT64>(width / 2, 1);
+			height = std::max(height / 2, 1u);
+			depth = std::max(depth / 2, 1u);
+			count++;
+		}
+		return count;
+	}
+
+	// CD3DX12_RESOURCE_DESC::Tex2D/Tex3D/Buffer와 같은 값 (d3dx12.h 없이)
+	D3D12_RESOURCE_DESC MakeResourceDesc(D3D12_RESOURCE_DIMENSION dimension, DXGI_FORMAT format, UINT64 width, UINT height,
+		UINT16 depthOrArraySize, UINT16 mipLevels, D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_NONE)
+	{
+		D3D12_RESOURCE_DESC desc = {};
+		desc.Dimension = dimension;
+		desc.Format = format;
+		desc.Width = width;
+		desc.Height = height;
+		desc.DepthOrArraySize = depthOrArraySize;
+		desc.MipLevels = mipLevels;
+		desc.SampleDesc.Count = 1;
+		desc.Layout = dimension == D3D12_RESOURCE_DIMENSION_BUFFER ? D3D12_TEXTURE_LAYOUT_ROW_MAJOR : D3D12_TEXTURE_LAYOUT_UNKNOWN;
+		desc.Flags = flags;
+		return desc;
+	}
+}
+
+std::vector<FootprintCase> BuildFootprintCases()
+{
+	const DXGI_FORMAT formats[] =
+	{
+		DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_R32G32B32A32_FLOAT, DXGI_FORMAT_R32G32B32_FLOAT, DXGI_FORMAT_R16_UNORM,
+		DXGI_FORMAT_R8_UNORM, DXGI_FORMAT_B5G6R5_UNORM, DXGI_FORMAT_R9G9B9E5_SHAREDEXP,
+		DXGI_FORMAT_BC1_UNORM, DXGI_FORMAT_BC3_UNORM, DXGI_FORMAT_BC4_UNORM, DXGI_FORMAT_BC6H_UF16, DXGI_FORMAT_BC7_UNORM,
+		DXGI_FORMAT_D24_UNORM_S8_UINT, DXGI_FORMAT_D32_FLOAT_S8X24_UINT, DXGI_FORMAT_D16_UNORM,
+		DXGI_FORMAT_YUY2, DXGI_FORMAT_Y210, DXGI_FORMAT_NV12, DXGI_FORMAT_P010,
+	};
+	const UINT sizes[][2] = { { 1, 1 }, { 3, 5 }, { 16, 16 }, { 17, 33 }, { 256, 256 }, { 1000, 600 }, { 1920, 1080 }, { 4096, 2048 } };
+	const UINT16 arraySizes[] = { 1, 6 };
+
+	std::vector<FootprintCase> cases;
+	for (DXGI_FORMAT format : formats)
+	{
+		const CopyablePlaneInfo info = GetCopyablePlaneInfo(format, 0);
+		const bool video = format == DXGI_FORMAT_NV12 || format == DXGI_FORMAT_P010 || format == DXGI_FORMAT_YUY2 || format == DXGI_FORMAT_Y210;
+		const bool depthStencil = GetCopyablePlaneCount(format) > 1 && !video;
+		for (const auto& size : sizes)
+		{
+			if (size[0] % info.BlockWidth != 0 || size[1] % info.BlockHeight != 0 || (video && (size[0] % 2 || size[1] % 2)))
+			{
+				continue;
+			}
+			for (UINT16 arraySize : arraySizes)
+			{
+				for (bool fullChain : { false, true })
+				{
+					if (video && (fullChain || arraySize > 1))
+					{
+						continue;
+					}
+
+					FootprintCase footprintCase;
+					footprintCase.Desc = MakeResourceDesc(D3D12_RESOURCE_DIMENSION_TEXTURE2D, format, size[0], size[1], arraySize,
+						fullChain ? GetFullMipCount(size[0], size[1], 1) : 1,
+						depthStencil ? D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL : D3D12_RESOURCE_FLAG_NONE);
+					footprintCase.BaseOffset = cases.size() % 3 == 0 ? D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT * 3 : 0;
+					footprintCase.SubresourceCount = footprintCase.Desc.MipLevels * arraySize * GetCopyablePlaneCount(format);
+					cases.push_back(footprintCase);
+				}
+			}
+		}
+	}
+
+	// 3D 텍스쳐와 버퍼
+	for (DXGI_FORMAT format : { DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_BC1_UNORM, DXGI_FORMAT_R16G16B16A16_FLOAT })
+	{
+		FootprintCase footprintCase;
+		footprintCase.Desc = MakeResourceDesc(D3D12_RESOURCE_DIMENSION_TEXTURE3D, format, 64, 32, 12, GetFullMipCount(64, 32, 12));
+		footprintCase.SubresourceCount = footprintCase.Desc.MipLevels;
+		cases.push_back(footprintCase);
+	}
+	for (UINT64 width : { 1ull, 1000ull, 65536ull })
+	{
+		FootprintCase footprintCase;
+		footprintCase.Desc = MakeResourceDesc(D3D12_RESOURCE_DIMENSION_BUFFER, DXGI_FORMAT_UNKNOWN, width, 1, 1, 1);
+		footprintCase.SubresourceCount = 1;
+		cases.push_back(footprintCase);
+	}
+	return cases;
+}
+
+FootprintResult ComputeFootprintOnCPU(const FootprintCase& footprintCase)
+{
+	FootprintResult result;
+	result.Layouts.resize(footprintCase.SubresourceCount);
+	result.NumRows.resize(footprintCase.SubresourceCount);
+	result.RowSizes.resize(footprintCase.SubresourceCount);
+	ComputeCopyableFootprints(footprintCase.Desc, 0, footprintCase.SubresourceCount, footprintCase.BaseOffset,
+		result.Layouts.data(), result.NumRows.data(), result.RowSizes.data(), &result.TotalBytes);
+	return result;
+}
+
+std::string DescribeFootprintCase(const FootprintCase& footprintCase)
+{
+	const auto& desc = footprintCase.Desc;
+	return std::format("dim {} format {} {}x{}x{} mips {} base {}", static_cast<int>(desc.Dimension), static_cast<int>(desc.Format),
+		desc.Width, desc.Height, desc.DepthOrArraySize, desc.MipLevels, footprintCase.BaseOffset);
+}
+
+std::string CompareFootprints(const FootprintResult& expected, const FootprintResult& actual)
+{
+	if (expected.TotalBytes != actual.TotalBytes)
+	{
+		return std::format("total bytes {} (device) != {} (cpu)", expected.TotalBytes, actual.TotalBytes);
+	}
+	for (size_t i = 0; i < expected.Layouts.size(); i++)
+	{
+		const auto& e = expected.Layouts[i];
+		const auto& a = actual.Layouts[i];
+		if (e.Offset != a.Offset || e.Footprint.Format != a.Footprint.Format || e.Footprint.Width != a.Footprint.Width
+			|| e.Footprint.Height != a.Footprint.Height || e.Footprint.Depth != a.Footprint.Depth
+			|| e.Footprint.RowPitch != a.Footprint.RowPitch || expected.NumRows[i] != actual.NumRows[i]
+			|| expected.RowSizes[i] != actual.RowSizes[i])
+		{
+			return std::format("subresource {}: device {{offset {} format {} {}x{}x{} pitch {} rows {} row size {}}}"
+				" cpu {{offset {} format {} {}x{}x{} pitch {} rows {} row size {}}}", i,
+				e.Offset, static_cast<int>(e.Footprint.Format), e.Footprint.Width, e.Footprint.Height, e.Footprint.Depth,
+				e.Footprint.RowPitch, expected.NumRows[i], expected.RowSizes[i],
+				a.Offset, static_cast<int>(a.Footprint.Format), a.Footprint.Width, a.Footprint.Height, a.Footprint.Depth,
+				a.Footprint.RowPitch, actual.NumRows[i], actual.RowSizes[i]);
+		}
+	}
+	return {};
+}
+
+void WriteFootprintRecord(std::ostream& file, const FootprintCase& footprintCase, const FootprintResult& result)
+{
+	const auto& desc = footprintCase.Desc;
+	file << "case " << desc.Dimension << ' ' << desc.Format << ' ' << desc.Width << ' ' << desc.Height << ' '
+		<< desc.DepthOrArraySize << ' ' << desc.MipLevels << ' ' << footprintCase.BaseOffset << ' '
+		<< footprintCase.SubresourceCount << ' ' << result.TotalBytes << '\n';
+	for (size_t i = 0; i < result.Layouts.size(); i++)
+	{
+		const auto& layout = result.Layouts[i];
+		file << layout.Offset << ' ' << layout.Footprint.Format << ' ' << layout.Footprint.Width << ' '
+			<< layout.Footprint.Height << ' ' << layout.Footprint.Depth << ' ' << layout.Footprint.RowPitch << ' '
+			<< result.NumRows[i] << ' ' << result.RowSizes[i] << '\n';
+	}
+}
+
+bool ReadFootprintRecord(std::istream& file, FootprintCase& footprintCase, FootprintResult& result)
+{
+	// 주석 줄은 건너뛴다.
+	while ((file >> std::ws).peek() == '#')
+	{
+		file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+	}
+
+	std::string tag;
+	UINT dimension = 0;
+	UINT format = 0;
+	UINT depthOrArraySize = 0;
+	UINT mipLevels = 0;
+	if (!(file >> tag) || tag != "case"
+		|| !(file >> dimension >> format >> footprintCase.Desc.Width >> footprintCase.Desc.Height >> depthOrArraySize >> mipLevels
+			>> footprintCase.BaseOffset >> footprintCase.SubresourceCount >> result.TotalBytes))
+	{
+		return false;
+	}
+
+	auto& desc = footprintCase.Desc;
+	desc.Dimension = static_cast<D3D12_RESOURCE_DIMENSION>(dimension);
+	desc.Format = static_cast<DXGI_FORMAT>(format);
+	desc.DepthOrArraySize = static_cast<UINT16>(depthOrArraySize);
+	desc.MipLevels = static_cast<UINT16>(mipLevels);
+	desc.SampleDesc.Count = 1;
+	desc.Layout = desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER ? D3D12_TEXTURE_LAYOUT_ROW_MAJOR : D3D12_TEXTURE_LAYOUT_UNKNOWN;
+
+	result.Layouts.resize(footprintCase.SubresourceCount);
+	result.NumRows.resize(footprintCase.SubresourceCount);
+	result.RowSizes.resize(footprintCase.SubresourceCount);
+	for (UINT i = 0; i < footprintCase.SubresourceCount; i++)
+	{
+		auto& layout = result.Layouts[i];
+		UINT layoutFormat = 0;
+		if (!(file >> layout.Offset >> layoutFormat >> layout.Footprint.Width >> layout.Footprint.Height >> layout.Footprint.Depth
+			>> layout.Footprint.RowPitch >> result.NumRows[i] >> result.RowSizes[i]))
+		{
+			return false;
+		}
+		layout.Footprint.Format = static_cast<DXGI_FORMAT>(layoutFormat);
+	}
+	return true;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#ifndef _FOOTPRINTRECORD_H_
+#define _FOOTPRINTRECORD_H_
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include "CopyableFootprints.h"
+
+// GetCopyableFootprints 결과를 텍스트로 남기고 다시 읽어 ComputeCopyableFootprints와 비교한다.
+// DxTool footprint-check --record가 장치 결과를 쓰고, --compare와 DxCheck footprint-test가 장치 없이 읽는다.
+// 기록 파일: #으로 시작하는 줄은 주석. 케이스마다
+//   case <dimension> <format> <width> <height> <depthOrArraySize> <mipLevels> <baseOffset> <subresourceCount> <totalBytes>
+// 다음에 서브리소스마다
+//   <offset> <format> <width> <height> <depth> <rowPitch> <numRows> <rowSize>
+// 사용법:
+//   for (const auto& footprintCase : BuildFootprintCases()) WriteFootprintRecord(file, footprintCase, deviceResult);
+//   while (ReadFootprintRecord(file, footprintCase, expected)) difference = CompareFootprints(expected, ComputeFootprintOnCPU(footprintCase));
+
+struct FootprintCase
+{
+	D3D12_RESOURCE_DESC Desc = {};
+	UINT64 BaseOffset = 0;
+	UINT SubresourceCount = 0;
+};
+
+struct FootprintResult
+{
+	std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> Layouts;
+	std::vector<UINT> NumRows;
+	std::vector<UINT64> RowSizes;
+	UINT64 TotalBytes = 0;
+};
+
+// 크기/밉/배열/포맷 조합. 장치가 받아들이지 않는 조합(BC의 4배수가 아닌 크기, 비디오 포맷의 밉 등)은 뺀다.
+std::vector<FootprintCase> BuildFootprintCases();
+
+FootprintResult ComputeFootprintOnCPU(const FootprintCase& footprintCase);
+
+std::string DescribeFootprintCase(const FootprintCase& footprintCase);
+// 다른 점을 찾으면 설명을 돌려준다. 같으면 빈 문자열. expected는 장치(또는 기록) 결과
+std::string CompareFootprints(const FootprintResult& expected, const FootprintResult& actual);
+
+void WriteFootprintRecord(std::ostream& file, const FootprintCase& footprintCase, const FootprintResult& result);
+// 케이스 하나를 읽는다. 파일 끝이거나 형식이 틀리면 false
+bool ReadFootprintRecord(std::istream& file, FootprintCase& footprintCase, FootprintResult& result);
+
+#endif
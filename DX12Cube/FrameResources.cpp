@@ -0,0 +1,198 @@
+#include "FrameResources.h"
+#include <algorithm>
+#include <format>
+#include "d3dx12.h"
+
+std::wstring FrameResourceStats::ToString() const
+{
+	return std::format(L"FrameResources: {} frames, frame {:.3f} ms avg / {:.3f} ms max, cpu wait {:.3f} ms avg ({} waits, {:.1f}%), {:.2f} frames in flight, record {:.3f} ms avg on {:.1f} lists, constants {:.1f} KB peak\n",
+		Frames, GetAverageFrameMilliseconds(), MaxFrameSeconds * 1000.0, GetAverageWaitMilliseconds(), Waits,
+		GetWaitFraction() * 100.0, GetAverageFramesInFlight(), GetAverageRecordMilliseconds(), GetAverageRecordedLists(),
+		PeakConstantBytes / 1024.0);
+}
+
+HRESULT LinearUploadAllocator::Create(ID3D12Device* device, UINT64 capacity)
+{
+	Release();
+
+	auto uploadHeapProp = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+	auto bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(capacity);
+	HRESULT hr = device->CreateCommittedResource(
+		&uploadHeapProp,
+		D3D12_HEAP_FLAG_NONE,
+		&bufferDesc,
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(&mBuffer));
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	// 업로드 힙은 계속 매핑해 둬도 된다. CPU는 쓰기만 한다.
+	CD3DX12_RANGE readRange(0, 0);
+	hr = mBuffer->Map(0, &readRange, reinterpret_cast<void**>(&mCpuBase));
+	if (FAILED(hr))
+	{
+		mBuffer.Reset();
+		return hr;
+	}
+
+	mGpuBase = mBuffer->GetGPUVirtualAddress();
+	mCapacity = capacity;
+	mOffset = 0;
+	return S_OK;
+}
+
+void LinearUploadAllocator::Release()
+{
+	if (mBuffer && mCpuBase)
+	{
+		mBuffer->Unmap(0, nullptr);
+	}
+	mBuffer.Reset();
+	mCpuBase = nullptr;
+	mGpuBase = 0;
+	mCapacity = 0;
+	mOffset = 0;
+}
+
+bool LinearUploadAllocator::Allocate(UINT64 size, UINT64 alignment, UploadAllocation& allocation)
+{
+	const UINT64 offset = (mOffset + alignment - 1) & ~(alignment - 1);
+	if (!mCpuBase || offset + size > mCapacity)
+	{
+		return false;
+	}
+
+	allocation.CpuAddress = mCpuBase + offset;
+	allocation.GpuAddress = mGpuBase + offset;
+	mOffset = offset + size;
+	return true;
+}
+
+FrameResourceRing::~FrameResourceRing()
+{
+	Release();
+}
+
+HRESULT FrameResourceRing::Create(ID3D12Device* device, UINT frameCount, UINT64 constantBytesPerFrame, UINT recordingListCount)
+{
+	Release();
+
+	mFenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+	if (!mFenceEvent)
+	{
+		return HRESULT_FROM_WIN32(GetLastError());
+	}
+
+	mFrames.resize(frameCount);
+	for (auto& frame : mFrames)
+	{
+		HRESULT hr = device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&frame.CommandAllocator));
+		if (SUCCEEDED(hr))
+		{
+			hr = frame.Constants.Create(device, constantBytesPerFrame);
+		}
+		frame.RecordingAllocators.resize(recordingListCount);
+		for (auto& allocator : frame.RecordingAllocators)
+		{
+			if (SUCCEEDED(hr))
+			{
+				hr = device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&allocator));
+			}
+		}
+		if (FAILED(hr))
+		{
+			Release();
+			return hr;
+		}
+	}
+	mCurrent = 0;
+	mStats = FrameResourceStats();
+	mHasLastBegin = false;
+	return S_OK;
+}
+
+void FrameResourceRing::Release()
+{
+	for (auto& frame : mFrames)
+	{
+		frame.Constants.Release();
+		frame.CommandAllocator.Reset();
+		frame.RecordingAllocators.clear();
+	}
+	mFrames.clear();
+
+	if (mFenceEvent)
+	{
+		CloseHandle(mFenceEvent);
+		mFenceEvent = nullptr;
+	}
+}
+
+FrameResource& FrameResourceRing::BeginFrame(ID3D12Fence* fence)
+{
+	// 이전 BeginFrame부터 지금까지가 한 프레임
+	const auto now = std::chrono::steady_clock::now();
+	if (mHasLastBegin)
+	{
+		const double frameSeconds = std::chrono::duration<double>(now - mLastBeginTime).count();
+		mStats.Frames++;
+		mStats.FrameSeconds += frameSeconds;
+		mStats.MaxFrameSeconds = std::max(mStats.MaxFrameSeconds, frameSeconds);
+	}
+	mLastBeginTime = now;
+	mHasLastBegin = true;
+
+	const UINT64 completed = fence->GetCompletedValue();
+	for (const auto& other : mFrames)
+	{
+		mStats.FramesInFlight += (other.FenceValue > completed) ? 1 : 0;
+	}
+
+	// GPU가 frameCount 프레임 전에 제출한 이 자원을 아직 쓰고 있으면 기다린다.
+	FrameResource& frame = mFrames[mCurrent];
+	if (frame.FenceValue > completed)
+	{
+		mStats.Waits++;
+		mStats.WaitSeconds += WaitForFence(fence, frame.FenceValue);
+	}
+
+	frame.CommandAllocator->Reset();
+	for (auto& allocator : frame.RecordingAllocators)
+	{
+		allocator->Reset();
+	}
+	frame.Constants.Reset();
+	return frame;
+}
+
+HRESULT FrameResourceRing::EndFrame(ID3D12CommandQueue* queue, ID3D12Fence* fence, UINT64& fenceValue)
+{
+	FrameResource& frame = mFrames[mCurrent];
+
+	fenceValue++;
+	HRESULT hr = queue->Signal(fence, fenceValue);
+	frame.FenceValue = fenceValue;
+
+	mStats.PeakConstantBytes = std::max(mStats.PeakConstantBytes, frame.Constants.GetUsed());
+
+	mCurrent = (mCurrent + 1) % static_cast<UINT>(mFrames.size());
+	return hr;
+}
+
+double FrameResourceRing::WaitForFence(ID3D12Fence* fence, UINT64 fenceValue)
+{
+	if (fence->GetCompletedValue() >= fenceValue)
+	{
+		return 0.0;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	if (mFenceEvent && SUCCEEDED(fence->SetEventOnCompletion(fenceValue, mFenceEvent)))
+	{
+		WaitForSingleObject(mFenceEvent, INFINITE);
+	}
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
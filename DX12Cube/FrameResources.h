@@ -0,0 +1,134 @@
+#pragma once
+#ifndef _FRAMERESOURCES_H_
+#define _FRAMERESOURCES_H_
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <d3d12.h>
+#include <wrl.h>
+
+// 한 프레임 동안 쓰는 업로드 메모리 선형 할당기
+// 업로드 버퍼 하나를 계속 매핑해 두고 앞에서부터 잘라 준다. 프레임이 끝나고 GPU가 다 읽은 뒤 Reset한다.
+// 사용법:
+//   UploadAllocation cb;
+//   if (allocator.Allocate(sizeof(FrameConstantBuffer), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, cb))
+//   {
+//       memcpy(cb.CpuAddress, &constants, sizeof(constants));
+//       cmdList->SetGraphicsRootConstantBufferView(0, cb.GpuAddress);
+//   }
+
+struct UploadAllocation
+{
+	void* CpuAddress = nullptr;
+	D3D12_GPU_VIRTUAL_ADDRESS GpuAddress = 0;
+};
+
+class LinearUploadAllocator
+{
+public:
+	HRESULT Create(ID3D12Device* device, UINT64 capacity);
+	void Release();
+
+	// 남은 공간이 모자라면 false
+	bool Allocate(UINT64 size, UINT64 alignment, UploadAllocation& allocation);
+	void Reset() { mOffset = 0; }
+
+	UINT64 GetUsed() const { return mOffset; }
+	UINT64 GetCapacity() const { return mCapacity; }
+
+private:
+	Microsoft::WRL::ComPtr<ID3D12Resource> mBuffer;
+	BYTE* mCpuBase = nullptr;
+	D3D12_GPU_VIRTUAL_ADDRESS mGpuBase = 0;
+	UINT64 mCapacity = 0;
+	UINT64 mOffset = 0;
+};
+
+// 동시에 GPU에 올라가 있을 수 있는 프레임마다 하나씩 두는 자원
+struct FrameResource
+{
+	Microsoft::WRL::ComPtr<ID3D12CommandAllocator> CommandAllocator;
+	// 여러 스레드에서 나눠 기록하는 커맨드 리스트마다 하나씩 (할당기는 스레드 하나만 써야 한다)
+	std::vector<Microsoft::WRL::ComPtr<ID3D12CommandAllocator>> RecordingAllocators;
+	// 물체별 상수 버퍼 (루트 CBV로 주소를 넘긴다)
+	LinearUploadAllocator Constants;
+	// 이 프레임을 제출하고 Signal한 펜스 값. GPU가 여기까지 끝내야 다시 쓸 수 있다.
+	UINT64 FenceValue = 0;
+};
+
+// 프레임 시간과 CPU 대기 측정. ResetWindow 이후 구간 값이다.
+struct FrameResourceStats
+{
+	UINT64 Frames = 0;
+	// BeginFrame에서 다음 BeginFrame까지 (CPU 프레임 시간)
+	double FrameSeconds = 0.0;
+	double MaxFrameSeconds = 0.0;
+	// 다음 프레임 자원을 GPU가 아직 쓰고 있어서 기다린 횟수와 시간
+	UINT64 Waits = 0;
+	double WaitSeconds = 0.0;
+	// BeginFrame 시점에 GPU가 아직 끝내지 않은 프레임 수의 합 (평균 지연 프레임 수)
+	UINT64 FramesInFlight = 0;
+	// 커맨드 리스트 기록에 걸린 시간과 쓴 리스트 수
+	double RecordSeconds = 0.0;
+	UINT64 RecordedLists = 0;
+	UINT64 PeakConstantBytes = 0;
+
+	double GetAverageFrameMilliseconds() const { return Frames ? FrameSeconds * 1000.0 / Frames : 0.0; }
+	double GetAverageWaitMilliseconds() const { return Frames ? WaitSeconds * 1000.0 / Frames : 0.0; }
+	// 프레임 시간 중 GPU를 기다린 비율. 1에 가까우면 GPU가 병목이다.
+	double GetWaitFraction() const { return FrameSeconds > 0.0 ? WaitSeconds / FrameSeconds : 0.0; }
+	double GetAverageFramesInFlight() const { return Frames ? static_cast<double>(FramesInFlight) / Frames : 0.0; }
+	double GetAverageRecordMilliseconds() const { return Frames ? RecordSeconds * 1000.0 / Frames : 0.0; }
+	double GetAverageRecordedLists() const { return Frames ? static_cast<double>(RecordedLists) / Frames : 0.0; }
+
+	std::wstring ToString() const;
+};
+
+// FrameResource를 돌려 가며 쓰는 고리 (프레임 스케줄러)
+// CPU는 GPU보다 최대 frameCount - 1 프레임 앞서서 명령을 기록한다. 매 프레임 FlushCommandQueue로 기다리지 않는다.
+// frameCount가 크면 CPU/GPU가 더 겹쳐서 처리량이 늘지만 입력에서 화면까지의 지연도 그만큼 는다.
+// 기다릴 때는 Create에서 만든 이벤트 하나를 계속 쓴다.
+// 사용법:
+//   auto& frame = ring.BeginFrame(fence); // 필요하면 여기서 기다림
+//   cmdList->Reset(frame.CommandAllocator.Get(), pso); ... 기록, 제출 ...
+//   ring.EndFrame(queue, fence, fenceValue); // ++fenceValue를 Signal
+//   ring.WaitForFence(fence, fenceValue);      // GPU가 다 끝날 때까지 (종료, 리소스 교체)
+class FrameResourceRing
+{
+public:
+	FrameResourceRing() = default;
+	~FrameResourceRing();
+
+	FrameResourceRing(const FrameResourceRing&) = delete;
+	FrameResourceRing& operator=(const FrameResourceRing&) = delete;
+
+	// recordingListCount는 프레임마다 둘 병렬 기록용 할당기 수
+	HRESULT Create(ID3D12Device* device, UINT frameCount, UINT64 constantBytesPerFrame, UINT recordingListCount = 0);
+	// GPU가 모든 프레임을 끝낸 뒤에 호출
+	void Release();
+
+	// 이번 프레임 자원을 GPU가 다 쓸 때까지 기다린 뒤, 명령 할당기와 상수 할당기를 리셋한다.
+	FrameResource& BeginFrame(ID3D12Fence* fence);
+	// fenceValue를 하나 올려서 Signal하고 이번 프레임 자원에 기록한다.
+	HRESULT EndFrame(ID3D12CommandQueue* queue, ID3D12Fence* fence, UINT64& fenceValue);
+
+	// fence가 fenceValue에 이를 때까지 기다린다. 기다린 시간(초)을 돌려준다.
+	double WaitForFence(ID3D12Fence* fence, UINT64 fenceValue);
+
+	FrameResource& GetCurrent() { return mFrames[mCurrent]; }
+	UINT GetFrameCount() const { return static_cast<UINT>(mFrames.size()); }
+	const FrameResourceStats& GetStats() const { return mStats; }
+	void ResetWindow() { mStats = FrameResourceStats(); }
+	void AddRecordTime(double seconds, UINT listCount) { mStats.RecordSeconds += seconds; mStats.RecordedLists += listCount; }
+
+private:
+	std::vector<FrameResource> mFrames;
+	UINT mCurrent = 0;
+	HANDLE mFenceEvent = nullptr;
+	FrameResourceStats mStats;
+	std::chrono::steady_clock::time_point mLastBeginTime;
+	bool mHasLastBegin = false;
+};
+
+#endif
@@ -0,0 +1,135 @@
+#include "FrustumCuller.h"
+#include <algorithm>
+#include <atomic>
+#include <format>
+#include "JobSystem.h"
+
+using namespace DirectX;
+
+CullBounds ComputeCullBounds(const XMFLOAT3* positions, size_t count, size_t stride)
+{
+	CullBounds bounds;
+	if (count == 0)
+	{
+		return bounds;
+	}
+
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(positions);
+	XMVECTOR minimum = XMLoadFloat3(positions);
+	XMVECTOR maximum = minimum;
+	for (size_t i = 1; i < count; i++)
+	{
+		XMVECTOR position = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(bytes + i * stride));
+		minimum = XMVectorMin(minimum, position);
+		maximum = XMVectorMax(maximum, position);
+	}
+
+	XMStoreFloat3(&bounds.Center, XMVectorScale(XMVectorAdd(minimum, maximum), 0.5f));
+	XMStoreFloat3(&bounds.Extents, XMVectorScale(XMVectorSubtract(maximum, minimum), 0.5f));
+	return bounds;
+}
+
+std::wstring FrustumCullStats::ToString() const
+{
+	const double frames = Frames ? static_cast<double>(Frames) : 1.0;
+	return std::format(L"FrustumCuller: {:.0f} tested, {:.0f} drawn, {:.0f} culled ({:.1f}%) per frame, {:.3f} ms avg\n",
+		Tested / frames, GetDrawn() / frames, Culled / frames, GetCulledFraction() * 100.0, GetAverageMilliseconds());
+}
+
+void FrustumCuller::SetViewProjection(FXMMATRIX viewProjection)
+{
+	// 행 벡터 규약(v * M)에서 클립 좌표는 M의 열과의 내적이다. 전치하면 열이 행이 된다.
+	// -w <= x <= w, -w <= y <= w, 0 <= z <= w
+	XMMATRIX columns = XMMatrixTranspose(viewProjection);
+	XMStoreFloat4(&mPlanes[0], XMVectorAdd(columns.r[3], columns.r[0]));      // 왼쪽
+	XMStoreFloat4(&mPlanes[1], XMVectorSubtract(columns.r[3], columns.r[0])); // 오른쪽
+	XMStoreFloat4(&mPlanes[2], XMVectorAdd(columns.r[3], columns.r[1]));      // 아래
+	XMStoreFloat4(&mPlanes[3], XMVectorSubtract(columns.r[3], columns.r[1])); // 위
+	XMStoreFloat4(&mPlanes[4], columns.r[2]);                                 // 가까운 면
+	XMStoreFloat4(&mPlanes[5], XMVectorSubtract(columns.r[3], columns.r[2])); // 먼 면
+}
+
+size_t FrustumCuller::Cull(const XMFLOAT4X4* worlds, const uint32_t* boundsIndices, const CullBounds* boundsTable,
+	size_t begin, size_t end, uint8_t* visible) const
+{
+	// 평면 성분을 레지스터마다 펼쳐 둔다. 물체 4개가 같은 평면과 비교된다.
+	XMVECTOR planeX[6], planeY[6], planeZ[6], planeW[6];
+	XMVECTOR absPlaneX[6], absPlaneY[6], absPlaneZ[6];
+	for (int p = 0; p < 6; p++)
+	{
+		XMVECTOR plane = XMLoadFloat4(&mPlanes[p]);
+		planeX[p] = XMVectorSplatX(plane);
+		planeY[p] = XMVectorSplatY(plane);
+		planeZ[p] = XMVectorSplatZ(plane);
+		planeW[p] = XMVectorSplatW(plane);
+		absPlaneX[p] = XMVectorAbs(planeX[p]);
+		absPlaneY[p] = XMVectorAbs(planeY[p]);
+		absPlaneZ[p] = XMVectorAbs(planeZ[p]);
+	}
+
+	size_t visibleCount = 0;
+	for (size_t i = begin; i < end; i += 4)
+	{
+		const size_t lanes = std::min<size_t>(4, end - i);
+
+		// 물체 4개의 월드 AABB. 행 하나가 물체 하나 (x, y, z, -)
+		// 월드 반 크기는 로컬 반 크기를 행렬 절댓값으로 옮긴 것 (회전한 AABB를 감싸는 AABB)
+		XMMATRIX centers;
+		XMMATRIX extents;
+		for (size_t k = 0; k < 4; k++)
+		{
+			// 모자라는 자리는 마지막 물체로 채운다. 결과는 쓰지 않는다.
+			const size_t item = i + std::min(k, lanes - 1);
+			const auto& bounds = boundsTable[boundsIndices[item]];
+			XMMATRIX world = XMLoadFloat4x4(&worlds[item]);
+			XMVECTOR extent = XMLoadFloat3(&bounds.Extents);
+
+			centers.r[k] = XMVector3Transform(XMLoadFloat3(&bounds.Center), world);
+			extents.r[k] = XMVectorMultiplyAdd(XMVectorSplatX(extent), XMVectorAbs(world.r[0]),
+				XMVectorMultiplyAdd(XMVectorSplatY(extent), XMVectorAbs(world.r[1]),
+					XMVectorMultiply(XMVectorSplatZ(extent), XMVectorAbs(world.r[2]))));
+		}
+
+		// 물체별(AoS)을 성분별(SoA)로: r[0]은 물체 4개의 x, r[1]은 y, r[2]는 z
+		centers = XMMatrixTranspose(centers);
+		extents = XMMatrixTranspose(extents);
+
+		// 중심의 평면 거리 + 평면 법선 방향 반지름이 음수면 그 평면 바깥이다.
+		XMVECTOR outside = XMVectorFalseInt();
+		for (int p = 0; p < 6; p++)
+		{
+			XMVECTOR distance = XMVectorMultiplyAdd(centers.r[0], planeX[p],
+				XMVectorMultiplyAdd(centers.r[1], planeY[p], XMVectorMultiplyAdd(centers.r[2], planeZ[p], planeW[p])));
+			XMVECTOR radius = XMVectorMultiplyAdd(extents.r[0], absPlaneX[p],
+				XMVectorMultiplyAdd(extents.r[1], absPlaneY[p], XMVectorMultiply(extents.r[2], absPlaneZ[p])));
+			outside = XMVectorOrInt(outside, XMVectorLess(XMVectorAdd(distance, radius), XMVectorZero()));
+		}
+
+		uint32_t outsideMask[4];
+		XMStoreInt4(outsideMask, outside);
+		for (size_t k = 0; k < lanes; k++)
+		{
+			visible[i + k] = outsideMask[k] ? 0 : 1;
+			visibleCount += visible[i + k];
+		}
+	}
+	return visibleCount;
+}
+
+size_t FrustumCuller::CullParallel(JobSystem& jobs, const XMFLOAT4X4* worlds, const uint32_t* boundsIndices,
+	const CullBounds* boundsTable, size_t count, uint8_t* visible) const
+{
+	if (count <= PARALLEL_GRAIN || jobs.GetConcurrency() <= 1)
+	{
+		return Cull(worlds, boundsIndices, boundsTable, 0, count, visible);
+	}
+
+	// 작업마다 visible의 다른 구간을 쓰므로 개수만 모은다.
+	const size_t grain = std::max(PARALLEL_GRAIN, (count + jobs.GetConcurrency() - 1) / jobs.GetConcurrency());
+	std::atomic<size_t> visibleCount = 0;
+	jobs.ParallelFor(count, grain, [&](size_t begin, size_t end)
+		{
+			visibleCount += Cull(worlds, boundsIndices, boundsTable, begin, end, visible);
+		});
+	return visibleCount;
+}
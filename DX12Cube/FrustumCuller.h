@@ -0,0 +1,74 @@
+#pragma once
+#ifndef _FRUSTUMCULLER_H_
+#define _FRUSTUMCULLER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <DirectXMath.h>
+
+class JobSystem;
+
+// 뷰 절두체 밖의 물체를 걸러내는 컬러
+// 메쉬마다 로컬 AABB를 한 번 구해 두고, 매 프레임 물체 월드 행렬로 옮긴 AABB를 절두체 평면 6개와 비교한다.
+// 물체 4개를 SIMD 레지스터 하나에 모아(SoA) 평면 하나를 한 번에 검사한다.
+// 옮긴 AABB는 회전을 감싸는 AABB라서 실제보다 조금 크다. 보이는 물체를 거르지는 않는다.
+// 사용법:
+//   meshBounds = ComputeCullBounds(&vertices[0].position, vertexCount, sizeof(Vertex));
+//   culler.SetViewProjection(sceneWorld * view * proj);
+//   size_t drawn = culler.Cull(worlds, meshIds, meshBoundsTable, 0, count, visible);
+//   size_t drawn = culler.CullParallel(jobs, worlds, meshIds, meshBoundsTable, count, visible);
+
+// 로컬 공간 AABB (중심과 반 크기)
+struct CullBounds
+{
+	DirectX::XMFLOAT3 Center = { 0.0f, 0.0f, 0.0f };
+	DirectX::XMFLOAT3 Extents = { 0.0f, 0.0f, 0.0f };
+};
+
+// positions는 stride 바이트 간격으로 놓인 XMFLOAT3 (버텍스 구조체의 position 필드)
+CullBounds ComputeCullBounds(const DirectX::XMFLOAT3* positions, size_t count, size_t stride);
+
+// 컬링 결과 누적. 프레임 통계 구간마다 비운다.
+struct FrustumCullStats
+{
+	uint64_t Frames = 0;
+	uint64_t Tested = 0;
+	uint64_t Culled = 0;
+	double Seconds = 0.0;
+
+	uint64_t GetDrawn() const { return Tested - Culled; }
+	double GetCulledFraction() const { return Tested ? static_cast<double>(Culled) / Tested : 0.0; }
+	double GetAverageMilliseconds() const { return Frames ? Seconds * 1000.0 / Frames : 0.0; }
+
+	std::wstring ToString() const;
+};
+
+class FrustumCuller
+{
+public:
+	// 병렬로 나눌 때 작업 하나가 맡을 최소 물체 수 (4의 배수)
+	static constexpr size_t PARALLEL_GRAIN = 4096;
+
+	// 물체 월드 행렬 뒤에 곱하는 행렬(장면 월드 * 뷰 * 프로젝션)에서 평면을 뽑는다.
+	void SetViewProjection(DirectX::FXMMATRIX viewProjection);
+
+	// [begin, end) 물체의 AABB(boundsTable[boundsIndices[i]]를 worlds[i]로 옮긴 것)가
+	// 절두체와 겹치면 visible[i] = 1, 아니면 0. 보이는 물체 수를 돌려준다.
+	// 읽기만 하므로 여러 스레드에서 서로 다른 구간으로 불러도 된다.
+	size_t Cull(const DirectX::XMFLOAT4X4* worlds, const uint32_t* boundsIndices, const CullBounds* boundsTable,
+		size_t begin, size_t end, uint8_t* visible) const;
+
+	// count가 PARALLEL_GRAIN보다 크면 jobs에 나눠서 Cull한다.
+	size_t CullParallel(JobSystem& jobs, const DirectX::XMFLOAT4X4* worlds, const uint32_t* boundsIndices,
+		const CullBounds* boundsTable, size_t count, uint8_t* visible) const;
+
+	// SceneBvh::QueryFrustum에 넘길 평면 6개
+	const DirectX::XMFLOAT4* GetPlanes() const { return mPlanes; }
+
+private:
+	// 안쪽이 양수인 평면 (a, b, c, d). 정규화하지 않는다. (부호만 본다)
+	DirectX::XMFLOAT4 mPlanes[6] = { };
+};
+
+#endif
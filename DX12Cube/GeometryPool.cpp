@@ -0,0 +1,123 @@
+#include "GeometryPool.h"
+#include "d3dx12.h"
+
+HRESULT GeometryPool::Create(ID3D12Device* device, UINT vertexStride, UINT maxVertices, UINT maxIndices, DXGI_FORMAT indexFormat,
+	ResourceHeapAllocator* heapAllocator)
+{
+	Release();
+
+	mIndexStride = indexFormat == DXGI_FORMAT_R32_UINT ? 4 : 2;
+	const UINT64 vertexBufferSize = static_cast<UINT64>(vertexStride) * maxVertices;
+	const UINT64 indexBufferSize = static_cast<UINT64>(mIndexStride) * maxIndices;
+
+	auto createBuffer = [&](UINT64 size, Microsoft::WRL::ComPtr<ID3D12Resource>& buffer, HeapAllocation& allocation)
+	{
+		auto bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(size);
+		if (heapAllocator)
+		{
+			return heapAllocator->CreateResource(bufferDesc, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COMMON, nullptr,
+				buffer, allocation);
+		}
+
+		auto defaultHeapProp = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+		return device->CreateCommittedResource(
+			&defaultHeapProp,
+			D3D12_HEAP_FLAG_NONE,
+			&bufferDesc,
+			D3D12_RESOURCE_STATE_COMMON,
+			nullptr,
+			IID_PPV_ARGS(&buffer));
+	};
+
+	mHeapAllocator = heapAllocator;
+	HRESULT hr = createBuffer(vertexBufferSize, mVertexBuffer, mVertexAllocation);
+	if (SUCCEEDED(hr))
+	{
+		hr = createBuffer(indexBufferSize, mIndexBuffer, mIndexAllocation);
+	}
+	if (FAILED(hr))
+	{
+		Release();
+		return hr;
+	}
+
+	mVertexBufferView.BufferLocation = mVertexBuffer->GetGPUVirtualAddress();
+	mVertexBufferView.SizeInBytes = static_cast<UINT>(vertexBufferSize);
+	mVertexBufferView.StrideInBytes = vertexStride;
+
+	mIndexBufferView.BufferLocation = mIndexBuffer->GetGPUVirtualAddress();
+	mIndexBufferView.SizeInBytes = static_cast<UINT>(indexBufferSize);
+	mIndexBufferView.Format = indexFormat;
+
+	mVertexAllocator.Reset(maxVertices);
+	mIndexAllocator.Reset(maxIndices);
+	return S_OK;
+}
+
+void GeometryPool::Release()
+{
+	mVertexBuffer.Reset();
+	mIndexBuffer.Reset();
+	if (mHeapAllocator)
+	{
+		mHeapAllocator->Free(mVertexAllocation);
+		mHeapAllocator->Free(mIndexAllocation);
+		mHeapAllocator = nullptr;
+	}
+	mVertexBufferView = { };
+	mIndexBufferView = { };
+	mUploaded = false;
+	mVertexAllocator.Reset(0);
+	mIndexAllocator.Reset(0);
+}
+
+bool GeometryPool::Allocate(UINT vertexCount, UINT indexCount, GeometryAllocation& allocation)
+{
+	if (!mVertexBuffer)
+	{
+		return false;
+	}
+
+	const UINT64 baseVertex = mVertexAllocator.Allocate(vertexCount);
+	if (baseVertex == RangeAllocator::INVALID_OFFSET)
+	{
+		return false;
+	}
+	const UINT64 startIndex = mIndexAllocator.Allocate(indexCount);
+	if (startIndex == RangeAllocator::INVALID_OFFSET)
+	{
+		mVertexAllocator.Free(baseVertex, vertexCount);
+		return false;
+	}
+
+	allocation.BaseVertex = static_cast<UINT>(baseVertex);
+	allocation.VertexCount = vertexCount;
+	allocation.StartIndex = static_cast<UINT>(startIndex);
+	allocation.IndexCount = indexCount;
+	return true;
+}
+
+void GeometryPool::Free(GeometryAllocation& allocation)
+{
+	if (!allocation.IsValid())
+	{
+		return;
+	}
+	mVertexAllocator.Free(allocation.BaseVertex, allocation.VertexCount);
+	mIndexAllocator.Free(allocation.StartIndex, allocation.IndexCount);
+	allocation = GeometryAllocation();
+}
+
+void GeometryPool::Upload(GeometryUploadBatch& batch, const GeometryAllocation& allocation, const void* vertices, const void* indices)
+{
+	const D3D12_RESOURCE_STATES vertexState = D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER;
+	const D3D12_RESOURCE_STATES indexState = D3D12_RESOURCE_STATE_INDEX_BUFFER;
+
+	batch.CopyToBuffer(mVertexBuffer.Get(), static_cast<UINT64>(allocation.BaseVertex) * mVertexBufferView.StrideInBytes,
+		vertices, static_cast<UINT64>(allocation.VertexCount) * mVertexBufferView.StrideInBytes,
+		mUploaded ? vertexState : D3D12_RESOURCE_STATE_COMMON, vertexState);
+	batch.CopyToBuffer(mIndexBuffer.Get(), static_cast<UINT64>(allocation.StartIndex) * mIndexStride,
+		indices, static_cast<UINT64>(allocation.IndexCount) * mIndexStride,
+		mUploaded ? indexState : D3D12_RESOURCE_STATE_COMMON, indexState);
+	mUploaded = true;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#ifndef _GEOMETRYPOOL_H_
+#define _GEOMETRYPOOL_H_
+
+#include <d3d12.h>
+#include <wrl.h>
+#include "GeometryUploadBatch.h"
+#include "RangeAllocator.h"
+#include "ResourceHeapAllocator.h"
+
+// 정적 메쉬 전체가 함께 쓰는 버텍스 버퍼 하나와 인덱스 버퍼 하나
+// 메쉬마다 버텍스/인덱스 구간을 잘라 주고, 그릴 때는 버퍼를 한 번만 묶은 뒤
+// DrawIndexedInstanced의 StartIndexLocation/BaseVertexLocation으로 구간을 고른다.
+// 인덱스는 메쉬 안의 번호 그대로 넣는다. (BaseVertexLocation이 더해짐)
+// 사용법:
+//   pool.Create(device, sizeof(Vertex), 256 * 1024, 1024 * 1024, DXGI_FORMAT_R16_UINT, &heapAllocator);
+//   GeometryAllocation allocation;
+//   if (pool.Allocate(vertexCount, indexCount, allocation))
+//       pool.Upload(batch, allocation, vertices, indices);
+//   cmdList->IASetVertexBuffers(0, 1, &pool.GetVertexBufferView());
+//   cmdList->DrawIndexedInstanced(allocation.IndexCount, 1, allocation.StartIndex, allocation.BaseVertex, 0);
+
+struct GeometryAllocation
+{
+	UINT BaseVertex = 0;
+	UINT VertexCount = 0;
+	UINT StartIndex = 0;
+	UINT IndexCount = 0;
+
+	bool IsValid() const { return VertexCount > 0 && IndexCount > 0; }
+};
+
+class GeometryPool
+{
+public:
+	// heapAllocator가 있으면 두 버퍼를 그 힙에 놓는다. 없으면 committed 리소스로 만든다.
+	HRESULT Create(ID3D12Device* device, UINT vertexStride, UINT maxVertices, UINT maxIndices, DXGI_FORMAT indexFormat,
+		ResourceHeapAllocator* heapAllocator = nullptr);
+	void Release();
+
+	// 구간이 모자라면 false (따로 버퍼를 만들어야 함)
+	bool Allocate(UINT vertexCount, UINT indexCount, GeometryAllocation& allocation);
+	// GPU가 이 구간을 더 이상 읽지 않을 때 호출
+	void Free(GeometryAllocation& allocation);
+
+	// 할당받은 구간으로 복사를 예약한다. batch를 Record한 명령이 실행된 뒤부터 그릴 수 있다.
+	void Upload(GeometryUploadBatch& batch, const GeometryAllocation& allocation, const void* vertices, const void* indices);
+
+	const D3D12_VERTEX_BUFFER_VIEW& GetVertexBufferView() const { return mVertexBufferView; }
+	const D3D12_INDEX_BUFFER_VIEW& GetIndexBufferView() const { return mIndexBufferView; }
+
+	const RangeAllocator& GetVertexAllocator() const { return mVertexAllocator; }
+	const RangeAllocator& GetIndexAllocator() const { return mIndexAllocator; }
+
+private:
+	Microsoft::WRL::ComPtr<ID3D12Resource> mVertexBuffer;
+	Microsoft::WRL::ComPtr<ID3D12Resource> mIndexBuffer;
+	ResourceHeapAllocator* mHeapAllocator = nullptr;
+	HeapAllocation mVertexAllocation;
+	HeapAllocation mIndexAllocation;
+	D3D12_VERTEX_BUFFER_VIEW mVertexBufferView = { };
+	D3D12_INDEX_BUFFER_VIEW mIndexBufferView = { };
+	UINT mIndexStride = 0;
+
+	// 처음 복사하기 전에는 COMMON, 그 뒤로는 읽기 상태
+	bool mUploaded = false;
+
+	RangeAllocator mVertexAllocator;
+	RangeAllocator mIndexAllocator;
+};
+
+#endif
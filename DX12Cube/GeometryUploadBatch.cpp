@@ -0,0 +1,132 @@
+#include "GeometryUploadBatch.h"
+#include <algorithm>
+#include "d3dx12.h"
+
+using Microsoft::WRL::ComPtr;
+
+namespace
+{
+	// 스트리밍 저장(MemcpyToUploadHeap)이 버퍼마다 정렬된 곳에서 시작하도록
+	const UINT64 StagingAlignment = 16;
+}
+
+ComPtr<ID3D12Resource> GeometryUploadBatch::CreateBuffer(ID3D12Device* device, const void* data, UINT64 size,
+	D3D12_RESOURCE_STATES finalState)
+{
+	// 버퍼는 COMMON으로 만들어지고, 복사할 때 COPY_DEST로 암묵적으로 승격된다.
+	ComPtr<ID3D12Resource> buffer;
+	auto defaultHeapProp = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+	auto bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(size);
+	if (FAILED(device->CreateCommittedResource(
+		&defaultHeapProp,
+		D3D12_HEAP_FLAG_NONE,
+		&bufferDesc,
+		D3D12_RESOURCE_STATE_COMMON,
+		nullptr,
+		IID_PPV_ARGS(&buffer))))
+	{
+		return nullptr;
+	}
+
+	CopyToBuffer(buffer.Get(), 0, data, size, D3D12_RESOURCE_STATE_COMMON, finalState);
+	return buffer;
+}
+
+void GeometryUploadBatch::CopyToBuffer(ID3D12Resource* buffer, UINT64 destOffset, const void* data, UINT64 size,
+	D3D12_RESOURCE_STATES stateBefore, D3D12_RESOURCE_STATES stateAfter)
+{
+	PendingCopy pending;
+	pending.Buffer = buffer;
+	pending.DestOffset = destOffset;
+	pending.Data.assign(static_cast<const BYTE*>(data), static_cast<const BYTE*>(data) + size);
+	pending.StateBefore = stateBefore;
+	pending.StateAfter = stateAfter;
+	mPending.push_back(std::move(pending));
+}
+
+HRESULT GeometryUploadBatch::Record(ID3D12Device* device, ID3D12GraphicsCommandList* cmdList)
+{
+	if (mPending.empty())
+	{
+		return S_OK;
+	}
+
+	UINT64 stagingBytes = 0;
+	for (const auto& pending : mPending)
+	{
+		stagingBytes = (stagingBytes + StagingAlignment - 1) & ~(StagingAlignment - 1);
+		stagingBytes += pending.Data.size();
+	}
+
+	auto uploadHeapProp = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+	auto stagingDesc = CD3DX12_RESOURCE_DESC::Buffer(stagingBytes);
+	HRESULT hr = device->CreateCommittedResource(
+		&uploadHeapProp,
+		D3D12_HEAP_FLAG_NONE,
+		&stagingDesc,
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(mStaging.ReleaseAndGetAddressOf()));
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	BYTE* mapped = nullptr;
+	CD3DX12_RANGE readRange(0, 0);
+	hr = mStaging->Map(0, &readRange, reinterpret_cast<void**>(&mapped));
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	// 버퍼마다 한 번씩만 전환한다. COMMON 버퍼는 복사할 때 COPY_DEST로 암묵적으로 승격되므로 앞 배리어가 필요 없다.
+	std::vector<ID3D12Resource*> buffers;
+	std::vector<D3D12_RESOURCE_BARRIER> beforeBarriers;
+	std::vector<D3D12_RESOURCE_BARRIER> afterBarriers;
+	for (const auto& pending : mPending)
+	{
+		if (std::find(buffers.begin(), buffers.end(), pending.Buffer.Get()) != buffers.end())
+		{
+			continue;
+		}
+		buffers.push_back(pending.Buffer.Get());
+		if (pending.StateBefore != D3D12_RESOURCE_STATE_COMMON && pending.StateBefore != D3D12_RESOURCE_STATE_COPY_DEST)
+		{
+			beforeBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(pending.Buffer.Get(),
+				pending.StateBefore, D3D12_RESOURCE_STATE_COPY_DEST));
+		}
+		if (pending.StateAfter != D3D12_RESOURCE_STATE_COPY_DEST)
+		{
+			afterBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(pending.Buffer.Get(),
+				D3D12_RESOURCE_STATE_COPY_DEST, pending.StateAfter));
+		}
+	}
+
+	if (!beforeBarriers.empty())
+	{
+		cmdList->ResourceBarrier(static_cast<UINT>(beforeBarriers.size()), beforeBarriers.data());
+	}
+
+	UINT64 offset = 0;
+	for (const auto& pending : mPending)
+	{
+		offset = (offset + StagingAlignment - 1) & ~(StagingAlignment - 1);
+		MemcpyToUploadHeap(mapped + offset, pending.Data.data(), pending.Data.size());
+		cmdList->CopyBufferRegion(pending.Buffer.Get(), pending.DestOffset, mStaging.Get(), offset, pending.Data.size());
+		offset += pending.Data.size();
+	}
+	MemcpyToUploadHeapFence();
+	mStaging->Unmap(0, nullptr);
+
+	// 복사가 모두 끝난 뒤에 한 번에 전환
+	if (!afterBarriers.empty())
+	{
+		cmdList->ResourceBarrier(static_cast<UINT>(afterBarriers.size()), afterBarriers.data());
+	}
+
+	mStats.BufferCount += static_cast<UINT>(buffers.size());
+	mStats.StagingBytes += stagingBytes;
+	mPending.clear();
+	return S_OK;
+}
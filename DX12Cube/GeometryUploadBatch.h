@@ -0,0 +1,60 @@
+#pragma once
+#ifndef _GEOMETRYUPLOADBATCH_H_
+#define _GEOMETRYUPLOADBATCH_H_
+
+#include <vector>
+#include <d3d12.h>
+#include <wrl.h>
+
+// 정적 버텍스/인덱스 버퍼를 기본 힙(D3D12_HEAP_TYPE_DEFAULT)에 만들고,
+// 모든 메쉬의 데이터를 스테이징 버퍼 하나에 모아서 복사 명령을 한 번에 기록한다.
+// 그리는 동안 지오메트리를 PCIe 너머 업로드 힙에서 읽지 않게 한다.
+// 사용법:
+//   auto vb = batch.CreateBuffer(device, vertices, bytes, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
+//   auto ib = batch.CreateBuffer(device, indices, bytes, D3D12_RESOURCE_STATE_INDEX_BUFFER);
+//   batch.Record(device, cmdList); // 실행하고 GPU가 끝날 때까지 기다린 뒤
+//   batch.ReleaseStaging();
+
+struct GeometryUploadStats
+{
+	UINT BufferCount = 0;
+	UINT64 StagingBytes = 0;
+};
+
+class GeometryUploadBatch
+{
+public:
+	// 기본 힙 버퍼를 만들고 데이터는 Record까지 보관한다. 반환된 버퍼는 Record한 명령이 실행된 뒤에 쓸 수 있다.
+	Microsoft::WRL::ComPtr<ID3D12Resource> CreateBuffer(ID3D12Device* device, const void* data, UINT64 size,
+		D3D12_RESOURCE_STATES finalState);
+
+	// 이미 있는 기본 힙 버퍼의 일부에 복사를 예약한다. (GeometryPool)
+	// stateBefore는 Record할 때 버퍼의 상태. 같은 버퍼에 여러 번 예약하면 처음 예약한 상태를 쓴다.
+	void CopyToBuffer(ID3D12Resource* buffer, UINT64 destOffset, const void* data, UINT64 size,
+		D3D12_RESOURCE_STATES stateBefore, D3D12_RESOURCE_STATES stateAfter);
+
+	// 모인 데이터를 스테이징 버퍼 하나에 담고, 버퍼마다 CopyBufferRegion과 상태 전환 배리어를 기록한다.
+	// 스테이징 버퍼는 GPU 복사가 끝날 때까지 ReleaseStaging을 부르지 말아야 한다.
+	HRESULT Record(ID3D12Device* device, ID3D12GraphicsCommandList* cmdList);
+
+	void ReleaseStaging() { mStaging.Reset(); }
+
+	bool IsEmpty() const { return mPending.empty(); }
+	const GeometryUploadStats& GetStats() const { return mStats; }
+
+private:
+	struct PendingCopy
+	{
+		Microsoft::WRL::ComPtr<ID3D12Resource> Buffer;
+		UINT64 DestOffset = 0;
+		std::vector<BYTE> Data;
+		D3D12_RESOURCE_STATES StateBefore = D3D12_RESOURCE_STATE_COMMON;
+		D3D12_RESOURCE_STATES StateAfter = D3D12_RESOURCE_STATE_COMMON;
+	};
+
+	std::vector<PendingCopy> mPending;
+	Microsoft::WRL::ComPtr<ID3D12Resource> mStaging;
+	GeometryUploadStats mStats;
+};
+
+#endif
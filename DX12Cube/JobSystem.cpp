@@ -0,0 +1,248 @@
+#include "JobSystem.h"
+
+namespace
+{
+	// 현재 스레드가 속한 JobSystem과 큐 번호
+	thread_local const JobSystem* tOwner = nullptr;
+	thread_local unsigned tQueueIndex = 0;
+}
+
+JobSystem::JobSystem(unsigned threadCount)
+{
+	if (threadCount == 0)
+	{
+		unsigned hardwareThreads = std::thread::hardware_concurrency();
+		threadCount = (hardwareThreads > 1) ? hardwareThreads - 1 : 1;
+	}
+
+	// 0번은 외부 스레드용, 1 ~ threadCount는 워커용
+	for (unsigned i = 0; i <= threadCount; i++)
+	{
+		mQueues.push_back(std::make_unique<WorkQueue>());
+	}
+
+	for (unsigned i = 1; i <= threadCount; i++)
+	{
+		mWorkers.emplace_back(&JobSystem::WorkerMain, this, i);
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	Wait();
+
+	{
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+		mQuit = true;
+	}
+	mWakeCondition.notify_all();
+
+	for (auto& worker : mWorkers)
+	{
+		worker.join();
+	}
+}
+
+unsigned JobSystem::GetCurrentWorkerIndex()
+{
+	return tQueueIndex;
+}
+
+void JobSystem::Submit(std::function<void()> job, JobCounter* counter)
+{
+	unsigned queueIndex = 0;
+	bool pushFront = false;
+	if (tOwner == this)
+	{
+		// 워커 안에서 만든 후속 작업은 자기 큐 앞에 넣어 바로 이어서 실행되게 한다.
+		queueIndex = tQueueIndex;
+		pushFront = true;
+	}
+	else if (!mWorkers.empty())
+	{
+		// 외부에서 들어온 작업은 워커 큐에 골고루 뿌린다.
+		queueIndex = 1 + mSubmitCursor.fetch_add(1) % static_cast<unsigned>(mWorkers.size());
+	}
+
+	// 큐에 넣자마자 다른 스레드가 실행할 수 있으므로 먼저 센다. 넣지 못하면 되돌린다.
+	mPendingJobs.fetch_add(1);
+	if (counter)
+	{
+		counter->mPending.fetch_add(1);
+	}
+	try
+	{
+		auto& queue = *mQueues[queueIndex];
+		std::lock_guard<std::mutex> lock(queue.Mutex);
+		if (pushFront)
+		{
+			queue.Jobs.push_front({ std::move(job), counter });
+		}
+		else
+		{
+			queue.Jobs.push_back({ std::move(job), counter });
+		}
+	}
+	catch (...)
+	{
+		FinishJob(counter);
+		throw;
+	}
+
+	{
+		// 잠들려는 워커가 알림을 놓치지 않도록 잠금을 한 번 거친다.
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+		mQueuedJobs++;
+	}
+	mWakeCondition.notify_one();
+	mIdleCondition.notify_all();
+}
+
+bool JobSystem::TryRunOne(unsigned queueIndex)
+{
+	Job job;
+
+	// 자기 큐는 앞에서 꺼낸다.
+	{
+		auto& queue = *mQueues[queueIndex];
+		std::lock_guard<std::mutex> lock(queue.Mutex);
+		if (!queue.Jobs.empty())
+		{
+			job = std::move(queue.Jobs.front());
+			queue.Jobs.pop_front();
+		}
+	}
+
+	// 비어 있으면 다른 큐의 뒤에서 훔친다.
+	const size_t queueCount = mQueues.size();
+	for (size_t i = 1; !job.Run && i < queueCount; i++)
+	{
+		auto& queue = *mQueues[(queueIndex + i) % queueCount];
+		std::lock_guard<std::mutex> lock(queue.Mutex);
+		if (!queue.Jobs.empty())
+		{
+			job = std::move(queue.Jobs.back());
+			queue.Jobs.pop_back();
+		}
+	}
+
+	if (!job.Run)
+	{
+		return false;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+		mQueuedJobs--;
+	}
+
+	try
+	{
+		job.Run();
+	}
+	catch (...)
+	{
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+		auto& firstError = job.Counter ? job.Counter->mFirstError : mFirstError;
+		if (!firstError)
+		{
+			firstError = std::current_exception();
+		}
+	}
+
+	// 끝난 작업이 잡고 있던 것은 counter를 줄이기 전에 놓는다. (기다리던 쪽이 바로 정리할 수 있다)
+	job.Run = nullptr;
+	FinishJob(job.Counter);
+
+	return true;
+}
+
+void JobSystem::FinishJob(JobCounter* counter)
+{
+	bool wake = mPendingJobs.fetch_sub(1) == 1;
+	// 0이 되면 기다리던 스레드가 counter를 바로 없앨 수 있으므로 이 뒤로는 counter를 건드리지 않는다.
+	if (counter && counter->mPending.fetch_sub(1) == 1)
+	{
+		wake = true;
+	}
+
+	if (wake)
+	{
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+		mIdleCondition.notify_all();
+	}
+}
+
+void JobSystem::WorkerMain(unsigned queueIndex)
+{
+	tOwner = this;
+	tQueueIndex = queueIndex;
+
+	while (true)
+	{
+		if (TryRunOne(queueIndex))
+		{
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(mSleepMutex);
+		mWakeCondition.wait(lock, [this] { return mQuit || mQueuedJobs > 0; });
+		if (mQuit && mQueuedJobs == 0)
+		{
+			return;
+		}
+	}
+}
+
+void JobSystem::Wait()
+{
+	// 워커 안에서 부르면 자기 큐 번호로, 외부에서 부르면 0번 큐로 돕는다.
+	const unsigned queueIndex = (tOwner == this) ? tQueueIndex : 0;
+
+	while (mPendingJobs > 0)
+	{
+		if (TryRunOne(queueIndex))
+		{
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(mSleepMutex);
+		mIdleCondition.wait(lock, [this] { return mPendingJobs == 0 || mQueuedJobs > 0; });
+	}
+
+	std::exception_ptr error;
+	{
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+		std::swap(error, mFirstError);
+	}
+	if (error)
+	{
+		std::rethrow_exception(error);
+	}
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	const unsigned queueIndex = (tOwner == this) ? tQueueIndex : 0;
+
+	while (counter.mPending > 0)
+	{
+		if (TryRunOne(queueIndex))
+		{
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(mSleepMutex);
+		mIdleCondition.wait(lock, [this, &counter] { return counter.mPending == 0 || mQueuedJobs > 0; });
+	}
+
+	std::exception_ptr error;
+	{
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+		std::swap(error, counter.mFirstError);
+	}
+	if (error)
+	{
+		std::rethrow_exception(error);
+	}
+}
@@ -0,0 +1,149 @@
+#pragma once
+#ifndef _JOBSYSTEM_H_
+#define _JOBSYSTEM_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 작업 훔치기(work-stealing) 스레드 풀
+// 각 워커는 자기 큐의 앞에서 작업을 꺼내고, 비어 있으면 다른 워커 큐의 뒤에서 훔쳐온다.
+// 워커 안에서 Submit하면 자기 큐에 들어가므로 이어지는 단계(예: 읽기 -> 파싱)가 같은 스레드에서 실행되기 쉽다.
+// 작업 묶음마다 JobCounter를 두면 Wait(counter)는 그 묶음만 기다리므로 작업 안에서도 기다릴 수 있다. (ParallelFor가 이렇게 한다)
+// 사용법:
+//   JobSystem jobs;
+//   jobs.Submit([] { ... });
+//   jobs.Wait(); // 호출한 스레드도 작업을 돕는다.
+//
+//   JobCounter counter;
+//   jobs.Submit([] { ... }, &counter);
+//   jobs.Wait(counter); // 이 묶음만 기다린다.
+class JobSystem;
+
+// Submit에 함께 넘긴 작업의 수와 그 작업들의 첫 번째 예외. 작업이 다 끝날 때까지 살아 있어야 한다.
+class JobCounter
+{
+public:
+	JobCounter() = default;
+
+	JobCounter(const JobCounter&) = delete;
+	JobCounter& operator=(const JobCounter&) = delete;
+
+	size_t GetPending() const { return mPending; }
+
+private:
+	friend class JobSystem;
+
+	std::atomic<size_t> mPending = 0;
+	// JobSystem::mSleepMutex로 보호
+	std::exception_ptr mFirstError;
+};
+
+class JobSystem
+{
+public:
+	// threadCount가 0이면 하드웨어 스레드 수 - 1개를 만든다. (호출 스레드가 Wait에서 함께 일함)
+	explicit JobSystem(unsigned threadCount = 0);
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	// counter가 있으면 작업이 끝날 때 counter를 줄이고, 작업의 예외는 Wait(counter)가 다시 던진다.
+	void Submit(std::function<void()> job, JobCounter* counter = nullptr);
+
+	// 지금까지 제출된 모든 작업이 끝날 때까지 대기. 대기하는 동안 호출 스레드도 작업을 실행한다.
+	// counter 없이 제출한 작업에서 예외가 나면 첫 번째 예외를 여기서 다시 던진다.
+	// 자기 자신도 남은 작업으로 세므로 작업 안에서 부르면 안 된다.
+	void Wait();
+
+	// counter로 제출한 작업만 끝날 때까지 대기하고 그 작업들의 첫 번째 예외를 다시 던진다.
+	// 기다리는 동안 다른 작업도 실행하므로 작업 안에서 불러도 된다.
+	void Wait(JobCounter& counter);
+
+	// [0, count) 구간을 grain 크기의 덩어리로 나눠 병렬 실행. fn(begin, end) 형태로 호출된다.
+	template <typename Fn>
+	void ParallelFor(size_t count, size_t grain, Fn&& fn)
+	{
+		if (count == 0)
+		{
+			return;
+		}
+		if (grain == 0)
+		{
+			grain = 1;
+		}
+
+		JobCounter counter;
+		try
+		{
+			for (size_t begin = 0; begin < count; begin += grain)
+			{
+				size_t end = (begin + grain < count) ? begin + grain : count;
+				Submit([&fn, begin, end] { fn(begin, end); }, &counter);
+			}
+		}
+		catch (...)
+		{
+			// 이미 넣은 작업이 fn과 counter를 쓰므로 다 끝난 뒤에 제출 예외를 던진다.
+			try
+			{
+				Wait(counter);
+			}
+			catch (...)
+			{
+			}
+			throw;
+		}
+		Wait(counter);
+	}
+
+	// 워커 수 + 호출 스레드
+	unsigned GetConcurrency() const { return static_cast<unsigned>(mWorkers.size()) + 1; }
+
+	// 현재 스레드의 워커 번호. 워커가 아니면(호출 스레드) 0, 워커는 1부터.
+	static unsigned GetCurrentWorkerIndex();
+
+private:
+	struct Job
+	{
+		std::function<void()> Run;
+		JobCounter* Counter = nullptr;
+	};
+
+	struct WorkQueue
+	{
+		std::mutex Mutex;
+		std::deque<Job> Jobs;
+	};
+
+	bool TryRunOne(unsigned queueIndex);
+	// 작업 하나를 끝낸 것으로 센다. 기다리는 스레드가 있으면 깨운다.
+	void FinishJob(JobCounter* counter);
+	void WorkerMain(unsigned queueIndex);
+
+	// 0번 큐는 워커가 아닌 스레드에서 제출된 작업용
+	std::vector<std::unique_ptr<WorkQueue>> mQueues;
+	std::vector<std::thread> mWorkers;
+
+	std::mutex mSleepMutex;
+	std::condition_variable mWakeCondition;
+	std::condition_variable mIdleCondition;
+
+	// mSleepMutex로 보호
+	size_t mQueuedJobs = 0;
+	std::exception_ptr mFirstError;
+
+	std::atomic<size_t> mPendingJobs = 0;
+	std::atomic<unsigned> mSubmitCursor = 0;
+	bool mQuit = false;
+};
+
+#endif
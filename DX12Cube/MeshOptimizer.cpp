@@ -0,0 +1,368 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+namespace
+{
+	const uint32_t NO_VERTEX = ~0u;
+
+	// FIFO 캐시. 버텍스마다 들어간 시각을 두고, 그 뒤로 cacheSize번 넘게 새로 들어왔으면 밀려난 것으로 본다.
+	class FifoCache
+	{
+	public:
+		FifoCache(size_t vertexCount, uint32_t cacheSize)
+			: mStamps(vertexCount, 0)
+			, mCacheSize(cacheSize)
+			, mTime(cacheSize + 1)
+		{
+		}
+
+		// 없으면 넣고 true
+		bool Access(uint32_t vertex)
+		{
+			if (mTime - mStamps[vertex] > mCacheSize)
+			{
+				mStamps[vertex] = mTime++;
+				return true;
+			}
+			return false;
+		}
+
+		// 0(가장 최근) ~ cacheSize. 캐시에 없으면 cacheSize보다 크다.
+		uint32_t GetAge(uint32_t vertex) const { return mTime - mStamps[vertex]; }
+
+		void Flush() { mTime += mCacheSize + 1; }
+
+	private:
+		std::vector<uint32_t> mStamps;
+		uint32_t mCacheSize;
+		uint32_t mTime;
+	};
+
+	const float* GetPosition(const float* positions, size_t vertexStride, uint32_t vertex)
+	{
+		return reinterpret_cast<const float*>(reinterpret_cast<const char*>(positions) + vertex * vertexStride);
+	}
+}
+
+size_t WeldVertices(void* vertices, size_t vertexCount, size_t vertexSize, uint32_t* indices, size_t indexCount)
+{
+	char* bytes = static_cast<char*>(vertices);
+	std::unordered_map<std::string, uint32_t> vertexIds;
+	vertexIds.reserve(vertexCount);
+	std::vector<uint32_t> remap(vertexCount);
+	uint32_t uniqueCount = 0;
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		// 앞으로만 옮기므로 아직 읽지 않은 버텍스를 덮어쓰지 않는다.
+		auto [it, inserted] = vertexIds.emplace(std::string(bytes + i * vertexSize, vertexSize), uniqueCount);
+		if (inserted)
+		{
+			if (uniqueCount != i)
+			{
+				memcpy(bytes + uniqueCount * vertexSize, bytes + i * vertexSize, vertexSize);
+			}
+			uniqueCount++;
+		}
+		remap[i] = it->second;
+	}
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		indices[i] = remap[indices[i]];
+	}
+	return uniqueCount;
+}
+
+void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize, std::vector<uint32_t>* clusters)
+{
+	const size_t triangleCount = indexCount / 3;
+	if (clusters)
+	{
+		clusters->clear();
+	}
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	// 버텍스마다 그 버텍스를 쓰는 삼각형 목록 (adjacency[offsets[v] ~ offsets[v + 1]])
+	std::vector<uint32_t> live(vertexCount, 0);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+	{
+		assert(indices[i] < vertexCount);
+		live[indices[i]]++;
+	}
+	std::vector<uint32_t> offsets(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		offsets[v + 1] = offsets[v] + live[v];
+	}
+	std::vector<uint32_t> adjacency(triangleCount * 3);
+	std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+	{
+		adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+	}
+
+	FifoCache cache(vertexCount, cacheSize);
+	std::vector<uint8_t> emitted(triangleCount, 0);
+	// 내보낸 버텍스를 차례로 쌓는다. 막히면 여기서 아직 삼각형이 남은 버텍스를 찾는다.
+	std::vector<uint32_t> deadEnds;
+	deadEnds.reserve(triangleCount * 3);
+	std::vector<uint32_t> output;
+	output.reserve(triangleCount * 3);
+	size_t scanCursor = 0;
+
+	auto skipDeadEnd = [&]() -> uint32_t
+	{
+		while (!deadEnds.empty())
+		{
+			const uint32_t vertex = deadEnds.back();
+			deadEnds.pop_back();
+			if (live[vertex] > 0)
+			{
+				return vertex;
+			}
+		}
+		for (; scanCursor < vertexCount; scanCursor++)
+		{
+			if (live[scanCursor] > 0)
+			{
+				return static_cast<uint32_t>(scanCursor);
+			}
+		}
+		return NO_VERTEX;
+	};
+
+	uint32_t fan = skipDeadEnd();
+	if (clusters)
+	{
+		clusters->push_back(0);
+	}
+	while (fan != NO_VERTEX)
+	{
+		// fan을 쓰는 남은 삼각형을 모두 내보낸다. 새로 나온 버텍스가 다음 fan 후보다.
+		const size_t candidateBegin = deadEnds.size();
+		for (uint32_t a = offsets[fan]; a < offsets[fan + 1]; a++)
+		{
+			const uint32_t triangle = adjacency[a];
+			if (emitted[triangle])
+			{
+				continue;
+			}
+			emitted[triangle] = 1;
+			for (int k = 0; k < 3; k++)
+			{
+				const uint32_t vertex = indices[triangle * 3 + k];
+				output.push_back(vertex);
+				deadEnds.push_back(vertex);
+				live[vertex]--;
+				cache.Access(vertex);
+			}
+		}
+
+		// 남은 삼각형을 다 그려도 캐시에서 밀려나지 않는 후보 중 가장 오래된 것을 고른다.
+		// 그런 후보가 없으면 삼각형이 남은 아무 후보나 쓴다.
+		uint32_t next = NO_VERTEX;
+		int64_t bestPriority = -1;
+		for (size_t c = candidateBegin; c < deadEnds.size(); c++)
+		{
+			const uint32_t vertex = deadEnds[c];
+			if (live[vertex] == 0)
+			{
+				continue;
+			}
+			int64_t priority = 0;
+			const uint32_t age = cache.GetAge(vertex);
+			if (age + 2 * live[vertex] <= cacheSize)
+			{
+				priority = age;
+			}
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				next = vertex;
+			}
+		}
+
+		if (next == NO_VERTEX)
+		{
+			next = skipDeadEnd();
+			if (next != NO_VERTEX && clusters)
+			{
+				clusters->push_back(static_cast<uint32_t>(output.size() / 3));
+			}
+		}
+		fan = next;
+	}
+
+	assert(output.size() == triangleCount * 3);
+	std::copy(output.begin(), output.end(), indices);
+}
+
+void OptimizeOverdraw(uint32_t* indices, size_t indexCount, const float* positions, size_t vertexStride, size_t vertexCount,
+	const std::vector<uint32_t>& clusters, float threshold, uint32_t cacheSize)
+{
+	const size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0 || clusters.empty())
+	{
+		return;
+	}
+
+	// 클러스터 안에서 캐시가 비는 삼각형(세 버텍스 모두 없음)에서 더 나눈다.
+	// 거기까지의 ACMR이 클러스터 전체 ACMR의 threshold배 이하일 때만 나눈다.
+	FifoCache cache(vertexCount, cacheSize);
+	auto countMisses = [&](size_t triangle)
+	{
+		uint32_t misses = 0;
+		for (int k = 0; k < 3; k++)
+		{
+			misses += cache.Access(indices[triangle * 3 + k]) ? 1 : 0;
+		}
+		return misses;
+	};
+
+	std::vector<uint32_t> boundaries;
+	for (size_t c = 0; c < clusters.size(); c++)
+	{
+		const size_t begin = clusters[c];
+		const size_t end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+		cache.Flush();
+		size_t clusterMisses = 0;
+		for (size_t t = begin; t < end; t++)
+		{
+			clusterMisses += countMisses(t);
+		}
+		const double limit = threshold * static_cast<double>(clusterMisses) / (end - begin);
+
+		cache.Flush();
+		boundaries.push_back(static_cast<uint32_t>(begin));
+		size_t softBegin = begin;
+		size_t softMisses = 0;
+		for (size_t t = begin; t < end; t++)
+		{
+			const uint32_t misses = countMisses(t);
+			if (t > softBegin && misses == 3 && softMisses <= limit * (t - softBegin))
+			{
+				boundaries.push_back(static_cast<uint32_t>(t));
+				softBegin = t;
+				softMisses = 0;
+			}
+			softMisses += misses;
+		}
+	}
+
+	// 메쉬 중심에서 클러스터 중심으로 가는 방향과 클러스터 노멀이 같을수록(바깥을 볼수록) 먼저 그린다.
+	struct ClusterSort
+	{
+		float Key;
+		uint32_t Cluster;
+	};
+	std::vector<double> centroids(boundaries.size() * 3, 0.0);
+	std::vector<double> normals(boundaries.size() * 3, 0.0);
+	std::vector<double> areas(boundaries.size(), 0.0);
+	double meshCentroid[3] = { 0.0, 0.0, 0.0 };
+	double meshArea = 0.0;
+	for (size_t c = 0; c < boundaries.size(); c++)
+	{
+		const size_t end = c + 1 < boundaries.size() ? boundaries[c + 1] : triangleCount;
+		for (size_t t = boundaries[c]; t < end; t++)
+		{
+			const float* a = GetPosition(positions, vertexStride, indices[t * 3]);
+			const float* b = GetPosition(positions, vertexStride, indices[t * 3 + 1]);
+			const float* d = GetPosition(positions, vertexStride, indices[t * 3 + 2]);
+			const double e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+			const double e2[3] = { d[0] - a[0], d[1] - a[1], d[2] - a[2] };
+			const double normal[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+			const double area = 0.5 * std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			for (int k = 0; k < 3; k++)
+			{
+				const double center = (a[k] + b[k] + d[k]) / 3.0;
+				centroids[c * 3 + k] += center * area;
+				normals[c * 3 + k] += normal[k];
+				meshCentroid[k] += center * area;
+			}
+			areas[c] += area;
+			meshArea += area;
+		}
+	}
+	for (int k = 0; k < 3; k++)
+	{
+		meshCentroid[k] = meshArea > 0.0 ? meshCentroid[k] / meshArea : 0.0;
+	}
+
+	std::vector<ClusterSort> order(boundaries.size());
+	for (size_t c = 0; c < boundaries.size(); c++)
+	{
+		const double* normal = &normals[c * 3];
+		const double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		double key = 0.0;
+		if (areas[c] > 0.0 && length > 0.0)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				key += (centroids[c * 3 + k] / areas[c] - meshCentroid[k]) * normal[k] / length;
+			}
+		}
+		order[c] = { static_cast<float>(key), static_cast<uint32_t>(c) };
+	}
+	std::stable_sort(order.begin(), order.end(), [](const ClusterSort& a, const ClusterSort& b) { return a.Key > b.Key; });
+
+	std::vector<uint32_t> output;
+	output.reserve(triangleCount * 3);
+	for (const auto& entry : order)
+	{
+		const size_t c = entry.Cluster;
+		const size_t end = c + 1 < boundaries.size() ? boundaries[c + 1] : triangleCount;
+		output.insert(output.end(), indices + boundaries[c] * 3, indices + end * 3);
+	}
+	std::copy(output.begin(), output.end(), indices);
+}
+
+size_t OptimizeVertexFetch(void* vertices, size_t vertexCount, size_t vertexSize, uint32_t* indices, size_t indexCount)
+{
+	std::vector<uint32_t> remap(vertexCount, NO_VERTEX);
+	uint32_t usedCount = 0;
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		uint32_t& target = remap[indices[i]];
+		if (target == NO_VERTEX)
+		{
+			target = usedCount++;
+		}
+		indices[i] = target;
+	}
+
+	char* bytes = static_cast<char*>(vertices);
+	const std::vector<char> source(bytes, bytes + vertexCount * vertexSize);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		if (remap[v] != NO_VERTEX)
+		{
+			memcpy(bytes + remap[v] * vertexSize, &source[v * vertexSize], vertexSize);
+		}
+	}
+	return usedCount;
+}
+
+VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize)
+{
+	VertexCacheStats stats;
+	stats.Triangles = indexCount / 3;
+	FifoCache cache(vertexCount, cacheSize);
+	std::vector<uint8_t> used(vertexCount, 0);
+	for (size_t i = 0; i < stats.Triangles * 3; i++)
+	{
+		stats.Transforms += cache.Access(indices[i]) ? 1 : 0;
+		if (!used[indices[i]])
+		{
+			used[indices[i]] = 1;
+			stats.Vertices++;
+		}
+	}
+	return stats;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#ifndef _MESHOPTIMIZER_H_
+#define _MESHOPTIMIZER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 메쉬를 올리기 전에 인덱스와 버텍스 순서를 GPU에 맞게 바꾸는 함수 모음
+// WeldVertices: 바이트가 모두 같은 버텍스를 하나로 합쳐 인덱스 버퍼를 만든다. (면마다 따로 만든 OBJ 버텍스)
+// OptimizeVertexCache: Tipsify(Sander 2007)로 삼각형 순서를 바꿔 변환 후 버텍스 캐시 적중을 높인다.
+//   캐시에 남은 버텍스의 삼각형을 이어 그리고, 막히면(캐시를 비우는 지점) 새 클러스터를 시작한다.
+// OptimizeOverdraw: 클러스터를 바깥을 보는 것부터 그려서 안쪽 면이 깊이 테스트에 걸리게 한다.
+//   캐시 효율이 threshold배보다 나빠지지 않는 곳에서 클러스터를 더 잘게 나눈 뒤 정렬한다.
+// OptimizeVertexFetch: 버텍스를 인덱스가 처음 쓰는 순서로 옮긴다. 쓰지 않는 버텍스는 버린다.
+// AnalyzeVertexCache: FIFO 캐시를 흉내 내서 ACMR(삼각형당 변환 수)과 ATVR(버텍스당 변환 수)을 잰다.
+// Windows나 D3D에 기대지 않으므로 DxCheck vcache-report, vcache-test로 리눅스에서도 돌린다.
+// 사용법:
+//   size_t vertexCount = WeldVertices(vertices, count, sizeof(Vertex), indices, indexCount);
+//   std::vector<uint32_t> clusters;
+//   OptimizeVertexCache(indices, indexCount, vertexCount, VERTEX_CACHE_SIZE, &clusters);
+//   OptimizeOverdraw(indices, indexCount, &vertices[0].position.x, sizeof(Vertex), vertexCount, clusters, 1.05f);
+//   vertexCount = OptimizeVertexFetch(vertices, vertexCount, sizeof(Vertex), indices, indexCount);
+//   auto stats = AnalyzeVertexCache(indices, indexCount, vertexCount);
+
+// 시뮬레이션과 Tipsify가 가정하는 캐시 크기 (버텍스 수)
+constexpr uint32_t VERTEX_CACHE_SIZE = 16;
+
+struct VertexCacheStats
+{
+	size_t Triangles = 0;
+	// 인덱스가 한 번이라도 쓰는 버텍스 수
+	size_t Vertices = 0;
+	// 캐시에 없어서 버텍스 셰이더를 다시 돌린 수
+	size_t Transforms = 0;
+
+	// 0.5 ~ 3. 작을수록 좋다. (버텍스를 잘 공유하는 메쉬는 0.6 ~ 0.7까지 내려간다)
+	float GetAcmr() const { return Triangles ? static_cast<float>(Transforms) / Triangles : 0.0f; }
+	// 1이 최선
+	float GetAtvr() const { return Vertices ? static_cast<float>(Transforms) / Vertices : 0.0f; }
+};
+
+// vertices는 vertexSize 바이트씩 vertexCount개. 앞쪽에 남은 버텍스 수를 돌려주고 indices를 그 번호로 바꾼다.
+size_t WeldVertices(void* vertices, size_t vertexCount, size_t vertexSize, uint32_t* indices, size_t indexCount);
+
+// clusters가 있으면 클러스터마다 첫 삼각형 번호를 오름차순으로 채운다. (0부터)
+void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = VERTEX_CACHE_SIZE,
+	std::vector<uint32_t>* clusters = nullptr);
+
+// positions는 vertexStride 바이트 간격의 float x, y, z. 삼각형 노멀은 (b - a) x (c - a)를 바깥으로 본다.
+// clusters는 OptimizeVertexCache가 만든 것. threshold가 1이면 캐시 효율을 잃지 않는 곳에서만 나눈다.
+void OptimizeOverdraw(uint32_t* indices, size_t indexCount, const float* positions, size_t vertexStride, size_t vertexCount,
+	const std::vector<uint32_t>& clusters, float threshold = 1.05f, uint32_t cacheSize = VERTEX_CACHE_SIZE);
+
+// 버텍스를 처음 쓰는 순서로 옮기고 indices를 고친다. 쓰는 버텍스 수를 돌려준다.
+size_t OptimizeVertexFetch(void* vertices, size_t vertexCount, size_t vertexSize, uint32_t* indices, size_t indexCount);
+
+VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount,
+	uint32_t cacheSize = VERTEX_CACHE_SIZE);
+
+#endif
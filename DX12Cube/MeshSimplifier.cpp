@@ -0,0 +1,696 @@
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <queue>
+#include <string>
+#include <unordered_map>
+
+namespace
+{
+	const uint32_t NO_POSITION = ~0u;
+	const uint32_t NO_WEDGE = ~0u;
+	// 접은 뒤 삼각형 노멀이 이보다 많이 돌아가면(코사인) 접지 않는다.
+	const double MIN_NORMAL_COSINE = 0.25;
+
+	// float 배열을 바이트 그대로 키로 써서 같은 값을 하나로 합친다.
+	std::string MakeKey(const float* values, size_t count)
+	{
+		return std::string(reinterpret_cast<const char*>(values), count * sizeof(float));
+	}
+
+	void Subtract(const double* a, const double* b, double* out)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			out[i] = a[i] - b[i];
+		}
+	}
+
+	void Cross(const double* a, const double* b, double* out)
+	{
+		out[0] = a[1] * b[2] - a[2] * b[1];
+		out[1] = a[2] * b[0] - a[0] * b[2];
+		out[2] = a[0] * b[1] - a[1] * b[0];
+	}
+
+	double Dot3(const double* a, const double* b)
+	{
+		return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+	}
+
+	// n차원 이차식 Q(v) = v^T A v + 2 b^T v + c. A는 대칭이라 위 삼각형만 둔다.
+	class QuadricTable
+	{
+	public:
+		QuadricTable(size_t count, uint32_t dimension)
+			: mDimension(dimension)
+			, mStride(dimension * (dimension + 1) / 2 + dimension + 1)
+			, mValues(count * mStride, 0.0)
+		{
+		}
+
+		// 점 p, q, r을 지나는 평면(위치 + 속성 공간)까지 거리 제곱에 weight를 곱해 더한다.
+		void AddTriangle(size_t index, const double* p, const double* q, const double* r, double weight)
+		{
+			const uint32_t n = mDimension;
+			double e1[3 + MAX_SIMPLIFY_ATTRIBUTES];
+			double e2[3 + MAX_SIMPLIFY_ATTRIBUTES];
+			double length1 = 0.0;
+			for (uint32_t i = 0; i < n; i++)
+			{
+				e1[i] = q[i] - p[i];
+				length1 += e1[i] * e1[i];
+			}
+			if (length1 <= 0.0)
+			{
+				return;
+			}
+			length1 = std::sqrt(length1);
+			double projection = 0.0;
+			for (uint32_t i = 0; i < n; i++)
+			{
+				e1[i] /= length1;
+				projection += (r[i] - p[i]) * e1[i];
+			}
+			double length2 = 0.0;
+			for (uint32_t i = 0; i < n; i++)
+			{
+				e2[i] = r[i] - p[i] - projection * e1[i];
+				length2 += e2[i] * e2[i];
+			}
+			if (length2 <= 0.0)
+			{
+				return;
+			}
+			length2 = std::sqrt(length2);
+			double pe1 = 0.0;
+			double pe2 = 0.0;
+			double pp = 0.0;
+			for (uint32_t i = 0; i < n; i++)
+			{
+				e2[i] /= length2;
+				pe1 += p[i] * e1[i];
+				pe2 += p[i] * e2[i];
+				pp += p[i] * p[i];
+			}
+
+			// A = I - e1 e1^T - e2 e2^T, b = (p.e1) e1 + (p.e2) e2 - p, c = p.p - (p.e1)^2 - (p.e2)^2
+			double* values = &mValues[index * mStride];
+			for (uint32_t i = 0; i < n; i++)
+			{
+				for (uint32_t j = i; j < n; j++)
+				{
+					*values++ += weight * ((i == j ? 1.0 : 0.0) - e1[i] * e1[j] - e2[i] * e2[j]);
+				}
+			}
+			for (uint32_t i = 0; i < n; i++)
+			{
+				*values++ += weight * (pe1 * e1[i] + pe2 * e2[i] - p[i]);
+			}
+			*values += weight * (pp - pe1 * pe1 - pe2 * pe2);
+		}
+
+		// 웨지를 합칠 때 from의 오차를 to에 더한다.
+		void Merge(size_t to, size_t from)
+		{
+			for (size_t i = 0; i < mStride; i++)
+			{
+				mValues[to * mStride + i] += mValues[from * mStride + i];
+			}
+		}
+
+		double Evaluate(size_t index, const double* v) const
+		{
+			const uint32_t n = mDimension;
+			const double* values = &mValues[index * mStride];
+			double result = 0.0;
+			for (uint32_t i = 0; i < n; i++)
+			{
+				result += *values++ * v[i] * v[i];
+				for (uint32_t j = i + 1; j < n; j++)
+				{
+					result += 2.0 * *values++ * v[i] * v[j];
+				}
+			}
+			for (uint32_t i = 0; i < n; i++)
+			{
+				result += 2.0 * *values++ * v[i];
+			}
+			return result + *values;
+		}
+
+	private:
+		uint32_t mDimension;
+		size_t mStride;
+		std::vector<double> mValues;
+	};
+
+	struct Collapse
+	{
+		double Cost;
+		uint32_t From;
+		uint32_t To;
+		uint32_t FromVersion;
+		uint32_t ToVersion;
+
+		bool operator>(const Collapse& other) const { return Cost > other.Cost; }
+	};
+
+	class Simplifier
+	{
+	public:
+		Simplifier(const float* vertices, size_t vertexCount, uint32_t attributeCount, const float* attributeWeights,
+			const uint32_t* indices, size_t indexCount)
+			: mDimension(3 + attributeCount)
+			, mQuadrics(0, 3 + attributeCount)
+		{
+			Weld(vertices, vertexCount, indices, indexCount);
+			ScaleVertices(attributeWeights);
+			BuildQuadrics();
+			BuildAdjacency();
+		}
+
+		MeshLod Run(size_t targetTriangleCount)
+		{
+			for (uint32_t from = 0; from < mPositions.size() / 3; from++)
+			{
+				PushCollapses(from);
+			}
+
+			double maxCost = 0.0;
+			while (mLiveTriangleCount > targetTriangleCount && !mHeap.empty())
+			{
+				const Collapse collapse = mHeap.top();
+				mHeap.pop();
+				if (mRemoved[collapse.From] || mRemoved[collapse.To] ||
+					mVersions[collapse.From] != collapse.FromVersion || mVersions[collapse.To] != collapse.ToVersion)
+				{
+					continue;
+				}
+				if (!CanCollapse(collapse.From, collapse.To))
+				{
+					continue;
+				}
+				Apply(collapse.From, collapse.To);
+				maxCost = std::max(maxCost, collapse.Cost);
+			}
+			return Output(std::sqrt(std::max(0.0, maxCost)) * mScale);
+		}
+
+	private:
+		// 모든 값이 같은 버텍스는 하나(웨지)로, 위치가 같은 웨지는 한 위치로 묶는다.
+		void Weld(const float* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount)
+		{
+			std::unordered_map<std::string, uint32_t> wedgeIds;
+			std::unordered_map<std::string, uint32_t> positionIds;
+			std::vector<uint32_t> vertexToWedge(vertexCount);
+			for (size_t i = 0; i < vertexCount; i++)
+			{
+				const float* vertex = vertices + i * mDimension;
+				auto [wedge, newWedge] = wedgeIds.emplace(MakeKey(vertex, mDimension), static_cast<uint32_t>(mWedgeValues.size() / mDimension));
+				vertexToWedge[i] = wedge->second;
+				if (!newWedge)
+				{
+					continue;
+				}
+
+				mWedgeValues.insert(mWedgeValues.end(), vertex, vertex + mDimension);
+				mOriginalAttributes.insert(mOriginalAttributes.end(), vertex + 3, vertex + mDimension);
+				auto [position, newPosition] = positionIds.emplace(MakeKey(vertex, 3), static_cast<uint32_t>(mPositions.size() / 3));
+				if (newPosition)
+				{
+					mPositions.insert(mPositions.end(), vertex, vertex + 3);
+				}
+				mWedgePositions.push_back(position->second);
+			}
+
+			mCorners.reserve(indexCount);
+			for (size_t i = 0; i + 2 < indexCount; i += 3)
+			{
+				const uint32_t a = vertexToWedge[indices[i]];
+				const uint32_t b = vertexToWedge[indices[i + 1]];
+				const uint32_t c = vertexToWedge[indices[i + 2]];
+				// 위치가 겹치는 삼각형은 처음부터 뺀다.
+				if (mWedgePositions[a] == mWedgePositions[b] || mWedgePositions[b] == mWedgePositions[c] || mWedgePositions[c] == mWedgePositions[a])
+				{
+					continue;
+				}
+				mCorners.insert(mCorners.end(), { a, b, c });
+			}
+			mLiveTriangleCount = mCorners.size() / 3;
+			mTriangleAlive.assign(mLiveTriangleCount, 1);
+		}
+
+		// 위치는 메쉬 크기로 나누고 속성은 가중치를 곱한 값으로 오차를 잰다.
+		void ScaleVertices(const float* attributeWeights)
+		{
+			const size_t positionCount = mPositions.size() / 3;
+			double minimum[3] = { HUGE_VAL, HUGE_VAL, HUGE_VAL };
+			double maximum[3] = { -HUGE_VAL, -HUGE_VAL, -HUGE_VAL };
+			for (size_t i = 0; i < positionCount; i++)
+			{
+				for (int a = 0; a < 3; a++)
+				{
+					minimum[a] = std::min(minimum[a], mPositions[i * 3 + a]);
+					maximum[a] = std::max(maximum[a], mPositions[i * 3 + a]);
+				}
+			}
+			mScale = 0.0;
+			for (int a = 0; a < 3; a++)
+			{
+				mScale = std::max(mScale, maximum[a] - minimum[a]);
+			}
+			if (mScale <= 0.0)
+			{
+				mScale = 1.0;
+			}
+
+			for (auto& value : mPositions)
+			{
+				value /= mScale;
+			}
+			const size_t wedgeCount = mWedgePositions.size();
+			for (size_t w = 0; w < wedgeCount; w++)
+			{
+				double* wedge = &mWedgeValues[w * mDimension];
+				for (uint32_t k = 0; k < mDimension - 3; k++)
+				{
+					wedge[3 + k] *= attributeWeights ? attributeWeights[k] : 1.0f;
+				}
+			}
+		}
+
+		// 삼각형마다 (위치 + 속성) 평면을 세 모서리의 웨지에 넓이만큼 더한다.
+		void BuildQuadrics()
+		{
+			const size_t wedgeCount = mWedgePositions.size();
+			mQuadrics = QuadricTable(wedgeCount, mDimension);
+			for (size_t t = 0; t < mCorners.size() / 3; t++)
+			{
+				double points[3][3 + MAX_SIMPLIFY_ATTRIBUTES];
+				for (int k = 0; k < 3; k++)
+				{
+					const uint32_t wedge = mCorners[t * 3 + k];
+					std::copy_n(&mPositions[mWedgePositions[wedge] * 3], 3, points[k]);
+					std::copy_n(&mWedgeValues[wedge * mDimension + 3], mDimension - 3, points[k] + 3);
+				}
+
+				double edge1[3], edge2[3], normal[3];
+				Subtract(points[1], points[0], edge1);
+				Subtract(points[2], points[0], edge2);
+				Cross(edge1, edge2, normal);
+				const double area = 0.5 * std::sqrt(Dot3(normal, normal));
+				for (int k = 0; k < 3; k++)
+				{
+					mQuadrics.AddTriangle(mCorners[t * 3 + k], points[0], points[1], points[2], area);
+				}
+			}
+		}
+
+		void BuildAdjacency()
+		{
+			const size_t positionCount = mPositions.size() / 3;
+			mPositionTriangles.assign(positionCount, {});
+			mPositionWedges.assign(positionCount, {});
+			mRemoved.assign(positionCount, 0);
+			mLocked.assign(positionCount, 0);
+			mVersions.assign(positionCount, 0);
+
+			for (uint32_t w = 0; w < mWedgePositions.size(); w++)
+			{
+				mPositionWedges[mWedgePositions[w]].push_back(w);
+			}
+
+			// 삼각형 하나만 쓰는 모서리는 열린 가장자리다. 두 끝을 고정한다.
+			std::unordered_map<uint64_t, uint32_t> edgeUses;
+			for (uint32_t t = 0; t < mCorners.size() / 3; t++)
+			{
+				for (int k = 0; k < 3; k++)
+				{
+					const uint32_t a = mWedgePositions[mCorners[t * 3 + k]];
+					const uint32_t b = mWedgePositions[mCorners[t * 3 + (k + 1) % 3]];
+					mPositionTriangles[a].push_back(t);
+					edgeUses[(static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b)]++;
+				}
+			}
+			for (const auto& [edge, uses] : edgeUses)
+			{
+				if (uses == 1)
+				{
+					mLocked[static_cast<uint32_t>(edge >> 32)] = 1;
+					mLocked[static_cast<uint32_t>(edge)] = 1;
+				}
+			}
+		}
+
+		uint32_t GetPosition(uint32_t triangle, int corner) const
+		{
+			return mWedgePositions[mCorners[triangle * 3 + corner]];
+		}
+
+		void CollectNeighbors(uint32_t position, std::vector<uint32_t>& neighbors) const
+		{
+			neighbors.clear();
+			for (uint32_t t : mPositionTriangles[position])
+			{
+				if (!mTriangleAlive[t])
+				{
+					continue;
+				}
+				for (int k = 0; k < 3; k++)
+				{
+					const uint32_t other = GetPosition(t, k);
+					if (other != position)
+					{
+						neighbors.push_back(other);
+					}
+				}
+			}
+			std::sort(neighbors.begin(), neighbors.end());
+			neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+		}
+
+		// from의 웨지마다 접은 뒤 합쳐질 to의 웨지를 mWedgeTargets에 찾는다. (mPositionWedges[from]과 같은 순서)
+		// 접히는 삼각형에서 from 모서리와 to 모서리가 쓰는 웨지는 그 삼각형 안에서 속성이 이어지므로 합친다.
+		// 모서리 양쪽 삼각형이 서로 다른 웨지를 가리키거나 접히는 삼각형에 없는 웨지는 속성이 똑같은 to 웨지가 있을 때만 합친다.
+		// 합칠 곳이 없으면 NO_WEDGE. 이음새(노멀/UV가 끊긴 곳)라서 위치만 to로 옮기고 속성은 그대로 둔다.
+		void MatchWedges(uint32_t from, uint32_t to)
+		{
+			const auto& fromWedges = mPositionWedges[from];
+			mWedgeTargets.assign(fromWedges.size(), NO_WEDGE);
+			std::vector<uint8_t> conflicts(fromWedges.size(), 0);
+			for (uint32_t t : mPositionTriangles[from])
+			{
+				if (!mTriangleAlive[t])
+				{
+					continue;
+				}
+				uint32_t fromWedge = NO_WEDGE;
+				uint32_t toWedge = NO_WEDGE;
+				for (int k = 0; k < 3; k++)
+				{
+					const uint32_t wedge = mCorners[t * 3 + k];
+					fromWedge = mWedgePositions[wedge] == from ? wedge : fromWedge;
+					toWedge = mWedgePositions[wedge] == to ? wedge : toWedge;
+				}
+				if (toWedge == NO_WEDGE)
+				{
+					continue;
+				}
+				const size_t slot = std::find(fromWedges.begin(), fromWedges.end(), fromWedge) - fromWedges.begin();
+				if (mWedgeTargets[slot] != NO_WEDGE && mWedgeTargets[slot] != toWedge)
+				{
+					conflicts[slot] = 1;
+				}
+				mWedgeTargets[slot] = toWedge;
+			}
+
+			const size_t attributeCount = mDimension - 3;
+			for (size_t slot = 0; slot < fromWedges.size(); slot++)
+			{
+				if (mWedgeTargets[slot] != NO_WEDGE && !conflicts[slot])
+				{
+					continue;
+				}
+				mWedgeTargets[slot] = NO_WEDGE;
+				const float* attributes = &mOriginalAttributes[fromWedges[slot] * attributeCount];
+				for (uint32_t wedge : mPositionWedges[to])
+				{
+					if (std::equal(attributes, attributes + attributeCount, &mOriginalAttributes[wedge * attributeCount]))
+					{
+						mWedgeTargets[slot] = wedge;
+						break;
+					}
+				}
+			}
+		}
+
+		// from을 to 위치로 옮겼을 때 오차. 합쳐지는 웨지는 남는 to 웨지의 속성으로, 이음새 웨지는 제 속성으로 잰다.
+		double ComputeCost(uint32_t from, uint32_t to)
+		{
+			MatchWedges(from, to);
+			double point[3 + MAX_SIMPLIFY_ATTRIBUTES];
+			std::copy_n(&mPositions[to * 3], 3, point);
+			double cost = 0.0;
+			const auto& fromWedges = mPositionWedges[from];
+			for (size_t slot = 0; slot < fromWedges.size(); slot++)
+			{
+				const uint32_t source = mWedgeTargets[slot] != NO_WEDGE ? mWedgeTargets[slot] : fromWedges[slot];
+				std::copy_n(&mWedgeValues[source * mDimension + 3], mDimension - 3, point + 3);
+				cost += mQuadrics.Evaluate(fromWedges[slot], point);
+			}
+			return std::max(0.0, cost);
+		}
+
+		void PushCollapses(uint32_t position)
+		{
+			if (mRemoved[position])
+			{
+				return;
+			}
+			CollectNeighbors(position, mNeighbors);
+			for (uint32_t neighbor : mNeighbors)
+			{
+				if (!mLocked[position])
+				{
+					mHeap.push({ ComputeCost(position, neighbor), position, neighbor, mVersions[position], mVersions[neighbor] });
+				}
+				if (!mLocked[neighbor])
+				{
+					mHeap.push({ ComputeCost(neighbor, position), neighbor, position, mVersions[neighbor], mVersions[position] });
+				}
+			}
+		}
+
+		bool CanCollapse(uint32_t from, uint32_t to)
+		{
+			// 두 위치를 함께 쓰는 삼각형 수와 공통 이웃 수가 같아야 접은 뒤에도 다양체다.
+			std::vector<uint32_t> toNeighbors;
+			CollectNeighbors(from, mNeighbors);
+			CollectNeighbors(to, toNeighbors);
+			if (!std::binary_search(mNeighbors.begin(), mNeighbors.end(), to))
+			{
+				return false;
+			}
+			size_t sharedNeighbors = 0;
+			for (uint32_t neighbor : mNeighbors)
+			{
+				sharedNeighbors += std::binary_search(toNeighbors.begin(), toNeighbors.end(), neighbor) ? 1 : 0;
+			}
+
+			size_t sharedTriangles = 0;
+			const double* target = &mPositions[to * 3];
+			for (uint32_t t : mPositionTriangles[from])
+			{
+				if (!mTriangleAlive[t])
+				{
+					continue;
+				}
+				double points[3][3];
+				bool hasTo = false;
+				for (int k = 0; k < 3; k++)
+				{
+					const uint32_t position = GetPosition(t, k);
+					hasTo |= position == to;
+					std::copy_n(&mPositions[position * 3], 3, points[k]);
+				}
+				if (hasTo)
+				{
+					sharedTriangles++;
+					continue;
+				}
+
+				// 남는 삼각형이 뒤집히거나 많이 꺾이면 안 된다.
+				double edge1[3], edge2[3], before[3], after[3];
+				Subtract(points[1], points[0], edge1);
+				Subtract(points[2], points[0], edge2);
+				Cross(edge1, edge2, before);
+				for (int k = 0; k < 3; k++)
+				{
+					if (GetPosition(t, k) == from)
+					{
+						std::copy_n(target, 3, points[k]);
+					}
+				}
+				Subtract(points[1], points[0], edge1);
+				Subtract(points[2], points[0], edge2);
+				Cross(edge1, edge2, after);
+				const double beforeLength = std::sqrt(Dot3(before, before));
+				const double afterLength = std::sqrt(Dot3(after, after));
+				if (afterLength <= 1e-12 * beforeLength || Dot3(before, after) < MIN_NORMAL_COSINE * beforeLength * afterLength)
+				{
+					return false;
+				}
+			}
+			return sharedNeighbors == sharedTriangles;
+		}
+
+		void Apply(uint32_t from, uint32_t to)
+		{
+			MatchWedges(from, to);
+			const auto& fromWedges = mPositionWedges[from];
+			for (uint32_t t : mPositionTriangles[from])
+			{
+				if (!mTriangleAlive[t])
+				{
+					continue;
+				}
+				bool hasTo = false;
+				for (int k = 0; k < 3; k++)
+				{
+					hasTo |= GetPosition(t, k) == to;
+				}
+				if (hasTo)
+				{
+					mTriangleAlive[t] = 0;
+					mLiveTriangleCount--;
+				}
+				else
+				{
+					mPositionTriangles[to].push_back(t);
+					for (int k = 0; k < 3; k++)
+					{
+						uint32_t& corner = mCorners[t * 3 + k];
+						if (mWedgePositions[corner] == from)
+						{
+							const uint32_t target = mWedgeTargets[std::find(fromWedges.begin(), fromWedges.end(), corner) - fromWedges.begin()];
+							corner = target != NO_WEDGE ? target : corner;
+						}
+					}
+				}
+			}
+
+			// 합쳐지는 웨지는 오차를 to 웨지에 넘기고, 이음새 웨지는 속성을 그대로 두고 위치만 to로 옮긴다.
+			for (size_t slot = 0; slot < fromWedges.size(); slot++)
+			{
+				const uint32_t wedge = fromWedges[slot];
+				if (mWedgeTargets[slot] != NO_WEDGE)
+				{
+					mQuadrics.Merge(mWedgeTargets[slot], wedge);
+					continue;
+				}
+				mWedgePositions[wedge] = to;
+				mPositionWedges[to].push_back(wedge);
+			}
+			mPositionWedges[from].clear();
+			mPositionTriangles[from].clear();
+			mRemoved[from] = 1;
+
+			// 죽은 삼각형을 치우고 to와 이웃의 비용을 다시 넣는다.
+			auto& triangles = mPositionTriangles[to];
+			triangles.erase(std::remove_if(triangles.begin(), triangles.end(), [this](uint32_t t) { return !mTriangleAlive[t]; }), triangles.end());
+			std::vector<uint32_t> neighbors;
+			CollectNeighbors(to, neighbors);
+			mVersions[to]++;
+			for (uint32_t neighbor : neighbors)
+			{
+				mVersions[neighbor]++;
+			}
+			PushCollapses(to);
+			for (uint32_t neighbor : neighbors)
+			{
+				PushCollapses(neighbor);
+			}
+		}
+
+		// 남은 삼각형이 쓰는 웨지만 모으고 원래 단위의 값으로 되돌린다. 같아진 버텍스는 합친다.
+		MeshLod Output(float error)
+		{
+			MeshLod lod;
+			lod.Error = error;
+			std::unordered_map<std::string, uint32_t> vertexIds;
+			std::vector<float> vertex(mDimension);
+			for (size_t t = 0; t < mTriangleAlive.size(); t++)
+			{
+				if (!mTriangleAlive[t])
+				{
+					continue;
+				}
+				for (int k = 0; k < 3; k++)
+				{
+					const uint32_t wedge = mCorners[t * 3 + k];
+					for (int a = 0; a < 3; a++)
+					{
+						vertex[a] = static_cast<float>(mPositions[mWedgePositions[wedge] * 3 + a] * mScale);
+					}
+					for (uint32_t a = 3; a < mDimension; a++)
+					{
+						vertex[a] = mOriginalAttributes[wedge * (mDimension - 3) + (a - 3)];
+					}
+					auto [it, inserted] = vertexIds.emplace(MakeKey(vertex.data(), mDimension), static_cast<uint32_t>(lod.Vertices.size() / mDimension));
+					if (inserted)
+					{
+						lod.Vertices.insert(lod.Vertices.end(), vertex.begin(), vertex.end());
+					}
+					lod.Indices.push_back(it->second);
+				}
+			}
+			return lod;
+		}
+
+		uint32_t mDimension;
+		double mScale = 1.0;
+
+		// 위치마다 x, y, z (메쉬 크기로 나눈 값)
+		std::vector<double> mPositions;
+		// 웨지마다 (3 + 속성)개. 속성은 가중치를 곱한 값
+		std::vector<double> mWedgeValues;
+		// 웨지마다 가중치를 곱하기 전 속성
+		std::vector<float> mOriginalAttributes;
+		std::vector<uint32_t> mWedgePositions;
+		QuadricTable mQuadrics;
+
+		// 삼각형마다 웨지 세 개
+		std::vector<uint32_t> mCorners;
+		std::vector<uint8_t> mTriangleAlive;
+		size_t mLiveTriangleCount = 0;
+
+		std::vector<std::vector<uint32_t>> mPositionTriangles;
+		std::vector<std::vector<uint32_t>> mPositionWedges;
+		std::vector<uint8_t> mRemoved;
+		std::vector<uint8_t> mLocked;
+		// 위치 주변이 바뀔 때마다 올린다. 힙의 낡은 항목을 알아본다.
+		std::vector<uint32_t> mVersions;
+
+		std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> mHeap;
+		std::vector<uint32_t> mNeighbors;
+		// MatchWedges 결과
+		std::vector<uint32_t> mWedgeTargets;
+	};
+}
+
+MeshLod SimplifyMesh(const float* vertices, size_t vertexCount, uint32_t attributeCount, const float* attributeWeights,
+	const uint32_t* indices, size_t indexCount, size_t targetIndexCount)
+{
+	assert(attributeCount <= MAX_SIMPLIFY_ATTRIBUTES);
+	Simplifier simplifier(vertices, vertexCount, attributeCount, attributeWeights, indices, indexCount);
+	return simplifier.Run(targetIndexCount / 3);
+}
+
+std::vector<MeshLod> BuildMeshLods(const float* vertices, size_t vertexCount, uint32_t attributeCount, const float* attributeWeights,
+	const uint32_t* indices, size_t indexCount, size_t maxLodCount, float reduction)
+{
+	std::vector<MeshLod> lods;
+	const uint32_t stride = 3 + attributeCount;
+	float error = 0.0f;
+	while (lods.size() < maxLodCount)
+	{
+		const size_t previousIndexCount = lods.empty() ? indexCount : lods.back().Indices.size();
+		const size_t targetIndexCount = static_cast<size_t>(previousIndexCount / 3 * reduction) * 3;
+		MeshLod lod = lods.empty()
+			? SimplifyMesh(vertices, vertexCount, attributeCount, attributeWeights, indices, indexCount, targetIndexCount)
+			: SimplifyMesh(lods.back().Vertices.data(), lods.back().Vertices.size() / stride, attributeCount, attributeWeights,
+				lods.back().Indices.data(), lods.back().Indices.size(), targetIndexCount);
+		if (lod.Indices.empty() || lod.Indices.size() > previousIndexCount * (1.0f - MIN_LOD_REDUCTION))
+		{
+			break;
+		}
+		// 앞 단계에서 줄인 메쉬를 다시 줄이므로 오차는 쌓인다.
+		error += lod.Error;
+		lod.Error = error;
+		lods.push_back(std::move(lod));
+	}
+	return lods;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#ifndef _MESHSIMPLIFIER_H_
+#define _MESHSIMPLIFIER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 이차 오차(quadric error metric)로 삼각형 메쉬를 줄이는 단순화
+// 버텍스마다 위치 float 3개 뒤에 속성(노멀, UV 등) float attributeCount개가 붙은 배열을 받는다.
+// 위치와 속성을 합친 (3 + attributeCount)차원 공간의 평면까지 거리로 오차를 재서 (Garland & Heckbert 1998)
+// 모양뿐 아니라 노멀이나 UV가 크게 바뀌는 모서리도 늦게 접는다.
+// 접는 위치의 웨지(같은 값의 버텍스)는 속성이 이어지는 남는 쪽 웨지로 합친다.
+// 노멀/UV가 끊긴 이음새의 웨지만 속성을 그대로 두고 위치를 옮긴다. 새 버텍스를 만들지 않는다.
+// 열린 가장자리 위치는 움직이지 않고, 삼각형이 뒤집히거나 다양체가 깨지는 접기는 하지 않는다.
+// 사용법:
+//   MeshLod lod = SimplifyMesh(vertices, vertexCount, 5, weights, indices, indexCount, indexCount / 2);
+//   auto lods = BuildMeshLods(vertices, vertexCount, 5, weights, indices, indexCount, 3);
+
+struct MeshLod
+{
+	// 버텍스마다 float (3 + attributeCount)개
+	std::vector<float> Vertices;
+	std::vector<uint32_t> Indices;
+	// 받아들인 접기 중 가장 큰 오차의 제곱근 (위치 단위)
+	float Error = 0.0f;
+};
+
+// 속성은 attributeWeights[k]를 곱해서 위치와 같은 크기로 맞춘다. (nullptr이면 모두 1)
+// 위치는 메쉬 크기로 나눠 재므로 가중치는 메쉬 크기와 상관없다.
+// 삼각형을 targetIndexCount / 3개 이하로 줄이거나 더 접을 모서리가 없으면 멈춘다.
+MeshLod SimplifyMesh(const float* vertices, size_t vertexCount, uint32_t attributeCount, const float* attributeWeights,
+	const uint32_t* indices, size_t indexCount, size_t targetIndexCount);
+
+// LOD1부터 차례로 앞 단계의 reduction배로 줄인 메쉬. (LOD0은 넣지 않는다)
+// 한 단계에서 삼각형이 MIN_LOD_REDUCTION만큼도 줄지 않으면 거기서 멈춘다.
+std::vector<MeshLod> BuildMeshLods(const float* vertices, size_t vertexCount, uint32_t attributeCount, const float* attributeWeights,
+	const uint32_t* indices, size_t indexCount, size_t maxLodCount, float reduction = 0.5f);
+
+// 앞 단계보다 이만큼은 줄어야 새 LOD로 친다.
+constexpr float MIN_LOD_REDUCTION = 0.2f;
+// 위치 뒤에 붙을 수 있는 속성 수
+constexpr uint32_t MAX_SIMPLIFY_ATTRIBUTES = 8;
+
+#endif
@@ -0,0 +1,395 @@
+#include "OcclusionCuller.h"
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <format>
+#include "FrustumCuller.h"
+#include "JobSystem.h"
+
+using namespace DirectX;
+
+namespace
+{
+	// 앞면(z = 0)으로 잘라낸 다각형은 꼭짓점이 4개까지 생긴다.
+	const int MAX_CLIPPED_VERTICES = 4;
+
+	// 클립 공간 선분 a-b가 z = 0과 만나는 점
+	XMFLOAT4 IntersectNearPlane(const XMFLOAT4& a, const XMFLOAT4& b)
+	{
+		const float t = a.z / (a.z - b.z);
+		return XMFLOAT4(a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, 0.0f, a.w + (b.w - a.w) * t);
+	}
+}
+
+std::wstring OcclusionCullStats::ToString() const
+{
+	const double frames = Frames ? static_cast<double>(Frames) : 1.0;
+	return std::format(L"OcclusionCuller: {:.0f} occluders, {:.0f} triangles, {:.0f} tested, {:.0f} occluded ({:.1f}%) per frame, "
+		L"render {:.3f} ms, test {:.3f} ms avg\n",
+		Occluders / frames, Triangles / frames, Tested / frames, Occluded / frames, GetOccludedFraction() * 100.0,
+		RenderSeconds * 1000.0 / frames, TestSeconds * 1000.0 / frames);
+}
+
+OcclusionCuller::OcclusionCuller()
+{
+	XMStoreFloat4x4(&mViewProjection, XMMatrixIdentity());
+	Resize(DEFAULT_WIDTH, DEFAULT_HEIGHT);
+}
+
+void OcclusionCuller::Resize(uint32_t width, uint32_t height)
+{
+	mTilesX = std::max(1u, (width + TILE_WIDTH - 1) / TILE_WIDTH);
+	mTilesY = std::max(1u, (height + TILE_HEIGHT - 1) / TILE_HEIGHT);
+	mWidth = mTilesX * TILE_WIDTH;
+	mHeight = mTilesY * TILE_HEIGHT;
+	mDepth.assign(static_cast<size_t>(mWidth) * mHeight, 1.0f);
+	mTileMaxDepth.assign(static_cast<size_t>(mTilesX) * mTilesY, 1.0f);
+}
+
+void OcclusionCuller::SetViewProjection(FXMMATRIX viewProjection)
+{
+	XMStoreFloat4x4(&mViewProjection, viewProjection);
+}
+
+void OcclusionCuller::ClearOccluders()
+{
+	mOccluders.clear();
+}
+
+void OcclusionCuller::AddOccluder(const XMFLOAT4X4& world, const XMFLOAT3* positions, size_t stride,
+	const uint16_t* indices, uint32_t indexCount)
+{
+	mOccluders.push_back({ world, positions, stride, indices, indexCount });
+}
+
+void OcclusionCuller::SetupOccluder(const Occluder& occluder, std::vector<ScreenTriangle>& triangles) const
+{
+	triangles.clear();
+	const XMMATRIX worldViewProjection = XMLoadFloat4x4(&occluder.World) * XMLoadFloat4x4(&mViewProjection);
+	const float halfWidth = mWidth * 0.5f;
+	const float halfHeight = mHeight * 0.5f;
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(occluder.Positions);
+
+	for (uint32_t i = 0; i + 2 < occluder.IndexCount; i += 3)
+	{
+		XMFLOAT4 clip[3];
+		for (int k = 0; k < 3; k++)
+		{
+			const auto* position = reinterpret_cast<const XMFLOAT3*>(bytes + occluder.Indices[i + k] * occluder.Stride);
+			XMStoreFloat4(&clip[k], XMVector3Transform(XMLoadFloat3(position), worldViewProjection));
+		}
+
+		// 한 평면 바깥에 꼭짓점이 모두 있으면 화면에 닿지 않는다.
+		if ((clip[0].x > clip[0].w && clip[1].x > clip[1].w && clip[2].x > clip[2].w) ||
+			(clip[0].x < -clip[0].w && clip[1].x < -clip[1].w && clip[2].x < -clip[2].w) ||
+			(clip[0].y > clip[0].w && clip[1].y > clip[1].w && clip[2].y > clip[2].w) ||
+			(clip[0].y < -clip[0].w && clip[1].y < -clip[1].w && clip[2].y < -clip[2].w) ||
+			(clip[0].z < 0.0f && clip[1].z < 0.0f && clip[2].z < 0.0f))
+		{
+			continue;
+		}
+
+		// 앞면 뒤(z < 0)로 넘어간 부분을 잘라낸다. 남은 부분은 w > 0이라 나눌 수 있다.
+		XMFLOAT4 polygon[MAX_CLIPPED_VERTICES];
+		int vertexCount = 0;
+		for (int k = 0; k < 3; k++)
+		{
+			const XMFLOAT4& a = clip[k];
+			const XMFLOAT4& b = clip[(k + 1) % 3];
+			if (a.z >= 0.0f)
+			{
+				polygon[vertexCount++] = a;
+			}
+			if ((a.z >= 0.0f) != (b.z >= 0.0f))
+			{
+				polygon[vertexCount++] = IntersectNearPlane(a, b);
+			}
+		}
+
+		float x[MAX_CLIPPED_VERTICES];
+		float y[MAX_CLIPPED_VERTICES];
+		float z[MAX_CLIPPED_VERTICES];
+		for (int k = 0; k < vertexCount; k++)
+		{
+			const float inverseW = 1.0f / polygon[k].w;
+			x[k] = (polygon[k].x * inverseW + 1.0f) * halfWidth;
+			y[k] = (1.0f - polygon[k].y * inverseW) * halfHeight;
+			z[k] = polygon[k].z * inverseW;
+		}
+
+		for (int k = 1; k + 1 < vertexCount; k++)
+		{
+			triangles.push_back({ { x[0], x[k], x[k + 1] }, { y[0], y[k], y[k + 1] }, { z[0], z[k], z[k + 1] } });
+		}
+	}
+}
+
+void OcclusionCuller::RasterizeBand(uint32_t band)
+{
+	const uint32_t firstRow = band * TILE_HEIGHT;
+	const uint32_t lastRow = firstRow + TILE_HEIGHT - 1;
+	float* bandDepth = &mDepth[static_cast<size_t>(firstRow) * mWidth];
+	std::fill(bandDepth, bandDepth + static_cast<size_t>(TILE_HEIGHT) * mWidth, 1.0f);
+
+	const XMVECTOR pixelOffsets = XMVectorSet(0.5f, 1.5f, 2.5f, 3.5f);
+	const XMVECTOR zero = XMVectorZero();
+
+	for (const auto& triangle : mTriangles)
+	{
+		// 픽셀 중심 (x + 0.5, y + 0.5)이 삼각형 경계 상자 안에 드는 줄과 칸
+		// 앞면 가까이의 꼭짓점은 화면 좌표가 매우 커진다. 정수로 바꾸기 전에 화면 근처로 자른다.
+		const float minY = std::max(-1.0f, std::min({ triangle.Y[0], triangle.Y[1], triangle.Y[2] }));
+		const float maxY = std::min(mHeight + 1.0f, std::max({ triangle.Y[0], triangle.Y[1], triangle.Y[2] }));
+		const int rowStart = std::max(static_cast<int>(firstRow), static_cast<int>(std::ceil(minY - 0.5f)));
+		const int rowEnd = std::min(static_cast<int>(lastRow), static_cast<int>(std::floor(maxY - 0.5f)));
+		if (rowStart > rowEnd)
+		{
+			continue;
+		}
+		const float minX = std::max(-1.0f, std::min({ triangle.X[0], triangle.X[1], triangle.X[2] }));
+		const float maxX = std::min(mWidth + 1.0f, std::max({ triangle.X[0], triangle.X[1], triangle.X[2] }));
+		const int columnStart = std::max(0, static_cast<int>(std::ceil(minX - 0.5f))) & ~3;
+		const int columnEnd = std::min(static_cast<int>(mWidth) - 1, static_cast<int>(std::floor(maxX - 0.5f)));
+		if (columnStart > columnEnd)
+		{
+			continue;
+		}
+
+		// 넓이가 양수가 되도록 꼭짓점 순서를 맞춘다. (앞뒷면 모두 그린다)
+		float x0 = triangle.X[0], y0 = triangle.Y[0], z0 = triangle.Z[0];
+		float x1 = triangle.X[1], y1 = triangle.Y[1], z1 = triangle.Z[1];
+		float x2 = triangle.X[2], y2 = triangle.Y[2], z2 = triangle.Z[2];
+		float area = (x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0);
+		if (std::fabs(area) < 1e-6f)
+		{
+			continue;
+		}
+		if (area < 0.0f)
+		{
+			std::swap(x1, x2);
+			std::swap(y1, y2);
+			std::swap(z1, z2);
+			area = -area;
+		}
+
+		// 변 a -> b의 안쪽 판정식 E(p) = A * p.x + B * p.y + C (안쪽이 양수)
+		const float a0 = y1 - y2, b0 = x2 - x1, c0 = -(a0 * x1 + b0 * y1);
+		const float a1 = y2 - y0, b1 = x0 - x2, c1 = -(a1 * x2 + b1 * y2);
+		const float a2 = y0 - y1, b2 = x1 - x0, c2 = -(a2 * x0 + b2 * y0);
+
+		// 화면 공간에서 z/w는 선형이다.
+		const float inverseArea = 1.0f / area;
+		const float dzdx = ((z1 - z0) * (y2 - y0) - (z2 - z0) * (y1 - y0)) * inverseArea;
+		const float dzdy = ((z2 - z0) * (x1 - x0) - (z1 - z0) * (x2 - x0)) * inverseArea;
+
+		const XMVECTOR columnX = XMVectorAdd(XMVectorReplicate(static_cast<float>(columnStart)), pixelOffsets);
+		const XMVECTOR edgeStep0 = XMVectorReplicate(a0 * 4.0f);
+		const XMVECTOR edgeStep1 = XMVectorReplicate(a1 * 4.0f);
+		const XMVECTOR edgeStep2 = XMVectorReplicate(a2 * 4.0f);
+		const XMVECTOR depthStep = XMVectorReplicate(dzdx * 4.0f);
+
+		for (int row = rowStart; row <= rowEnd; row++)
+		{
+			const float py = row + 0.5f;
+			XMVECTOR edge0 = XMVectorMultiplyAdd(XMVectorReplicate(a0), columnX, XMVectorReplicate(b0 * py + c0));
+			XMVECTOR edge1 = XMVectorMultiplyAdd(XMVectorReplicate(a1), columnX, XMVectorReplicate(b1 * py + c1));
+			XMVECTOR edge2 = XMVectorMultiplyAdd(XMVectorReplicate(a2), columnX, XMVectorReplicate(b2 * py + c2));
+			XMVECTOR depth = XMVectorMultiplyAdd(XMVectorReplicate(dzdx), columnX, XMVectorReplicate(z0 - dzdx * x0 + dzdy * (py - y0)));
+
+			float* rowDepth = &mDepth[static_cast<size_t>(row) * mWidth];
+			for (int column = columnStart; column <= columnEnd; column += 4)
+			{
+				XMVECTOR inside = XMVectorAndInt(XMVectorAndInt(XMVectorGreaterOrEqual(edge0, zero), XMVectorGreaterOrEqual(edge1, zero)),
+					XMVectorGreaterOrEqual(edge2, zero));
+				if (!XMVector4EqualInt(inside, XMVectorFalseInt()))
+				{
+					auto* pixels = reinterpret_cast<XMFLOAT4*>(rowDepth + column);
+					XMVECTOR old = XMLoadFloat4(pixels);
+					XMStoreFloat4(pixels, XMVectorSelect(old, XMVectorMin(old, depth), inside));
+				}
+				edge0 = XMVectorAdd(edge0, edgeStep0);
+				edge1 = XMVectorAdd(edge1, edgeStep1);
+				edge2 = XMVectorAdd(edge2, edgeStep2);
+				depth = XMVectorAdd(depth, depthStep);
+			}
+		}
+	}
+
+	// 이 띠의 타일마다 가장 먼 깊이
+	for (uint32_t tileX = 0; tileX < mTilesX; tileX++)
+	{
+		XMVECTOR maxDepth = XMVectorZero();
+		for (uint32_t row = 0; row < TILE_HEIGHT; row++)
+		{
+			const float* pixels = &bandDepth[static_cast<size_t>(row) * mWidth + tileX * TILE_WIDTH];
+			for (uint32_t column = 0; column < TILE_WIDTH; column += 4)
+			{
+				maxDepth = XMVectorMax(maxDepth, XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(pixels + column)));
+			}
+		}
+		XMFLOAT4 lanes;
+		XMStoreFloat4(&lanes, maxDepth);
+		mTileMaxDepth[band * mTilesX + tileX] = std::max(std::max(lanes.x, lanes.y), std::max(lanes.z, lanes.w));
+	}
+}
+
+void OcclusionCuller::Render(JobSystem* jobs)
+{
+	// 삼각형을 화면 좌표로 옮긴다. 가리는 물체마다 따로 모았다가 한 배열로 합친다.
+	mOccluderTriangles.resize(mOccluders.size());
+	auto setup = [this](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				SetupOccluder(mOccluders[i], mOccluderTriangles[i]);
+			}
+		};
+	auto rasterize = [this](size_t begin, size_t end)
+		{
+			for (size_t band = begin; band < end; band++)
+			{
+				RasterizeBand(static_cast<uint32_t>(band));
+			}
+		};
+
+	const bool parallel = jobs && jobs->GetConcurrency() > 1;
+	if (parallel)
+	{
+		jobs->ParallelFor(mOccluders.size(), 1, setup);
+	}
+	else
+	{
+		setup(0, mOccluders.size());
+	}
+
+	mTriangles.clear();
+	for (const auto& triangles : mOccluderTriangles)
+	{
+		mTriangles.insert(mTriangles.end(), triangles.begin(), triangles.end());
+	}
+
+	// 띠마다 쓰는 줄이 겹치지 않는다.
+	if (parallel)
+	{
+		jobs->ParallelFor(mTilesY, 1, rasterize);
+	}
+	else
+	{
+		rasterize(0, mTilesY);
+	}
+}
+
+bool OcclusionCuller::IsVisible(const XMFLOAT4X4& world, const CullBounds& bounds) const
+{
+	const XMMATRIX worldViewProjection = XMLoadFloat4x4(&world) * XMLoadFloat4x4(&mViewProjection);
+
+	// 꼭짓점 8개 = 중심 ± 축마다 반 크기 (클립 공간에서 더한다)
+	const XMVECTOR center = XMVector3Transform(XMLoadFloat3(&bounds.Center), worldViewProjection);
+	const XMVECTOR axisX = XMVectorScale(worldViewProjection.r[0], bounds.Extents.x);
+	const XMVECTOR axisY = XMVectorScale(worldViewProjection.r[1], bounds.Extents.y);
+	const XMVECTOR axisZ = XMVectorScale(worldViewProjection.r[2], bounds.Extents.z);
+
+	float minX = FLT_MAX, minY = FLT_MAX, minZ = FLT_MAX;
+	float maxX = -FLT_MAX, maxY = -FLT_MAX;
+	for (int corner = 0; corner < 8; corner++)
+	{
+		XMVECTOR position = center;
+		position = (corner & 1) ? XMVectorAdd(position, axisX) : XMVectorSubtract(position, axisX);
+		position = (corner & 2) ? XMVectorAdd(position, axisY) : XMVectorSubtract(position, axisY);
+		position = (corner & 4) ? XMVectorAdd(position, axisZ) : XMVectorSubtract(position, axisZ);
+
+		XMFLOAT4 clip;
+		XMStoreFloat4(&clip, position);
+		// 앞면을 넘는 물체는 카메라에 닿아 있다. 가려졌다고 할 수 없다.
+		if (clip.z < 0.0f || clip.w <= 0.0f)
+		{
+			return true;
+		}
+		const float inverseW = 1.0f / clip.w;
+		const float x = (clip.x * inverseW + 1.0f) * mWidth * 0.5f;
+		const float y = (1.0f - clip.y * inverseW) * mHeight * 0.5f;
+		minX = std::min(minX, x);
+		maxX = std::max(maxX, x);
+		minY = std::min(minY, y);
+		maxY = std::max(maxY, y);
+		minZ = std::min(minZ, clip.z * inverseW);
+	}
+
+	// 화면 밖이면 절두체 컬링에 맡긴다.
+	minX = std::max(minX, -1.0f);
+	maxX = std::min(maxX, mWidth + 1.0f);
+	minY = std::max(minY, -1.0f);
+	maxY = std::min(maxY, mHeight + 1.0f);
+	if (maxX < 0.0f || minX > mWidth || maxY < 0.0f || minY > mHeight)
+	{
+		return true;
+	}
+	// 닿는 픽셀과 그 둘레 한 픽셀. 가리는 물체는 픽셀 중심으로 그려져 가장자리 픽셀을 다 덮은 것처럼 보이므로
+	// 그 바깥 픽셀까지 봐야 가장자리 틈으로 보이는 물체를 거르지 않는다.
+	const int x0 = std::max(0, static_cast<int>(std::floor(minX)) - 1);
+	const int x1 = std::min(static_cast<int>(mWidth) - 1, static_cast<int>(std::floor(maxX)) + 1);
+	const int y0 = std::max(0, static_cast<int>(std::floor(minY)) - 1);
+	const int y1 = std::min(static_cast<int>(mHeight) - 1, static_cast<int>(std::floor(maxY)) + 1);
+
+	// 타일의 가장 먼 깊이보다 물체가 뒤면 그 타일은 다 가려졌다. 아니면 겹치는 픽셀을 본다.
+	for (int tileY = y0 / static_cast<int>(TILE_HEIGHT); tileY <= y1 / static_cast<int>(TILE_HEIGHT); tileY++)
+	{
+		for (int tileX = x0 / static_cast<int>(TILE_WIDTH); tileX <= x1 / static_cast<int>(TILE_WIDTH); tileX++)
+		{
+			if (mTileMaxDepth[tileY * mTilesX + tileX] < minZ)
+			{
+				continue;
+			}
+
+			const int rowStart = std::max(y0, tileY * static_cast<int>(TILE_HEIGHT));
+			const int rowEnd = std::min(y1, (tileY + 1) * static_cast<int>(TILE_HEIGHT) - 1);
+			const int columnStart = std::max(x0, tileX * static_cast<int>(TILE_WIDTH));
+			const int columnEnd = std::min(x1, (tileX + 1) * static_cast<int>(TILE_WIDTH) - 1);
+			for (int row = rowStart; row <= rowEnd; row++)
+			{
+				const float* rowDepth = &mDepth[static_cast<size_t>(row) * mWidth];
+				for (int column = columnStart; column <= columnEnd; column++)
+				{
+					if (rowDepth[column] >= minZ)
+					{
+						return true;
+					}
+				}
+			}
+		}
+	}
+	return false;
+}
+
+size_t OcclusionCuller::Cull(const XMFLOAT4X4* worlds, const uint32_t* boundsIndices, const CullBounds* boundsTable,
+	size_t begin, size_t end, uint8_t* visible) const
+{
+	size_t occludedCount = 0;
+	for (size_t i = begin; i < end; i++)
+	{
+		if (visible[i] && !IsVisible(worlds[i], boundsTable[boundsIndices[i]]))
+		{
+			visible[i] = 0;
+			occludedCount++;
+		}
+	}
+	return occludedCount;
+}
+
+size_t OcclusionCuller::CullParallel(JobSystem& jobs, const XMFLOAT4X4* worlds, const uint32_t* boundsIndices,
+	const CullBounds* boundsTable, size_t count, uint8_t* visible) const
+{
+	if (count <= PARALLEL_GRAIN || jobs.GetConcurrency() <= 1)
+	{
+		return Cull(worlds, boundsIndices, boundsTable, 0, count, visible);
+	}
+
+	const size_t grain = std::max(PARALLEL_GRAIN, (count + jobs.GetConcurrency() - 1) / jobs.GetConcurrency());
+	std::atomic<size_t> occludedCount = 0;
+	jobs.ParallelFor(count, grain, [&](size_t begin, size_t end)
+		{
+			occludedCount += Cull(worlds, boundsIndices, boundsTable, begin, end, visible);
+		});
+	return occludedCount;
+}
@@ -0,0 +1,125 @@
+#pragma once
+#ifndef _OCCLUSIONCULLER_H_
+#define _OCCLUSIONCULLER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <DirectXMath.h>
+
+class JobSystem;
+struct CullBounds;
+
+// CPU에서 가리는 물체(occluder)를 낮은 해상도 깊이 버퍼에 그리고, 물체 AABB가 그 뒤에 완전히 숨는지 검사하는 컬러
+// 가리는 물체 삼각형은 픽셀 4개를 SIMD 레지스터 하나로 한 번에 그린다. 앞뒷면을 가리지 않는다.
+// 화면을 TILE_HEIGHT 줄 띠로 나눠 띠마다 다른 스레드가 그리고, 그 띠의 타일(TILE_WIDTH x TILE_HEIGHT)마다 가장 먼 깊이를 남긴다.
+// 검사는 타일의 가장 먼 깊이로 먼저 보고, 타일 안이 다 가려지지 않았을 때만 픽셀을 본다.
+// 가리는 물체는 픽셀 중심으로 그리고, 검사하는 물체는 화면 사각형을 한 픽셀씩 넓혀 본다. 가장자리 틈으로 보이는 물체를 거르지 않는다.
+// GPU 없이 돌아가므로 DxCheck occlusion-test, occlusion-bench로 리눅스에서도 확인한다.
+// 사용법:
+//   culler.SetViewProjection(sceneWorld * view * proj);
+//   culler.ClearOccluders();
+//   culler.AddOccluder(world, positions, sizeof(Vertex), indices, indexCount);
+//   culler.Render(&jobs);
+//   size_t occluded = culler.Cull(worlds, meshIds, meshBoundsTable, 0, count, visible);
+
+// 컬링 결과 누적. 프레임 통계 구간마다 비운다.
+struct OcclusionCullStats
+{
+	uint64_t Frames = 0;
+	uint64_t Occluders = 0;
+	uint64_t Triangles = 0;
+	uint64_t Tested = 0;
+	uint64_t Occluded = 0;
+	double RenderSeconds = 0.0;
+	double TestSeconds = 0.0;
+
+	double GetOccludedFraction() const { return Tested ? static_cast<double>(Occluded) / Tested : 0.0; }
+
+	std::wstring ToString() const;
+};
+
+class OcclusionCuller
+{
+public:
+	static constexpr uint32_t TILE_WIDTH = 8;
+	static constexpr uint32_t TILE_HEIGHT = 8;
+	static constexpr uint32_t DEFAULT_WIDTH = 256;
+	static constexpr uint32_t DEFAULT_HEIGHT = 144;
+	// 병렬로 나눌 때 작업 하나가 맡을 최소 물체 수
+	static constexpr size_t PARALLEL_GRAIN = 1024;
+
+	OcclusionCuller();
+
+	// width, height는 타일 크기의 배수로 올린다.
+	void Resize(uint32_t width, uint32_t height);
+
+	// 물체 월드 행렬 뒤에 곱하는 행렬(장면 월드 * 뷰 * 프로젝션). 다음 Render부터 쓴다.
+	void SetViewProjection(DirectX::FXMMATRIX viewProjection);
+
+	void ClearOccluders();
+	// positions는 stride 바이트 간격으로 놓인 XMFLOAT3. 데이터는 Render가 끝날 때까지 살아 있어야 한다.
+	void AddOccluder(const DirectX::XMFLOAT4X4& world, const DirectX::XMFLOAT3* positions, size_t stride,
+		const uint16_t* indices, uint32_t indexCount);
+
+	// 깊이를 지우고 가리는 물체를 모두 그린 뒤 타일 깊이를 만든다. jobs가 있으면 띠마다 나눠 그린다.
+	void Render(JobSystem* jobs = nullptr);
+
+	// AABB가 그려 둔 깊이 뒤에 완전히 숨으면 false. 카메라 앞면을 넘거나 화면 밖이면 true
+	bool IsVisible(const DirectX::XMFLOAT4X4& world, const CullBounds& bounds) const;
+
+	// [begin, end) 중 visible[i]가 1인 물체를 검사해서 가려지면 0으로 바꾼다. 가려진 물체 수를 돌려준다.
+	// 읽기만 하므로 여러 스레드에서 서로 다른 구간으로 불러도 된다.
+	size_t Cull(const DirectX::XMFLOAT4X4* worlds, const uint32_t* boundsIndices, const CullBounds* boundsTable,
+		size_t begin, size_t end, uint8_t* visible) const;
+
+	// count가 PARALLEL_GRAIN보다 크면 jobs에 나눠서 Cull한다.
+	size_t CullParallel(JobSystem& jobs, const DirectX::XMFLOAT4X4* worlds, const uint32_t* boundsIndices,
+		const CullBounds* boundsTable, size_t count, uint8_t* visible) const;
+
+	uint32_t GetWidth() const { return mWidth; }
+	uint32_t GetHeight() const { return mHeight; }
+	// 행 우선, 0(가까움) ~ 1(멂). 아무것도 그리지 않은 픽셀은 1
+	const float* GetDepth() const { return mDepth.data(); }
+	size_t GetOccluderCount() const { return mOccluders.size(); }
+	// 마지막 Render에서 앞면으로 잘라낸 뒤 화면에 남은 삼각형 수
+	size_t GetTriangleCount() const { return mTriangles.size(); }
+
+private:
+	struct Occluder
+	{
+		DirectX::XMFLOAT4X4 World;
+		const DirectX::XMFLOAT3* Positions;
+		size_t Stride;
+		const uint16_t* Indices;
+		uint32_t IndexCount;
+	};
+
+	// 화면 좌표 삼각형 (픽셀 단위 x, y와 0 ~ 1 깊이)
+	struct ScreenTriangle
+	{
+		float X[3];
+		float Y[3];
+		float Z[3];
+	};
+
+	void SetupOccluder(const Occluder& occluder, std::vector<ScreenTriangle>& triangles) const;
+	void RasterizeBand(uint32_t band);
+
+	uint32_t mWidth = 0;
+	uint32_t mHeight = 0;
+	uint32_t mTilesX = 0;
+	uint32_t mTilesY = 0;
+	DirectX::XMFLOAT4X4 mViewProjection;
+
+	std::vector<float> mDepth;
+	// 타일마다 가장 먼 깊이
+	std::vector<float> mTileMaxDepth;
+
+	std::vector<Occluder> mOccluders;
+	std::vector<ScreenTriangle> mTriangles;
+	std::vector<std::vector<ScreenTriangle>> mOccluderTriangles;
+};
+
+#endif
@@ -0,0 +1,89 @@
+#include "RangeAllocator.h"
+#include <algorithm>
+#include <iterator>
+
+void RangeAllocator::Reset(uint64_t capacity)
+{
+	mFreeRanges.clear();
+	mCapacity = capacity;
+	mUsed = 0;
+	if (capacity)
+	{
+		mFreeRanges[0] = capacity;
+	}
+}
+
+uint64_t RangeAllocator::Allocate(uint64_t size, uint64_t alignment)
+{
+	if (!size || !alignment)
+	{
+		return INVALID_OFFSET;
+	}
+
+	for (auto it = mFreeRanges.begin(); it != mFreeRanges.end(); ++it)
+	{
+		const uint64_t rangeStart = it->first;
+		const uint64_t rangeEnd = it->first + it->second;
+		const uint64_t offset = (rangeStart + alignment - 1) & ~(alignment - 1);
+		if (offset >= rangeEnd || rangeEnd - offset < size)
+		{
+			continue;
+		}
+
+		mFreeRanges.erase(it);
+		// 정렬 때문에 앞에 남은 부분
+		if (offset > rangeStart)
+		{
+			mFreeRanges[rangeStart] = offset - rangeStart;
+		}
+		if (offset + size < rangeEnd)
+		{
+			mFreeRanges[offset + size] = rangeEnd - (offset + size);
+		}
+		mUsed += size;
+		return offset;
+	}
+	return INVALID_OFFSET;
+}
+
+void RangeAllocator::Free(uint64_t offset, uint64_t size)
+{
+	if (!size)
+	{
+		return;
+	}
+	mUsed -= size;
+
+	auto next = mFreeRanges.lower_bound(offset);
+
+	// 앞 구간과 붙어 있으면 합친다.
+	if (next != mFreeRanges.begin())
+	{
+		auto prev = std::prev(next);
+		if (prev->first + prev->second == offset)
+		{
+			offset = prev->first;
+			size += prev->second;
+			mFreeRanges.erase(prev);
+		}
+	}
+
+	// 뒤 구간과 붙어 있으면 합친다.
+	if (next != mFreeRanges.end() && offset + size == next->first)
+	{
+		size += next->second;
+		mFreeRanges.erase(next);
+	}
+
+	mFreeRanges[offset] = size;
+}
+
+uint64_t RangeAllocator::GetLargestFreeRange() const
+{
+	uint64_t largest = 0;
+	for (const auto& range : mFreeRanges)
+	{
+		largest = std::max(largest, range.second);
+	}
+	return largest;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#ifndef _RANGEALLOCATOR_H_
+#define _RANGEALLOCATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+
+// 구간 할당기 (free-list)
+// 비어 있는 구간을 시작 위치 순서로 들고 있다가 처음 맞는 구간(first-fit)에서 잘라 준다.
+// 정렬 때문에 앞에 남는 부분은 빈 구간으로 남긴다. 돌려받은 구간은 앞뒤 빈 구간과 합친다.
+// 단위는 호출하는 쪽이 정한다. (GeometryPool은 버텍스/인덱스 개수, ResourceHeapAllocator는 바이트)
+// 사용법:
+//   allocator.Reset(capacity);
+//   auto offset = allocator.Allocate(size, alignment);
+//   if (offset != RangeAllocator::INVALID_OFFSET) { ...; allocator.Free(offset, size); }
+class RangeAllocator
+{
+public:
+	static constexpr uint64_t INVALID_OFFSET = ~0ull;
+
+	void Reset(uint64_t capacity);
+
+	// alignment는 2의 거듭제곱. 실패하면 INVALID_OFFSET
+	uint64_t Allocate(uint64_t size, uint64_t alignment = 1);
+	void Free(uint64_t offset, uint64_t size);
+
+	uint64_t GetCapacity() const { return mCapacity; }
+	uint64_t GetUsed() const { return mUsed; }
+	uint64_t GetLargestFreeRange() const;
+	size_t GetFreeRangeCount() const { return mFreeRanges.size(); }
+	bool IsEmpty() const { return mUsed == 0; }
+
+private:
+	// 시작 위치 -> 크기
+	std::map<uint64_t, uint64_t> mFreeRanges;
+	uint64_t mCapacity = 0;
+	uint64_t mUsed = 0;
+};
+
+#endif
@@ -0,0 +1,332 @@
+#include "ResourceHeapAllocator.h"
+#include <algorithm>
+#include <format>
+#include "d3dx12.h"
+
+using Microsoft::WRL::ComPtr;
+
+struct ResourceHeapAllocator::Block
+{
+	ComPtr<ID3D12Heap> Heap;
+	RangeAllocator Ranges;
+	UINT AllocationCount = 0;
+};
+
+struct ResourceHeapAllocator::Pool
+{
+	D3D12_HEAP_TYPE HeapType = D3D12_HEAP_TYPE_DEFAULT;
+	ResourceHeapCategory Category = ResourceHeapCategory::Buffers;
+	// 놓은 블록은 Heap이 nullptr인 채로 남겨서 다른 블록의 번호가 바뀌지 않게 한다.
+	std::vector<Block> Blocks;
+};
+
+namespace
+{
+	D3D12_HEAP_FLAGS GetHeapFlags(ResourceHeapCategory category)
+	{
+		switch (category)
+		{
+		case ResourceHeapCategory::Buffers:
+			return D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+		case ResourceHeapCategory::Textures:
+			return D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+		default:
+			return D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+		}
+	}
+
+	// MSAA 렌더 타겟도 놓을 수 있게 RT/DS 블록은 4MB에 정렬한다.
+	UINT64 GetHeapAlignment(ResourceHeapCategory category)
+	{
+		return category == ResourceHeapCategory::RenderTargetTextures
+			? D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT
+			: D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+	}
+
+	const wchar_t* GetHeapTypeName(D3D12_HEAP_TYPE heapType)
+	{
+		switch (heapType)
+		{
+		case D3D12_HEAP_TYPE_DEFAULT:
+			return L"default";
+		case D3D12_HEAP_TYPE_UPLOAD:
+			return L"upload";
+		case D3D12_HEAP_TYPE_READBACK:
+			return L"readback";
+		default:
+			return L"custom";
+		}
+	}
+
+	const wchar_t* GetCategoryName(ResourceHeapCategory category)
+	{
+		switch (category)
+		{
+		case ResourceHeapCategory::Buffers:
+			return L"buffers";
+		case ResourceHeapCategory::Textures:
+			return L"textures";
+		default:
+			return L"rt/ds";
+		}
+	}
+}
+
+std::wstring ResourceHeapStats::ToString() const
+{
+	std::wstring text = std::format(L"ResourceHeapAllocator: {:.2f} / {:.2f} MB used, {} placed\n",
+		TotalUsedBytes / (1024.0 * 1024.0), TotalReservedBytes / (1024.0 * 1024.0), PlacedResourceCount);
+	for (const auto& pool : Pools)
+	{
+		text += std::format(L"  {:8} {:8}: {} blocks, {} allocations, {:.2f} / {:.2f} MB, largest free {:.2f} MB, {} free ranges, fragmentation {:.2f}\n",
+			GetHeapTypeName(pool.HeapType), GetCategoryName(pool.Category), pool.BlockCount, pool.AllocationCount,
+			pool.UsedBytes / (1024.0 * 1024.0), pool.ReservedBytes / (1024.0 * 1024.0), pool.LargestFreeRange / (1024.0 * 1024.0),
+			pool.FreeRangeCount, pool.GetFragmentation());
+	}
+	return text;
+}
+
+ResourceHeapAllocator::ResourceHeapAllocator() = default;
+
+ResourceHeapAllocator::~ResourceHeapAllocator() = default;
+
+void ResourceHeapAllocator::Initialize(ID3D12Device* device, UINT64 blockSize)
+{
+	Release();
+	mDevice = device;
+	mBlockSize = blockSize;
+}
+
+void ResourceHeapAllocator::Release()
+{
+	mPools.clear();
+	mPlacedResourceCount = 0;
+}
+
+ResourceHeapCategory ResourceHeapAllocator::GetCategory(const D3D12_RESOURCE_DESC& desc)
+{
+	if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+	{
+		return ResourceHeapCategory::Buffers;
+	}
+	if (desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL))
+	{
+		return ResourceHeapCategory::RenderTargetTextures;
+	}
+	return ResourceHeapCategory::Textures;
+}
+
+D3D12_RESOURCE_ALLOCATION_INFO ResourceHeapAllocator::GetAllocationInfo(D3D12_RESOURCE_DESC& desc) const
+{
+	// 작은 텍스쳐(64KB 안에 들어가는 것)는 4KB 정렬이 가능하다. 장치가 거절하면 기본 정렬로 다시 묻는다.
+	if (desc.Dimension != D3D12_RESOURCE_DIMENSION_BUFFER && GetCategory(desc) == ResourceHeapCategory::Textures
+		&& desc.SampleDesc.Count <= 1 && desc.Alignment == 0)
+	{
+		desc.Alignment = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+		const D3D12_RESOURCE_ALLOCATION_INFO smallInfo = mDevice->GetResourceAllocationInfo(0, 1, &desc);
+		if (smallInfo.Alignment == D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT)
+		{
+			return smallInfo;
+		}
+		desc.Alignment = 0;
+	}
+	return mDevice->GetResourceAllocationInfo(0, 1, &desc);
+}
+
+ResourceHeapAllocator::Pool& ResourceHeapAllocator::GetPool(D3D12_HEAP_TYPE heapType, ResourceHeapCategory category, UINT& poolIndex)
+{
+	for (size_t i = 0; i < mPools.size(); i++)
+	{
+		if (mPools[i]->HeapType == heapType && mPools[i]->Category == category)
+		{
+			poolIndex = static_cast<UINT>(i);
+			return *mPools[i];
+		}
+	}
+
+	auto pool = std::make_unique<Pool>();
+	pool->HeapType = heapType;
+	pool->Category = category;
+	mPools.push_back(std::move(pool));
+	poolIndex = static_cast<UINT>(mPools.size() - 1);
+	return *mPools.back();
+}
+
+HRESULT ResourceHeapAllocator::AllocateRegion(D3D12_HEAP_TYPE heapType, ResourceHeapCategory category, UINT64 size, UINT64 alignment,
+	HeapAllocation& allocation)
+{
+	if (!mDevice || !size)
+	{
+		return E_INVALIDARG;
+	}
+	if (!alignment)
+	{
+		alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+	}
+
+	UINT poolIndex = 0;
+	Pool& pool = GetPool(heapType, category, poolIndex);
+
+	auto place = [&](UINT blockIndex) -> bool
+	{
+		Block& block = pool.Blocks[blockIndex];
+		if (!block.Heap)
+		{
+			return false;
+		}
+		const UINT64 offset = block.Ranges.Allocate(size, alignment);
+		if (offset == RangeAllocator::INVALID_OFFSET)
+		{
+			return false;
+		}
+		block.AllocationCount++;
+		allocation.Heap = block.Heap.Get();
+		allocation.Offset = offset;
+		allocation.Size = size;
+		allocation.PoolIndex = poolIndex;
+		allocation.BlockIndex = blockIndex;
+		return true;
+	};
+
+	for (UINT i = 0; i < pool.Blocks.size(); i++)
+	{
+		if (place(i))
+		{
+			return S_OK;
+		}
+	}
+
+	// 들어갈 블록이 없으면 새로 만든다. 블록보다 큰 리소스는 딱 맞는 크기로 만든다.
+	const UINT64 heapAlignment = GetHeapAlignment(category);
+	const UINT64 blockSize = (std::max(mBlockSize, size) + heapAlignment - 1) & ~(heapAlignment - 1);
+
+	D3D12_HEAP_DESC heapDesc = {};
+	heapDesc.SizeInBytes = blockSize;
+	heapDesc.Properties = CD3DX12_HEAP_PROPERTIES(heapType);
+	heapDesc.Alignment = heapAlignment;
+	heapDesc.Flags = GetHeapFlags(category);
+
+	ComPtr<ID3D12Heap> heap;
+	HRESULT hr = mDevice->CreateHeap(&heapDesc, IID_PPV_ARGS(&heap));
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	// 놓았던 자리가 있으면 다시 쓴다.
+	UINT blockIndex = static_cast<UINT>(pool.Blocks.size());
+	for (UINT i = 0; i < pool.Blocks.size(); i++)
+	{
+		if (!pool.Blocks[i].Heap)
+		{
+			blockIndex = i;
+			break;
+		}
+	}
+	if (blockIndex == pool.Blocks.size())
+	{
+		pool.Blocks.emplace_back();
+	}
+
+	Block& block = pool.Blocks[blockIndex];
+	block.Heap = heap;
+	block.Ranges.Reset(blockSize);
+	block.AllocationCount = 0;
+
+	return place(blockIndex) ? S_OK : E_OUTOFMEMORY;
+}
+
+HRESULT ResourceHeapAllocator::CreateResource(const D3D12_RESOURCE_DESC& desc, D3D12_HEAP_TYPE heapType, D3D12_RESOURCE_STATES initialState,
+	const D3D12_CLEAR_VALUE* clearValue, ComPtr<ID3D12Resource>& resource, HeapAllocation& allocation)
+{
+	if (!mDevice)
+	{
+		return E_INVALIDARG;
+	}
+
+	D3D12_RESOURCE_DESC placedDesc = desc;
+	const D3D12_RESOURCE_ALLOCATION_INFO info = GetAllocationInfo(placedDesc);
+	if (info.SizeInBytes == UINT64_MAX)
+	{
+		return E_INVALIDARG;
+	}
+
+	HRESULT hr = AllocateRegion(heapType, GetCategory(placedDesc), info.SizeInBytes, info.Alignment, allocation);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	hr = mDevice->CreatePlacedResource(allocation.Heap, allocation.Offset, &placedDesc, initialState, clearValue,
+		IID_PPV_ARGS(resource.ReleaseAndGetAddressOf()));
+	if (FAILED(hr))
+	{
+		Free(allocation);
+		return hr;
+	}
+
+	mPlacedResourceCount++;
+	return S_OK;
+}
+
+void ResourceHeapAllocator::Free(HeapAllocation& allocation)
+{
+	if (!allocation.IsValid() || allocation.PoolIndex >= mPools.size())
+	{
+		return;
+	}
+
+	Pool& pool = *mPools[allocation.PoolIndex];
+	Block& block = pool.Blocks[allocation.BlockIndex];
+	block.Ranges.Free(allocation.Offset, allocation.Size);
+	block.AllocationCount--;
+
+	// 빈 블록은 놓는다. 단, 풀에 남은 마지막 블록은 바로 다시 쓸 수 있게 남겨 둔다.
+	if (block.AllocationCount == 0)
+	{
+		UINT liveBlocks = 0;
+		for (const auto& other : pool.Blocks)
+		{
+			liveBlocks += other.Heap ? 1 : 0;
+		}
+		if (liveBlocks > 1 || block.Ranges.GetCapacity() > mBlockSize)
+		{
+			block.Heap.Reset();
+			block.Ranges.Reset(0);
+		}
+	}
+
+	allocation = HeapAllocation();
+}
+
+ResourceHeapStats ResourceHeapAllocator::GetStats() const
+{
+	ResourceHeapStats stats;
+	stats.PlacedResourceCount = mPlacedResourceCount;
+
+	for (const auto& pool : mPools)
+	{
+		ResourceHeapPoolStats poolStats;
+		poolStats.HeapType = pool->HeapType;
+		poolStats.Category = pool->Category;
+		for (const auto& block : pool->Blocks)
+		{
+			if (!block.Heap)
+			{
+				continue;
+			}
+			poolStats.BlockCount++;
+			poolStats.AllocationCount += block.AllocationCount;
+			poolStats.ReservedBytes += block.Ranges.GetCapacity();
+			poolStats.UsedBytes += block.Ranges.GetUsed();
+			poolStats.LargestFreeRange = std::max(poolStats.LargestFreeRange, block.Ranges.GetLargestFreeRange());
+			poolStats.FreeRangeCount += static_cast<UINT>(block.Ranges.GetFreeRangeCount());
+		}
+		poolStats.FreeBytes = poolStats.ReservedBytes - poolStats.UsedBytes;
+
+		stats.TotalReservedBytes += poolStats.ReservedBytes;
+		stats.TotalUsedBytes += poolStats.UsedBytes;
+		stats.Pools.push_back(poolStats);
+	}
+	return stats;
+}
@@ -0,0 +1,121 @@
+#pragma once
+#ifndef _RESOURCEHEAPALLOCATOR_H_
+#define _RESOURCEHEAPALLOCATOR_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+// DxCheck: DirectX-Headers의 d3d12.h를 Windows 형 정의 없이 쓴다.
+#include <wsl/winadapter.h>
+#endif
+#include <d3d12.h>
+#ifndef _WIN32
+// __declspec(uuid) 대신 IID_PPV_ARGS가 찾는 uuidof 특수화
+#include <dxguids/dxguids.h>
+#endif
+#include <wrl/client.h>
+#include "RangeAllocator.h"
+
+// 큰 ID3D12Heap 블록을 미리 잡아 두고 CreatePlacedResource로 리소스를 그 안에 놓는 할당기
+// CreateCommittedResource처럼 리소스마다 암묵적인 힙을 만들지 않는다.
+// 힙 종류(DEFAULT/UPLOAD/READBACK)와 리소스 분류(버퍼/일반 텍스쳐/RT·DS 텍스쳐)마다 블록을 따로 둔다.
+// (리소스 힙 tier 1에서는 분류를 섞을 수 없다)
+// D3D12_RESOURCE_ALLOCATION_INFO의 크기와 정렬을 그대로 따르고, 작은 텍스쳐는 4KB 정렬을 먼저 시도한다.
+// 블록보다 큰 리소스는 그 크기에 맞는 블록을 따로 만든다.
+// 사용법:
+//   allocator.Initialize(device);
+//   HeapAllocation allocation;
+//   allocator.CreateResource(desc, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COMMON, nullptr, resource, allocation);
+//   ...GPU가 다 쓴 뒤...
+//   resource.Reset(); allocator.Free(allocation);
+
+enum class ResourceHeapCategory
+{
+	Buffers,
+	Textures,
+	RenderTargetTextures,
+	Count,
+};
+
+struct HeapAllocation
+{
+	ID3D12Heap* Heap = nullptr;
+	UINT64 Offset = 0;
+	UINT64 Size = 0;
+
+	// Free할 때 찾아가는 위치
+	UINT PoolIndex = 0;
+	UINT BlockIndex = 0;
+
+	bool IsValid() const { return Heap != nullptr; }
+};
+
+struct ResourceHeapPoolStats
+{
+	D3D12_HEAP_TYPE HeapType = D3D12_HEAP_TYPE_DEFAULT;
+	ResourceHeapCategory Category = ResourceHeapCategory::Buffers;
+	UINT BlockCount = 0;
+	UINT AllocationCount = 0;
+	UINT64 ReservedBytes = 0;
+	UINT64 UsedBytes = 0;
+	UINT64 FreeBytes = 0;
+	UINT64 LargestFreeRange = 0;
+	UINT FreeRangeCount = 0;
+
+	// 빈 공간이 조각난 정도. 0이면 빈 공간이 한 구간, 1에 가까울수록 잘게 흩어져 있다.
+	double GetFragmentation() const { return FreeBytes ? 1.0 - static_cast<double>(LargestFreeRange) / FreeBytes : 0.0; }
+};
+
+struct ResourceHeapStats
+{
+	std::vector<ResourceHeapPoolStats> Pools;
+	UINT64 TotalReservedBytes = 0;
+	UINT64 TotalUsedBytes = 0;
+	UINT PlacedResourceCount = 0;
+
+	std::wstring ToString() const;
+};
+
+class ResourceHeapAllocator
+{
+public:
+	static constexpr UINT64 DEFAULT_BLOCK_SIZE = 64ull * 1024 * 1024;
+
+	ResourceHeapAllocator();
+	~ResourceHeapAllocator();
+
+	void Initialize(ID3D12Device* device, UINT64 blockSize = DEFAULT_BLOCK_SIZE);
+	// 모든 블록을 놓는다. 이 할당기로 만든 리소스는 먼저 해제되어 있어야 한다.
+	void Release();
+
+	// 리소스 분류는 desc에서 정한다.
+	HRESULT CreateResource(const D3D12_RESOURCE_DESC& desc, D3D12_HEAP_TYPE heapType, D3D12_RESOURCE_STATES initialState,
+		const D3D12_CLEAR_VALUE* clearValue, Microsoft::WRL::ComPtr<ID3D12Resource>& resource, HeapAllocation& allocation);
+
+	// GPU가 더 이상 쓰지 않을 때 호출. 블록이 모두 비면 힙도 놓는다.
+	void Free(HeapAllocation& allocation);
+
+	// desc가 들어갈 분류
+	static ResourceHeapCategory GetCategory(const D3D12_RESOURCE_DESC& desc);
+	// 작은 텍스쳐면 4KB 정렬로 바꿔서 크기/정렬을 돌려준다.
+	D3D12_RESOURCE_ALLOCATION_INFO GetAllocationInfo(D3D12_RESOURCE_DESC& desc) const;
+
+	ResourceHeapStats GetStats() const;
+
+private:
+	struct Block;
+	struct Pool;
+
+	Pool& GetPool(D3D12_HEAP_TYPE heapType, ResourceHeapCategory category, UINT& poolIndex);
+	// 블록에서 빈 구간을 잡는다. 들어갈 블록이 없으면 새로 만든다.
+	HRESULT AllocateRegion(D3D12_HEAP_TYPE heapType, ResourceHeapCategory category, UINT64 size, UINT64 alignment,
+		HeapAllocation& allocation);
+
+	ID3D12Device* mDevice = nullptr;
+	UINT64 mBlockSize = DEFAULT_BLOCK_SIZE;
+	std::vector<std::unique_ptr<Pool>> mPools;
+	UINT mPlacedResourceCount = 0;
+};
+
+#endif
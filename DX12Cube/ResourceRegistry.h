@@ -0,0 +1,175 @@
+#pragma once
+#ifndef _RESOURCEREGISTRY_H_
+#define _RESOURCEREGISTRY_H_
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// 이름으로 등록한 리소스를 평평한 배열에 두고 핸들로 찾는 표
+// 이름 -> 핸들은 로드할 때 한 번만 바꾸고, 그 뒤로는 핸들의 배열 위치로 바로 읽는다. (문자열 해시 없음)
+// 핸들은 타입마다 따로라서 메쉬 핸들로 재질 표를 읽으면 컴파일 오류가 난다.
+// Remove한 자리는 세대(generation)를 올리고 다음 Add에서 다시 쓴다. 지운 뒤 남아 있던 옛 핸들은 IsValid가 false다.
+// 배열이 커지면 값의 주소가 바뀌므로 포인터 말고 핸들을 들고 있는다.
+// 사용법:
+//   ResourceRegistry<MeshData> meshes;
+//   auto handle = meshes.Intern("box");          // 로드할 때
+//   meshes[handle].indexCount = 36;
+//   ... 매 프레임 ...
+//   const auto& mesh = meshes[handle];           // 배열 위치로 바로
+//   meshes.ForEach([](auto handle, MeshData& mesh) { mesh.Release(); });
+
+template <typename T>
+struct ResourceHandle
+{
+	static constexpr uint32_t INVALID_INDEX = ~0u;
+
+	uint32_t Index = INVALID_INDEX;
+	uint32_t Generation = 0;
+
+	bool IsValid() const { return Index != INVALID_INDEX; }
+	bool operator==(const ResourceHandle& other) const { return Index == other.Index && Generation == other.Generation; }
+	bool operator!=(const ResourceHandle& other) const { return !(*this == other); }
+};
+
+template <typename T>
+class ResourceRegistry
+{
+public:
+	using Handle = ResourceHandle<T>;
+
+	// 이름이 이미 있으면 그 핸들, 없으면 기본값으로 새로 만든다.
+	Handle Intern(const std::string& name)
+	{
+		auto it = mNameToIndex.find(name);
+		if (it != mNameToIndex.end())
+		{
+			return { it->second, mGenerations[it->second] };
+		}
+
+		uint32_t index;
+		if (!mFreeIndices.empty())
+		{
+			index = mFreeIndices.back();
+			mFreeIndices.pop_back();
+		}
+		else
+		{
+			index = static_cast<uint32_t>(mValues.size());
+			mValues.emplace_back();
+			mGenerations.push_back(0);
+			mNames.emplace_back();
+			mAlive.push_back(false);
+		}
+
+		mNames[index] = name;
+		mAlive[index] = true;
+		mNameToIndex.emplace(name, index);
+		mCount++;
+		return { index, mGenerations[index] };
+	}
+
+	// 같은 이름이 있으면 값을 바꾼다.
+	Handle Add(const std::string& name, T value)
+	{
+		Handle handle = Intern(name);
+		mValues[handle.Index] = std::move(value);
+		return handle;
+	}
+
+	// 없으면 잘못된 핸들. 로드할 때만 쓴다.
+	Handle Find(const std::string& name) const
+	{
+		auto it = mNameToIndex.find(name);
+		if (it == mNameToIndex.end())
+		{
+			return {};
+		}
+		return { it->second, mGenerations[it->second] };
+	}
+
+	// 값은 기본값으로 되돌린다. 리소스 해제는 호출하는 쪽이 먼저 한다.
+	void Remove(Handle handle)
+	{
+		if (!IsValid(handle))
+		{
+			return;
+		}
+
+		mNameToIndex.erase(mNames[handle.Index]);
+		mValues[handle.Index] = T();
+		mNames[handle.Index].clear();
+		mAlive[handle.Index] = false;
+		mGenerations[handle.Index]++;
+		mFreeIndices.push_back(handle.Index);
+		mCount--;
+	}
+
+	bool IsValid(Handle handle) const
+	{
+		return handle.Index < mValues.size() && mAlive[handle.Index] && mGenerations[handle.Index] == handle.Generation;
+	}
+
+	T& operator[](Handle handle) { assert(IsValid(handle)); return mValues[handle.Index]; }
+	const T& operator[](Handle handle) const { assert(IsValid(handle)); return mValues[handle.Index]; }
+
+	// 지운 핸들이면 nullptr
+	T* Get(Handle handle) { return IsValid(handle) ? &mValues[handle.Index] : nullptr; }
+	const T* Get(Handle handle) const { return IsValid(handle) ? &mValues[handle.Index] : nullptr; }
+
+	const std::string& GetName(Handle handle) const { assert(IsValid(handle)); return mNames[handle.Index]; }
+	size_t GetCount() const { return mCount; }
+
+	// 살아 있는 항목을 배열 순서(처음 등록한 순서, 빈 자리는 다시 쓴 순서)로 돈다.
+	template <typename Fn>
+	void ForEach(Fn&& fn)
+	{
+		for (uint32_t i = 0; i < mValues.size(); i++)
+		{
+			if (mAlive[i])
+			{
+				fn(Handle{ i, mGenerations[i] }, mValues[i]);
+			}
+		}
+	}
+
+	template <typename Fn>
+	void ForEach(Fn&& fn) const
+	{
+		for (uint32_t i = 0; i < mValues.size(); i++)
+		{
+			if (mAlive[i])
+			{
+				fn(Handle{ i, mGenerations[i] }, mValues[i]);
+			}
+		}
+	}
+
+	void Clear()
+	{
+		mValues.clear();
+		mGenerations.clear();
+		mNames.clear();
+		mAlive.clear();
+		mFreeIndices.clear();
+		mNameToIndex.clear();
+		mCount = 0;
+	}
+
+private:
+	// 핸들의 Index로 읽는 배열. 값만 따로 두어서 자주 읽는 쪽이 빽빽하다.
+	std::vector<T> mValues;
+	std::vector<uint32_t> mGenerations;
+	std::vector<std::string> mNames;
+	std::vector<bool> mAlive;
+	std::vector<uint32_t> mFreeIndices;
+	size_t mCount = 0;
+
+	std::unordered_map<std::string, uint32_t> mNameToIndex;
+};
+
+#endif
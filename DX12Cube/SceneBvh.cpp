@@ -0,0 +1,691 @@
+#include "SceneBvh.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <utility>
+#include "FrustumCuller.h"
+#include "JobSystem.h"
+
+using namespace DirectX;
+
+namespace
+{
+	const uint32_t NO_PARENT = ~0u;
+	// 탐색 스택 크기. 트리 깊이보다 커야 한다.
+	const int STACK_SIZE = 128;
+	// 이보다 깊어지면 SAH 대신 가운데에서 잘라 깊이를 묶어 둔다.
+	const uint32_t MAX_SAH_DEPTH = 64;
+
+	struct Aabb
+	{
+		float Min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+		float Max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+		void Grow(const float* minimum, const float* maximum)
+		{
+			for (int a = 0; a < 3; a++)
+			{
+				Min[a] = std::min(Min[a], minimum[a]);
+				Max[a] = std::max(Max[a], maximum[a]);
+			}
+		}
+		void Grow(const Aabb& other) { Grow(other.Min, other.Max); }
+		void Grow(const BvhBounds& bounds) { Grow(&bounds.Min.x, &bounds.Max.x); }
+		void GrowPoint(const float* point) { Grow(point, point); }
+
+		// 겉넓이의 절반. 비교에만 쓴다.
+		float HalfArea() const
+		{
+			if (Min[0] > Max[0])
+			{
+				return 0.0f;
+			}
+			const float x = Max[0] - Min[0];
+			const float y = Max[1] - Min[1];
+			const float z = Max[2] - Min[2];
+			return x * y + y * z + z * x;
+		}
+	};
+
+	void SetNodeBounds(BvhNode& node, const Aabb& aabb)
+	{
+		node.Min = XMFLOAT3(aabb.Min[0], aabb.Min[1], aabb.Min[2]);
+		node.Max = XMFLOAT3(aabb.Max[0], aabb.Max[1], aabb.Max[2]);
+	}
+
+	// 부분 트리 하나를 만든다. 노드 번호는 nodes 안의 위치다.
+	struct BvhBuilder
+	{
+		const BvhBounds* Bounds;
+		const XMFLOAT3* Centroids;
+		uint32_t* Items;
+		std::vector<BvhNode>& Nodes;
+
+		// 0이 아니면 물체가 이보다 적은 노드는 나누지 않고 Deferred에 (노드, 깊이)로 남긴다. (병렬 빌드의 위쪽 단계)
+		size_t DeferBelow = 0;
+		std::vector<std::pair<uint32_t, uint32_t>>* Deferred = nullptr;
+
+		Aabb ComputeBounds(uint32_t first, uint32_t count, Aabb& centroidBounds) const
+		{
+			Aabb bounds;
+			for (uint32_t i = first; i < first + count; i++)
+			{
+				bounds.Grow(Bounds[Items[i]]);
+				centroidBounds.GrowPoint(&Centroids[Items[i]].x);
+			}
+			return bounds;
+		}
+
+		void Subdivide(uint32_t nodeIndex, uint32_t first, uint32_t count, uint32_t depth)
+		{
+			Aabb centroidBounds;
+			const Aabb bounds = ComputeBounds(first, count, centroidBounds);
+			{
+				auto& node = Nodes[nodeIndex];
+				SetNodeBounds(node, bounds);
+				node.LeftOrFirst = first;
+				node.Count = count;
+			}
+
+			if (count <= SceneBvh::MAX_LEAF_SIZE)
+			{
+				return;
+			}
+			if (Deferred && count < DeferBelow)
+			{
+				Deferred->emplace_back(nodeIndex, depth);
+				return;
+			}
+
+			if (depth >= MAX_SAH_DEPTH)
+			{
+				// 무게중심이 가장 넓게 퍼진 축의 가운데 값에서 반으로 나눈다.
+				int axis = 0;
+				for (int a = 1; a < 3; a++)
+				{
+					if (centroidBounds.Max[a] - centroidBounds.Min[a] > centroidBounds.Max[axis] - centroidBounds.Min[axis])
+					{
+						axis = a;
+					}
+				}
+				std::nth_element(Items + first, Items + first + count / 2, Items + first + count, [&](uint32_t a, uint32_t b)
+					{
+						return (&Centroids[a].x)[axis] < (&Centroids[b].x)[axis];
+					});
+				Split(nodeIndex, first, count, count / 2, depth);
+				return;
+			}
+
+			// 축마다 무게중심을 BIN_COUNT 구간에 넣고, 구간 경계마다 왼쪽/오른쪽 SAH 비용을 구한다.
+			int bestAxis = -1;
+			uint32_t bestSplit = 0;
+			float bestCost = FLT_MAX;
+			// 물체 목록은 한 번만 읽고 세 축의 구간을 같이 채운다.
+			Aabb binBounds[3][SceneBvh::BIN_COUNT];
+			uint32_t binCounts[3][SceneBvh::BIN_COUNT] = { };
+			float scales[3];
+			for (int axis = 0; axis < 3; axis++)
+			{
+				const float extent = centroidBounds.Max[axis] - centroidBounds.Min[axis];
+				scales[axis] = extent > 0.0f ? SceneBvh::BIN_COUNT / extent : 0.0f;
+			}
+			for (uint32_t i = first; i < first + count; i++)
+			{
+				const uint32_t item = Items[i];
+				for (int axis = 0; axis < 3; axis++)
+				{
+					const float offset = (&Centroids[item].x)[axis] - centroidBounds.Min[axis];
+					const uint32_t bin = std::min(SceneBvh::BIN_COUNT - 1, static_cast<uint32_t>(offset * scales[axis]));
+					binCounts[axis][bin]++;
+					binBounds[axis][bin].Grow(Bounds[item]);
+				}
+			}
+
+			for (int axis = 0; axis < 3; axis++)
+			{
+				if (scales[axis] == 0.0f)
+				{
+					continue;
+				}
+
+				// 왼쪽에서 오른쪽으로 쌓은 값과 반대로 쌓은 값
+				float leftArea[SceneBvh::BIN_COUNT - 1];
+				uint32_t leftCount[SceneBvh::BIN_COUNT - 1];
+				Aabb left;
+				uint32_t leftSum = 0;
+				for (uint32_t i = 0; i < SceneBvh::BIN_COUNT - 1; i++)
+				{
+					left.Grow(binBounds[axis][i]);
+					leftSum += binCounts[axis][i];
+					leftArea[i] = leftSum ? left.HalfArea() : 0.0f;
+					leftCount[i] = leftSum;
+				}
+				Aabb right;
+				uint32_t rightSum = 0;
+				for (uint32_t i = SceneBvh::BIN_COUNT - 1; i > 0; i--)
+				{
+					right.Grow(binBounds[axis][i]);
+					rightSum += binCounts[axis][i];
+					if (leftCount[i - 1] == 0 || rightSum == 0)
+					{
+						continue;
+					}
+					const float cost = leftCount[i - 1] * leftArea[i - 1] + rightSum * right.HalfArea();
+					if (cost < bestCost)
+					{
+						bestCost = cost;
+						bestAxis = axis;
+						bestSplit = i;
+					}
+				}
+			}
+
+			// 나누는 비용(노드 하나 더 내려가기 + 양쪽 물체)이 잎으로 두는 비용보다 크면 잎으로 둔다.
+			const float leafCost = count * bounds.HalfArea();
+			const float traversalCost = bounds.HalfArea();
+			uint32_t leftCountFinal = 0;
+			if (bestAxis >= 0 && (bestCost + traversalCost < leafCost || count > 4 * SceneBvh::MAX_LEAF_SIZE))
+			{
+				const float minimum = centroidBounds.Min[bestAxis];
+				const float scale = SceneBvh::BIN_COUNT / (centroidBounds.Max[bestAxis] - minimum);
+				auto middle = std::partition(Items + first, Items + first + count, [&](uint32_t item)
+					{
+						const float offset = (&Centroids[item].x)[bestAxis] - minimum;
+						return std::min(SceneBvh::BIN_COUNT - 1, static_cast<uint32_t>(offset * scale)) < bestSplit;
+					});
+				leftCountFinal = static_cast<uint32_t>(middle - (Items + first));
+			}
+			else if (bestAxis < 0 && count > 4 * SceneBvh::MAX_LEAF_SIZE)
+			{
+				// 무게중심이 모두 같다. 큰 잎이 생기지 않게 반으로 자른다.
+				leftCountFinal = count / 2;
+			}
+
+			if (leftCountFinal == 0 || leftCountFinal == count)
+			{
+				return;
+			}
+			Split(nodeIndex, first, count, leftCountFinal, depth);
+		}
+
+		// Items[first, first + count)가 이미 나뉘어 있다. 자식 두 개를 붙이고 내려간다.
+		void Split(uint32_t nodeIndex, uint32_t first, uint32_t count, uint32_t leftCount, uint32_t depth)
+		{
+			const uint32_t leftChild = static_cast<uint32_t>(Nodes.size());
+			Nodes.emplace_back();
+			Nodes.emplace_back();
+			Nodes[nodeIndex].LeftOrFirst = leftChild;
+			Nodes[nodeIndex].Count = 0;
+
+			Subdivide(leftChild, first, leftCount, depth + 1);
+			Subdivide(leftChild + 1, first + leftCount, count - leftCount, depth + 1);
+		}
+	};
+
+	bool Overlaps(const BvhBounds& bounds, const XMFLOAT3& center, float radiusSq)
+	{
+		// AABB 안에서 구 중심에 가장 가까운 점까지의 거리
+		const float* minimum = &bounds.Min.x;
+		const float* maximum = &bounds.Max.x;
+		const float* point = &center.x;
+		float distanceSq = 0.0f;
+		for (int a = 0; a < 3; a++)
+		{
+			const float v = std::clamp(point[a], minimum[a], maximum[a]) - point[a];
+			distanceSq += v * v;
+		}
+		return distanceSq <= radiusSq;
+	}
+
+	// 슬랩 검사. 닿으면 들어가는 거리를 돌려주고, 아니면 FLT_MAX
+	float IntersectRay(const XMFLOAT3& minimum, const XMFLOAT3& maximum, const float* origin, const float* inverseDirection, float maxDistance)
+	{
+		const float* lo = &minimum.x;
+		const float* hi = &maximum.x;
+		float tMin = 0.0f;
+		float tMax = maxDistance;
+		for (int a = 0; a < 3; a++)
+		{
+			float t0 = (lo[a] - origin[a]) * inverseDirection[a];
+			float t1 = (hi[a] - origin[a]) * inverseDirection[a];
+			if (t0 > t1)
+			{
+				std::swap(t0, t1);
+			}
+			tMin = std::max(tMin, t0);
+			tMax = std::min(tMax, t1);
+			if (tMin > tMax)
+			{
+				return FLT_MAX;
+			}
+		}
+		return tMin;
+	}
+
+	// 평면 안쪽 판정: 노드가 평면 밖에 완전히 있으면 -1, 완전히 안이면 1, 걸치면 0
+	int ClassifyPlane(const XMFLOAT4& plane, const XMFLOAT3& minimum, const XMFLOAT3& maximum)
+	{
+		// 평면 법선 방향으로 가장 먼 꼭짓점(p)과 가장 가까운 꼭짓점(n)
+		const float px = plane.x >= 0.0f ? maximum.x : minimum.x;
+		const float py = plane.y >= 0.0f ? maximum.y : minimum.y;
+		const float pz = plane.z >= 0.0f ? maximum.z : minimum.z;
+		if (plane.x * px + plane.y * py + plane.z * pz + plane.w < 0.0f)
+		{
+			return -1;
+		}
+		const float nx = plane.x >= 0.0f ? minimum.x : maximum.x;
+		const float ny = plane.y >= 0.0f ? minimum.y : maximum.y;
+		const float nz = plane.z >= 0.0f ? minimum.z : maximum.z;
+		return (plane.x * nx + plane.y * ny + plane.z * nz + plane.w >= 0.0f) ? 1 : 0;
+	}
+}
+
+void ComputeBvhBounds(const XMFLOAT4X4* worlds, const uint32_t* boundsIndices, const CullBounds* boundsTable,
+	size_t begin, size_t end, BvhBounds* bounds)
+{
+	for (size_t i = begin; i < end; i++)
+	{
+		const auto& local = boundsTable[boundsIndices[i]];
+		XMMATRIX world = XMLoadFloat4x4(&worlds[i]);
+		XMVECTOR extent = XMLoadFloat3(&local.Extents);
+
+		// 회전한 AABB를 감싸는 AABB (FrustumCuller와 같은 방식)
+		XMVECTOR center = XMVector3Transform(XMLoadFloat3(&local.Center), world);
+		XMVECTOR worldExtent = XMVectorMultiplyAdd(XMVectorSplatX(extent), XMVectorAbs(world.r[0]),
+			XMVectorMultiplyAdd(XMVectorSplatY(extent), XMVectorAbs(world.r[1]),
+				XMVectorMultiply(XMVectorSplatZ(extent), XMVectorAbs(world.r[2]))));
+		XMStoreFloat3(&bounds[i].Min, XMVectorSubtract(center, worldExtent));
+		XMStoreFloat3(&bounds[i].Max, XMVectorAdd(center, worldExtent));
+	}
+}
+
+void SceneBvh::Build(const BvhBounds* bounds, size_t count, JobSystem* jobs)
+{
+	Clear();
+	if (count == 0)
+	{
+		return;
+	}
+
+	std::vector<XMFLOAT3> centroids(count);
+	mItems.resize(count);
+	auto prepare = [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				centroids[i] = XMFLOAT3(
+					(bounds[i].Min.x + bounds[i].Max.x) * 0.5f,
+					(bounds[i].Min.y + bounds[i].Max.y) * 0.5f,
+					(bounds[i].Min.z + bounds[i].Max.z) * 0.5f);
+				mItems[i] = static_cast<uint32_t>(i);
+			}
+		};
+	const bool parallel = jobs && jobs->GetConcurrency() > 1 && count > PARALLEL_BUILD_GRAIN;
+	if (parallel)
+	{
+		jobs->ParallelFor(count, PARALLEL_BUILD_GRAIN, prepare);
+	}
+	else
+	{
+		prepare(0, count);
+	}
+
+	// 물체가 최대 2n - 1개 노드를 만든다. 미리 잡아 두면 자라면서 복사하지 않는다.
+	mNodes.reserve(2 * count);
+	mNodes.emplace_back();
+
+	if (!parallel)
+	{
+		BvhBuilder builder = { bounds, centroids.data(), mItems.data(), mNodes };
+		builder.Subdivide(0, 0, static_cast<uint32_t>(count), 0);
+	}
+	else
+	{
+		// 위쪽은 이 스레드에서 나누다가 작업 하나 크기 밑으로 내려온 노드는 남겨 둔다.
+		const size_t taskCount = jobs->GetConcurrency() * 4;
+		std::vector<std::pair<uint32_t, uint32_t>> deferred;
+		BvhBuilder top = { bounds, centroids.data(), mItems.data(), mNodes };
+		top.DeferBelow = std::max(PARALLEL_BUILD_GRAIN, count / taskCount);
+		top.Deferred = &deferred;
+		top.Subdivide(0, 0, static_cast<uint32_t>(count), 0);
+
+		// 남은 노드마다 따로 부분 트리를 만든다. 물체 목록은 노드마다 겹치지 않는 구간이다.
+		std::vector<std::vector<BvhNode>> subtrees(deferred.size());
+		jobs->ParallelFor(deferred.size(), 1, [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; i++)
+				{
+					const BvhNode& root = mNodes[deferred[i].first];
+					auto& nodes = subtrees[i];
+					nodes.reserve(2 * root.Count);
+					nodes.emplace_back();
+					BvhBuilder builder = { bounds, centroids.data(), mItems.data(), nodes };
+					builder.Subdivide(0, root.LeftOrFirst, root.Count, deferred[i].second);
+				}
+			});
+
+		// 부분 트리를 뒤에 이어 붙인다. 뿌리는 남겨 둔 노드 자리에 넣고 자식 위치를 옮긴다.
+		for (size_t i = 0; i < deferred.size(); i++)
+		{
+			const auto& nodes = subtrees[i];
+			const uint32_t base = static_cast<uint32_t>(mNodes.size()) - 1;
+			auto remap = [base](BvhNode node)
+				{
+					if (!node.IsLeaf())
+					{
+						node.LeftOrFirst += base;
+					}
+					return node;
+				};
+			mNodes[deferred[i].first] = remap(nodes[0]);
+			for (size_t j = 1; j < nodes.size(); j++)
+			{
+				mNodes.push_back(remap(nodes[j]));
+			}
+		}
+	}
+
+	mItemBounds.resize(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		mItemBounds[i] = bounds[mItems[i]];
+	}
+	UpdateLinks();
+}
+
+void SceneBvh::Clear()
+{
+	mNodes.clear();
+	mItems.clear();
+	mItemBounds.clear();
+	mParents.clear();
+	mItemLeaves.clear();
+	mItemPositions.clear();
+	mDepth = 0;
+}
+
+void SceneBvh::UpdateLinks()
+{
+	mParents.assign(mNodes.size(), NO_PARENT);
+	mItemLeaves.assign(mItems.size(), 0);
+	mItemPositions.assign(mItems.size(), 0);
+
+	// 자식은 부모보다 뒤에 있으므로 앞에서부터 깊이를 물려준다.
+	std::vector<uint32_t> depths(mNodes.size(), 1);
+	mDepth = 1;
+	for (uint32_t i = 0; i < mNodes.size(); i++)
+	{
+		const auto& node = mNodes[i];
+		if (node.IsLeaf())
+		{
+			for (uint32_t k = node.LeftOrFirst; k < node.LeftOrFirst + node.Count; k++)
+			{
+				mItemLeaves[mItems[k]] = i;
+				mItemPositions[mItems[k]] = k;
+			}
+			continue;
+		}
+		for (uint32_t child = node.LeftOrFirst; child < node.LeftOrFirst + 2; child++)
+		{
+			mParents[child] = i;
+			depths[child] = depths[i] + 1;
+			mDepth = std::max(mDepth, depths[child]);
+		}
+	}
+}
+
+void SceneBvh::RefitNode(uint32_t nodeIndex)
+{
+	auto& node = mNodes[nodeIndex];
+	Aabb aabb;
+	if (node.IsLeaf())
+	{
+		for (uint32_t k = node.LeftOrFirst; k < node.LeftOrFirst + node.Count; k++)
+		{
+			aabb.Grow(mItemBounds[k]);
+		}
+	}
+	else
+	{
+		const auto& left = mNodes[node.LeftOrFirst];
+		const auto& right = mNodes[node.LeftOrFirst + 1];
+		aabb.Grow(&left.Min.x, &left.Max.x);
+		aabb.Grow(&right.Min.x, &right.Max.x);
+	}
+	SetNodeBounds(node, aabb);
+}
+
+void SceneBvh::Refit(const BvhBounds* bounds, JobSystem* jobs)
+{
+	// 잎 순서로 AABB를 다시 늘어놓고 잎을 고친다. 잎끼리는 겹치지 않으므로 나눠서 해도 된다.
+	auto refitLeaves = [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				mItemBounds[i] = bounds[mItems[i]];
+			}
+		};
+	const size_t count = mItems.size();
+	if (jobs && jobs->GetConcurrency() > 1 && count > PARALLEL_BUILD_GRAIN)
+	{
+		jobs->ParallelFor(count, PARALLEL_BUILD_GRAIN, refitLeaves);
+	}
+	else
+	{
+		refitLeaves(0, count);
+	}
+
+	// 자식이 부모보다 뒤에 있으므로 뒤에서부터 고치면 자식이 먼저 끝난다.
+	for (size_t i = mNodes.size(); i > 0; i--)
+	{
+		RefitNode(static_cast<uint32_t>(i - 1));
+	}
+}
+
+void SceneBvh::RefitItem(uint32_t item, const BvhBounds& bounds)
+{
+	mItemBounds[mItemPositions[item]] = bounds;
+
+	// 잎에서 뿌리 쪽으로. AABB가 그대로인 노드에서 멈춘다.
+	uint32_t nodeIndex = mItemLeaves[item];
+	while (nodeIndex != NO_PARENT)
+	{
+		const BvhNode before = mNodes[nodeIndex];
+		RefitNode(nodeIndex);
+		const auto& after = mNodes[nodeIndex];
+		if (before.Min.x == after.Min.x && before.Min.y == after.Min.y && before.Min.z == after.Min.z &&
+			before.Max.x == after.Max.x && before.Max.y == after.Max.y && before.Max.z == after.Max.z)
+		{
+			break;
+		}
+		nodeIndex = mParents[nodeIndex];
+	}
+}
+
+void SceneBvh::QueryFrustum(const XMFLOAT4* planes, std::vector<uint32_t>& items) const
+{
+	if (mNodes.empty())
+	{
+		return;
+	}
+
+	// 아직 검사해야 하는 평면을 비트로 들고 내려간다.
+	const uint32_t allPlanes = (1u << 6) - 1;
+	struct Entry
+	{
+		uint32_t Node;
+		uint32_t PlaneMask;
+	};
+	Entry stack[STACK_SIZE];
+	int top = 0;
+	stack[top++] = { 0, allPlanes };
+
+	while (top > 0)
+	{
+		const Entry entry = stack[--top];
+		const auto& node = mNodes[entry.Node];
+
+		uint32_t planeMask = entry.PlaneMask;
+		bool outside = false;
+		for (int p = 0; p < 6 && planeMask; p++)
+		{
+			if (!(planeMask & (1u << p)))
+			{
+				continue;
+			}
+			const int side = ClassifyPlane(planes[p], node.Min, node.Max);
+			if (side < 0)
+			{
+				outside = true;
+				break;
+			}
+			if (side > 0)
+			{
+				planeMask &= ~(1u << p);
+			}
+		}
+		if (outside)
+		{
+			continue;
+		}
+
+		if (node.IsLeaf())
+		{
+			for (uint32_t k = node.LeftOrFirst; k < node.LeftOrFirst + node.Count; k++)
+			{
+				bool itemOutside = false;
+				for (int p = 0; p < 6 && !itemOutside; p++)
+				{
+					itemOutside = (planeMask & (1u << p)) && ClassifyPlane(planes[p], mItemBounds[k].Min, mItemBounds[k].Max) < 0;
+				}
+				if (!itemOutside)
+				{
+					items.push_back(mItems[k]);
+				}
+			}
+			continue;
+		}
+
+		stack[top++] = { node.LeftOrFirst + 1, planeMask };
+		stack[top++] = { node.LeftOrFirst, planeMask };
+	}
+}
+
+void SceneBvh::QuerySphere(const XMFLOAT3& center, float radius, std::vector<uint32_t>& items) const
+{
+	if (mNodes.empty())
+	{
+		return;
+	}
+
+	const float radiusSq = radius * radius;
+	uint32_t stack[STACK_SIZE];
+	int top = 0;
+	stack[top++] = 0;
+
+	while (top > 0)
+	{
+		const auto& node = mNodes[stack[--top]];
+		if (!Overlaps({ node.Min, node.Max }, center, radiusSq))
+		{
+			continue;
+		}
+
+		if (node.IsLeaf())
+		{
+			for (uint32_t k = node.LeftOrFirst; k < node.LeftOrFirst + node.Count; k++)
+			{
+				if (Overlaps(mItemBounds[k], center, radiusSq))
+				{
+					items.push_back(mItems[k]);
+				}
+			}
+			continue;
+		}
+
+		stack[top++] = node.LeftOrFirst + 1;
+		stack[top++] = node.LeftOrFirst;
+	}
+}
+
+bool SceneBvh::Raycast(const XMFLOAT3& origin, const XMFLOAT3& direction, float maxDistance, BvhRayHit& hit) const
+{
+	if (mNodes.empty())
+	{
+		return false;
+	}
+
+	// 0으로 나누면 inf가 되어 슬랩 검사가 그대로 맞게 동작한다.
+	const float rayOrigin[3] = { origin.x, origin.y, origin.z };
+	const float inverseDirection[3] = { 1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z };
+
+	float closest = maxDistance;
+	bool found = false;
+
+	struct Entry
+	{
+		uint32_t Node;
+		float Distance;
+	};
+	Entry stack[STACK_SIZE];
+	int top = 0;
+	const float rootDistance = IntersectRay(mNodes[0].Min, mNodes[0].Max, rayOrigin, inverseDirection, closest);
+	if (rootDistance == FLT_MAX)
+	{
+		return false;
+	}
+	stack[top++] = { 0, rootDistance };
+
+	while (top > 0)
+	{
+		const Entry entry = stack[--top];
+		// 쌓은 뒤 더 가까운 물체를 찾았으면 건너뛴다.
+		if (entry.Distance > closest)
+		{
+			continue;
+		}
+
+		const auto& node = mNodes[entry.Node];
+		if (node.IsLeaf())
+		{
+			for (uint32_t k = node.LeftOrFirst; k < node.LeftOrFirst + node.Count; k++)
+			{
+				const float distance = IntersectRay(mItemBounds[k].Min, mItemBounds[k].Max, rayOrigin, inverseDirection, closest);
+				if (distance != FLT_MAX && (distance < closest || !found))
+				{
+					closest = distance;
+					hit.Item = mItems[k];
+					hit.Distance = distance;
+					found = true;
+				}
+			}
+			continue;
+		}
+
+		// 가까운 자식을 나중에 쌓아서 먼저 꺼낸다.
+		const uint32_t left = node.LeftOrFirst;
+		const uint32_t right = node.LeftOrFirst + 1;
+		float leftDistance = IntersectRay(mNodes[left].Min, mNodes[left].Max, rayOrigin, inverseDirection, closest);
+		float rightDistance = IntersectRay(mNodes[right].Min, mNodes[right].Max, rayOrigin, inverseDirection, closest);
+		if (leftDistance <= rightDistance)
+		{
+			if (rightDistance != FLT_MAX)
+			{
+				stack[top++] = { right, rightDistance };
+			}
+			if (leftDistance != FLT_MAX)
+			{
+				stack[top++] = { left, leftDistance };
+			}
+		}
+		else
+		{
+			if (leftDistance != FLT_MAX)
+			{
+				stack[top++] = { left, leftDistance };
+			}
+			stack[top++] = { right, rightDistance };
+		}
+	}
+	return found;
+}
@@ -0,0 +1,101 @@
+#pragma once
+#ifndef _SCENEBVH_H_
+#define _SCENEBVH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+
+class JobSystem;
+struct CullBounds;
+
+// 장면 물체 AABB 위의 경계 볼륨 계층 (BVH)
+// 축마다 구간(bin)을 나눠 SAH 비용이 가장 낮은 곳에서 자른다. 잎에는 물체가 MAX_LEAF_SIZE개 이하로 들어간다.
+// 노드는 한 배열에 깊이 우선으로 놓고 두 자식은 이웃한 자리에 둔다. (자식 위치가 부모보다 뒤)
+// 물체 AABB도 잎 순서로 다시 늘어놓아서 잎을 읽을 때 메모리를 건너뛰지 않는다.
+// 물체가 움직이면 트리 모양은 그대로 두고 AABB만 다시 맞춘다(Refit). 많이 움직이면 다시 Build한다.
+// 물체 번호는 Build에 넘긴 배열의 위치다. (SceneStore 밀집 위치라면 Add/Remove 뒤에 다시 Build)
+// 사용법:
+//   ComputeBvhBounds(worlds, meshIds, meshBounds, 0, count, bounds.data());
+//   bvh.Build(bounds.data(), count, &jobs);
+//   bvh.QueryFrustum(culler.GetPlanes(), visibleItems);
+//   bvh.RefitItem(item, newBounds);   // 물체 하나가 움직였을 때
+//   bvh.Refit(bounds.data(), &jobs);  // 많이 움직였을 때
+
+struct BvhBounds
+{
+	DirectX::XMFLOAT3 Min;
+	DirectX::XMFLOAT3 Max;
+};
+
+// 32바이트. 캐시 줄 하나에 두 개
+struct BvhNode
+{
+	DirectX::XMFLOAT3 Min;
+	// 안쪽 노드는 왼쪽 자식 위치 (오른쪽은 + 1), 잎은 물체 목록 안의 첫 위치
+	uint32_t LeftOrFirst;
+	DirectX::XMFLOAT3 Max;
+	// 잎의 물체 수. 0이면 안쪽 노드
+	uint32_t Count;
+
+	bool IsLeaf() const { return Count != 0; }
+};
+
+struct BvhRayHit
+{
+	uint32_t Item = ~0u;
+	float Distance = 0.0f;
+};
+
+// worlds[i]로 옮긴 boundsTable[boundsIndices[i]]를 감싸는 월드 AABB
+void ComputeBvhBounds(const DirectX::XMFLOAT4X4* worlds, const uint32_t* boundsIndices, const CullBounds* boundsTable,
+	size_t begin, size_t end, BvhBounds* bounds);
+
+class SceneBvh
+{
+public:
+	static constexpr uint32_t BIN_COUNT = 16;
+	static constexpr uint32_t MAX_LEAF_SIZE = 4;
+	// 병렬 빌드에서 작업 하나가 맡을 최소 물체 수
+	static constexpr size_t PARALLEL_BUILD_GRAIN = 16 * 1024;
+
+	// jobs가 있으면 위쪽 몇 단계를 나눈 뒤 아래 부분 트리를 동시에 만든다.
+	void Build(const BvhBounds* bounds, size_t count, JobSystem* jobs = nullptr);
+	void Clear();
+
+	// bounds는 Build 때와 같은 순서와 개수. 트리 모양은 그대로 두고 모든 노드 AABB를 다시 구한다.
+	void Refit(const BvhBounds* bounds, JobSystem* jobs = nullptr);
+	// 물체 하나의 AABB를 바꾸고 잎에서 뿌리 쪽으로 바뀌지 않는 노드까지만 올라가며 고친다.
+	void RefitItem(uint32_t item, const BvhBounds& bounds);
+
+	// planes는 안쪽이 양수인 평면 6개 (FrustumCuller::GetPlanes). 절두체와 겹치는 물체를 items에 더한다.
+	// 노드가 평면 안쪽에 완전히 들어가면 그 평면은 아래에서 다시 검사하지 않는다.
+	void QueryFrustum(const DirectX::XMFLOAT4* planes, std::vector<uint32_t>& items) const;
+	// 구와 겹치는 물체를 items에 더한다.
+	void QuerySphere(const DirectX::XMFLOAT3& center, float radius, std::vector<uint32_t>& items) const;
+	// AABB에 가장 먼저 닿는 물체. 가까운 자식부터 내려가고 더 먼 노드는 건너뛴다.
+	bool Raycast(const DirectX::XMFLOAT3& origin, const DirectX::XMFLOAT3& direction, float maxDistance, BvhRayHit& hit) const;
+
+	size_t GetItemCount() const { return mItems.size(); }
+	size_t GetNodeCount() const { return mNodes.size(); }
+	uint32_t GetDepth() const { return mDepth; }
+	const std::vector<BvhNode>& GetNodes() const { return mNodes; }
+
+private:
+	void UpdateLinks();
+	void RefitNode(uint32_t nodeIndex);
+
+	std::vector<BvhNode> mNodes;
+	// 잎 순서로 늘어놓은 물체 번호와 그 AABB
+	std::vector<uint32_t> mItems;
+	std::vector<BvhBounds> mItemBounds;
+
+	// RefitItem용: 노드 -> 부모, 물체 번호 -> 잎
+	std::vector<uint32_t> mParents;
+	std::vector<uint32_t> mItemLeaves;
+	std::vector<uint32_t> mItemPositions;
+	uint32_t mDepth = 0;
+};
+
+#endif
@@ -0,0 +1,99 @@
+#include "SceneStore.h"
+
+using namespace DirectX;
+
+void SceneStore::Reserve(size_t count)
+{
+	mWorlds.reserve(count);
+	mTexTransforms.reserve(count);
+	mMeshes.reserve(count);
+	mMaterials.reserve(count);
+	mFlags.reserve(count);
+	mLods.reserve(count);
+	mHandles.reserve(count);
+	mIndices.reserve(count);
+}
+
+void SceneStore::Clear()
+{
+	mWorlds.clear();
+	mTexTransforms.clear();
+	mMeshes.clear();
+	mMaterials.clear();
+	mFlags.clear();
+	mLods.clear();
+	mHandles.clear();
+	mIndices.clear();
+	mFreeHandles.clear();
+	mMovedHandles.clear();
+	mStructureVersion++;
+}
+
+SceneStore::Handle SceneStore::Add(const XMFLOAT4X4& world, uint32_t mesh, uint32_t material, uint32_t flags)
+{
+	Handle handle;
+	if (!mFreeHandles.empty())
+	{
+		handle = mFreeHandles.back();
+		mFreeHandles.pop_back();
+	}
+	else
+	{
+		handle = static_cast<Handle>(mIndices.size());
+		mIndices.push_back(FREE_INDEX);
+	}
+
+	XMFLOAT4X4 identity;
+	XMStoreFloat4x4(&identity, XMMatrixIdentity());
+
+	mIndices[handle] = static_cast<uint32_t>(mHandles.size());
+	mWorlds.push_back(world);
+	mTexTransforms.push_back(identity);
+	mMeshes.push_back(mesh);
+	mMaterials.push_back(material);
+	mFlags.push_back(flags);
+	mLods.push_back(0);
+	mHandles.push_back(handle);
+	mStructureVersion++;
+	return handle;
+}
+
+void SceneStore::Remove(Handle handle)
+{
+	if (!IsValid(handle))
+	{
+		return;
+	}
+
+	// 마지막 물체를 지운 자리로 옮긴다.
+	const uint32_t index = mIndices[handle];
+	const uint32_t last = static_cast<uint32_t>(mHandles.size() - 1);
+	if (index != last)
+	{
+		mWorlds[index] = mWorlds[last];
+		mTexTransforms[index] = mTexTransforms[last];
+		mMeshes[index] = mMeshes[last];
+		mMaterials[index] = mMaterials[last];
+		mFlags[index] = mFlags[last];
+		mLods[index] = mLods[last];
+		mHandles[index] = mHandles[last];
+		mIndices[mHandles[index]] = index;
+	}
+
+	mWorlds.pop_back();
+	mTexTransforms.pop_back();
+	mMeshes.pop_back();
+	mMaterials.pop_back();
+	mFlags.pop_back();
+	mLods.pop_back();
+	mHandles.pop_back();
+
+	mIndices[handle] = FREE_INDEX;
+	mFreeHandles.push_back(handle);
+	mStructureVersion++;
+}
+
+bool SceneStore::IsValid(Handle handle) const
+{
+	return handle < mIndices.size() && mIndices[handle] != FREE_INDEX;
+}
@@ -0,0 +1,98 @@
+#pragma once
+#ifndef _SCENESTORE_H_
+#define _SCENESTORE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+
+// 장면 물체를 필드별 배열(SoA)에 빈틈없이 모아 두는 저장소
+// 정렬, 인스턴스 데이터 쓰기처럼 매 프레임 모든 물체를 도는 코드는 필요한 배열만 앞에서부터 읽는다.
+// 물체마다 힙 할당을 하거나 포인터를 따라가지 않는다.
+// 메쉬와 재질은 호출하는 쪽 표의 번호로 들고 있다.
+// 핸들은 지워도 다른 물체의 핸들이 바뀌지 않는다. 지운 핸들 번호는 다음 Add에서 다시 쓴다.
+// Remove하면 마지막 물체가 빈 자리로 옮겨 오므로 밀집 배열 순서는 바뀐다.
+// 밀집 위치로 물체를 가리키는 쪽(예: BVH)은 구조 버전이 바뀌면 다시 만들고, 아니면 움직인 물체만 고친다.
+// 월드 행렬은 SetWorld로만 바꾼다. 움직인 핸들이 기록된다.
+// 사용법:
+//   auto handle = scene.Add(world, meshId, materialId, SceneItemOpaque);
+//   for (size_t i = 0; i < scene.GetCount(); i++) Use(scene.GetWorlds()[i], scene.GetMeshes()[i]);
+//   scene.SetWorld(handle, newWorld);
+//   scene.Remove(handle);
+//   if (scene.GetStructureVersion() != builtVersion) Rebuild(); else for (auto moved : scene.GetMovedHandles()) Refit(moved);
+//   scene.ClearMoved();
+
+enum SceneItemFlags : uint32_t
+{
+	SceneItemOpaque = 1 << 0,
+	SceneItemAlphaTested = 1 << 1,
+	SceneItemTransparent = 1 << 2,
+	// 저장소에는 남겨 두고 그리지 않는다.
+	SceneItemHidden = 1 << 3,
+};
+
+class SceneStore
+{
+public:
+	using Handle = uint32_t;
+	static constexpr Handle INVALID_HANDLE = ~0u;
+
+	void Reserve(size_t count);
+	void Clear();
+
+	Handle Add(const DirectX::XMFLOAT4X4& world, uint32_t mesh, uint32_t material, uint32_t flags);
+	void Remove(Handle handle);
+	bool IsValid(Handle handle) const;
+
+	// 핸들의 지금 밀집 배열 위치. 다른 물체를 지우면 바뀔 수 있다.
+	size_t GetIndex(Handle handle) const { return mIndices[handle]; }
+
+	void SetWorld(Handle handle, const DirectX::XMFLOAT4X4& world)
+	{
+		mWorlds[mIndices[handle]] = world;
+		mMovedHandles.push_back(handle);
+	}
+	void SetTexTransform(Handle handle, const DirectX::XMFLOAT4X4& texTransform) { mTexTransforms[mIndices[handle]] = texTransform; }
+	void SetFlags(Handle handle, uint32_t flags) { mFlags[mIndices[handle]] = flags; }
+
+	size_t GetCount() const { return mHandles.size(); }
+
+	// Add, Remove, Clear마다 늘어난다. 밀집 위치가 바뀌었는지 볼 때 쓴다.
+	uint32_t GetStructureVersion() const { return mStructureVersion; }
+	// 마지막 ClearMoved 뒤에 SetWorld한 핸들. 같은 핸들이 여러 번 들어가거나 그 뒤에 지워졌을 수 있다.
+	const std::vector<Handle>& GetMovedHandles() const { return mMovedHandles; }
+	void ClearMoved() { mMovedHandles.clear(); }
+
+	// 밀집 배열 [0, GetCount())
+	const DirectX::XMFLOAT4X4* GetWorlds() const { return mWorlds.data(); }
+	const DirectX::XMFLOAT4X4* GetTexTransforms() const { return mTexTransforms.data(); }
+	const uint32_t* GetMeshes() const { return mMeshes.data(); }
+	const uint32_t* GetMaterials() const { return mMaterials.data(); }
+	const uint32_t* GetFlags() const { return mFlags.data(); }
+	// 물체마다 이번 프레임에 그릴 LOD 단계 (0이 원본). 호출하는 쪽이 매 프레임 고른다.
+	uint8_t* GetLods() { return mLods.data(); }
+	const uint8_t* GetLods() const { return mLods.data(); }
+	const Handle* GetHandles() const { return mHandles.data(); }
+
+private:
+	static constexpr uint32_t FREE_INDEX = ~0u;
+
+	std::vector<DirectX::XMFLOAT4X4> mWorlds;
+	std::vector<DirectX::XMFLOAT4X4> mTexTransforms;
+	std::vector<uint32_t> mMeshes;
+	std::vector<uint32_t> mMaterials;
+	std::vector<uint32_t> mFlags;
+	std::vector<uint8_t> mLods;
+	// 밀집 위치 -> 핸들
+	std::vector<Handle> mHandles;
+
+	// 핸들 -> 밀집 위치 (비어 있으면 FREE_INDEX)
+	std::vector<uint32_t> mIndices;
+	std::vector<Handle> mFreeHandles;
+
+	uint32_t mStructureVersion = 0;
+	std::vector<Handle> mMovedHandles;
+};
+
+#endif
@@ -0,0 +1,50 @@
+#include "TextureContentCache.h"
+
+bool TextureContentCache::Find(const TextureContentKey& key, UINT64 payloadBytes,
+	Microsoft::WRL::ComPtr<ID3D12Resource>& texture, std::string& canonicalName)
+{
+	mStats.Lookups++;
+
+	auto it = mEntries.find(key);
+	if (it == mEntries.end())
+	{
+		return false;
+	}
+
+	mStats.Hits++;
+	mStats.PayloadBytesSaved += payloadBytes;
+	mStats.GpuBytesSaved += it->second.GpuBytes;
+
+	texture = it->second.Texture;
+	canonicalName = it->second.CanonicalName;
+	return true;
+}
+
+void TextureContentCache::Insert(const TextureContentKey& key, const std::string& canonicalName,
+	const Microsoft::WRL::ComPtr<ID3D12Resource>& texture, UINT64 gpuBytes)
+{
+	auto& entry = mEntries[key];
+	entry.CanonicalName = canonicalName;
+	entry.Texture = texture;
+	entry.GpuBytes = gpuBytes;
+}
+
+void TextureContentCache::Remove(const std::string& canonicalName)
+{
+	for (auto it = mEntries.begin(); it != mEntries.end(); )
+	{
+		if (it->second.CanonicalName == canonicalName)
+		{
+			it = mEntries.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+void TextureContentCache::Clear()
+{
+	mEntries.clear();
+}
@@ -0,0 +1,73 @@
+#pragma once
+#ifndef _TEXTURECONTENTCACHE_H_
+#define _TEXTURECONTENTCACHE_H_
+
+#include <d3d12.h>
+#include <wrl.h>
+#include <string>
+#include <unordered_map>
+#include "ContentHash.h"
+
+// DDS 내용(파일 전체 바이트)의 해시로 찾는 텍스쳐 캐시
+// 이름은 달라도 바이트가 같은 텍스쳐는 ID3D12Resource 하나와 SRV 하나를 함께 쓴다.
+// 같은 파일이라도 maxsize(잘라낸 밉)가 다르면 다른 리소스이므로 키에 함께 넣는다.
+// 사용법:
+//   if (cache.Find(key, payloadBytes, texture, canonicalName)) { ... 업로드 생략 ... }
+//   else { ... 생성 ...; cache.Insert(key, fileName, texture, gpuBytes); }
+
+struct TextureContentKey
+{
+	Hash128 Hash;
+	size_t MaxSize = 0;
+
+	bool operator==(const TextureContentKey& other) const { return Hash == other.Hash && MaxSize == other.MaxSize; }
+};
+
+struct TextureContentKeyHasher
+{
+	size_t operator()(const TextureContentKey& key) const { return Hash128Hasher()(key.Hash) ^ (key.MaxSize * 0x9e3779b97f4a7c15ull); }
+};
+
+struct TextureContentCacheStats
+{
+	UINT64 Lookups = 0;
+	UINT64 Hits = 0;
+	// 읽기는 했지만 업로드하지 않은 DDS 바이트
+	UINT64 PayloadBytesSaved = 0;
+	// 따로 만들었다면 더 썼을 GPU 메모리
+	UINT64 GpuBytesSaved = 0;
+
+	double GetHitRate() const { return Lookups ? static_cast<double>(Hits) / Lookups : 0.0; }
+};
+
+class TextureContentCache
+{
+public:
+	// 같은 내용이 이미 올라가 있으면 true와 함께 리소스와 처음 올린 파일 이름을 돌려준다.
+	bool Find(const TextureContentKey& key, UINT64 payloadBytes,
+		Microsoft::WRL::ComPtr<ID3D12Resource>& texture, std::string& canonicalName);
+
+	void Insert(const TextureContentKey& key, const std::string& canonicalName,
+		const Microsoft::WRL::ComPtr<ID3D12Resource>& texture, UINT64 gpuBytes);
+
+	// 텍스쳐를 내리거나 다른 밉 수로 다시 읽기 전에 호출. 캐시가 잡고 있는 참조를 놓는다.
+	void Remove(const std::string& canonicalName);
+	// 종료할 때 호출. 잡고 있는 리소스를 모두 놓아야 힙과 장치보다 먼저 해제된다.
+	void Clear();
+	bool IsEmpty() const { return mEntries.empty(); }
+
+	const TextureContentCacheStats& GetStats() const { return mStats; }
+
+private:
+	struct Entry
+	{
+		std::string CanonicalName;
+		Microsoft::WRL::ComPtr<ID3D12Resource> Texture;
+		UINT64 GpuBytes = 0;
+	};
+
+	std::unordered_map<TextureContentKey, Entry, TextureContentKeyHasher> mEntries;
+	TextureContentCacheStats mStats;
+};
+
+#endif
@@ -0,0 +1,228 @@
+#include "TextureLoadPipeline.h"
+#include <chrono>
+#include <format>
+#include <new>
+
+using namespace DirectX;
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	double SecondsSince(Clock::time_point start)
+	{
+		return std::chrono::duration<double>(Clock::now() - start).count();
+	}
+
+	HRESULT CurrentExceptionToHResult()
+	{
+		try
+		{
+			throw;
+		}
+		catch (const std::bad_alloc&)
+		{
+			return E_OUTOFMEMORY;
+		}
+		catch (...)
+		{
+			return E_FAIL;
+		}
+	}
+
+	// 어떻게 Run을 빠져나가든 이 Run의 작업이 모두 끝난 뒤에 나가게 한다. 작업은 this와 fileNames를 쓴다.
+	struct JobCounterWaiter
+	{
+		JobSystem& Jobs;
+		JobCounter& Counter;
+
+		~JobCounterWaiter()
+		{
+			try
+			{
+				Jobs.Wait(Counter);
+			}
+			catch (...)
+			{
+			}
+		}
+	};
+}
+
+double TextureLoadStageStats::GetMegaBytesPerSecond() const
+{
+	if (BusySeconds <= 0.0)
+	{
+		return 0.0;
+	}
+	return (Bytes / (1024.0 * 1024.0)) / BusySeconds;
+}
+
+std::wstring TextureLoadStats::ToString() const
+{
+	auto stage = [this](const wchar_t* name, const TextureLoadStageStats& s)
+	{
+		double filesPerSecond = (WallSeconds > 0.0) ? s.Count / WallSeconds : 0.0;
+		return std::format(L"  {:8}: {} files, {:.2f} MB, busy {:.2f} ms, {:.1f} MB/s per thread, {:.1f} files/s\n",
+			name, s.Count, s.Bytes / (1024.0 * 1024.0), s.BusySeconds * 1000.0, s.GetMegaBytesPerSecond(), filesPerSecond);
+	};
+
+	return std::format(L"TextureLoadPipeline: {} workers, wall {:.2f} ms\n", WorkerCount, WallSeconds * 1000.0)
+		+ stage(L"read", Read)
+		+ stage(L"prepare", Prepare)
+		+ stage(L"record", Record);
+}
+
+HRESULT TextureLoadPipeline::Run(const std::vector<std::wstring>& fileNames,
+	const std::vector<size_t>& maxSizes,
+	const std::function<HRESULT(size_t, DDS_TEXTURE_DATA12&, const Hash128&)>& onRecord)
+{
+	mStats = TextureLoadStats();
+	mStats.WorkerCount = mJobs.GetConcurrency() - 1;
+	mReadyItems.clear();
+	// 작업은 파일마다 결과를 하나씩 넣는다. 미리 잡아 두면 PushReady가 할당에 실패하지 않는다.
+	mReadyItems.reserve(fileNames.size());
+
+	const auto start = Clock::now();
+	JobCounterWaiter waiter{ mJobs, mJobCounter };
+
+	for (size_t i = 0; i < fileNames.size(); i++)
+	{
+		// fileNames는 Run이 끝날 때까지 살아 있으므로 참조로 넘겨도 된다.
+		const std::wstring& fileName = fileNames[i];
+		const size_t maxsize = (i < maxSizes.size()) ? maxSizes[i] : 0;
+		mJobs.Submit([this, i, &fileName, maxsize] { ReadJob(i, fileName, maxsize); }, &mJobCounter);
+	}
+
+	// 기록 스레드: 준비된 순서대로 꺼내서 기록
+	HRESULT firstError = S_OK;
+	for (size_t recorded = 0; recorded < fileNames.size(); recorded++)
+	{
+		ReadyItem item;
+		{
+			std::unique_lock<std::mutex> lock(mReadyMutex);
+			mReadyCondition.wait(lock, [this] { return !mReadyItems.empty(); });
+			item = std::move(mReadyItems.back());
+			mReadyItems.pop_back();
+		}
+
+		if (FAILED(item.Result))
+		{
+			if (SUCCEEDED(firstError))
+			{
+				firstError = item.Result;
+			}
+			continue;
+		}
+
+		const auto recordStart = Clock::now();
+		HRESULT hr = onRecord(item.Index, item.Data, item.ContentHash);
+		const double recordSeconds = SecondsSince(recordStart);
+
+		{
+			std::lock_guard<std::mutex> lock(mReadyMutex);
+			mStats.Record.Count++;
+			mStats.Record.Bytes += item.Data.ddsDataSize;
+			mStats.Record.BusySeconds += recordSeconds;
+		}
+
+		if (FAILED(hr) && SUCCEEDED(firstError))
+		{
+			firstError = hr;
+		}
+	}
+
+	// 모든 결과를 받았지만 결과를 넣은 작업이 아직 마무리 중일 수 있다.
+	mJobs.Wait(mJobCounter);
+
+	mStats.WallSeconds = SecondsSince(start);
+
+	return firstError;
+}
+
+void TextureLoadPipeline::ReadJob(size_t index, const std::wstring& fileName, size_t maxsize)
+{
+	// 예외로 빠져나가면 기록 스레드가 이 파일의 결과를 영영 기다리므로 실패 결과로 바꿔 넣는다.
+	try
+	{
+		const auto readStart = Clock::now();
+
+		std::unique_ptr<uint8_t[]> ddsData;
+		size_t ddsDataSize = 0;
+		HRESULT hr = LoadDDSFileData12(fileName.c_str(), ddsData, ddsDataSize);
+
+		const double readSeconds = SecondsSince(readStart);
+		{
+			std::lock_guard<std::mutex> lock(mReadyMutex);
+			mStats.Read.Count++;
+			mStats.Read.Bytes += ddsDataSize;
+			mStats.Read.BusySeconds += readSeconds;
+		}
+
+		if (FAILED(hr))
+		{
+			PushFailed(index, hr);
+			return;
+		}
+
+		// 워커 안에서 제출하므로 이 워커 큐의 앞에 들어간다. 그 사이 다른 워커는 다음 파일을 읽는다.
+		// 제출이 실패하면 ddsData가 그대로 해제하고, 성공하면 Prepare 작업이 소유한다.
+		auto* data = ddsData.get();
+		mJobs.Submit([this, index, data, ddsDataSize, maxsize]
+			{
+				PrepareJob(index, std::unique_ptr<uint8_t[]>(data), ddsDataSize, maxsize);
+			}, &mJobCounter);
+		ddsData.release();
+	}
+	catch (...)
+	{
+		PushFailed(index, CurrentExceptionToHResult());
+	}
+}
+
+void TextureLoadPipeline::PrepareJob(size_t index, std::unique_ptr<uint8_t[]> ddsData, size_t ddsDataSize, size_t maxsize)
+{
+	try
+	{
+		const auto prepareStart = Clock::now();
+
+		ReadyItem item;
+		item.Index = index;
+		if (ddsData)
+		{
+			item.ContentHash = ComputeHash128(ddsData.get(), ddsDataSize);
+		}
+		item.Result = PrepareDDSTextureData12(std::move(ddsData), ddsDataSize, maxsize, item.Data);
+
+		const double prepareSeconds = SecondsSince(prepareStart);
+		{
+			std::lock_guard<std::mutex> lock(mReadyMutex);
+			mStats.Prepare.Count++;
+			mStats.Prepare.Bytes += ddsDataSize;
+			mStats.Prepare.BusySeconds += prepareSeconds;
+		}
+
+		PushReady(std::move(item));
+	}
+	catch (...)
+	{
+		PushFailed(index, CurrentExceptionToHResult());
+	}
+}
+
+void TextureLoadPipeline::PushReady(ReadyItem&& item)
+{
+	{
+		std::lock_guard<std::mutex> lock(mReadyMutex);
+		mReadyItems.push_back(std::move(item));
+	}
+	mReadyCondition.notify_one();
+}
+
+void TextureLoadPipeline::PushFailed(size_t index, HRESULT result)
+{
+	ReadyItem item;
+	item.Index = index;
+	item.Result = result;
+	PushReady(std::move(item));
+}
@@ -0,0 +1,88 @@
+#pragma once
+#ifndef _TEXTURELOADPIPELINE_H_
+#define _TEXTURELOADPIPELINE_H_
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ContentHash.h"
+#include "DDSTextureLoader.h"
+#include "JobSystem.h"
+
+// 여러 DDS 파일을 병렬로 읽고(I/O), 헤더 검증 및 레이아웃 계산(Prepare)을 한 뒤
+// 준비가 끝난 순서대로 호출 스레드 하나에서 리소스 생성 명령을 기록(Record)하는 파이프라인.
+// 읽기가 끝난 파일은 같은 워커의 큐 앞에 Prepare 작업으로 들어가므로 다른 파일의 읽기와 겹쳐서 실행된다.
+// 사용법:
+//   TextureLoadPipeline pipeline(jobs);
+//   pipeline.Run(fileNames, {}, [&](size_t index, DirectX::DDS_TEXTURE_DATA12& data, const Hash128& contentHash) { CreateDDSTextureFromData12(...); });
+//   OutputDebugString(pipeline.GetStats().ToString().c_str());
+
+struct TextureLoadStageStats
+{
+	size_t Count = 0;
+	UINT64 Bytes = 0;
+	// 각 작업이 실제로 걸린 시간의 합(스레드 시간)
+	double BusySeconds = 0.0;
+
+	double GetMegaBytesPerSecond() const;
+};
+
+struct TextureLoadStats
+{
+	TextureLoadStageStats Read;
+	TextureLoadStageStats Prepare;
+	TextureLoadStageStats Record;
+
+	// Run 시작부터 마지막 기록까지
+	double WallSeconds = 0.0;
+	unsigned WorkerCount = 0;
+
+	std::wstring ToString() const;
+};
+
+class TextureLoadPipeline
+{
+public:
+	explicit TextureLoadPipeline(JobSystem& jobs) : mJobs(jobs) { }
+
+	// onRecord(index, textureData, contentHash)는 항상 Run을 호출한 스레드에서만 불린다. index는 fileNames의 순서.
+	// contentHash는 DDS 파일 전체 바이트의 해시로, Prepare 단계에서 함께 계산한다.
+	// maxSizes는 파일별 DDS 로더 maxsize 인자(상위 밉 자르기). 비어 있으면 모두 0.
+	// 실패한 파일은 onRecord를 부르지 않고, 모든 파일을 처리한 뒤 첫 번째 실패 HRESULT를 돌려준다.
+	// 작업 안에서 난 예외도 그 파일의 실패(E_OUTOFMEMORY, E_FAIL)로 센다. onRecord가 던진 예외는
+	// 남은 작업이 끝나기를 기다린 뒤 그대로 밖으로 나간다.
+	HRESULT Run(const std::vector<std::wstring>& fileNames,
+		const std::vector<size_t>& maxSizes,
+		const std::function<HRESULT(size_t, DirectX::DDS_TEXTURE_DATA12&, const Hash128&)>& onRecord);
+
+	const TextureLoadStats& GetStats() const { return mStats; }
+
+private:
+	struct ReadyItem
+	{
+		size_t Index = 0;
+		HRESULT Result = S_OK;
+		DirectX::DDS_TEXTURE_DATA12 Data;
+		Hash128 ContentHash;
+	};
+
+	void ReadJob(size_t index, const std::wstring& fileName, size_t maxsize);
+	void PrepareJob(size_t index, std::unique_ptr<uint8_t[]> ddsData, size_t ddsDataSize, size_t maxsize);
+	void PushReady(ReadyItem&& item);
+	// 예외로 끝난 작업 대신 실패한 결과를 넣는다. 그래야 기록 스레드가 파일 수만큼 결과를 받는다.
+	void PushFailed(size_t index, HRESULT result);
+
+	JobSystem& mJobs;
+	// 이번 Run이 제출한 작업. 같은 JobSystem의 다른 작업은 기다리지 않는다.
+	JobCounter mJobCounter;
+	TextureLoadStats mStats;
+
+	// 워커 -> 기록 스레드로 넘기는 완료 큐. 통계도 같은 잠금으로 보호한다.
+	std::mutex mReadyMutex;
+	std::condition_variable mReadyCondition;
+	std::vector<ReadyItem> mReadyItems;
+};
+
+#endif
@@ -0,0 +1,200 @@
+#include "TextureResidency.h"
+#include <algorithm>
+
+void TextureResidencyManager::OnTextureLoaded(const std::string& name, uint64_t residentBytes,
+	uint32_t fullWidth, uint32_t fullHeight, uint32_t fullMipLevels,
+	uint32_t skippedMips, uint64_t frame)
+{
+	auto& entry = mEntries[name];
+	if (entry.Resident)
+	{
+		mResidentBytes -= entry.ResidentBytes;
+	}
+
+	entry.ResidentBytes = residentBytes;
+	entry.FullWidth = fullWidth;
+	entry.FullHeight = fullHeight;
+	entry.FullMipLevels = std::max(fullMipLevels, 1u);
+	entry.SkippedMips = skippedMips;
+	entry.LastUsedFrame = std::max(entry.LastUsedFrame, frame);
+	entry.Resident = true;
+	entry.ReloadPending = false;
+
+	mResidentBytes += residentBytes;
+}
+
+void TextureResidencyManager::OnTextureEvicted(const std::string& name)
+{
+	auto it = mEntries.find(name);
+	if (it == mEntries.end() || !it->second.Resident)
+	{
+		return;
+	}
+
+	// ResidentBytes는 다시 읽을 때 크기 추정용으로 남겨 둔다.
+	mResidentBytes -= it->second.ResidentBytes;
+	it->second.Resident = false;
+}
+
+void TextureResidencyManager::MarkUsed(const std::string& name, uint64_t frame)
+{
+	auto it = mEntries.find(name);
+	if (it == mEntries.end())
+	{
+		return;
+	}
+
+	it->second.LastUsedFrame = frame;
+	if (!it->second.Resident)
+	{
+		it->second.ReloadPending = true;
+	}
+}
+
+bool TextureResidencyManager::IsResident(const std::string& name) const
+{
+	auto it = mEntries.find(name);
+	return it != mEntries.end() && it->second.Resident;
+}
+
+size_t TextureResidencyManager::GetMaxSize(const Entry& entry, uint32_t skippedMips) const
+{
+	if (skippedMips == 0)
+	{
+		return 0;
+	}
+
+	size_t size = std::max(entry.FullWidth, entry.FullHeight) >> skippedMips;
+	return std::max<size_t>(size, 1);
+}
+
+std::vector<TextureResidencyRequest> TextureResidencyManager::CollectRequests(uint64_t frame)
+{
+	std::vector<TextureResidencyRequest> requests;
+	uint64_t projectedBytes = mResidentBytes;
+
+	// 1. 내려간 상태에서 다시 쓰인 텍스쳐는 먼저 올린다.
+	for (auto& [name, entry] : mEntries)
+	{
+		if (entry.Resident || !entry.ReloadPending)
+		{
+			continue;
+		}
+
+		TextureResidencyRequest request;
+		request.Name = name;
+		request.Action = TextureResidencyAction::Reload;
+		request.SkippedMips = entry.SkippedMips;
+		request.MaxSize = GetMaxSize(entry, entry.SkippedMips);
+		requests.push_back(request);
+
+		entry.ReloadPending = false;
+		projectedBytes += entry.ResidentBytes;
+		mReloads++;
+	}
+
+	// 오래 안 쓴 순서로 정렬
+	std::vector<std::pair<const std::string*, Entry*>> candidates;
+	for (auto& [name, entry] : mEntries)
+	{
+		if (entry.Resident)
+		{
+			candidates.push_back({ &name, &entry });
+		}
+	}
+	std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b)
+		{
+			return a.second->LastUsedFrame < b.second->LastUsedFrame;
+		});
+
+	// 2. 예산을 넘으면 오래 안 쓴 것부터 내리거나 상위 밉을 자른다. 텍스쳐 하나당 한 프레임에 한 번만.
+	bool overBudget = projectedBytes > mBudgetBytes;
+	for (auto& [name, entry] : candidates)
+	{
+		if (projectedBytes <= mBudgetBytes)
+		{
+			break;
+		}
+
+		TextureResidencyRequest request;
+		request.Name = *name;
+
+		if (frame - entry->LastUsedFrame >= mEvictAfterFrames)
+		{
+			request.Action = TextureResidencyAction::Evict;
+			request.SkippedMips = entry->SkippedMips;
+			projectedBytes -= entry->ResidentBytes;
+			mEvictions++;
+		}
+		else if (entry->FullMipLevels - entry->SkippedMips > 1)
+		{
+			// 2D 텍스쳐는 상위 밉 하나가 전체의 약 3/4
+			request.Action = TextureResidencyAction::DropMip;
+			request.SkippedMips = entry->SkippedMips + 1;
+			request.MaxSize = GetMaxSize(*entry, request.SkippedMips);
+			projectedBytes -= entry->ResidentBytes - entry->ResidentBytes / 4;
+			mMipDrops++;
+		}
+		else
+		{
+			continue;
+		}
+
+		requests.push_back(request);
+	}
+
+	// 3. 예산에 여유가 있으면 최근에 쓴 텍스쳐부터 잘랐던 밉을 하나 되살린다.
+	//    바로 다시 잘리지 않도록 예산의 90%까지만 채운다.
+	if (!overBudget)
+	{
+		for (auto it = candidates.rbegin(); it != candidates.rend(); ++it)
+		{
+			auto& [name, entry] = *it;
+			if (entry->SkippedMips == 0)
+			{
+				continue;
+			}
+
+			uint64_t restoredBytes = projectedBytes + entry->ResidentBytes * 3;
+			if (restoredBytes > mBudgetBytes / 10 * 9)
+			{
+				break;
+			}
+
+			TextureResidencyRequest request;
+			request.Name = *name;
+			request.Action = TextureResidencyAction::RestoreMip;
+			request.SkippedMips = entry->SkippedMips - 1;
+			request.MaxSize = GetMaxSize(*entry, request.SkippedMips);
+			requests.push_back(request);
+
+			mMipRestores++;
+			break;
+		}
+	}
+
+	return requests;
+}
+
+TextureResidencyStats TextureResidencyManager::GetStats() const
+{
+	TextureResidencyStats stats;
+	stats.ResidentBytes = mResidentBytes;
+	stats.BudgetBytes = mBudgetBytes;
+	for (const auto& [name, entry] : mEntries)
+	{
+		if (entry.Resident)
+		{
+			stats.ResidentCount++;
+		}
+		else
+		{
+			stats.EvictedCount++;
+		}
+	}
+	stats.Evictions = mEvictions;
+	stats.MipDrops = mMipDrops;
+	stats.MipRestores = mMipRestores;
+	stats.Reloads = mReloads;
+	return stats;
+}
@@ -0,0 +1,107 @@
+#pragma once
+#ifndef _TEXTURERESIDENCY_H_
+#define _TEXTURERESIDENCY_H_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 텍스쳐 상주 관리자
+// 텍스쳐별 GPU 크기와 마지막으로 그려진 프레임을 기록하고, 예산을 넘으면
+// 오래 안 쓴 텍스쳐부터 내리거나(evict) 상위 밉을 잘라낸다(drop mip).
+// 실제 리소스 생성/해제는 하지 않고 해야 할 일의 목록만 돌려준다. 다시 읽기는 기존 DDS 경로를 그대로 쓴다.
+// 사용법:
+//   residency.OnTextureLoaded("grass.dds", bytes, width, height, mipLevels, 0, frame);
+//   residency.MarkUsed("grass.dds", frame); // DrawRenderItems에서
+//   for (auto& request : residency.CollectRequests(frame)) { ... }
+
+enum class TextureResidencyAction
+{
+	// 내려간 텍스쳐가 다시 쓰여서 읽어야 함
+	Reload,
+	// 상위 밉을 하나 잘라서 다시 읽음
+	DropMip,
+	// 예산이 남아서 잘랐던 밉을 하나 되살림
+	RestoreMip,
+	// GPU 메모리에서 내림
+	Evict,
+};
+
+struct TextureResidencyRequest
+{
+	std::string Name;
+	TextureResidencyAction Action = TextureResidencyAction::Reload;
+	// DDS 로더의 maxsize 인자. 0이면 전체 밉
+	size_t MaxSize = 0;
+	uint32_t SkippedMips = 0;
+};
+
+struct TextureResidencyStats
+{
+	uint64_t ResidentBytes = 0;
+	uint64_t BudgetBytes = 0;
+	uint32_t ResidentCount = 0;
+	uint32_t EvictedCount = 0;
+
+	// 누적
+	uint64_t Evictions = 0;
+	uint64_t MipDrops = 0;
+	uint64_t MipRestores = 0;
+	uint64_t Reloads = 0;
+};
+
+class TextureResidencyManager
+{
+public:
+	explicit TextureResidencyManager(uint64_t budgetBytes = 256ull * 1024 * 1024) : mBudgetBytes(budgetBytes) { }
+
+	void SetBudget(uint64_t budgetBytes) { mBudgetBytes = budgetBytes; }
+	uint64_t GetBudget() const { return mBudgetBytes; }
+
+	// 이 프레임 수 이상 안 쓴 텍스쳐만 통째로 내린다. 그보다 최근에 쓴 텍스쳐는 밉만 자른다.
+	void SetEvictAfterFrames(uint64_t frames) { mEvictAfterFrames = frames; }
+
+	// 텍스쳐를 (다시) 올린 뒤 호출. fullWidth/fullHeight/fullMipLevels는 원본 DDS 기준
+	void OnTextureLoaded(const std::string& name, uint64_t residentBytes,
+		uint32_t fullWidth, uint32_t fullHeight, uint32_t fullMipLevels,
+		uint32_t skippedMips, uint64_t frame);
+	void OnTextureEvicted(const std::string& name);
+
+	void MarkUsed(const std::string& name, uint64_t frame);
+
+	bool IsResident(const std::string& name) const;
+
+	// 이번 프레임에 할 일. 다시 읽기 -> 예산 맞추기 -> 여유가 있으면 밉 되살리기 순으로 판단한다.
+	std::vector<TextureResidencyRequest> CollectRequests(uint64_t frame);
+
+	TextureResidencyStats GetStats() const;
+
+private:
+	struct Entry
+	{
+		uint64_t ResidentBytes = 0;
+		uint32_t FullWidth = 0;
+		uint32_t FullHeight = 0;
+		uint32_t FullMipLevels = 1;
+		uint32_t SkippedMips = 0;
+		uint64_t LastUsedFrame = 0;
+		bool Resident = false;
+		// 내려간 상태에서 쓰여서 다시 읽어야 함
+		bool ReloadPending = false;
+	};
+
+	size_t GetMaxSize(const Entry& entry, uint32_t skippedMips) const;
+
+	std::unordered_map<std::string, Entry> mEntries;
+	uint64_t mBudgetBytes;
+	uint64_t mEvictAfterFrames = 120;
+	uint64_t mResidentBytes = 0;
+
+	uint64_t mEvictions = 0;
+	uint64_t mMipDrops = 0;
+	uint64_t mMipRestores = 0;
+	uint64_t mReloads = 0;
+};
+
+#endif
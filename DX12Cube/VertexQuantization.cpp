@@ -0,0 +1,225 @@
+#include "VertexQuantization.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	const float UNORM16_MAX = 65535.0f;
+	const float SNORM16_MAX = 32767.0f;
+	const float DEGREES_PER_RADIAN = 57.2957795f;
+
+	float DecodeSnorm16(int16_t value)
+	{
+		return std::max(static_cast<float>(value) / SNORM16_MAX, -1.0f);
+	}
+
+	// 셰이더 DecodeOctahedral과 같은 식
+	void DecodeOctahedral(const int16_t* encoded, float* normal)
+	{
+		float x = DecodeSnorm16(encoded[0]);
+		float y = DecodeSnorm16(encoded[1]);
+		const float z = 1.0f - fabsf(x) - fabsf(y);
+		const float t = std::clamp(-z, 0.0f, 1.0f);
+		x += x >= 0.0f ? -t : t;
+		y += y >= 0.0f ? -t : t;
+		const float length = sqrtf(x * x + y * y + z * z);
+		normal[0] = x / length;
+		normal[1] = y / length;
+		normal[2] = z / length;
+	}
+
+	// 정팔면체 면에 투영한 뒤 아래 반쪽은 바깥 삼각형으로 접어서 [-1, 1]^2에 편다.
+	// 반올림 방향 네 가지를 모두 복원해 보고 원래 방향과 가장 가까운 것을 쓴다.
+	void EncodeOctahedral(const float* normal, int16_t* encoded)
+	{
+		const float l1 = fabsf(normal[0]) + fabsf(normal[1]) + fabsf(normal[2]);
+		float u = normal[0] / l1;
+		float v = normal[1] / l1;
+		if (normal[2] < 0.0f)
+		{
+			const float foldedU = (1.0f - fabsf(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+			const float foldedV = (1.0f - fabsf(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+			u = foldedU;
+			v = foldedV;
+		}
+
+		const float scaledU = std::clamp(u, -1.0f, 1.0f) * SNORM16_MAX;
+		const float scaledV = std::clamp(v, -1.0f, 1.0f) * SNORM16_MAX;
+		float bestDot = -2.0f;
+		for (int i = 0; i < 4; i++)
+		{
+			const int16_t candidate[2] =
+			{
+				static_cast<int16_t>((i & 1) ? ceilf(scaledU) : floorf(scaledU)),
+				static_cast<int16_t>((i & 2) ? ceilf(scaledV) : floorf(scaledV)),
+			};
+			float decoded[3];
+			DecodeOctahedral(candidate, decoded);
+			const float dot = decoded[0] * normal[0] + decoded[1] * normal[1] + decoded[2] * normal[2];
+			if (dot > bestDot)
+			{
+				bestDot = dot;
+				encoded[0] = candidate[0];
+				encoded[1] = candidate[1];
+			}
+		}
+	}
+}
+
+uint16_t FloatToHalf(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	const uint32_t sign = (bits >> 16) & 0x8000;
+	const uint32_t magnitude = bits & 0x7FFFFFFF;
+
+	// NaN은 조용한 NaN, 너무 큰 값은 무한대
+	if (magnitude > 0x7F800000)
+	{
+		return static_cast<uint16_t>(sign | 0x7E00);
+	}
+	if (magnitude >= 0x477FF000)
+	{
+		return static_cast<uint16_t>(sign | 0x7C00);
+	}
+
+	// 정규화된 half보다 작으면 비정규화 수로 (가수를 밀고 짝수 쪽으로 반올림)
+	if (magnitude < 0x38800000)
+	{
+		if (magnitude < 0x33000000)
+		{
+			return static_cast<uint16_t>(sign);
+		}
+		const uint32_t exponent = magnitude >> 23;
+		const uint32_t mantissa = (magnitude & 0x7FFFFF) | 0x800000;
+		const uint32_t shift = 126 - exponent;
+		uint32_t half = mantissa >> shift;
+		const uint32_t remainder = mantissa & ((1u << shift) - 1);
+		const uint32_t halfway = 1u << (shift - 1);
+		if (remainder > halfway || (remainder == halfway && (half & 1)))
+		{
+			half++;
+		}
+		return static_cast<uint16_t>(sign | half);
+	}
+
+	// 지수를 옮기고 가수 아래 13비트를 짝수 쪽으로 반올림한다. 올림이 지수로 넘어가도 맞는 값이 된다.
+	const uint32_t rebased = magnitude - 0x38000000;
+	const uint32_t half = (rebased + 0x0FFF + ((rebased >> 13) & 1)) >> 13;
+	return static_cast<uint16_t>(sign | half);
+}
+
+float HalfToFloat(uint16_t value)
+{
+	const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+	const uint32_t exponent = (value >> 10) & 0x1F;
+	const uint32_t mantissa = value & 0x3FF;
+	uint32_t bits;
+	if (exponent == 0x1F)
+	{
+		bits = sign | 0x7F800000 | (mantissa << 13);
+	}
+	else if (exponent != 0)
+	{
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	}
+	else
+	{
+		// 비정규화 half는 float로는 정규화된 수다.
+		const float result = static_cast<float>(mantissa) * (1.0f / 16777216.0f);
+		return sign ? -result : result;
+	}
+	float result;
+	memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+
+bool QuantizeVertices(const float* vertices, size_t vertexCount, const VertexErrorLimits& limits,
+	std::vector<PackedVertex>& packed, VertexQuantization& quantization, VertexQuantizationError& error)
+{
+	packed.resize(vertexCount);
+	quantization = VertexQuantization();
+	error = VertexQuantizationError();
+	if (vertexCount == 0)
+	{
+		return true;
+	}
+
+	float minimum[3] = { vertices[0], vertices[1], vertices[2] };
+	float maximum[3] = { vertices[0], vertices[1], vertices[2] };
+	for (size_t i = 1; i < vertexCount; i++)
+	{
+		for (int a = 0; a < 3; a++)
+		{
+			minimum[a] = std::min(minimum[a], vertices[i * 8 + a]);
+			maximum[a] = std::max(maximum[a], vertices[i * 8 + a]);
+		}
+	}
+	float extent = 0.0f;
+	for (int a = 0; a < 3; a++)
+	{
+		quantization.PositionOffset[a] = minimum[a];
+		extent = std::max(extent, maximum[a] - minimum[a]);
+	}
+	quantization.PositionScale = extent > 0.0f ? extent : 1.0f;
+
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		const float* source = vertices + i * 8;
+		PackedVertex& target = packed[i];
+		for (int a = 0; a < 3; a++)
+		{
+			const float unorm = (source[a] - quantization.PositionOffset[a]) / quantization.PositionScale;
+			target.Position[a] = static_cast<uint16_t>(std::clamp(unorm, 0.0f, 1.0f) * UNORM16_MAX + 0.5f);
+		}
+		target.Position[3] = 0;
+
+		// 길이가 0인 노멀은 +z로 둔다.
+		float normal[3] = { source[3], source[4], source[5] };
+		const float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if (length > 0.0f)
+		{
+			for (float& component : normal)
+			{
+				component /= length;
+			}
+		}
+		else
+		{
+			normal[0] = 0.0f;
+			normal[1] = 0.0f;
+			normal[2] = 1.0f;
+		}
+		EncodeOctahedral(normal, target.Normal);
+
+		target.Tex[0] = FloatToHalf(source[6]);
+		target.Tex[1] = FloatToHalf(source[7]);
+
+		float decoded[8];
+		DecodePackedVertex(target, quantization, decoded);
+		const float dx = decoded[0] - source[0];
+		const float dy = decoded[1] - source[1];
+		const float dz = decoded[2] - source[2];
+		error.Position = std::max(error.Position, sqrtf(dx * dx + dy * dy + dz * dz));
+		if (length > 0.0f)
+		{
+			const float dot = std::clamp(decoded[3] * normal[0] + decoded[4] * normal[1] + decoded[5] * normal[2], -1.0f, 1.0f);
+			error.NormalDegrees = std::max(error.NormalDegrees, acosf(dot) * DEGREES_PER_RADIAN);
+		}
+		error.Tex = std::max({ error.Tex, fabsf(decoded[6] - source[6]), fabsf(decoded[7] - source[7]) });
+	}
+
+	return error.Position <= limits.Position && error.NormalDegrees <= limits.NormalDegrees && error.Tex <= limits.Tex;
+}
+
+void DecodePackedVertex(const PackedVertex& vertex, const VertexQuantization& quantization, float* out)
+{
+	for (int a = 0; a < 3; a++)
+	{
+		out[a] = quantization.PositionOffset[a] + vertex.Position[a] / UNORM16_MAX * quantization.PositionScale;
+	}
+	DecodeOctahedral(vertex.Normal, out + 3);
+	out[6] = HalfToFloat(vertex.Tex[0]);
+	out[7] = HalfToFloat(vertex.Tex[1]);
+}
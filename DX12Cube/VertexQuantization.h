@@ -0,0 +1,67 @@
+#pragma once
+#ifndef _VERTEXQUANTIZATION_H_
+#define _VERTEXQUANTIZATION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 위치, 노멀, UV 버텍스(float 8개, 32바이트)를 16바이트로 줄이는 양자화
+// 위치: 메쉬마다 offset, scale을 두고 16비트 UNORM 세 개 (+ 빈 칸 하나). 세 축이 같은 scale이라 월드 행렬 앞에 곱해도 노멀이 틀어지지 않는다.
+// 노멀: 팔면체(octahedral) 매핑한 16비트 SNORM 두 개. 반올림 이웃 네 점 중 복원했을 때 가장 가까운 것을 고른다.
+// UV: half float 두 개
+// 복원한 값과 원래 값의 차이를 재서 한도를 넘으면 false를 돌려준다. 그런 메쉬는 float 버텍스로 올린다.
+// 셰이더의 VSMainPacked와 DecodePackedVertex는 같은 식으로 복원한다.
+// 사용법:
+//   std::vector<PackedVertex> packed;
+//   VertexQuantization quantization;
+//   VertexQuantizationError error;
+//   if (QuantizeVertices(&vertices[0].position.x, vertexCount, VertexErrorLimits(), packed, quantization, error))
+//       Upload(packed.data(), packed.size() * sizeof(PackedVertex));
+
+struct PackedVertex
+{
+	// (위치 - PositionOffset) / PositionScale을 0 ~ 65535로. [3]은 0
+	uint16_t Position[4];
+	// 팔면체 매핑한 노멀. -32767 ~ 32767
+	int16_t Normal[2];
+	// half float
+	uint16_t Tex[2];
+};
+static_assert(sizeof(PackedVertex) == 16, "PackedVertex must be 16 bytes");
+
+// 메쉬마다 하나. 위치 = PositionOffset + Position / 65535 * PositionScale
+struct VertexQuantization
+{
+	float PositionOffset[3] = { 0.0f, 0.0f, 0.0f };
+	float PositionScale = 1.0f;
+};
+
+// 메쉬 전체에서 가장 큰 차이
+struct VertexQuantizationError
+{
+	// 로컬 공간 거리
+	float Position = 0.0f;
+	float NormalDegrees = 0.0f;
+	float Tex = 0.0f;
+};
+
+struct VertexErrorLimits
+{
+	float Position = 1e-3f;
+	float NormalDegrees = 0.1f;
+	// 1024 텍스쳐에서 1/4 텍셀
+	float Tex = 1.0f / 4096.0f;
+};
+
+// vertices는 버텍스마다 위치 3, 노멀 3, UV 2 (float 8개). 한도를 넘어도 packed와 error는 채운다.
+bool QuantizeVertices(const float* vertices, size_t vertexCount, const VertexErrorLimits& limits,
+	std::vector<PackedVertex>& packed, VertexQuantization& quantization, VertexQuantizationError& error);
+
+// float 8개로 되돌린다. (노멀은 길이 1)
+void DecodePackedVertex(const PackedVertex& vertex, const VertexQuantization& quantization, float* out);
+
+uint16_t FloatToHalf(float value);
+float HalfToFloat(uint16_t value);
+
+#endif
@@ -8,12 +8,33 @@
 #include <DirectXMath.h>
 #include <iostream>
 #include <string>
-#include <map>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
 #include <comdef.h>
 #include "DDSTextureLoader.h"
 #include <codecvt>
 #include "objparser.h"
 #include <format>
+#include "JobSystem.h"
+#include "TextureLoadPipeline.h"
+#include "TextureResidency.h"
+#include "TextureContentCache.h"
+#include "CookedTexture.h"
+#include "GeometryUploadBatch.h"
+#include "GeometryPool.h"
+#include "ResourceHeapAllocator.h"
+#include "FrameResources.h"
+#include "CommandRecorder.h"
+#include "DrawQueue.h"
+#include "SceneStore.h"
+#include "ResourceRegistry.h"
+#include "FrustumCuller.h"
+#include "SceneBvh.h"
+#include "OcclusionCuller.h"
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+#include "VertexQuantization.h"
 
 #pragma comment(lib, "d3d12.lib")
 #pragma comment(lib, "dxgi.lib")
@@ -91,6 +112,9 @@ ID3D12Debug* gDebug = nullptr;
 // 장치
 ID3D12Device* gDevice = nullptr;
 
+// 로딩 등에 쓰는 작업 스레드 풀
+std::unique_ptr<JobSystem> gJobSystem;
+
 // 스왑 체인 생성을 위한 dxgi팩토리
 IDXGIFactory4* gFactory = nullptr;
 
@@ -98,6 +122,8 @@ IDXGIFactory4* gFactory = nullptr;
 ID3D12Fence* gFence = nullptr;
 // 현재 펜스 숫자
 UINT64 gCurrentFence = 0;
+// FlushCommandQueue에서 계속 쓰는 대기 이벤트
+HANDLE gFenceEvent = nullptr;
 
 // 커맨드 3형제
 ID3D12CommandQueue* gCommandQueue = nullptr;
@@ -117,19 +143,28 @@ UINT gCurrentBufferIndex = 0;
 ID3D12Resource* gRenderBuffer[SwapChainBufferCount] = { nullptr };
 // 깊이 스텐실 버퍼 리소스 - 깊이 스텐실 힙과 연결됨
 ID3D12Resource* gDepthStencilBuffer = nullptr;
+HeapAllocation gDepthStencilAllocation;
+
+// 기본 힙 리소스를 큰 ID3D12Heap 블록에 놓는 할당기
+ResourceHeapAllocator gHeapAllocator;
 
-// rtv, dsv, cbv힙, 각 핸들은 그때그때 만들어 쓴다.
+// rtv, dsv, srv힙, 각 핸들은 그때그때 만들어 쓴다. 상수 버퍼는 루트 CBV로 넘기므로 힙이 없다.
 ID3D12DescriptorHeap* gRtvHeap = nullptr;
 ID3D12DescriptorHeap* gDsvHeap = nullptr;
-ID3D12DescriptorHeap* gCbvHeap = nullptr;
 ID3D12DescriptorHeap* gSrvHeap = nullptr;
 
 Microsoft::WRL::ComPtr<ID3D12Resource> gScribbleTex;
 
-// rtv, dsv, cbv 힙의 크기
+// rtv, dsv, srv 힙의 서술자 크기
 UINT gRtvHeapSize = 0;
 UINT gDsvHeapSize = 0;
-UINT gCbvHeapSize = 0;
+UINT gSrvHeapSize = 0;
+
+// srv 힙은 텍스쳐를 다 읽은 뒤 InitShaderResources에서 (같은 내용을 합친 텍스쳐 수 + 여유) 크기로 만든다.
+// 여유 자리는 그 뒤에 등록되어 자기 자리가 없는 텍스쳐를 다시 읽어 올릴 때 쓴다. (UpdateTextureResidency)
+const UINT SrvHeapReloadHeadroom = 16;
+UINT gSrvHeapCapacity = 0;
+UINT gSrvHeapUsed = 0;
 
 // 뷰포트
 D3D12_VIEWPORT gViewport = { };
@@ -158,7 +193,16 @@ void CreateScissorRect();
 void CreateFence();
 
 // 텍스쳐 생성 일반화 함수
-void CreateTextureResourceFromFile(std::wstring fileName);
+// 파일 읽기, 헤더 검증, 레이아웃 계산은 워커 스레드에서 하고 커맨드 리스트 기록은 이 스레드에서 한 번에 한다.
+// maxSizes는 파일별 DDS maxsize(상위 밉 자르기). 비어 있으면 전체 밉을 올린다.
+void CreateTextureResourcesFromFiles(const std::vector<std::wstring>& fileNames, const std::vector<size_t>& maxSizes = {});
+// 텍스쳐의 SRV를 자기 힙 위치에 (다시) 만든다. 내려간 텍스쳐는 null SRV
+struct TextureEntry;
+void CreateTextureSrv(ResourceHandle<TextureEntry> handle);
+// gSrvHeap에서 빈 SRV 자리를 하나 준다. 모자라면 assert
+int AllocateSrvHeapIndex();
+// 예산에 맞춰 텍스쳐를 내리거나 밉을 자르고, 다시 쓰인 텍스쳐를 올린다. GPU가 쉬고 있을 때 호출
+void UpdateTextureResidency();
 
 // rtv, dsv 관련 리소스 생성
 void CreateHeapResources();
@@ -168,7 +212,10 @@ void Update();
 
 /*** 그리기 관련 ***/
 // 커맨드 오브젝트들의 리셋
-void PopulateCommandList();
+// 이번 프레임 명령을 기록해서 제출할 순서대로 cmdLists에 담는다.
+void PopulateCommandList(std::vector<ID3D12CommandList*>& cmdLists);
+// 렌더 타겟, 뷰포트, 루트 서명처럼 프레임의 모든 커맨드 리스트가 같이 가져야 하는 상태
+void SetCommonRenderState(CommandRecorder& recorder);
 // 펜스 조작
 void FlushCommandQueue();
 // 그리기
@@ -186,10 +233,23 @@ typedef struct _Vertex
 	XMFLOAT2 tex;
 } Vertex;
 
+// 메쉬 버텍스 형식. 패스마다 형식별 PSO가 있다.
+enum VertexFormat : UINT
+{
+	// Vertex (32바이트)
+	VertexFormatFloat,
+	// PackedVertex (16바이트). 셰이더는 VSMainPacked
+	VertexFormatPacked,
+	VertexFormatCount,
+};
+
 ID3D12RootSignature* gRootSignature = nullptr;
 
-std::map<std::string, ID3DBlob*> gShaders;
-std::map<std::string, ID3D12PipelineState*> gPSOs;
+// 이름은 CreatePSO에서 한 번만 핸들로 바꾼다. 그릴 때는 핸들로 읽는다.
+ResourceRegistry<ID3DBlob*> gShaders;
+ResourceRegistry<ID3D12PipelineState*> gPSOs;
+using ShaderHandle = ResourceRegistry<ID3DBlob*>::Handle;
+using PipelineHandle = ResourceRegistry<ID3D12PipelineState*>::Handle;
 
 // MeshData 생성
 struct Material
@@ -203,45 +263,119 @@ struct Material
 	float Roughness = 0.25f;
 	DirectX::XMFLOAT4X4 MatTransform = Identity4x4();
 };
+using MaterialHandle = ResourceHandle<Material>;
 
 // MeshData 생성
 class MeshData
 {
 public:
-	ID3D12Resource* vertexBuffer;
+	// gGeometryPool에 들어간 메쉬는 버퍼를 따로 갖지 않는다. (nullptr, 뷰는 풀 전체)
+	ID3D12Resource* vertexBuffer = nullptr;
 	D3D12_VERTEX_BUFFER_VIEW vertexBufferView = { };
 
-	ID3D12Resource* indexBuffer;
+	ID3D12Resource* indexBuffer = nullptr;
 	D3D12_INDEX_BUFFER_VIEW indexBufferView = { };
 	UINT indexCount;
 
+	// 풀 안에서의 위치. 따로 만든 버퍼면 0
+	UINT startIndexLocation = 0;
+	INT baseVertexLocation = 0;
+	GeometryAllocation poolAllocation;
+
+	VertexFormat vertexFormat = VertexFormatFloat;
+	// PackedVertex의 0 ~ 1 위치를 로컬 좌표로 되돌리는 행렬 (크기 * 이동). DrawQueueRuns가 월드 행렬 앞에 곱한다.
+	XMFLOAT4X4 positionDecode = Identity4x4();
+
+	// 로컬 공간 AABB. CreateMeshData에서 float 버텍스로 구한다.
+	CullBounds bounds;
+	// gOccluderMeshNames에 있는 메쉬만 CPU에 위치와 인덱스를 남긴다. gOcclusionCuller가 그린다.
+	std::vector<XMFLOAT3> occluderPositions;
+	std::vector<UINT16> occluderIndices;
+	// 함께 만든 LOD 메쉬 수. LOD k는 GetLodMeshName(이름, k)로 등록된다.
+	UINT lodCount = 0;
+
 	void Release()
 	{
-		vertexBuffer->Release();
-		indexBuffer->Release();
+		if (vertexBuffer)
+		{
+			vertexBuffer->Release();
+		}
+		if (indexBuffer)
+		{
+			indexBuffer->Release();
+		}
 	}
 };
 
-struct RenderItem
+// 장면 물체가 쓰는 재질. gScene의 재질 번호가 gSceneMaterials의 위치다.
+struct SceneMaterial
 {
-	RenderItem() = default;
-
-	XMFLOAT4X4 WorldMat = Identity4x4();
-	XMFLOAT4X4 TexTransform = Identity4x4();
-
-	MeshData* MeshData;
-	Material* Material;
+	MaterialHandle Material;
+
+	// GetSceneMaterialId가 채운다. 그릴 때 이름으로 맵을 찾지 않는다.
+	D3D12_GPU_DESCRIPTOR_HANDLE DiffuseSrv = { };
+	// 텍스쳐 상주 관리에 알릴 이름 (같은 내용의 텍스쳐는 처음 올린 이름)
+	std::string TextureResidencyName;
+	// 정렬 키에 넣는 번호 (SRV 위치)
+	UINT SortId = 0;
+	// 상주 관리에 마지막으로 알린 프레임. 같은 재질은 한 프레임에 한 번만 알린다.
+	UINT64 LastMarkedFrame = ~0ull;
 };
 
-std::map<std::string, MeshData> gMeshDatas;
-std::map<std::wstring, Microsoft::WRL::ComPtr<ID3D12Resource>> gTexDatas;
-std::map<std::string, int> gTexDiffuseSrvHeapIndices;
+ResourceRegistry<MeshData> gMeshes;
+using MeshHandle = ResourceRegistry<MeshData>::Handle;
 
-std::map<std::string, Material> gMaterials;
-
-std::vector<std::unique_ptr<RenderItem>> gOpaqueRenderItems;
-std::vector<std::unique_ptr<RenderItem>> gTransparentRenderItems;
-std::vector<std::unique_ptr<RenderItem>> gAlphaTestedRenderItems;
+// 텍스쳐 파일 하나. gTextures에 UTF-8 파일 이름으로 등록한다.
+struct TextureEntry
+{
+	// 내려간 텍스쳐는 nullptr
+	Microsoft::WRL::ComPtr<ID3D12Resource> Resource;
+	// gSrvHeap 안의 SRV 위치. InitShaderResources가 정한다.
+	int SrvHeapIndex = -1;
+	// 같은 내용을 처음 올린 텍스쳐. 같은 내용이면 리소스와 SRV를 함께 쓴다. 아직 안 올렸으면 잘못된 핸들
+	ResourceHandle<TextureEntry> Canonical;
+	// gHeapAllocator에 놓은 텍스쳐의 위치 (쿡 파일로 올린 텍스쳐)
+	HeapAllocation Allocation;
+};
+ResourceRegistry<TextureEntry> gTextures;
+using TextureHandle = ResourceRegistry<TextureEntry>::Handle;
+TextureContentCache gTexContentCache;
+
+ResourceRegistry<Material> gMaterials;
+
+// 정적 메쉬의 스테이징 복사를 모아 둔다.
+GeometryUploadBatch gGeometryUploads;
+
+// 정적 메쉬 전체가 함께 쓰는 버텍스/인덱스 버퍼
+const UINT GeometryPoolMaxVertices = 64 * 1024;
+const UINT GeometryPoolMaxIndices = 256 * 1024;
+GeometryPool gGeometryPool;
+// PackedVertex로 올린 정적 메쉬가 함께 쓰는 버퍼. 크기는 gGeometryPool과 같다.
+GeometryPool gPackedGeometryPool;
+// 정적 메쉬를 오차 한도 안에서 PackedVertex로 줄여 올린다. 명령줄 -floatvertices로 끈다.
+bool gPackedVertices = true;
+
+// 텍스쳐 GPU 메모리 예산
+const UINT64 TextureBudgetBytes = 256ull * 1024 * 1024;
+TextureResidencyManager gTextureResidency(TextureBudgetBytes);
+
+// 그린 프레임 수. 텍스쳐 LRU 판단에 쓴다.
+UINT64 gFrameCount = 0;
+
+// 장면 물체. 월드 행렬, 메쉬, 재질, 플래그를 배열마다 모아 둔다.
+SceneStore gScene;
+// gScene의 메쉬 번호 -> 메쉬. 정렬 키의 메쉬 필드도 이 번호다.
+std::vector<MeshHandle> gSceneMeshes;
+// gScene의 메쉬 번호 -> 로컬 AABB. 컬링이 메쉬 표를 거치지 않고 바로 읽는다.
+std::vector<CullBounds> gSceneMeshBounds;
+// gScene의 메쉬 번호 -> 가리는 물체 메쉬면 1
+std::vector<uint8_t> gSceneMeshOccluders;
+// gScene의 메쉬 번호 -> VertexFormat. 정렬 키의 PSO 필드에 넣는다.
+std::vector<uint8_t> gSceneMeshFormats;
+// gScene의 메쉬 번호 -> LOD 단계마다 그릴 메쉬 번호. [0]은 자기 자신이고 LOD가 없으면 하나뿐이다.
+std::vector<std::vector<uint32_t>> gSceneMeshLods;
+// gScene의 재질 번호 -> 재질
+std::vector<SceneMaterial> gSceneMaterials;
 
 // 초기화
 void CreateRootSignature();
@@ -249,13 +383,40 @@ void CreatePSO();
 
 // 메쉬 초기화 및 버퍼 생성, 그리기
 void CreateMaterials();
-void CreateMeshData(const Vertex* vertices, UINT vertexCount, const UINT16* indices, UINT indexCount, const char* meshName);
+// dynamic이면 CPU에서 계속 고쳐 쓸 수 있게 업로드 힙에 둔다. 아니면 기본 힙에 만들고 gGeometryUploads로 복사한다.
+void CreateMeshData(const Vertex* vertices, UINT vertexCount, const UINT16* indices, UINT indexCount, const char* meshName, bool dynamic = false);
+// 모아 둔 정적 지오메트리 복사를 한 번에 실행한다.
+void SubmitGeometryUploads();
 void CreateBoxGeometry();
 void CreateGrassGeometry();
 void CreateWaterGeometry();
 void CreateObjGeometry();
+// 같은 버텍스를 합치고 삼각형과 버텍스 순서를 GPU 캐시에 맞게 바꾼 뒤 CreateMeshData로 올린다. vertices, indices도 바뀐다.
+// 합친 버텍스가 MaxMeshVertices보다 많으면 (R16 인덱스) E_INVALIDARG로 실패한다.
+const size_t MaxMeshVertices = 0xFFFF;
+void CreateOptimizedMeshData(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, const char* meshName);
 void CreateRenderItems();
-void DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vector<std::unique_ptr<RenderItem>>& renderItems);
+// 메쉬/재질 이름을 gScene에 넣을 번호로 바꾼다. 처음 보는 이름이면 표에 더한다. (로드할 때만)
+uint32_t GetSceneMeshId(const char* meshName);
+// meshName의 LOD lod 메쉬 이름 ("monkey@lod1")
+std::string GetLodMeshName(const char* meshName, UINT lod);
+// 재질 텍스쳐의 SRV 위치도 여기서 찾아 둔다. InitShaderResources 뒤에 호출
+uint32_t GetSceneMaterialId(const char* materialName);
+// gScene을 앞에서부터 한 번 훑어서 이번 프레임 그리기 목록(gDrawQueue)을 만들어 정렬하고 gDrawRuns로 나눈다.
+void BuildDrawQueue();
+// gScene 구조가 바뀌었으면 gSceneBvh를 다시 만들고, 아니면 움직인 물체만 고친다.
+void UpdateSceneBvh();
+// 절두체를 통과한 물체 중 가리는 물체 뒤에 숨은 것을 gSceneVisible에서 뺀다.
+void CullOccludedSceneItems();
+// 물체마다 화면에 비치는 크기로 gScene의 LOD 단계를 고른다. sceneView는 장면 월드 * 뷰, projScale은 프로젝션 _22
+void SelectSceneLods(FXMMATRIX sceneView, float projScale);
+// gScene 밀집 위치 index의 물체가 이번 프레임에 그릴 메쉬 번호 (고른 LOD의 메쉬)
+uint32_t GetSceneDrawMesh(size_t index);
+// 정렬된 목록의 [beginRun, endRun) 구간을 구간마다 인스턴싱 한 번으로 그린다.
+// instances는 미리 잡아 둔 물체 수만큼의 InstanceData 자리. 여러 스레드에서 불러도 된다.
+void DrawQueueRuns(CommandRecorder& recorder, size_t beginRun, size_t endRun, const UploadAllocation& instances);
+// 텍스쳐 상주 관리에 이번 프레임에 쓴 텍스쳐를 알린다. BuildDrawQueue 뒤, 기록 스레드 밖에서
+void MarkSceneTexturesUsed();
 
 // 상수 버퍼
 void InitConstantBuffer();
@@ -264,10 +425,10 @@ void InitConstantBuffer();
 void InitShaderResources();
 
 // 빛 방향 추가
-struct ObjectConstantBuffer
+// 프레임마다 하나 (b0). 물체마다 다른 값은 InstanceData로 넘긴다.
+struct FrameConstantBuffer
 {
-	XMFLOAT4X4 World;
-	XMFLOAT4X4 WorldViewProjection;
+	XMFLOAT4X4 ViewProjection;
 	XMFLOAT3 EyePos;
 	float padding2; // TexOffset을 x,y 모두 적용하려면 padding2를 추가해서 4개 단위로 기록해야 한다.
 	XMFLOAT2 TexOffset;
@@ -279,8 +440,7 @@ struct ObjectConstantBuffer
 	float gFogRange;
 
 	char padding[256
-		- sizeof(World)
-		- sizeof(WorldViewProjection)
+		- sizeof(ViewProjection)
 		- sizeof(EyePos)
 		- sizeof(TexOffset)
 		- sizeof(padding2)
@@ -293,9 +453,107 @@ struct ObjectConstantBuffer
 	];
 };
 
-ID3D12Resource* gConstantBuffer = nullptr;
-ObjectConstantBuffer gConstantBufferData;
-UINT8* gCbvDataBegin;
+// 물체마다 셰이더의 gInstances(t1)에 들어가는 값. 같은 메쉬와 재질이 이어지는 구간(run)은 한 번의 DrawIndexedInstanced로 그린다.
+struct InstanceData
+{
+	XMFLOAT4X4 World;
+	XMFLOAT4X4 TexTransform;
+};
+
+// 프레임 전체에 같은 값(카메라, 빛, 안개). 프레임마다 한 번 프레임 상수 할당기에 쓴다.
+FrameConstantBuffer gConstantBufferData;
+
+// CPU가 GPU보다 최대 몇 프레임 앞서서 기록할지. 프레임 자원은 gMaxFramesAhead + 1벌
+// 크면 처리량이, 작으면 입력 지연이 좋아진다. 명령줄 -framesahead N으로 바꾼다.
+UINT gMaxFramesAhead = 2;
+const UINT MaxFramesAheadLimit = 8;
+// 이 프레임 수마다 프레임 시간/CPU 대기 통계를 출력하고 새로 잰다.
+const UINT64 FrameStatsInterval = 600;
+// 한 프레임에 그릴 수 있는 물체 수
+const UINT64 MaxInstancesPerFrame = 64 * 1024;
+// 루트 SRV 주소 정렬 (StructuredBuffer 원소 크기의 배수면 충분하다)
+const UINT64 InstanceDataAlignment = 16;
+// 프레임당 상수 버퍼 + 인스턴스 데이터 공간 (조각마다 정렬로 버리는 자리를 넉넉히 더한다)
+const UINT64 FrameConstantBytes = MaxInstancesPerFrame * sizeof(InstanceData) + 64 * 1024;
+// 명령줄 -boxes N으로 상자 N개를 격자로 더 놓는다. (인스턴싱 확인용)
+UINT gStressBoxCount = 0;
+FrameResourceRing gFrameResources;
+
+// 켜 두면 물체 묶음(큰 묶음은 여러 조각)을 커맨드 리스트 여러 개에 나눠서 gJobSystem으로 동시에 기록한다. P 키로 바꾼다.
+bool gParallelRecording = true;
+// 켜 두면 절두체 밖의 물체를 그리기 목록에 넣지 않는다. C 키로 바꾼다.
+bool gFrustumCulling = true;
+// 평면은 Update에서 카메라가 바뀔 때마다 다시 뽑는다.
+FrustumCuller gFrustumCuller;
+// gScene 밀집 위치마다 이번 프레임 컬링 결과 (1이면 그린다)
+std::vector<uint8_t> gSceneVisible;
+// FrameStatsInterval 동안 검사한 물체와 거른 물체
+FrustumCullStats gFrustumCullStats;
+// 켜 두면 절두체 컬링을 물체마다 하지 않고 gSceneBvh를 내려가며 한다. B 키로 바꾼다.
+bool gBvhCulling = true;
+// gScene 밀집 위치를 물체 번호로 쓰는 BVH. 물체를 더하거나 지우면 다시 만들고, gScene.SetWorld로 움직인 물체는 RefitItem으로 고친다.
+SceneBvh gSceneBvh;
+// gSceneBvh를 만들 때의 gScene 구조 버전. BVH 컬링을 끄는 동안 물체가 움직이면 맞지 않는 값으로 둔다.
+uint32_t gSceneBvhVersion = ~0u;
+// gScene 밀집 위치마다 월드 AABB
+std::vector<BvhBounds> gSceneBvhBounds;
+// QueryFrustum 결과를 매 프레임 다시 쓴다.
+std::vector<uint32_t> gSceneBvhVisibleItems;
+// 켜 두면 가리는 물체를 CPU 깊이 버퍼에 그리고 그 뒤에 숨은 물체를 그리지 않는다. O 키로 바꾼다.
+bool gOcclusionCulling = true;
+// 큰 불투명 메쉬만 가리는 물체로 쓴다. 이 메쉬를 쓰는 장면 물체가 모두 가리는 물체가 된다.
+const char* const gOccluderMeshNames[] = { "grass" };
+OcclusionCuller gOcclusionCuller;
+OcclusionCullStats gOcclusionCullStats;
+// 켜 두면 Update에서 물체마다 화면 크기로 LOD를 고른다. L 키로 바꾼다.
+bool gLodSelection = true;
+// OBJ 메쉬를 읽을 때 만드는 LOD 수. 단계마다 삼각형을 MeshLodReduction배로 줄인다.
+const UINT MaxMeshLods = 3;
+const float MeshLodReduction = 0.5f;
+// 오버드로를 줄이려고 클러스터를 나눌 때 허용하는 ACMR 증가 비율
+const float MeshOverdrawThreshold = 1.05f;
+// 이보다 삼각형이 적은 메쉬는 LOD를 만들지 않는다.
+const size_t MinLodSourceTriangles = 256;
+// 물체 지름이 화면 높이의 gLodScreenSizes[k]배보다 작으면 LOD k + 1 이상을 그린다.
+const float gLodScreenSizes[MaxMeshLods] = { 0.25f, 0.12f, 0.06f };
+// LOD를 고를 때 작업 하나가 맡을 최소 물체 수
+const size_t LodSelectionGrain = 4096;
+// FrameStatsInterval 동안 LOD 단계마다 그린 물체 수
+UINT64 gLodDrawCounts[MaxMeshLods + 1] = { };
+// 한 프레임에 쓸 수 있는 병렬 기록용 커맨드 리스트 수 (프레임 자원마다 할당기도 이만큼)
+const UINT MaxRecordingLists = 16;
+// 커맨드 리스트 하나에 맡길 최소 물체 수. 이보다 잘게 나누면 리스트마다 상태를 다시 잡는 비용이 더 크다.
+const size_t MinItemsPerRecordingList = 256;
+std::vector<Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList>> gRecordingCommandLists;
+// 커맨드 리스트마다 하나. 0번은 gCommandList, i + 1번은 gRecordingCommandLists[i]
+std::vector<CommandRecorder> gCommandRecorders;
+// FrameStatsInterval 동안 넣은 호출과 거른 호출
+CommandRecorderStats gCommandRecorderStats;
+
+// 그리기 패스. 정렬 키의 맨 앞 필드라서 이 순서대로 그려진다.
+enum DrawPass : UINT
+{
+	DrawPassMarkStencil,
+	DrawPassOpaque,
+	DrawPassAlphaTested,
+	DrawPassTransparent,
+	DrawPassCount,
+};
+// 정렬된 목록에서 패스, 메쉬, 재질이 같은 연속 구간. 상태는 구간마다 한 번만 잡는다.
+struct DrawRun
+{
+	UINT Begin;
+	UINT Count;
+};
+// 항목의 Index는 gScene의 밀집 위치, 패스는 키의 맨 앞 필드
+DrawQueue gDrawQueue;
+std::vector<DrawRun> gDrawRuns;
+// 패스와 버텍스 형식마다 PSO 핸들. CreatePSO에서 받는다.
+PipelineHandle gDrawPassPipelines[DrawPassCount][VertexFormatCount];
+// 패스와 버텍스 형식마다 PSO. PopulateCommandList에서 핸들로 채운다.
+ID3D12PipelineState* gDrawPassPSOs[DrawPassCount][VertexFormatCount] = { };
+// 이번 프레임 상수 버퍼 자리. PopulateCommandList에서 기록 전에 쓴다.
+UploadAllocation gFrameConstants;
 
 // 모델 뷰 프로젝션
 XMFLOAT4X4 gWorld = Identity4x4();
@@ -327,6 +585,24 @@ int WINAPI wWinMain(
 {
 	LPCWSTR className = L"DX12Study!";
 
+	if (lpCmdLine)
+	{
+		if (const wchar_t* arg = wcsstr(lpCmdLine, L"-framesahead "))
+		{
+			const long framesAhead = wcstol(arg + wcslen(L"-framesahead "), nullptr, 10);
+			gMaxFramesAhead = static_cast<UINT>(std::clamp(framesAhead, 1L, static_cast<long>(MaxFramesAheadLimit)));
+		}
+		if (const wchar_t* arg = wcsstr(lpCmdLine, L"-boxes "))
+		{
+			const long boxCount = wcstol(arg + wcslen(L"-boxes "), nullptr, 10);
+			gStressBoxCount = static_cast<UINT>(std::clamp(boxCount, 0L, static_cast<long>(MaxInstancesPerFrame / 2)));
+		}
+		if (wcsstr(lpCmdLine, L"-floatvertices"))
+		{
+			gPackedVertices = false;
+		}
+	}
+
 	WNDCLASS wc;
 	wc.style = 0;
 	wc.lpfnWndProc = WndProc;
@@ -407,6 +683,36 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 		{
 			isRightKeyPressed = true;
 		}
+		else if (wParam == 'P')
+		{
+			gParallelRecording = !gParallelRecording;
+			auto s = std::format(L"Parallel command list recording: {}\n", gParallelRecording ? L"on" : L"off");
+			OutputDebugString(s.c_str());
+		}
+		else if (wParam == 'C')
+		{
+			gFrustumCulling = !gFrustumCulling;
+			auto s = std::format(L"Frustum culling: {}\n", gFrustumCulling ? L"on" : L"off");
+			OutputDebugString(s.c_str());
+		}
+		else if (wParam == 'B')
+		{
+			gBvhCulling = !gBvhCulling;
+			auto s = std::format(L"BVH culling: {}\n", gBvhCulling ? L"on" : L"off");
+			OutputDebugString(s.c_str());
+		}
+		else if (wParam == 'O')
+		{
+			gOcclusionCulling = !gOcclusionCulling;
+			auto s = std::format(L"Occlusion culling: {}\n", gOcclusionCulling ? L"on" : L"off");
+			OutputDebugString(s.c_str());
+		}
+		else if (wParam == 'L')
+		{
+			gLodSelection = !gLodSelection;
+			auto s = std::format(L"LOD selection: {}\n", gLodSelection ? L"on" : L"off");
+			OutputDebugString(s.c_str());
+		}
 		break;
 	case WM_KEYUP:
 		if (wParam == VK_LEFT)
@@ -439,6 +745,9 @@ void MakeResourceTransitionDepthStencilBuffer()
 	auto transition = CD3DX12_RESOURCE_BARRIER::Transition(gDepthStencilBuffer, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_DEPTH_WRITE);
 	gCommandList->ResourceBarrier(1, &transition);
 
+	// 힙에 놓은 깊이 버퍼는 내용이 정해져 있지 않으므로 처음 쓰기 전에 초기화한다.
+	gCommandList->DiscardResource(gDepthStencilBuffer, nullptr);
+
 	// 무조건 닫아준다.
 	ThrowIfFailed(gCommandList->Close());
 
@@ -451,6 +760,8 @@ HRESULT InitD3D(HWND hWnd)
 {
 	gHWnd = hWnd;
 
+	gJobSystem = std::make_unique<JobSystem>();
+
 	CreateDebug();
 	CreateFactory();
 	CreateDevice();
@@ -464,26 +775,33 @@ HRESULT InitD3D(HWND hWnd)
 	CreateHeapResources();
 	CreateFence();
 
-	CreateTextureResourceFromFile(L"scribble.dds");
-	CreateTextureResourceFromFile(L"grass.dds");
-	CreateTextureResourceFromFile(L"bricks.dds");
-	CreateTextureResourceFromFile(L"water.dds");
-	CreateTextureResourceFromFile(L"WireFence.dds");
+	CreateTextureResourcesFromFiles({
+		L"scribble.dds",
+		L"grass.dds",
+		L"bricks.dds",
+		L"water.dds",
+		L"WireFence.dds",
+	});
 
 	MakeResourceTransitionDepthStencilBuffer();
 
 	CreateMaterials();
 
+	ThrowIfFailed(gGeometryPool.Create(gDevice, sizeof(Vertex), GeometryPoolMaxVertices, GeometryPoolMaxIndices, DXGI_FORMAT_R16_UINT, &gHeapAllocator));
+	ThrowIfFailed(gPackedGeometryPool.Create(gDevice, sizeof(PackedVertex), GeometryPoolMaxVertices, GeometryPoolMaxIndices, DXGI_FORMAT_R16_UINT, &gHeapAllocator));
+
 	CreateBoxGeometry();
 	CreateGrassGeometry();
 	CreateWaterGeometry();
 	CreateObjGeometry();
+	SubmitGeometryUploads();
+
+	// 물체를 만들 때 SRV 위치를 찾아 두므로 먼저 만든다.
+	InitShaderResources();
 	CreateRenderItems();
 
 	InitConstantBuffer();
 
-	InitShaderResources();
-
 	CreateViewport();
 	CreateScissorRect();
 
@@ -506,6 +824,8 @@ void CreateFactory()
 void CreateDevice()
 {
 	ThrowIfFailed(D3D12CreateDevice(nullptr, D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&gDevice)));
+
+	gHeapAllocator.Initialize(gDevice);
 }
 
 void CreateCommandObjects()
@@ -521,6 +841,15 @@ void CreateCommandObjects()
 
 	// 무조건 닫아준다.
 	ThrowIfFailed(gCommandList->Close());
+
+	// 병렬 기록용 리스트. 할당기는 프레임 자원에 있으므로 여기서는 만들고 닫아만 둔다.
+	gRecordingCommandLists.resize(MaxRecordingLists);
+	gCommandRecorders.resize(MaxRecordingLists + 1);
+	for (auto& cmdList : gRecordingCommandLists)
+	{
+		ThrowIfFailed(gDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, gCommandAlloc, nullptr, IID_PPV_ARGS(&cmdList)));
+		ThrowIfFailed(cmdList->Close());
+	}
 }
 
 void CreateHeaps()
@@ -541,27 +870,11 @@ void CreateHeaps()
 
 	ThrowIfFailed(gDevice->CreateDescriptorHeap(&dsvHeapDesc, IID_PPV_ARGS(&gDsvHeap)));
 
-	// cbv
-	D3D12_DESCRIPTOR_HEAP_DESC cbvHeapDesc = {};
-	cbvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-	cbvHeapDesc.NumDescriptors = 1;
-	cbvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-
-	ThrowIfFailed(gDevice->CreateDescriptorHeap(&cbvHeapDesc, IID_PPV_ARGS(&gCbvHeap)));
-
-	// srv
-	D3D12_DESCRIPTOR_HEAP_DESC srvHeapDesc = {};
-	srvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-	// 텍스쳐 개수 변경
-	srvHeapDesc.NumDescriptors = 5;
-	srvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-
-	ThrowIfFailed(gDevice->CreateDescriptorHeap(&srvHeapDesc, IID_PPV_ARGS(&gSrvHeap)));
-
+	// srv 힙은 텍스쳐 개수를 알아야 하므로 InitShaderResources에서 만든다.
 
 	gRtvHeapSize = gDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
 	gDsvHeapSize = gDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
-	gCbvHeapSize = gDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+	gSrvHeapSize = gDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 }
 
 void CreateSwapChain()
@@ -614,6 +927,12 @@ void CreateScissorRect()
 void CreateFence()
 {
 	ThrowIfFailed(gDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&gFence)));
+
+	gFenceEvent = CreateEvent(nullptr, false, false, nullptr);
+	if (gFenceEvent == NULL)
+	{
+		ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+	}
 }
 
 void CreateHeapResources()
@@ -646,8 +965,10 @@ void CreateHeapResources()
 	clearValue.DepthStencil.Depth = 1.0f;
 	clearValue.DepthStencil.Stencil = 0x85;
 
-	auto defHeapProp = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
-	gDevice->CreateCommittedResource(&defHeapProp, D3D12_HEAP_FLAG_NONE, &depthStencilDesc, D3D12_RESOURCE_STATE_COMMON, &clearValue, IID_PPV_ARGS(&gDepthStencilBuffer));
+	Microsoft::WRL::ComPtr<ID3D12Resource> depthStencilBuffer;
+	ThrowIfFailed(gHeapAllocator.CreateResource(depthStencilDesc, D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COMMON, &clearValue,
+		depthStencilBuffer, gDepthStencilAllocation));
+	gDepthStencilBuffer = depthStencilBuffer.Detach();
 
 	D3D12_DEPTH_STENCIL_VIEW_DESC dsvDesc = {};
 	dsvDesc.Format = gDepthStencilFormat;
@@ -685,11 +1006,12 @@ void Update()
 	XMMATRIX proj = XMMatrixPerspectiveFovLH(XM_PIDIV2, aspectRatio, 1, 1000);
 	XMStoreFloat4x4(&gProj, proj);
 
-	XMMATRIX world = XMLoadFloat4x4(&gWorld);
-	auto worldViewProjection = XMMatrixTranspose(world * view * proj);
+	// 물체 월드 행렬 뒤에 곱하는 부분 전체로 절두체를 만든다.
+	gFrustumCuller.SetViewProjection(XMLoadFloat4x4(&gWorld) * view * proj);
+	gOcclusionCuller.SetViewProjection(XMLoadFloat4x4(&gWorld) * view * proj);
+	SelectSceneLods(XMLoadFloat4x4(&gWorld) * view, gProj._22);
 
-	XMStoreFloat4x4(&gConstantBufferData.World, world);
-	XMStoreFloat4x4(&gConstantBufferData.WorldViewProjection, worldViewProjection);
+	// ViewProjection은 PopulateCommandList에서, 물체의 World는 DrawQueueRuns에서 인스턴스 데이터로 채운다.
 	XMStoreFloat3(&gConstantBufferData.EyePos, pos);
 
 	XMVECTOR texOffset = XMVectorSet(gTheta, gTheta, 0, 0);
@@ -704,60 +1026,178 @@ void Update()
 
 	gConstantBufferData.gFogStart = 5.0f;
 	gConstantBufferData.gFogRange = 50.0f;
-
-	memcpy(gCbvDataBegin, &gConstantBufferData, sizeof(gConstantBufferData));
 }
 
-void PopulateCommandList()
+void SetCommonRenderState(CommandRecorder& recorder)
 {
-	// 커맨드리스트, 할당자 리셋 및 렌더 명령 기록
-	ThrowIfFailed(gCommandAlloc->Reset());
-	// 파이프라인 상태 객체 기본값 넣기
-	ThrowIfFailed(gCommandList->Reset(gCommandAlloc, gPSOs["opaque"]));
+	auto cmdList = recorder.Get();
 
 	// 루트 서명 넣기
-	gCommandList->SetGraphicsRootSignature(gRootSignature);
+	recorder.SetGraphicsRootSignature(gRootSignature);
 
-	// RS
-	gCommandList->RSSetViewports(1, &gViewport);
-	gCommandList->RSSetScissorRects(1, &gScissorRect);
+	// 셰이더에서 보는 CBV/SRV 힙은 gSrvHeap 하나뿐이고 프레임 내내 같다. (상수 버퍼는 루트 CBV)
+	recorder.SetDescriptorHeap(gSrvHeap);
 
-	// rtv 처리
-	CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(gRtvHeap->GetCPUDescriptorHandleForHeapStart(), gCurrentBufferIndex, gRtvHeapSize);
+	// 첫 번째 루트 파라미터: 이번 프레임 상수 버퍼
+	recorder.SetGraphicsRootConstantBufferView(0, gFrameConstants.GpuAddress);
+
+	// RS
+	cmdList->RSSetViewports(1, &gViewport);
+	cmdList->RSSetScissorRects(1, &gScissorRect);
 
 	// OMSetRenderTargets은 render target을 그리기 전에 미리 핸들을 먼저 얻은 다음 호출해야 한다.
+	CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(gRtvHeap->GetCPUDescriptorHandleForHeapStart(), gCurrentBufferIndex, gRtvHeapSize);
 	auto dsvCpuHandle = gDsvHeap->GetCPUDescriptorHandleForHeapStart();
-	gCommandList->OMSetRenderTargets(1, &rtvHandle, true, &dsvCpuHandle);
+	cmdList->OMSetRenderTargets(1, &rtvHandle, true, &dsvCpuHandle);
+
+	recorder.OMSetStencilRef(1);
+	recorder.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+}
+
+void PopulateCommandList(std::vector<ID3D12CommandList*>& cmdLists)
+{
+	// 커맨드리스트 리셋 및 렌더 명령 기록. 할당자는 BeginFrame에서 이번 프레임 것을 리셋했다.
+	auto& frame = gFrameResources.GetCurrent();
+
+	// 패스와 버텍스 형식마다 PSO. 핸들의 배열 위치로 바로 읽는다.
+	for (UINT pass = 0; pass < DrawPassCount; pass++)
+	{
+		for (UINT format = 0; format < VertexFormatCount; format++)
+		{
+			gDrawPassPSOs[pass][format] = gPSOs[gDrawPassPipelines[pass][format]];
+		}
+	}
+
+	// 파이프라인 상태 객체 기본값 넣기
+	ThrowIfFailed(gCommandList->Reset(frame.CommandAllocator.Get(), gDrawPassPSOs[DrawPassOpaque][VertexFormatFloat]));
+
+	// 프레임 상수 버퍼는 한 번만 쓰고 모든 리스트가 같은 주소를 묶는다.
+	if (!frame.Constants.Allocate(sizeof(FrameConstantBuffer), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, gFrameConstants))
+	{
+		ThrowIfFailed(E_OUTOFMEMORY);
+	}
+	FrameConstantBuffer frameConstants = gConstantBufferData;
+	XMStoreFloat4x4(&frameConstants.ViewProjection, XMMatrixTranspose(XMLoadFloat4x4(&gView) * XMLoadFloat4x4(&gProj)));
+	memcpy(gFrameConstants.CpuAddress, &frameConstants, sizeof(frameConstants));
+
+	auto& mainRecorder = gCommandRecorders[0];
+	mainRecorder.Begin(gCommandList, gDrawPassPSOs[DrawPassOpaque][VertexFormatFloat]);
+	SetCommonRenderState(mainRecorder);
 
 	auto transition1 = CD3DX12_RESOURCE_BARRIER::Transition(gRenderBuffer[gCurrentBufferIndex], D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET);
 	gCommandList->ResourceBarrier(1, &transition1);
 
 	// 렌더 명령 기록
+	CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(gRtvHeap->GetCPUDescriptorHandleForHeapStart(), gCurrentBufferIndex, gRtvHeapSize);
 	gCommandList->ClearRenderTargetView(rtvHandle, Colors::AliceBlue, 0, nullptr);
 
 	CD3DX12_CPU_DESCRIPTOR_HANDLE dsvHandle(gDsvHeap->GetCPUDescriptorHandleForHeapStart(), 0, gDsvHeapSize);
 	gCommandList->ClearDepthStencilView(dsvHandle, D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0x85, 0, nullptr);
 
-	// 각종 물체 그리기 및 PSO 변경
+	// 각종 물체를 정렬 키 순서대로 그린다. (패스 -> PSO -> 재질 -> 메쉬 -> 깊이, 반투명은 깊이가 먼저)
+	BuildDrawQueue();
+	MarkSceneTexturesUsed();
+
+	auto transition2 = CD3DX12_RESOURCE_BARRIER::Transition(gRenderBuffer[gCurrentBufferIndex], D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
 
-	gCommandList->OMSetStencilRef(1);
-	gCommandList->SetPipelineState(gPSOs["markStencil"]);
-	DrawRenderItems(gCommandList, gAlphaTestedRenderItems);
+	cmdLists.clear();
+	cmdLists.push_back(gCommandList);
 
-	gCommandList->SetPipelineState(gPSOs["opaque"]); // gCommandList->Reset() 시 지정하므로 다시 지정하지 않아도 됨
-	DrawRenderItems(gCommandList, gOpaqueRenderItems);
+	if (!gParallelRecording)
+	{
+		// 한 리스트에 차례로 기록
+		if (!gDrawRuns.empty())
+		{
+			UploadAllocation instances;
+			if (!frame.Constants.Allocate(gDrawQueue.GetSize() * sizeof(InstanceData), InstanceDataAlignment, instances))
+			{
+				ThrowIfFailed(E_OUTOFMEMORY);
+			}
+			DrawQueueRuns(mainRecorder, 0, gDrawRuns.size(), instances);
+		}
 
-	gCommandList->SetPipelineState(gPSOs["alphaTested"]);
-	DrawRenderItems(gCommandList, gAlphaTestedRenderItems);
+		gCommandList->ResourceBarrier(1, &transition2);
+		ThrowIfFailed(gCommandList->Close());
 
-	gCommandList->SetPipelineState(gPSOs["transparent"]);
-	DrawRenderItems(gCommandList, gTransparentRenderItems);
+		gCommandRecorderStats += mainRecorder.GetStats();
+		mainRecorder.ResetStats();
+		return;
+	}
 
-	
-	auto transition2 = CD3DX12_RESOURCE_BARRIER::Transition(gRenderBuffer[gCurrentBufferIndex], D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
-	gCommandList->ResourceBarrier(1, &transition2);
+	// 정렬된 목록을 grain개 이상씩 잘라서 리스트 하나에 기록한다. 구간(run) 중간에서는 자르지 않는다.
+	// 마지막 조각 말고는 grain개 이상이므로 리스트 수는 MaxRecordingLists를 넘지 않는다.
+	const size_t totalItems = gDrawQueue.GetSize();
+	const size_t grain = std::max(MinItemsPerRecordingList, (totalItems + MaxRecordingLists - 1) / MaxRecordingLists);
 
+	// 인스턴스 데이터 자리는 기록 스레드가 나눠 쓰지 않도록 여기서 조각마다 미리 잡는다.
+	struct RecordTask
+	{
+		size_t BeginRun;
+		size_t EndRun;
+		UploadAllocation Instances;
+	};
+	std::vector<RecordTask> tasks;
+	for (size_t beginRun = 0; beginRun < gDrawRuns.size();)
+	{
+		size_t endRun = beginRun;
+		size_t itemCount = 0;
+		while (endRun < gDrawRuns.size() && itemCount < grain)
+		{
+			itemCount += gDrawRuns[endRun].Count;
+			endRun++;
+		}
+
+		RecordTask task = { beginRun, endRun, {} };
+		if (!frame.Constants.Allocate(itemCount * sizeof(InstanceData), InstanceDataAlignment, task.Instances))
+		{
+			ThrowIfFailed(E_OUTOFMEMORY);
+		}
+		tasks.push_back(task);
+		beginRun = endRun;
+	}
+
+	// 그릴 것이 없으면 마지막 배리어도 첫 리스트에 넣는다.
+	if (tasks.empty())
+	{
+		gCommandList->ResourceBarrier(1, &transition2);
+	}
 	ThrowIfFailed(gCommandList->Close());
+
+	const auto& entries = gDrawQueue.GetEntries();
+	gJobSystem->ParallelFor(tasks.size(), 1, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				const auto& task = tasks[i];
+				auto cmdList = gRecordingCommandLists[i].Get();
+				auto pso = gDrawPassPSOs[DrawSortKey::GetPass(entries[gDrawRuns[task.BeginRun].Begin].Key)][VertexFormatFloat];
+
+				// 커맨드 리스트 상태는 리스트끼리 이어지지 않으므로 리스트마다 다시 잡는다.
+				auto& recorder = gCommandRecorders[i + 1];
+				ThrowIfFailed(cmdList->Reset(frame.RecordingAllocators[i].Get(), pso));
+				recorder.Begin(cmdList, pso);
+				SetCommonRenderState(recorder);
+				DrawQueueRuns(recorder, task.BeginRun, task.EndRun, task.Instances);
+
+				if (i + 1 == tasks.size())
+				{
+					cmdList->ResourceBarrier(1, &transition2);
+				}
+				ThrowIfFailed(cmdList->Close());
+			}
+		});
+
+	// 기록은 순서 없이 끝나도 제출은 그리는 순서대로 한 번에 한다.
+	for (size_t i = 0; i < tasks.size(); i++)
+	{
+		cmdLists.push_back(gRecordingCommandLists[i].Get());
+	}
+
+	for (size_t i = 0; i <= tasks.size(); i++)
+	{
+		gCommandRecorderStats += gCommandRecorders[i].GetStats();
+		gCommandRecorders[i].ResetStats();
+	}
 }
 
 void FlushCommandQueue()
@@ -767,62 +1207,99 @@ void FlushCommandQueue()
 
 	ThrowIfFailed(gCommandQueue->Signal(gFence, gCurrentFence));
 
+	// 이벤트는 CreateFence에서 한 번만 만든다.
 	if (gFence->GetCompletedValue() < gCurrentFence)
 	{
-		HANDLE eventHandle = CreateEvent(nullptr, false, false, nullptr);
-		if (eventHandle != NULL)
-		{
-			ThrowIfFailed(gFence->SetEventOnCompletion(gCurrentFence, eventHandle));
-			WaitForSingleObject(eventHandle, INFINITE);
-			CloseHandle(eventHandle);
-		}
+		ThrowIfFailed(gFence->SetEventOnCompletion(gCurrentFence, gFenceEvent));
+		WaitForSingleObject(gFenceEvent, INFINITE);
 	}
 }
 
 void Render()
 {
-	PopulateCommandList();
+	// 이번 프레임 자원을 GPU가 아직 쓰고 있을 때만 기다린다. (gMaxFramesAhead 프레임 앞서 갈 수 있다)
+	gFrameResources.BeginFrame(gFence);
 
-	ID3D12CommandList* cmdLists[] = { gCommandList };
-	gCommandQueue->ExecuteCommandLists(_countof(cmdLists), cmdLists);
+	const auto recordStart = std::chrono::steady_clock::now();
+	std::vector<ID3D12CommandList*> cmdLists;
+	PopulateCommandList(cmdLists);
+	gFrameResources.AddRecordTime(std::chrono::duration<double>(std::chrono::steady_clock::now() - recordStart).count(), static_cast<UINT>(cmdLists.size()));
+
+	gCommandQueue->ExecuteCommandLists(static_cast<UINT>(cmdLists.size()), cmdLists.data());
 
 	// 첫 번째 인자는 vsync의 여부
 	ThrowIfFailed(gSwapChain->Present(0, 0));
 
 	gCurrentBufferIndex = (gCurrentBufferIndex + 1) % SwapChainBufferCount;
 
-	FlushCommandQueue();
+	// 매 프레임 기다리지 않고 펜스 값만 남겨 둔다.
+	ThrowIfFailed(gFrameResources.EndFrame(gCommandQueue, gFence, gCurrentFence));
+
+	if (gFrameResources.GetStats().Frames >= FrameStatsInterval)
+	{
+		auto s = std::format(L"[frames ahead {}] {}", gMaxFramesAhead, gFrameResources.GetStats().ToString());
+		OutputDebugString(s.c_str());
+		gFrameResources.ResetWindow();
+
+		s = gCommandRecorderStats.ToString();
+		OutputDebugString(s.c_str());
+
+		s = std::format(L"DrawQueue: {} items in {} runs, {} radix passes\n", gDrawQueue.GetSize(), gDrawRuns.size(), gDrawQueue.GetLastSortPasses());
+		OutputDebugString(s.c_str());
+		gCommandRecorderStats = CommandRecorderStats();
+
+		OutputDebugString(gFrustumCullStats.ToString().c_str());
+		gFrustumCullStats = FrustumCullStats();
+
+		OutputDebugString(gOcclusionCullStats.ToString().c_str());
+		gOcclusionCullStats = OcclusionCullStats();
+
+		s = L"LOD items:";
+		for (UINT lod = 0; lod <= MaxMeshLods; lod++)
+		{
+			s += std::format(L" {}", gLodDrawCounts[lod]);
+			gLodDrawCounts[lod] = 0;
+		}
+		s += L"\n";
+		OutputDebugString(s.c_str());
+	}
+
+	// 할 일이 있을 때만 GPU를 기다린 뒤 텍스쳐를 내리거나 바꾼다.
+	UpdateTextureResidency();
+
+	gFrameCount++;
 }
 
 void Release()
 {
-	for (auto var : gTexDatas)
-	{
-		gTexDatas[var.first].Reset();
-	}
+	// 아직 GPU에서 돌고 있는 프레임이 있을 수 있다.
+	FlushCommandQueue();
 
-	COM_RELEASE(gConstantBuffer);
+	// 캐시도 리소스를 잡고 있다. 힙(gHeapAllocator.Release)보다 먼저 모두 놓아야 한다.
+	gTextures.ForEach([](TextureHandle, TextureEntry& texture) { texture.Resource.Reset(); });
+	gTexContentCache.Clear();
 
-	for (auto var : gMeshDatas)
-	{
-		gMeshDatas[var.first].Release();
-	}
+	gFrameResources.Release();
+	gRecordingCommandLists.clear();
+	gCommandRecorders.clear();
 
-	gScribbleTex.Reset();
+	gMeshes.ForEach([](MeshHandle, MeshData& meshData) { meshData.Release(); });
+	gGeometryPool.Release();
+	gPackedGeometryPool.Release();
 
-	for (auto var : gPSOs)
-	{
-		gPSOs[var.first]->Release();
-	}
+	gScribbleTex.Reset();
 
-	for (auto var : gShaders)
-	{
-		gShaders[var.first]->Release();
-	}
+	gPSOs.ForEach([](PipelineHandle, ID3D12PipelineState* pso) { pso->Release(); });
+	gShaders.ForEach([](ShaderHandle, ID3DBlob* shader) { shader->Release(); });
 
 	COM_RELEASE(gRootSignature);
 
 	COM_RELEASE(gFence);
+	if (gFenceEvent)
+	{
+		CloseHandle(gFenceEvent);
+		gFenceEvent = nullptr;
+	}
 
 	for (size_t i = 0; i < SwapChainBufferCount; i++)
 	{
@@ -830,11 +1307,15 @@ void Release()
 	}
 
 	COM_RELEASE(gDepthStencilBuffer);
+	gHeapAllocator.Free(gDepthStencilAllocation);
+
+	gTextures.ForEach([](TextureHandle, TextureEntry& texture) { gHeapAllocator.Free(texture.Allocation); });
+	gTextures.Clear();
+	gHeapAllocator.Release();
 
 	COM_RELEASE(gSwapChain);
 
 	COM_RELEASE(gSrvHeap);
-	COM_RELEASE(gCbvHeap);
 	COM_RELEASE(gDsvHeap);
 	COM_RELEASE(gRtvHeap);
 
@@ -842,11 +1323,15 @@ void Release()
 	COM_RELEASE(gCommandAlloc);
 	COM_RELEASE(gCommandList);
 
+	// 장치보다 오래 사는 텍스쳐가 없어야 한다.
+	assert(gTexContentCache.IsEmpty());
 	COM_RELEASE(gDevice);
 	COM_RELEASE(gFactory);
 
 	COM_RELEASE(gDebug);
 
+	gJobSystem.reset();
+
 #if defined(_DEBUG)
 	IDXGIDebug1* dxgiDebug;
 	ThrowIfFailed(DXGIGetDebugInterface1(0, IID_PPV_ARGS(&dxgiDebug)));
@@ -857,13 +1342,10 @@ void Release()
 
 void CreateRootSignature()
 {
-	CD3DX12_ROOT_PARAMETER rootParams[2];
+	CD3DX12_ROOT_PARAMETER rootParams[3];
 
-	{
-		CD3DX12_DESCRIPTOR_RANGE range[1];
-		range[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, 0);
-		rootParams[0].InitAsDescriptorTable(1, &range[0]);
-	}
+	// 프레임 상수 버퍼 (b0). 프레임 상수 할당기의 주소를 바로 넘긴다.
+	rootParams[0].InitAsConstantBufferView(0);
 
 	{
 		CD3DX12_DESCRIPTOR_RANGE range[1];
@@ -871,6 +1353,9 @@ void CreateRootSignature()
 		rootParams[1].InitAsDescriptorTable(1, &range[0]);
 	}
 
+	// 인스턴스 데이터 (t1). 구간마다 프레임 상수 할당기에 쓴 StructuredBuffer 주소를 넘긴다.
+	rootParams[2].InitAsShaderResourceView(1);
+
 	// TODO: 기본 샘플러 생성 
 	CD3DX12_STATIC_SAMPLER_DESC sampler(0);
 
@@ -892,8 +1377,16 @@ void CreatePSO()
 		{"NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, sizeof(XMFLOAT3), D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
 		{"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, sizeof(XMFLOAT3) + sizeof(XMFLOAT3), D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
 	};
+	// PackedVertex: 위치 0 ~ 1, 팔면체 노멀, half UV. VSMainPacked가 복원한다.
+	D3D12_INPUT_ELEMENT_DESC packedInputElementDesc[] =
+	{
+		{"POSITION", 0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, offsetof(PackedVertex, Position), D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+		{"NORMAL", 0, DXGI_FORMAT_R16G16_SNORM, 0, offsetof(PackedVertex, Normal), D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+		{"TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT, 0, offsetof(PackedVertex, Tex), D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+	};
 
 	ID3DBlob* vertexShader = nullptr;
+	ID3DBlob* packedVertexShader = nullptr;
 	ID3DBlob* pixelShader = nullptr;
 	ID3DBlob* alphaTestedPS = nullptr;
 	ID3DBlob* error = nullptr;
@@ -922,25 +1415,49 @@ void CreatePSO()
 	auto errorBufferPtr = error->GetBufferPointer();
 	OutputDebugStringA((LPCSTR)errorBufferPtr);
 
-	gShaders["VS"] = vertexShader;
+	const ShaderHandle vs = gShaders.Add("VS", vertexShader);
+
+	D3DCompileFromFile(L"shaders.hlsl", nullptr, nullptr, "VSMainPacked", "vs_5_0", compileFlags, 0, &packedVertexShader, &error);
+	errorBufferPtr = error->GetBufferPointer();
+	OutputDebugStringA((LPCSTR)errorBufferPtr);
+
+	const ShaderHandle packedVS = gShaders.Add("packedVS", packedVertexShader);
 
 	D3DCompileFromFile(L"shaders.hlsl", defines, nullptr, "PSMain", "ps_5_0", compileFlags, 0, &pixelShader, &error);
 	errorBufferPtr = error->GetBufferPointer();
 	OutputDebugStringA((LPCSTR)errorBufferPtr);
 
-	gShaders["opaquePS"] = pixelShader;
+	const ShaderHandle opaquePS = gShaders.Add("opaquePS", pixelShader);
 
 	D3DCompileFromFile(L"shaders.hlsl", alphaTestDefines, nullptr, "PSMain", "ps_5_0", compileFlags, 0, &alphaTestedPS, &error);
 	errorBufferPtr = error->GetBufferPointer();
 	OutputDebugStringA((LPCSTR)errorBufferPtr);
 
-	gShaders["alphaTestedPS"] = alphaTestedPS;
+	const ShaderHandle alphaTestedPSHandle = gShaders.Add("alphaTestedPS", alphaTestedPS);
+
+	// 같은 설정으로 버텍스 형식마다 PSO를 만든다. 입력 레이아웃과 버텍스 셰이더만 다르다.
+	const D3D12_INPUT_LAYOUT_DESC inputLayouts[VertexFormatCount] =
+	{
+		{ inputElementDesc, _countof(inputElementDesc) },
+		{ packedInputElementDesc, _countof(packedInputElementDesc) },
+	};
+	const ShaderHandle vertexShaders[VertexFormatCount] = { vs, packedVS };
+	auto createPassPipelines = [&](DrawPass pass, const std::string& name, D3D12_GRAPHICS_PIPELINE_STATE_DESC desc)
+	{
+		for (UINT format = 0; format < VertexFormatCount; format++)
+		{
+			desc.InputLayout = inputLayouts[format];
+			desc.VS = CD3DX12_SHADER_BYTECODE(gShaders[vertexShaders[format]]);
+			gDrawPassPipelines[pass][format] = gPSOs.Intern(format == VertexFormatPacked ? name + "Packed" : name);
+			ThrowIfFailed(gDevice->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&gPSOs[gDrawPassPipelines[pass][format]])));
+		}
+	};
 
 	// opaque
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC opaquePSODesc = { };
 	opaquePSODesc.pRootSignature = gRootSignature;
-	opaquePSODesc.VS = CD3DX12_SHADER_BYTECODE(gShaders["VS"]);
-	opaquePSODesc.PS = CD3DX12_SHADER_BYTECODE(gShaders["opaquePS"]);
+	opaquePSODesc.VS = CD3DX12_SHADER_BYTECODE(gShaders[vs]);
+	opaquePSODesc.PS = CD3DX12_SHADER_BYTECODE(gShaders[opaquePS]);
 	opaquePSODesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
 	opaquePSODesc.SampleMask = UINT_MAX;
 	opaquePSODesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
@@ -966,7 +1483,7 @@ void CreatePSO()
 	opaquePSODesc.SampleDesc.Count = 1;
 	opaquePSODesc.SampleDesc.Quality = 0;
 
-	ThrowIfFailed(gDevice->CreateGraphicsPipelineState(&opaquePSODesc, IID_PPV_ARGS(&gPSOs["opaque"])));
+	createPassPipelines(DrawPassOpaque, "opaque", opaquePSODesc);
 
 	// transparent
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC transparentPSODesc = opaquePSODesc;
@@ -987,20 +1504,20 @@ void CreatePSO()
 	transparencyBlendDesc.RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
 
 	transparentPSODesc.BlendState.RenderTarget[0] = transparencyBlendDesc;
-	ThrowIfFailed(gDevice->CreateGraphicsPipelineState(&transparentPSODesc, IID_PPV_ARGS(&gPSOs["transparent"])));
+	createPassPipelines(DrawPassTransparent, "transparent", transparentPSODesc);
 
 	// alpha test
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC alphaTestedPSODesc = opaquePSODesc;
-	alphaTestedPSODesc.PS = CD3DX12_SHADER_BYTECODE(gShaders["alphaTestedPS"]);
+	alphaTestedPSODesc.PS = CD3DX12_SHADER_BYTECODE(gShaders[alphaTestedPSHandle]);
 	alphaTestedPSODesc.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
-	ThrowIfFailed(gDevice->CreateGraphicsPipelineState(&alphaTestedPSODesc, IID_PPV_ARGS(&gPSOs["alphaTested"])));
+	createPassPipelines(DrawPassAlphaTested, "alphaTested", alphaTestedPSODesc);
 
 
 	// 스텐실 영역 렌더링용
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC markStencilPSODesc = {};
 	markStencilPSODesc.pRootSignature = gRootSignature;
-	markStencilPSODesc.VS = CD3DX12_SHADER_BYTECODE(gShaders["VS"]);
-	markStencilPSODesc.PS = CD3DX12_SHADER_BYTECODE(gShaders["alphaTestedPS"]);
+	markStencilPSODesc.VS = CD3DX12_SHADER_BYTECODE(gShaders[vs]);
+	markStencilPSODesc.PS = CD3DX12_SHADER_BYTECODE(gShaders[alphaTestedPSHandle]);
 
 	CD3DX12_BLEND_DESC markStencilBlendState(D3D12_DEFAULT);
 	markStencilBlendState.RenderTarget[0].RenderTargetWriteMask = 0; // RT에는 그리지 않는다.
@@ -1032,33 +1549,15 @@ void CreatePSO()
 	markStencilPSODesc.SampleDesc.Count = 1;
 	markStencilPSODesc.SampleDesc.Quality = 0;
 
-	ThrowIfFailed(gDevice->CreateGraphicsPipelineState(&markStencilPSODesc, IID_PPV_ARGS(&gPSOs["markStencil"])));
+	createPassPipelines(DrawPassMarkStencil, "markStencil", markStencilPSODesc);
 }
 
 void InitConstantBuffer()
 {
-	static_assert(sizeof(ObjectConstantBuffer) % 256 == 0, "constant buffer must be 256 byte");
-	const UINT constantBufferSize = sizeof(ObjectConstantBuffer);
+	static_assert(sizeof(FrameConstantBuffer) % D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT == 0, "constant buffer must be 256 byte");
 
-	auto uploadHeapProp = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
-	auto constantBuffer = CD3DX12_RESOURCE_DESC::Buffer(constantBufferSize);
-	ThrowIfFailed(gDevice->CreateCommittedResource(
-		&uploadHeapProp,
-		D3D12_HEAP_FLAG_NONE,
-		&constantBuffer,
-		D3D12_RESOURCE_STATE_GENERIC_READ,
-		nullptr,
-		IID_PPV_ARGS(&gConstantBuffer)
-	));
-
-	D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc = { };
-	cbvDesc.BufferLocation = gConstantBuffer->GetGPUVirtualAddress();
-	cbvDesc.SizeInBytes = constantBufferSize;
-	gDevice->CreateConstantBufferView(&cbvDesc, gCbvHeap->GetCPUDescriptorHandleForHeapStart());
-
-	gConstantBuffer->Map(0, nullptr, reinterpret_cast<void**>(&gCbvDataBegin));
-	memcpy(gCbvDataBegin, &gConstantBufferData, sizeof(gConstantBufferData));
-	//gConstantBuffer->Unmap(0, nullptr);
+	// 프레임마다 명령 할당기(병렬 기록용 포함)와 계속 매핑해 둔 상수 버퍼 하나씩
+	ThrowIfFailed(gFrameResources.Create(gDevice, gMaxFramesAhead + 1, FrameConstantBytes, MaxRecordingLists));
 }
 
 // Convert a wide Unicode string to an UTF8 string
@@ -1083,39 +1582,203 @@ std::wstring utf8_decode(const std::string& str)
 
 void InitShaderResources()
 {
-	CD3DX12_CPU_DESCRIPTOR_HANDLE srvHandle(gSrvHeap->GetCPUDescriptorHandleForHeapStart());
+	// SRV는 같은 내용을 먼저 올린 텍스쳐(Canonical)마다 하나
+	UINT canonicalCount = 0;
+	gTextures.ForEach([&](TextureHandle handle, TextureEntry& texture)
+		{
+			canonicalCount += (texture.Canonical == handle) ? 1 : 0;
+		});
 
-	// TODO: 텍스쳐 순서 보장하기?
-	int index = 0;
-	for (auto texPair : gTexDatas)
-	{
-		D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = { };
-		srvDesc.Format = texPair.second->GetDesc().Format;
-		srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-		srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-		srvDesc.Texture2D.MostDetailedMip = 0;
-		srvDesc.Texture2D.MipLevels = texPair.second->GetDesc().MipLevels;
-		srvDesc.Texture2D.PlaneSlice = 0;
-		srvDesc.Texture2D.ResourceMinLODClamp = 0;
+	D3D12_DESCRIPTOR_HEAP_DESC srvHeapDesc = {};
+	srvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+	srvHeapDesc.NumDescriptors = canonicalCount + SrvHeapReloadHeadroom;
+	srvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
 
-		gDevice->CreateShaderResourceView(texPair.second.Get(), &srvDesc, srvHandle);
+	ThrowIfFailed(gDevice->CreateDescriptorHeap(&srvHeapDesc, IID_PPV_ARGS(&gSrvHeap)));
+	gSrvHeapCapacity = srvHeapDesc.NumDescriptors;
+	gSrvHeapUsed = 0;
 
-		gTexDiffuseSrvHeapIndices.insert(std::make_pair(utf8_encode(texPair.first), index));
+	// SRV 자리는 텍스쳐를 처음 등록한 순서대로 준다.
+	gTextures.ForEach([&](TextureHandle handle, TextureEntry& texture)
+		{
+			if (texture.Canonical != handle)
+			{
+				// 같은 내용을 먼저 올린 텍스쳐의 SRV를 같이 쓴다.
+				return;
+			}
+
+			texture.SrvHeapIndex = AllocateSrvHeapIndex();
+			CreateTextureSrv(handle);
+		});
 
-		srvHandle.Offset(1, gCbvHeapSize);
-		index += 1;
+	gTextures.ForEach([](TextureHandle handle, TextureEntry& texture)
+		{
+			if (texture.Canonical.IsValid() && texture.Canonical != handle)
+			{
+				texture.SrvHeapIndex = gTextures[texture.Canonical].SrvHeapIndex;
+			}
+		});
+}
+
+int AllocateSrvHeapIndex()
+{
+	// 모자라면 SrvHeapReloadHeadroom을 늘린다.
+	assert(gSrvHeapUsed < gSrvHeapCapacity && "gSrvHeap is out of SRV slots");
+	return static_cast<int>(gSrvHeapUsed++);
+}
+
+void CreateTextureSrv(TextureHandle handle)
+{
+	const auto& entry = gTextures[handle];
+	if (entry.SrvHeapIndex < 0)
+	{
+		return;
 	}
+	assert(static_cast<UINT>(entry.SrvHeapIndex) < gSrvHeapCapacity);
+
+	CD3DX12_CPU_DESCRIPTOR_HANDLE srvHandle(gSrvHeap->GetCPUDescriptorHandleForHeapStart());
+	srvHandle.Offset(entry.SrvHeapIndex, gSrvHeapSize);
+
+	ID3D12Resource* texture = entry.Resource.Get();
+
+	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = { };
+	// 내려간 텍스쳐는 null SRV로 채운다. 형식은 아무거나 괜찮다.
+	srvDesc.Format = texture ? texture->GetDesc().Format : DXGI_FORMAT_R8G8B8A8_UNORM;
+	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	srvDesc.Texture2D.MostDetailedMip = 0;
+	srvDesc.Texture2D.MipLevels = texture ? texture->GetDesc().MipLevels : 1;
+	srvDesc.Texture2D.PlaneSlice = 0;
+	srvDesc.Texture2D.ResourceMinLODClamp = 0;
+
+	gDevice->CreateShaderResourceView(texture, &srvDesc, srvHandle);
 }
 
-void CreateTextureResourceFromFile(std::wstring fileName)
+void CreateTextureResourcesFromFiles(const std::vector<std::wstring>& fileNames, const std::vector<size_t>& maxSizes)
 {
 	ThrowIfFailed(gCommandAlloc->Reset());
-	//ThrowIfFailed(gCommandList->Reset(gCommandAlloc, gPSO));
 	ThrowIfFailed(gCommandList->Reset(gCommandAlloc, nullptr));
 
-	Microsoft::WRL::ComPtr<ID3D12Resource> uploadHeap;
-	gTexDatas[fileName] = nullptr;
-	CreateDDSTextureFromFile12(gDevice, gCommandList, fileName.data(), gTexDatas[fileName], uploadHeap);
+	// 업로드 힙은 GPU 복사가 끝날 때까지(FlushCommandQueue) 살아 있어야 한다.
+	std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> uploadHeaps(fileNames.size());
+
+	// 이름은 먼저 모두 등록한다. 읽는 도중에 표가 커지면 항목 참조가 무효가 된다.
+	std::vector<TextureHandle> handles(fileNames.size());
+	for (size_t i = 0; i < fileNames.size(); i++)
+	{
+		handles[i] = gTextures.Intern(utf8_encode(fileNames[i]));
+	}
+
+	// 같은 바이트의 텍스쳐가 이미 올라가 있으면 업로드하지 않고 그 리소스를 같이 쓴다.
+	auto findShared = [&](TextureHandle handle, const TextureContentKey& key, UINT64 payloadBytes)
+		{
+			auto& texture = gTextures[handle];
+			std::string canonicalName;
+			if (!gTexContentCache.Find(key, payloadBytes, texture.Resource, canonicalName))
+			{
+				return false;
+			}
+			texture.Canonical = gTextures.Find(canonicalName);
+			return true;
+		};
+
+	// 상주 관리자에는 실제 GPU 할당 크기와 원본 크기를 알려준다.
+	auto registerLoaded = [&](TextureHandle handle, const TextureContentKey& key,
+		UINT fullWidth, UINT fullHeight, UINT fullMipCount, UINT skipMip)
+		{
+			auto& texture = gTextures[handle];
+			const auto& name = gTextures.GetName(handle);
+			auto desc = texture.Resource->GetDesc();
+			auto allocationInfo = gDevice->GetResourceAllocationInfo(0, 1, &desc);
+
+			gTexContentCache.Insert(key, name, texture.Resource, allocationInfo.SizeInBytes);
+			texture.Canonical = handle;
+
+			gTextureResidency.OnTextureLoaded(name, allocationInfo.SizeInBytes, fullWidth, fullHeight, fullMipCount, skipMip, gFrameCount);
+		};
+
+	// 쿡 파일(업로드 배치로 미리 풀어 둔 페이로드)이 있으면 파이프라인을 거치지 않고 업로드 버퍼로 바로 읽는다.
+	// 쿡 파일이 없거나, 원본이 바뀌었거나, maxsize로 밉을 잘라야 하면 DDS 경로로 읽는다.
+	std::vector<std::wstring> ddsFileNames;
+	std::vector<size_t> ddsMaxSizes;
+	std::vector<size_t> ddsIndices;
+	size_t cookedCount = 0;
+	for (size_t i = 0; i < fileNames.size(); i++)
+	{
+		const size_t maxSize = (i < maxSizes.size()) ? maxSizes[i] : 0;
+		const auto cookedPath = GetCookedTexturePath(fileNames[i]);
+
+		CookedTextureHeader header;
+		if (OpenCookedTexture(cookedPath, fileNames[i], header) == S_OK && CanUseCookedTexture(header, maxSize))
+		{
+			auto& texture = gTextures[handles[i]];
+
+			TextureContentKey key;
+			key.Hash = header.SourceHash;
+			key.MaxSize = maxSize;
+
+			if (findShared(handles[i], key, header.PayloadSize))
+			{
+				cookedCount++;
+				continue;
+			}
+			HeapAllocation allocation;
+			if (SUCCEEDED(CreateTextureFromCookedFile12(gDevice, gCommandList, cookedPath, header, texture.Resource, uploadHeaps[i],
+				&gHeapAllocator, &allocation)))
+			{
+				texture.Allocation = allocation;
+				registerLoaded(handles[i], key, static_cast<UINT>(header.Width), header.Height, header.MipLevels, 0);
+				cookedCount++;
+				continue;
+			}
+		}
+
+		ddsFileNames.push_back(fileNames[i]);
+		ddsMaxSizes.push_back(maxSize);
+		ddsIndices.push_back(i);
+	}
+
+	TextureLoadPipeline pipeline(*gJobSystem);
+	ThrowIfFailed(pipeline.Run(ddsFileNames, ddsMaxSizes, [&](size_t ddsIndex, DDS_TEXTURE_DATA12& textureData, const Hash128& contentHash)
+		{
+			const size_t index = ddsIndices[ddsIndex];
+			auto& texture = gTextures[handles[index]];
+
+			TextureContentKey key;
+			key.Hash = contentHash;
+			key.MaxSize = ddsMaxSizes[ddsIndex];
+
+			if (findShared(handles[index], key, textureData.ddsDataSize))
+			{
+				return S_OK;
+			}
+
+			HeapAllocation allocation;
+			HRESULT hr = CreateDDSTextureFromData12(gDevice, gCommandList, textureData, texture.Resource, uploadHeaps[index],
+				&gHeapAllocator, &allocation);
+			if (FAILED(hr))
+			{
+				return hr;
+			}
+			texture.Allocation = allocation;
+
+			registerLoaded(handles[index], key,
+				static_cast<UINT>(textureData.fullWidth),
+				static_cast<UINT>(textureData.fullHeight),
+				static_cast<UINT>(textureData.mipCount + textureData.skipMip),
+				static_cast<UINT>(textureData.skipMip));
+			return S_OK;
+		}));
+
+	auto cookedMessage = std::format(L"Cooked textures: {} / {}\n", cookedCount, fileNames.size());
+	OutputDebugString(cookedMessage.c_str());
+	OutputDebugString(pipeline.GetStats().ToString().c_str());
+
+	const auto& cacheStats = gTexContentCache.GetStats();
+	auto s = std::format(L"TextureContentCache: {} / {} hits ({:.1f}%), saved {:.2f} MB payload, {:.2f} MB GPU\n",
+		cacheStats.Hits, cacheStats.Lookups, cacheStats.GetHitRate() * 100.0,
+		cacheStats.PayloadBytesSaved / (1024.0 * 1024.0), cacheStats.GpuBytesSaved / (1024.0 * 1024.0));
+	OutputDebugString(s.c_str());
 
 	// 무조건 닫아준다.
 	ThrowIfFailed(gCommandList->Close());
@@ -1125,6 +1788,90 @@ void CreateTextureResourceFromFile(std::wstring fileName)
 	FlushCommandQueue();
 }
 
+void UpdateTextureResidency()
+{
+	auto requests = gTextureResidency.CollectRequests(gFrameCount);
+	if (requests.empty())
+	{
+		return;
+	}
+
+	// 앞선 프레임들이 아직 텍스쳐를 읽고 있을 수 있으므로 GPU가 쉴 때까지 기다린다.
+	FlushCommandQueue();
+
+	std::vector<std::wstring> reloadFileNames;
+	std::vector<size_t> reloadMaxSizes;
+	std::vector<TextureHandle> reloadHandles;
+	for (const auto& request : requests)
+	{
+		// 상주 관리자는 이름으로 요청한다. 요청은 가끔 몇 개씩만 오므로 여기서 핸들로 바꾼다.
+		const TextureHandle handle = gTextures.Find(request.Name);
+		if (!handle.IsValid())
+		{
+			continue;
+		}
+
+		// 캐시가 잡고 있는 참조를 놓아야 내리거나 바꾼 리소스가 실제로 해제된다.
+		gTexContentCache.Remove(request.Name);
+
+		// 같은 내용을 같이 쓰던 텍스쳐의 참조까지 모두 놓은 뒤에 힙 자리를 돌려준다. (ResourceHeapAllocator.h 사용법 순서)
+		// 먼저 Free하면 블록이 비었을 때 살아 있는 리소스 밑에서 힙이 해제되고,
+		// 같은 배치에서 다시 올리는 텍스쳐가 아직 살아 있는 리소스 자리에 겹쳐 놓일 수 있다.
+		gTextures.ForEach([&](TextureHandle, TextureEntry& texture)
+			{
+				if (texture.Canonical == handle)
+				{
+					texture.Resource.Reset();
+				}
+			});
+		gTextures[handle].Resource.Reset();
+		gHeapAllocator.Free(gTextures[handle].Allocation);
+		// 같이 쓰는 SRV 하나를 null SRV로 바꾼다. 다시 올리면 아래에서 새 리소스로 다시 만든다.
+		CreateTextureSrv(handle);
+
+		if (request.Action == TextureResidencyAction::Evict)
+		{
+			gTextureResidency.OnTextureEvicted(request.Name);
+		}
+		else
+		{
+			// 다시 올리기, 밉 자르기, 밉 되살리기 모두 maxsize만 바꿔서 기존 DDS 경로로 다시 읽는다.
+			reloadFileNames.push_back(utf8_decode(request.Name));
+			reloadMaxSizes.push_back(request.MaxSize);
+			reloadHandles.push_back(handle);
+		}
+	}
+
+	if (!reloadFileNames.empty())
+	{
+		CreateTextureResourcesFromFiles(reloadFileNames, reloadMaxSizes);
+		for (const auto handle : reloadHandles)
+		{
+			if (gTextures[handle].SrvHeapIndex < 0)
+			{
+				gTextures[handle].SrvHeapIndex = AllocateSrvHeapIndex();
+			}
+
+			const auto resource = gTextures[handle].Resource;
+			gTextures.ForEach([&](TextureHandle, TextureEntry& texture)
+				{
+					if (texture.Canonical == handle)
+					{
+						texture.Resource = resource;
+					}
+				});
+			CreateTextureSrv(handle);
+		}
+	}
+
+	auto stats = gTextureResidency.GetStats();
+	auto s = std::format(L"TextureResidency: {} requests, {:.2f} / {:.2f} MB, resident {}, evicted {} (evictions {}, mip drops {}, mip restores {}, reloads {})\n",
+		requests.size(), stats.ResidentBytes / (1024.0 * 1024.0), stats.BudgetBytes / (1024.0 * 1024.0),
+		stats.ResidentCount, stats.EvictedCount, stats.Evictions, stats.MipDrops, stats.MipRestores, stats.Reloads);
+	OutputDebugString(s.c_str());
+	OutputDebugString(gHeapAllocator.GetStats().ToString().c_str());
+}
+
 void CreateMaterials()
 {
 	auto grass = Material();
@@ -1150,9 +1897,9 @@ void CreateMaterials()
 	water.FresnelR0 = XMFLOAT3(0.1f, 0.1f, 0.1f);
 	water.Roughness = 0.0f;
 
-	gMaterials["grass"] = grass;
-	gMaterials["box"] = box;
-	gMaterials["water"] = water;
+	gMaterials.Add("grass", grass);
+	gMaterials.Add("box", box);
+	gMaterials.Add("water", water);
 }
 
 void CreateBoxGeometry()
@@ -1247,13 +1994,10 @@ void CreateGrassGeometry()
 	CreateMeshData(vertices, _countof(vertices), indices, _countof(indices), "grass");
 }
 
-void CreateMeshData(const Vertex* vertices, UINT vertexCount, const UINT16* indices, UINT indexCount, const char* meshName)
+// 업로드 힙에 버텍스/인덱스 버퍼를 만들고 바로 채운다. 그릴 때도 업로드 힙에서 읽는다.
+void CreateDynamicMeshBuffers(const Vertex* vertices, UINT vertexBufferSize, const UINT16* indices, UINT indexBufferSize,
+	ID3D12Resource*& vertexBuffer, ID3D12Resource*& indexBuffer)
 {
-	const UINT vertexBufferSize = sizeof(Vertex) * vertexCount;
-	const UINT indexBufferSize = sizeof(UINT16) * indexCount;
-
-	ID3D12Resource* vertexBuffer;
-
 	{
 		// 버텍스 버퍼 생성
 		auto uploadHeapProp = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
@@ -1270,19 +2014,10 @@ void CreateMeshData(const Vertex* vertices, UINT vertexCount, const UINT16* indi
 
 	// 버텍스 버퍼에 삼각형 정보 복사
 	UINT8* pVertexDataBegin;
-	CD3DX12_RANGE readRange(0, 0);
 	ThrowIfFailed(vertexBuffer->Map(0, nullptr, reinterpret_cast<void**>(&pVertexDataBegin)));
 	memcpy(pVertexDataBegin, vertices, vertexBufferSize);
 	vertexBuffer->Unmap(0, nullptr);
 
-	D3D12_VERTEX_BUFFER_VIEW vertexBufferView;
-
-	// 버텍스 버퍼 뷰 생성
-	vertexBufferView.BufferLocation = vertexBuffer->GetGPUVirtualAddress();
-	vertexBufferView.SizeInBytes = vertexBufferSize;
-	vertexBufferView.StrideInBytes = sizeof(Vertex);
-
-	ID3D12Resource* indexBuffer;
 	{
 		auto uploadHeapProp = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
 		auto indexBufferDesc = CD3DX12_RESOURCE_DESC::Buffer(indexBufferSize);
@@ -1302,6 +2037,96 @@ void CreateMeshData(const Vertex* vertices, UINT vertexCount, const UINT16* indi
 	ThrowIfFailed(indexBuffer->Map(0, nullptr, reinterpret_cast<void**>(&pIndexDataBegin)));
 	memcpy(pIndexDataBegin, indices, indexBufferSize);
 	indexBuffer->Unmap(0, nullptr);
+}
+
+void CreateMeshData(const Vertex* vertices, UINT vertexCount, const UINT16* indices, UINT indexCount, const char* meshName, bool dynamic)
+{
+	const UINT indexBufferSize = sizeof(UINT16) * indexCount;
+
+	auto& meshData = gMeshes[gMeshes.Intern(meshName)];
+	meshData.indexCount = indexCount;
+	meshData.bounds = ComputeCullBounds(&vertices[0].position, vertexCount, sizeof(Vertex));
+	for (const char* occluderName : gOccluderMeshNames)
+	{
+		if (strcmp(occluderName, meshName) == 0)
+		{
+			meshData.occluderPositions.resize(vertexCount);
+			for (UINT i = 0; i < vertexCount; i++)
+			{
+				meshData.occluderPositions[i] = vertices[i].position;
+			}
+			meshData.occluderIndices.assign(indices, indices + indexCount);
+		}
+	}
+
+	// 정적 메쉬는 복원 오차가 한도 안이면 PackedVertex로 줄여 올린다. CPU에 남기는 값은 위에서 float로 구했다.
+	std::vector<PackedVertex> packedVertices;
+	meshData.vertexFormat = VertexFormatFloat;
+	meshData.positionDecode = Identity4x4();
+	if (!dynamic && gPackedVertices)
+	{
+		static_assert(sizeof(Vertex) == 8 * sizeof(float), "Vertex must be position, normal, tex floats");
+		VertexQuantization quantization;
+		VertexQuantizationError error;
+		const bool packed = QuantizeVertices(&vertices[0].position.x, vertexCount, VertexErrorLimits(), packedVertices, quantization, error);
+		auto s = std::format(L"{}: {} vertices, error position {:.6f}, normal {:.4f} deg, uv {:.6f}\n", utf8_decode(meshName),
+			packed ? L"packed" : L"float (over error limits)", error.Position, error.NormalDegrees, error.Tex);
+		OutputDebugString(s.c_str());
+		if (packed)
+		{
+			meshData.vertexFormat = VertexFormatPacked;
+			const float scale = quantization.PositionScale;
+			XMStoreFloat4x4(&meshData.positionDecode, XMMatrixScaling(scale, scale, scale) *
+				XMMatrixTranslation(quantization.PositionOffset[0], quantization.PositionOffset[1], quantization.PositionOffset[2]));
+		}
+	}
+	const bool packed = meshData.vertexFormat == VertexFormatPacked;
+	const void* vertexData = packed ? static_cast<const void*>(packedVertices.data()) : vertices;
+	const UINT vertexStride = packed ? sizeof(PackedVertex) : sizeof(Vertex);
+	const UINT vertexBufferSize = vertexStride * vertexCount;
+	GeometryPool& pool = packed ? gPackedGeometryPool : gGeometryPool;
+
+	// 정적 메쉬는 먼저 공용 풀에서 구간을 받는다. 그릴 때 버퍼를 다시 묶지 않아도 된다.
+	if (!dynamic && pool.Allocate(vertexCount, indexCount, meshData.poolAllocation))
+	{
+		pool.Upload(gGeometryUploads, meshData.poolAllocation, vertexData, indices);
+
+		meshData.vertexBufferView = pool.GetVertexBufferView();
+		meshData.indexBufferView = pool.GetIndexBufferView();
+		meshData.baseVertexLocation = static_cast<INT>(meshData.poolAllocation.BaseVertex);
+		meshData.startIndexLocation = meshData.poolAllocation.StartIndex;
+		return;
+	}
+
+	ID3D12Resource* vertexBuffer;
+	ID3D12Resource* indexBuffer;
+
+	if (!dynamic)
+	{
+		// 풀이 가득 찬 정적 메쉬: 따로 기본 힙에 만들고 데이터는 SubmitGeometryUploads에서 한 번에 복사
+		auto s = std::format(L"{}: geometry pool is full, using separate buffers\n", utf8_decode(meshName));
+		OutputDebugString(s.c_str());
+
+		auto vertexBufferPtr = gGeometryUploads.CreateBuffer(gDevice, vertexData, vertexBufferSize, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
+		auto indexBufferPtr = gGeometryUploads.CreateBuffer(gDevice, indices, indexBufferSize, D3D12_RESOURCE_STATE_INDEX_BUFFER);
+		if (!vertexBufferPtr || !indexBufferPtr)
+		{
+			ThrowIfFailed(E_OUTOFMEMORY);
+		}
+		vertexBuffer = vertexBufferPtr.Detach();
+		indexBuffer = indexBufferPtr.Detach();
+	}
+	else
+	{
+		CreateDynamicMeshBuffers(vertices, vertexBufferSize, indices, indexBufferSize, vertexBuffer, indexBuffer);
+	}
+
+	D3D12_VERTEX_BUFFER_VIEW vertexBufferView;
+
+	// 버텍스 버퍼 뷰 생성
+	vertexBufferView.BufferLocation = vertexBuffer->GetGPUVirtualAddress();
+	vertexBufferView.SizeInBytes = vertexBufferSize;
+	vertexBufferView.StrideInBytes = vertexStride;
 
 	D3D12_INDEX_BUFFER_VIEW indexBufferView;
 
@@ -1310,14 +2135,44 @@ void CreateMeshData(const Vertex* vertices, UINT vertexCount, const UINT16* indi
 	indexBufferView.SizeInBytes = indexBufferSize;
 	indexBufferView.Format = DXGI_FORMAT_R16_UINT;
 
-	auto& meshData = gMeshDatas[meshName];
 	meshData.vertexBuffer = vertexBuffer;
 	meshData.vertexBufferView = vertexBufferView;
 	meshData.indexBuffer = indexBuffer;
 	meshData.indexBufferView = indexBufferView;
-	meshData.indexCount = indexCount;
+}
 
-	//FlushCommandQueue();
+void SubmitGeometryUploads()
+{
+	if (gGeometryUploads.IsEmpty())
+	{
+		return;
+	}
+
+	ThrowIfFailed(gCommandAlloc->Reset());
+	ThrowIfFailed(gCommandList->Reset(gCommandAlloc, nullptr));
+
+	ThrowIfFailed(gGeometryUploads.Record(gDevice, gCommandList));
+
+	ThrowIfFailed(gCommandList->Close());
+	ID3D12CommandList* cmdLists[] = { gCommandList };
+	gCommandQueue->ExecuteCommandLists(_countof(cmdLists), cmdLists);
+	FlushCommandQueue();
+
+	// 복사가 끝났으므로 스테이징 버퍼는 필요 없다.
+	gGeometryUploads.ReleaseStaging();
+
+	const auto& stats = gGeometryUploads.GetStats();
+	auto s = std::format(L"Geometry uploads: {} buffers, {} staging bytes, pool {} / {} vertices, {} / {} indices\n",
+		stats.BufferCount, stats.StagingBytes,
+		gGeometryPool.GetVertexAllocator().GetUsed(), gGeometryPool.GetVertexAllocator().GetCapacity(),
+		gGeometryPool.GetIndexAllocator().GetUsed(), gGeometryPool.GetIndexAllocator().GetCapacity());
+	OutputDebugString(s.c_str());
+	s = std::format(L"Packed geometry pool: {} / {} vertices ({} bytes each, float {}), {} / {} indices\n",
+		gPackedGeometryPool.GetVertexAllocator().GetUsed(), gPackedGeometryPool.GetVertexAllocator().GetCapacity(),
+		sizeof(PackedVertex), sizeof(Vertex),
+		gPackedGeometryPool.GetIndexAllocator().GetUsed(), gPackedGeometryPool.GetIndexAllocator().GetCapacity());
+	OutputDebugString(s.c_str());
+	OutputDebugString(gHeapAllocator.GetStats().ToString().c_str());
 }
 
 void CreateWaterGeometry()
@@ -1348,8 +2203,8 @@ void CreateObjFileGeometry(const wchar_t* fileName, const char* meshName)
 	OutputDebugString(s.c_str());
 
 	std::vector<Vertex> vertices;
-	std::vector<UINT16> indices;
-	UINT16 ind = 0;
+	std::vector<uint32_t> indices;
+	uint32_t ind = 0;
 	for (const auto& f : obj.faces)
 	{
 		for (auto i = 0; i < 3; i++)
@@ -1373,7 +2228,59 @@ void CreateObjFileGeometry(const wchar_t* fileName, const char* meshName)
 		}
 	}
 
-	CreateMeshData(&vertices[0], (UINT)vertices.size(), &indices[0], (UINT)indices.size(), meshName);
+	CreateOptimizedMeshData(vertices, indices, meshName);
+
+	// 멀리 있는 물체에 쓸 LOD를 노멀과 UV를 지키며 줄여서 따로 메쉬로 만든다.
+	if (indices.size() / 3 < MinLodSourceTriangles)
+	{
+		return;
+	}
+	static_assert(sizeof(Vertex) == 8 * sizeof(float), "Vertex must be position, normal, tex floats");
+	const float attributeWeights[] = { 1.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+	const auto lods = BuildMeshLods(reinterpret_cast<const float*>(vertices.data()), vertices.size(), 5, attributeWeights,
+		indices.data(), indices.size(), MaxMeshLods, MeshLodReduction);
+	for (UINT lod = 1; lod <= lods.size(); lod++)
+	{
+		const auto& lodMesh = lods[lod - 1];
+		std::vector<Vertex> lodVertices(lodMesh.Vertices.size() / 8);
+		memcpy(lodVertices.data(), lodMesh.Vertices.data(), lodMesh.Vertices.size() * sizeof(float));
+		std::vector<uint32_t> lodIndices = lodMesh.Indices;
+		s = std::format(L"  LOD{}: {} faces, error {}\n", lod, lodIndices.size() / 3, lodMesh.Error);
+		OutputDebugString(s.c_str());
+		CreateOptimizedMeshData(lodVertices, lodIndices, GetLodMeshName(meshName, lod).c_str());
+	}
+	gMeshes[gMeshes.Intern(meshName)].lodCount = (UINT)lods.size();
+}
+
+void CreateOptimizedMeshData(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, const char* meshName)
+{
+	const size_t weldedCount = WeldVertices(vertices.data(), vertices.size(), sizeof(Vertex), indices.data(), indices.size());
+	const auto before = AnalyzeVertexCache(indices.data(), indices.size(), weldedCount);
+
+	std::vector<uint32_t> clusters;
+	OptimizeVertexCache(indices.data(), indices.size(), weldedCount, VERTEX_CACHE_SIZE, &clusters);
+	OptimizeOverdraw(indices.data(), indices.size(), &vertices[0].position.x, sizeof(Vertex), weldedCount, clusters, MeshOverdrawThreshold);
+	vertices.resize(OptimizeVertexFetch(vertices.data(), weldedCount, sizeof(Vertex), indices.data(), indices.size()));
+
+	const auto after = AnalyzeVertexCache(indices.data(), indices.size(), vertices.size());
+	auto s = std::format(L"  {}: {} vertices, ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}\n", utf8_decode(meshName),
+		vertices.size(), before.GetAcmr(), after.GetAcmr(), before.GetAtvr(), after.GetAtvr());
+	OutputDebugString(s.c_str());
+
+	// 지오메트리 풀과 메쉬 버퍼는 R16 인덱스다. 합친 뒤에도 버텍스가 더 많으면 인덱스가 잘려서 엉뚱하게 그려지므로 받지 않는다.
+	if (vertices.size() > MaxMeshVertices)
+	{
+		s = std::format(L"{}: {} vertices after welding, R16 indices allow {}\n", utf8_decode(meshName), vertices.size(), MaxMeshVertices);
+		OutputDebugString(s.c_str());
+		ThrowIfFailed(E_INVALIDARG);
+	}
+	const std::vector<UINT16> meshIndices(indices.begin(), indices.end());
+	CreateMeshData(&vertices[0], (UINT)vertices.size(), &meshIndices[0], (UINT)meshIndices.size(), meshName);
+}
+
+std::string GetLodMeshName(const char* meshName, UINT lod)
+{
+	return std::string(meshName) + "@lod" + std::to_string(lod);
 }
 
 void CreateObjGeometry()
@@ -1384,70 +2291,385 @@ void CreateObjGeometry()
 
 void CreateRenderItems()
 {
+	const auto identity = Identity4x4();
+	gScene.Add(identity, GetSceneMeshId("grass"), GetSceneMaterialId("grass"), SceneItemOpaque);
+	gScene.Add(identity, GetSceneMeshId("rotatedCube"), GetSceneMaterialId("box"), SceneItemOpaque);
+	gScene.Add(identity, GetSceneMeshId("monkey"), GetSceneMaterialId("box"), SceneItemOpaque);
+	gScene.Add(identity, GetSceneMeshId("box"), GetSceneMaterialId("box"), SceneItemAlphaTested);
+	gScene.Add(identity, GetSceneMeshId("water"), GetSceneMaterialId("water"), SceneItemTransparent);
+
+	// -boxes N: 같은 메쉬와 재질의 상자를 격자로 놓는다. 정렬하면 한 구간이 되어 한 번에 그려진다.
+	const uint32_t boxMesh = GetSceneMeshId("rotatedCube");
+	const uint32_t boxMaterial = GetSceneMaterialId("box");
+	gScene.Reserve(gScene.GetCount() + gStressBoxCount);
+	const UINT gridSize = static_cast<UINT>(ceilf(sqrtf(static_cast<float>(gStressBoxCount))));
+	for (UINT i = 0; i < gStressBoxCount; i++)
+	{
+		const float spacing = 3.0f;
+		const float x = (static_cast<float>(i % gridSize) - gridSize * 0.5f) * spacing;
+		const float z = (static_cast<float>(i / gridSize) - gridSize * 0.5f) * spacing;
+
+		XMFLOAT4X4 world;
+		XMStoreFloat4x4(&world, XMMatrixTranslation(x, -2.0f, z));
+		gScene.Add(world, boxMesh, boxMaterial, SceneItemOpaque);
+	}
+}
+
+uint32_t GetSceneMeshId(const char* meshName)
+{
+	const MeshHandle mesh = gMeshes.Intern(meshName);
+	for (uint32_t i = 0; i < gSceneMeshes.size(); i++)
+	{
+		if (gSceneMeshes[i] == mesh)
+		{
+			return i;
+		}
+	}
+	gSceneMeshes.push_back(mesh);
+	gSceneMeshBounds.push_back(gMeshes[mesh].bounds);
+	gSceneMeshOccluders.push_back(gMeshes[mesh].occluderIndices.empty() ? 0 : 1);
+	gSceneMeshFormats.push_back(static_cast<uint8_t>(gMeshes[mesh].vertexFormat));
+	const uint32_t id = static_cast<uint32_t>(gSceneMeshes.size() - 1);
+
+	// LOD 메쉬도 gScene 메쉬 번호를 받는다. 부르는 동안 표가 늘어나므로 번호를 다 모은 뒤 넣는다.
+	gSceneMeshLods.emplace_back();
+	std::vector<uint32_t> lods = { id };
+	const UINT lodCount = gMeshes[mesh].lodCount;
+	for (UINT lod = 1; lod <= lodCount; lod++)
+	{
+		lods.push_back(GetSceneMeshId(GetLodMeshName(meshName, lod).c_str()));
+	}
+	gSceneMeshLods[id] = std::move(lods);
+	return id;
+}
+
+uint32_t GetSceneMaterialId(const char* materialName)
+{
+	const MaterialHandle material = gMaterials.Intern(materialName);
+	for (uint32_t i = 0; i < gSceneMaterials.size(); i++)
 	{
-		auto renderItem = std::make_unique<RenderItem>();
-		renderItem->WorldMat = Identity4x4();
-		renderItem->MeshData = &gMeshDatas["grass"];
-		renderItem->Material = &gMaterials["grass"];
-		gOpaqueRenderItems.push_back(std::move(renderItem));
+		if (gSceneMaterials[i].Material == material)
+		{
+			return i;
+		}
 	}
+
+	SceneMaterial sceneMaterial;
+	sceneMaterial.Material = material;
+
+	// 텍스쳐가 내려가거나 다시 올라와도 SRV는 같은 자리에 다시 만들어지므로 위치는 바뀌지 않는다.
+	const auto& fileName = gMaterials[material].TextureFileName;
+	const TextureEntry* texture = gTextures.Get(gTextures.Find(fileName));
+	auto texIndex = (texture && texture->SrvHeapIndex >= 0) ? texture->SrvHeapIndex : 0;
+	CD3DX12_GPU_DESCRIPTOR_HANDLE tex(gSrvHeap->GetGPUDescriptorHandleForHeapStart());
+	tex.Offset(texIndex, gSrvHeapSize);
+	sceneMaterial.DiffuseSrv = tex;
+	sceneMaterial.SortId = static_cast<UINT>(texIndex);
+
+	sceneMaterial.TextureResidencyName = (texture && texture->Canonical.IsValid()) ? gTextures.GetName(texture->Canonical) : fileName;
+
+	gSceneMaterials.push_back(sceneMaterial);
+	return static_cast<uint32_t>(gSceneMaterials.size() - 1);
+}
+
+void UpdateSceneBvh()
+{
+	if (!gFrustumCulling || !gBvhCulling)
+	{
+		// 쓰지 않는 동안은 고치지 않고 다시 켤 때 새로 만든다.
+		if (!gScene.GetMovedHandles().empty())
+		{
+			gSceneBvhVersion = ~0u;
+			gScene.ClearMoved();
+		}
+		return;
+	}
+
+	if (gSceneBvhVersion != gScene.GetStructureVersion())
 	{
-		auto renderItem = std::make_unique<RenderItem>();
-		renderItem->WorldMat = Identity4x4();
-		renderItem->MeshData = &gMeshDatas["rotatedCube"];
-		renderItem->Material = &gMaterials["box"];
-		gOpaqueRenderItems.push_back(std::move(renderItem));
+		// Remove는 마지막 물체를 빈 자리로 옮기므로 물체 수가 같아도 밀집 위치가 바뀌었을 수 있다.
+		const size_t count = gScene.GetCount();
+		gSceneBvhBounds.resize(count);
+		gJobSystem->ParallelFor(count, SceneBvh::PARALLEL_BUILD_GRAIN, [](size_t begin, size_t end)
+			{
+				ComputeBvhBounds(gScene.GetWorlds(), gScene.GetMeshes(), gSceneMeshBounds.data(), begin, end, gSceneBvhBounds.data());
+			});
+		gSceneBvh.Build(gSceneBvhBounds.data(), count, gJobSystem.get());
+		gSceneBvhVersion = gScene.GetStructureVersion();
 	}
+	else
+	{
+		for (SceneStore::Handle handle : gScene.GetMovedHandles())
+		{
+			const size_t index = gScene.GetIndex(handle);
+			ComputeBvhBounds(gScene.GetWorlds(), gScene.GetMeshes(), gSceneMeshBounds.data(), index, index + 1, gSceneBvhBounds.data());
+			gSceneBvh.RefitItem(static_cast<uint32_t>(index), gSceneBvhBounds[index]);
+		}
+	}
+	gScene.ClearMoved();
+}
+
+uint32_t GetSceneDrawMesh(size_t index)
+{
+	return gSceneMeshLods[gScene.GetMeshes()[index]][gScene.GetLods()[index]];
+}
+
+void SelectSceneLods(FXMMATRIX sceneView, float projScale)
+{
+	const size_t count = gScene.GetCount();
+	uint8_t* lods = gScene.GetLods();
+	if (!gLodSelection)
 	{
-		auto renderItem = std::make_unique<RenderItem>();
-		renderItem->WorldMat = Identity4x4();
-		renderItem->MeshData = &gMeshDatas["monkey"];
-		renderItem->Material = &gMaterials["box"];
-		gOpaqueRenderItems.push_back(std::move(renderItem));
+		std::fill(lods, lods + count, static_cast<uint8_t>(0));
+		return;
 	}
+
+	gJobSystem->ParallelFor(count, LodSelectionGrain, [sceneView, projScale, lods](size_t begin, size_t end)
+		{
+			const XMFLOAT4X4* worlds = gScene.GetWorlds();
+			const uint32_t* meshes = gScene.GetMeshes();
+			for (size_t i = begin; i < end; i++)
+			{
+				const auto& meshLods = gSceneMeshLods[meshes[i]];
+				if (meshLods.size() <= 1)
+				{
+					lods[i] = 0;
+					continue;
+				}
+
+				// 로컬 AABB를 감싸는 구를 가장 많이 늘어나는 축의 배율로 키운다. 뷰 행렬은 크기를 바꾸지 않는다.
+				const auto& bounds = gSceneMeshBounds[meshes[i]];
+				const XMMATRIX worldView = XMLoadFloat4x4(&worlds[i]) * sceneView;
+				const float scaleSq = std::max({ XMVectorGetX(XMVector3LengthSq(worldView.r[0])),
+					XMVectorGetX(XMVector3LengthSq(worldView.r[1])), XMVectorGetX(XMVector3LengthSq(worldView.r[2])) });
+				const float radius = XMVectorGetX(XMVector3Length(XMLoadFloat3(&bounds.Extents))) * sqrtf(scaleSq);
+				const XMVECTOR center = XMVector3TransformCoord(XMLoadFloat3(&bounds.Center), worldView);
+				const float distance = XMVectorGetX(XMVector3Length(center));
+
+				// 화면 높이에 대한 지름 비율. 카메라가 구 안에 있으면 원본을 그린다.
+				const float screenSize = distance > radius ? radius * projScale / distance : 1.0f;
+				UINT lod = 0;
+				while (lod + 1 < meshLods.size() && screenSize < gLodScreenSizes[lod])
+				{
+					lod++;
+				}
+				lods[i] = static_cast<uint8_t>(lod);
+			}
+		});
+}
+
+void CullOccludedSceneItems()
+{
+	const size_t count = gScene.GetCount();
+	const XMFLOAT4X4* worlds = gScene.GetWorlds();
+	const uint32_t* meshes = gScene.GetMeshes();
+	const uint32_t* flags = gScene.GetFlags();
+
+	// 화면에 보이는 가리는 물체만 그린다.
+	auto start = std::chrono::steady_clock::now();
+	gOcclusionCuller.ClearOccluders();
+	size_t tested = 0;
+	for (size_t i = 0; i < count; i++)
 	{
-		auto renderItem = std::make_unique<RenderItem>();
-		renderItem->WorldMat = Identity4x4();
-		renderItem->MeshData = &gMeshDatas["box"];
-		renderItem->Material = &gMaterials["box"];
-		gAlphaTestedRenderItems.push_back(std::move(renderItem));
+		tested += gSceneVisible[i];
+		if (!gSceneMeshOccluders[meshes[i]] || !gSceneVisible[i] || (flags[i] & SceneItemHidden))
+		{
+			continue;
+		}
+		const auto& mesh = gMeshes[gSceneMeshes[meshes[i]]];
+		gOcclusionCuller.AddOccluder(worlds[i], mesh.occluderPositions.data(), sizeof(XMFLOAT3),
+			mesh.occluderIndices.data(), static_cast<uint32_t>(mesh.occluderIndices.size()));
 	}
+	if (gOcclusionCuller.GetOccluderCount() == 0)
 	{
-		auto renderItem = std::make_unique<RenderItem>();
-		renderItem->WorldMat = Identity4x4();
-		renderItem->MeshData = &gMeshDatas["water"];
-		renderItem->Material = &gMaterials["water"];
-		gTransparentRenderItems.push_back(std::move(renderItem));
+		return;
 	}
+	gOcclusionCuller.Render(gJobSystem.get());
+	auto end = std::chrono::steady_clock::now();
+	gOcclusionCullStats.RenderSeconds += std::chrono::duration<double>(end - start).count();
+
+	// 가리는 물체 자신은 자기 깊이보다 앞에 있으므로 가려지지 않는다.
+	start = end;
+	const size_t occluded = gOcclusionCuller.CullParallel(*gJobSystem, worlds, meshes, gSceneMeshBounds.data(), count, gSceneVisible.data());
+	gOcclusionCullStats.TestSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	gOcclusionCullStats.Frames++;
+	gOcclusionCullStats.Occluders += gOcclusionCuller.GetOccluderCount();
+	gOcclusionCullStats.Triangles += gOcclusionCuller.GetTriangleCount();
+	gOcclusionCullStats.Tested += tested;
+	gOcclusionCullStats.Occluded += occluded;
 }
 
-void DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vector<std::unique_ptr<RenderItem>>& renderItems)
+void BuildDrawQueue()
 {
-	for (const auto& ri : renderItems)
+	gDrawQueue.Clear();
+	gDrawRuns.clear();
+
+	const size_t count = gScene.GetCount();
+	const XMFLOAT4X4* worlds = gScene.GetWorlds();
+	const uint32_t* meshes = gScene.GetMeshes();
+	const uint32_t* materials = gScene.GetMaterials();
+	const uint32_t* flags = gScene.GetFlags();
+	const uint8_t* lods = gScene.GetLods();
+
+	// 알파 테스트 물체는 스텐실 표시 패스에서 한 번 더 그린다.
+	gDrawQueue.Reserve(count * 2);
+
+	// 절두체 밖의 물체는 큐에 넣지 않는다. 물체가 많으면 여러 스레드에서 나눠 검사한다.
+	gSceneVisible.resize(count);
+	const auto cullStart = std::chrono::steady_clock::now();
+	size_t drawn = count;
+	UpdateSceneBvh();
+	if (gFrustumCulling && gBvhCulling)
+	{
+		gSceneBvhVisibleItems.clear();
+		gSceneBvh.QueryFrustum(gFrustumCuller.GetPlanes(), gSceneBvhVisibleItems);
+		std::fill(gSceneVisible.begin(), gSceneVisible.end(), static_cast<uint8_t>(0));
+		for (uint32_t item : gSceneBvhVisibleItems)
+		{
+			gSceneVisible[item] = 1;
+		}
+		drawn = gSceneBvhVisibleItems.size();
+	}
+	else if (gFrustumCulling)
+	{
+		drawn = gFrustumCuller.CullParallel(*gJobSystem, worlds, meshes, gSceneMeshBounds.data(), count, gSceneVisible.data());
+	}
+	else
+	{
+		std::fill(gSceneVisible.begin(), gSceneVisible.end(), static_cast<uint8_t>(1));
+	}
+	gFrustumCullStats.Frames++;
+	gFrustumCullStats.Tested += count;
+	gFrustumCullStats.Culled += count - drawn;
+	gFrustumCullStats.Seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - cullStart).count();
+	if (gOcclusionCulling)
+	{
+		CullOccludedSceneItems();
+	}
+	const uint8_t* visible = gSceneVisible.data();
+
+	XMMATRIX sceneView = XMLoadFloat4x4(&gWorld) * XMLoadFloat4x4(&gView);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const uint32_t itemFlags = flags[i];
+		if ((itemFlags & SceneItemHidden) || !visible[i])
+		{
+			continue;
+		}
+
+		// 물체 원점의 뷰 공간 깊이로 앞뒤를 정한다. 원점은 월드 행렬의 이동 성분이다.
+		const auto& world = worlds[i];
+		const float viewDepth = XMVectorGetZ(XMVector3Transform(XMVectorSet(world._41, world._42, world._43, 0.0f), sceneView));
+		const UINT material = gSceneMaterials[materials[i]].SortId;
+		// 정렬 키에는 그릴 LOD 메쉬 번호를 넣는다. 컬링은 원본 메쉬의 AABB로 했다.
+		const UINT mesh = GetSceneDrawMesh(i);
+		const UINT index = static_cast<UINT>(i);
+		gLodDrawCounts[lods[i]]++;
+
+		// PSO는 패스와 버텍스 형식마다 하나이므로 PSO 필드에는 둘을 합친 번호를 넣는다.
+		const UINT format = gSceneMeshFormats[mesh];
+		if (itemFlags & SceneItemOpaque)
+		{
+			gDrawQueue.Add(DrawSortKey::MakeFrontToBack(DrawPassOpaque, DrawPassOpaque * VertexFormatCount + format, material, mesh, viewDepth), index);
+		}
+		if (itemFlags & SceneItemAlphaTested)
+		{
+			gDrawQueue.Add(DrawSortKey::MakeFrontToBack(DrawPassMarkStencil, DrawPassMarkStencil * VertexFormatCount + format, material, mesh, viewDepth), index);
+			gDrawQueue.Add(DrawSortKey::MakeFrontToBack(DrawPassAlphaTested, DrawPassAlphaTested * VertexFormatCount + format, material, mesh, viewDepth), index);
+		}
+		if (itemFlags & SceneItemTransparent)
+		{
+			gDrawQueue.Add(DrawSortKey::MakeBackToFront(DrawPassTransparent, DrawPassTransparent * VertexFormatCount + format, material, mesh, viewDepth), index);
+		}
+	}
+
+	gDrawQueue.Sort();
+
+	// 패스, 메쉬, 재질이 같은 항목이 이어지면 한 구간으로 묶는다.
+	const auto& entries = gDrawQueue.GetEntries();
+	for (UINT i = 0; i < entries.size(); i++)
 	{
-		// 첫 번째 루트 파라미터
+		const auto& entry = entries[i];
+		if (!gDrawRuns.empty())
 		{
-			ID3D12DescriptorHeap* heaps[] = { gCbvHeap };
-			gCommandList->SetDescriptorHeaps(_countof(heaps), heaps);
-			gCommandList->SetGraphicsRootDescriptorTable(0, gCbvHeap->GetGPUDescriptorHandleForHeapStart());
+			const auto& first = entries[gDrawRuns.back().Begin];
+			if (DrawSortKey::GetPass(first.Key) == DrawSortKey::GetPass(entry.Key) &&
+				GetSceneDrawMesh(first.Index) == GetSceneDrawMesh(entry.Index) && materials[first.Index] == materials[entry.Index])
+			{
+				gDrawRuns.back().Count++;
+				continue;
+			}
 		}
+		gDrawRuns.push_back({ i, 1 });
+	}
+}
 
-		// 두 번째 루트 파라미터
+void DrawQueueRuns(CommandRecorder& recorder, size_t beginRun, size_t endRun, const UploadAllocation& instances)
+{
+	XMMATRIX sceneWorld = XMLoadFloat4x4(&gWorld);
+
+	const auto& entries = gDrawQueue.GetEntries();
+	const XMFLOAT4X4* worlds = gScene.GetWorlds();
+	const XMFLOAT4X4* texTransforms = gScene.GetTexTransforms();
+	const uint32_t* materials = gScene.GetMaterials();
+	UINT64 offset = 0;
+
+	// 여러 스레드에서 동시에 불린다. 전역 맵은 보지 않고 번호로 표만 읽는다.
+	for (size_t runIndex = beginRun; runIndex < endRun; runIndex++)
+	{
+		const auto& run = gDrawRuns[runIndex];
+		const auto& first = entries[run.Begin];
+		const auto& mesh = gMeshes[gSceneMeshes[GetSceneDrawMesh(first.Index)]];
+		const auto& material = gSceneMaterials[materials[first.Index]];
+
+		// 구간 안의 물체는 PSO, 텍스쳐, 메쉬가 같다.
+		// 두 번째 루트 파라미터 (SRV 힙은 SetCommonRenderState에서 묶었다)
+		// IA는 Input Assembler의 약자. 토폴로지는 SetCommonRenderState에서 정했다.
+		recorder.SetPipelineState(gDrawPassPSOs[DrawSortKey::GetPass(first.Key)][mesh.vertexFormat]);
+		recorder.SetGraphicsRootDescriptorTable(1, material.DiffuseSrv);
+		recorder.IASetVertexBuffer(mesh.vertexBufferView);
+		recorder.IASetIndexBuffer(mesh.indexBufferView);
+
+		// 세 번째 루트 파라미터: 구간의 물체마다 인스턴스 데이터를 이어서 쓰고 그 시작 주소를 넘긴다.
+		// SV_InstanceID는 StartInstanceLocation을 더하지 않으므로 구간마다 주소를 바꾼다.
+		// PackedVertex 메쉬는 0 ~ 1 위치를 로컬 좌표로 되돌리는 행렬을 물체 월드 행렬 앞에 곱한다.
+		auto instanceData = reinterpret_cast<InstanceData*>(static_cast<BYTE*>(instances.CpuAddress) + offset);
+		const bool packed = mesh.vertexFormat == VertexFormatPacked;
+		const XMMATRIX positionDecode = XMLoadFloat4x4(&mesh.positionDecode);
+		for (UINT i = 0; i < run.Count; i++)
 		{
-			ID3D12DescriptorHeap* heaps[] = { gSrvHeap };
-			gCommandList->SetDescriptorHeaps(_countof(heaps), heaps);
-
-			CD3DX12_GPU_DESCRIPTOR_HANDLE tex(gSrvHeap->GetGPUDescriptorHandleForHeapStart());
-			//tex.Offset(4, gCbvHeapSize);
-			auto texIndex = gTexDiffuseSrvHeapIndices[ri->Material->TextureFileName];
-			tex.Offset(texIndex, gCbvHeapSize);
-			gCommandList->SetGraphicsRootDescriptorTable(1, tex);
+			const UINT index = entries[run.Begin + i].Index;
+
+			XMMATRIX world = XMLoadFloat4x4(&worlds[index]) * sceneWorld;
+			if (packed)
+			{
+				world = positionDecode * world;
+			}
+			XMStoreFloat4x4(&instanceData[i].World, XMMatrixTranspose(world));
+			XMStoreFloat4x4(&instanceData[i].TexTransform, XMMatrixTranspose(XMLoadFloat4x4(&texTransforms[index])));
 		}
+		recorder.SetGraphicsRootShaderResourceView(2, instances.GpuAddress + offset);
+
+		recorder.DrawIndexedInstanced(mesh.indexCount, run.Count, mesh.startIndexLocation, mesh.baseVertexLocation, 0);
+
+		offset += run.Count * sizeof(InstanceData);
+	}
+}
 
-		// IA는 Input Assembler의 약자
-		gCommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-		gCommandList->IASetVertexBuffers(0, 1, &ri->MeshData->vertexBufferView);
-		gCommandList->IASetIndexBuffer(&ri->MeshData->indexBufferView);
-		gCommandList->DrawIndexedInstanced(ri->MeshData->indexCount, 1, 0, 0, 0);
+void MarkSceneTexturesUsed()
+{
+	// 구간마다 재질이 하나이므로 물체마다가 아니라 구간마다 본다.
+	const auto& entries = gDrawQueue.GetEntries();
+	const uint32_t* materials = gScene.GetMaterials();
+	for (const auto& run : gDrawRuns)
+	{
+		auto& material = gSceneMaterials[materials[entries[run.Begin].Index]];
+		if (material.LastMarkedFrame != gFrameCount)
+		{
+			material.LastMarkedFrame = gFrameCount;
+			gTextureResidency.MarkUsed(material.TextureResidencyName, gFrameCount);
+		}
 	}
 }
@@ -1,4 +1,12 @@
 #include "objparser.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+#ifndef _WIN32
+// strtok_s와 인자 순서가 같다.
+#define strtok_s strtok_r
+#endif
 
 std::vector<std::string> SplitString(std::string input, const char* sep)
 {
@@ -17,7 +25,7 @@ std::vector<std::string> SplitString(std::string input, const char* sep)
 
 ObjModel ObjParse(LPCWSTR fileName)
 {
-	std::ifstream objFile(fileName);
+	std::ifstream objFile{ std::filesystem::path(fileName) };
 	std::string objText;
 
 	ObjModel o;
@@ -135,3 +143,22 @@ ObjModel ObjParse(LPCWSTR fileName)
 	objFile.close();
 	return o;
 }
+
+bool ObjToTriangles(const ObjModel& obj, std::vector<float>& vertices, std::vector<uint32_t>& indices)
+{
+	vertices.clear();
+	indices.clear();
+	const ObjVector zero = { };
+	for (const auto& f : obj.faces)
+	{
+		for (auto i = 0; i < 3; i++)
+		{
+			const auto& v = obj.vertices[f.vs[i] - 1];
+			const auto& vn = f.vns[i] > 0 ? obj.vertexNormalVectors[f.vns[i] - 1] : zero;
+			const auto& vt = f.vts[i] > 0 ? obj.vertexTexCoordVectors[f.vts[i] - 1] : zero;
+			indices.push_back(static_cast<uint32_t>(vertices.size() / 8));
+			vertices.insert(vertices.end(), { v.x, v.y, v.z, vn.x, vn.y, vn.z, vt.x, vt.y });
+		}
+	}
+	return !indices.empty();
+}
@@ -2,7 +2,12 @@
 #ifndef _OBJPARSER_H_
 #define _OBJPARSER_H_
 
+#ifdef _WIN32
 #include <Windows.h>
+#else
+#include <wsl/winadapter.h>
+#endif
+#include <cstdint>
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -14,6 +19,7 @@
 // 파일명, 정점, 색인 정보만 읽어옴.
 // 매터리얼 정보는 읽지 않음
 // https://en.wikipedia.org/wiki/Wavefront_.obj_file
+// Windows가 아닌 곳(DxCheck)에서는 DirectX-Headers의 winadapter.h로 LPCWSTR, UINT16을 얻는다.
 // 사용법: ObjModel model = ObjParse("cube.obj");
 
 // v [x] [y] [z]
@@ -63,4 +69,8 @@ public:
 std::vector<std::string> SplitString(std::string input, const char* sep);
 ObjModel ObjParse(LPCWSTR fileName);
 
+// DX12Cube CreateObjFileGeometry와 같이 면마다 버텍스 세 개를 따로 만든다. (버텍스마다 위치, 노멀, UV float 8개)
+// 면에 노멀이나 UV 번호가 없으면 0으로 채운다. 면이 없으면 false
+bool ObjToTriangles(const ObjModel& obj, std::vector<float>& vertices, std::vector<uint32_t>& indices);
+
 #endif
@@ -12,10 +12,10 @@
 Texture2D gScribbleTex : register(t0) {};
 SamplerState gSampler : register(s0) {};
 
-cbuffer ObjectConstantBuffer : register(b0)
+//  ü  . ü ٸ  gInstances ִ.
+cbuffer FrameConstantBuffer : register(b0)
 {
-    float4x4 world;
-    float4x4 worldViewProjection;
+    float4x4 viewProjection;
     float3 eyePos;
     float2 texOffset;
     float3 lightDirection;
@@ -24,6 +24,14 @@ cbuffer ObjectConstantBuffer : register(b0)
     float gFogRange;
 };
 
+// νϽ ϳ.  ޽   ü   ׸ SV_InstanceID ã´.
+struct InstanceData
+{
+    float4x4 world;
+    float4x4 texTransform;
+};
+StructuredBuffer<InstanceData> gInstances : register(t1);
+
 struct PSInput
 {
     float3 posW : POSITION;
@@ -43,20 +51,41 @@ float4 ComputeDirectLight(float lightStrength, float3 lightDirection, float3 nor
 float3 BlinnPhong(float lightStrength, float3 lightVec, float3 normal, float3 toEye, Material mat);
 float3 SchlickFresnel(float3 r0, float3 normal, float3 lightVec);
 
-PSInput VSMain(float4 position : POSITION, float3 normal : NORMAL, float2 tex : TEXCOORD)
+PSInput VSMain(float4 position : POSITION, float3 normal : NORMAL, float2 tex : TEXCOORD, uint instanceID : SV_InstanceID)
 {
     PSInput result;
 
-    float4 posW = mul(float4(position.xyz, 1.0f), world);
+    InstanceData instance = gInstances[instanceID];
+
+    float4 posW = mul(float4(position.xyz, 1.0f), instance.world);
     result.posW = posW.xyz;
 
-    result.position = mul(position, worldViewProjection);
-    result.normal = mul(normal, (float3x3)worldViewProjection);
-    result.tex = tex;
+    result.position = mul(posW, viewProjection);
+    //    ϹǷ ֵ  (յ ϸ )
+    result.normal = mul(normal, (float3x3)instance.world);
+    result.tex = mul(float4(tex, 0.0f, 1.0f), instance.texTransform).xy;
 
     return result;
 }
 
+// ȸü   ǵ. (VertexQuantization.cpp DecodeOctahedral  )
+float3 DecodeOctahedral(float2 e)
+{
+    float3 n = float3(e, 1.0f - abs(e.x) - abs(e.y));
+    float t = saturate(-n.z);
+    n.xy += n.xy >= 0.0f ? -t : t;
+    return normalize(n);
+}
+
+// PackedVertex(16Ʈ) Է. ġ UNORM 0 ~ 1̰ ޽ offset, scale instance.world ̸  д.
+PSInput VSMainPacked(float4 position : POSITION, float2 octNormal : NORMAL, float2 tex : TEXCOORD, uint instanceID : SV_InstanceID)
+{
+    PSInput result = VSMain(float4(position.xyz, 1.0f), DecodeOctahedral(octNormal), tex, instanceID);
+    // world  scale  Ƿ  ̸ ٽ .
+    result.normal = normalize(result.normal);
+    return result;
+}
+
 float4 PSMain(PSInput input) : SV_TARGET
 {
     const float4 ambientLight = float4(0.0f, 0.0f, 0.0f, 1.0f);
@@ -0,0 +1,9 @@
+#pragma once
+#ifndef _DXCHECK_SAL_H_
+#define _DXCHECK_SAL_H_
+
+// Windows가 아닌 곳에서 DirectXMath가 찾는 sal.h 대신 쓴다.
+// SAL 주석은 DirectX-Headers의 wsl/winadapter.h가 빈 매크로로 정의한다.
+#include <wsl/winadapter.h>
+
+#endif
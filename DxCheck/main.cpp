@@ -0,0 +1,2468 @@
+#include <DirectXMath.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include "JobSystem.h"
+#include "FrustumCuller.h"
+#include "SceneStore.h"
+#include "SceneBvh.h"
+#include "OcclusionCuller.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "VertexQuantization.h"
+#include "DrawQueue.h"
+#include "ResourceRegistry.h"
+#include "TextureResidency.h"
+#include "RangeAllocator.h"
+#include "ResourceHeapAllocator.h"
+#include "d3dx12.h"
+#include "BCDecoder.h"
+#include "BCEncoder.h"
+#include "objparser.h"
+#include "FootprintRecord.h"
+
+// DX12Cube의 CPU 쪽 모듈을 GPU와 Windows 없이 검사하고 측정하는 명령줄 도구. 리눅스에서도 빌드한다. (루트 CMakeLists.txt)
+// *-test 명령은 알려진 답과 비교해서 하나라도 틀리면 1을 돌려준다. ctest가 모두 돌린다.
+// 사용법:
+//   DxCheck <명령> [인자...]
+//   DxCheck jobs-test
+//   DxCheck frustum-test
+//   DxCheck occlusion-test
+//   DxCheck bvh-test
+//   DxCheck scene-test
+//   DxCheck bvh-bench [개수]
+//   DxCheck occlusion-bench [개수]
+//   DxCheck vcache-test [파일.obj...]
+//   DxCheck vcache-report [-c 캐시 크기] 파일.obj...
+//   DxCheck simplify-test
+//   DxCheck drawqueue-test
+//   DxCheck registry-test
+//   DxCheck allocator-test
+//   DxCheck memcpy-test
+//   DxCheck bcdecode-test
+//   DxCheck bcencode-test
+//   DxCheck residency-test
+//   DxCheck vquant-test [파일.obj...]
+//   DxCheck footprint-test 기록.txt
+
+using namespace DirectX;
+
+namespace
+{
+	void Print(const std::string& text)
+	{
+		fputs(text.c_str(), stdout);
+	}
+
+	double SecondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// 검사 명령에서 결과를 모은다. 틀린 것만 출력한다.
+	class Checker
+	{
+	public:
+		void Expect(bool condition, const std::string& description)
+		{
+			mChecks++;
+			if (!condition)
+			{
+				mFailures++;
+				Print(std::format("  FAILED: {}\n", description));
+			}
+		}
+
+		int Finish(const char* name) const
+		{
+			Print(std::format("{}: {} checks, {} failed\n", name, mChecks, mFailures));
+			return mFailures ? 1 : 0;
+		}
+
+	private:
+		int mChecks = 0;
+		int mFailures = 0;
+	};
+
+	int ParseCount(const std::vector<std::string>& args, int defaultCount)
+	{
+		return args.empty() ? defaultCount : std::max(1, atoi(args[0].c_str()));
+	}
+
+	// 단위 상자 (-0.5 ~ 0.5). 가리는 물체로 쓴다.
+	const XMFLOAT3 gBoxPositions[] =
+	{
+		{ -0.5f, -0.5f, -0.5f }, { -0.5f, +0.5f, -0.5f }, { +0.5f, +0.5f, -0.5f }, { +0.5f, -0.5f, -0.5f },
+		{ -0.5f, -0.5f, +0.5f }, { -0.5f, +0.5f, +0.5f }, { +0.5f, +0.5f, +0.5f }, { +0.5f, -0.5f, +0.5f },
+	};
+	const uint16_t gBoxIndices[] =
+	{
+		0, 1, 2, 0, 2, 3, 4, 6, 5, 4, 7, 6, 4, 5, 1, 4, 1, 0,
+		3, 2, 6, 3, 6, 7, 1, 5, 6, 1, 6, 2, 4, 0, 3, 4, 3, 7,
+	};
+	const uint32_t gBoxIndexCount = sizeof(gBoxIndices) / sizeof(gBoxIndices[0]);
+
+	XMFLOAT4X4 MakeWorld(FXMMATRIX world)
+	{
+		XMFLOAT4X4 result;
+		XMStoreFloat4x4(&result, world);
+		return result;
+	}
+
+	//--------------------------------------------------------------------------------------
+	// jobs-test: 묶음마다 따로 기다리기, 작업 안의 ParallelFor, 묶음별 예외
+	//--------------------------------------------------------------------------------------
+	int RunJobsTest(const std::vector<std::string>&)
+	{
+		Checker checker;
+		JobSystem jobs(4);
+
+		// 모든 번호를 정확히 한 번씩
+		std::vector<std::atomic<int>> hits(10007);
+		jobs.ParallelFor(hits.size(), 64, [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; i++)
+				{
+					hits[i]++;
+				}
+			});
+		checker.Expect(std::all_of(hits.begin(), hits.end(), [](const std::atomic<int>& hit) { return hit == 1; }),
+			"ParallelFor visits every index once");
+
+		// 작업 안에서 ParallelFor. 부른 작업이 자기를 기다리면 끝나지 않는다.
+		std::atomic<int> nested = 0;
+		jobs.ParallelFor(64, 1, [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; i++)
+				{
+					jobs.ParallelFor(100, 7, [&](size_t first, size_t last) { nested += static_cast<int>(last - first); });
+				}
+			});
+		checker.Expect(nested == 6400, std::format("nested ParallelFor ran {} of 6400", nested.load()));
+
+		// 다른 묶음의 예외는 받지 않고, 자기 묶음의 예외는 받는다.
+		jobs.Submit([] { throw std::runtime_error("unrelated"); });
+		bool threwUnrelated = false;
+		try
+		{
+			jobs.ParallelFor(16, 1, [](size_t, size_t) { });
+		}
+		catch (...)
+		{
+			threwUnrelated = true;
+		}
+		checker.Expect(!threwUnrelated, "ParallelFor does not rethrow other jobs' exceptions");
+
+		bool poolThrew = false;
+		try
+		{
+			jobs.Wait();
+		}
+		catch (const std::runtime_error&)
+		{
+			poolThrew = true;
+		}
+		checker.Expect(poolThrew, "Wait() rethrows an exception from a job without a counter");
+
+		std::string caught;
+		try
+		{
+			jobs.ParallelFor(16, 1, [](size_t begin, size_t) { if (begin == 5) throw std::runtime_error("mine"); });
+		}
+		catch (const std::runtime_error& error)
+		{
+			caught = error.what();
+		}
+		checker.Expect(caught == "mine", "ParallelFor rethrows its own exception");
+
+		// 묶음 하나만 기다린다. 다른 묶음의 작업은 막혀 있어도 된다.
+		// 막힌 작업이 워커에서 돌기 시작한 뒤에 기다려야 호출 스레드가 그 작업을 집어 들지 않는다.
+		std::atomic<bool> started = false;
+		std::atomic<bool> release = false;
+		JobCounter blocked;
+		jobs.Submit([&] { started = true; while (!release) { std::this_thread::yield(); } }, &blocked);
+		while (!started)
+		{
+			std::this_thread::yield();
+		}
+		JobCounter counter;
+		std::atomic<int> done = 0;
+		for (int i = 0; i < 100; i++)
+		{
+			jobs.Submit([&] { jobs.ParallelFor(50, 1, [&](size_t, size_t) { done++; }); }, &counter);
+		}
+		jobs.Wait(counter);
+		checker.Expect(done == 5000, std::format("Wait(counter) returned after {} of 5000 chunks", done.load()));
+		checker.Expect(blocked.GetPending() == 1, "Wait(counter) does not wait for another counter");
+		release = true;
+		jobs.Wait(blocked);
+
+		return checker.Finish("jobs-test");
+	}
+
+	//--------------------------------------------------------------------------------------
+	// frustum-test: 원점에서 +z를 보는 절두체로 답을 아는 상자를 검사
+	//--------------------------------------------------------------------------------------
+	int RunFrustumTest(const std::vector<std::string>&)
+	{
+		Checker checker;
+
+		const XMFLOAT3 positions[] = { { -1.0f, 2.0f, 3.0f }, { 4.0f, -5.0f, 6.0f }, { 0.0f, 0.0f, 0.0f } };
+		const CullBounds computed = ComputeCullBounds(positions, 3, sizeof(XMFLOAT3));
+		checker.Expect(computed.Center.x == 1.5f && computed.Center.y == -1.5f && computed.Center.z == 3.0f
+			&& computed.Extents.x == 2.5f && computed.Extents.y == 3.5f && computed.Extents.z == 3.0f, "ComputeCullBounds");
+
+		// 수직 시야 90도, 가로 세로 1:1, 1 ~ 100
+		const XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f), XMVectorSet(0.0f, 0.0f, 1.0f, 1.0f),
+			XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+		FrustumCuller culler;
+		culler.SetViewProjection(view * XMMatrixPerspectiveFovLH(0.5f * XM_PI, 1.0f, 1.0f, 100.0f));
+
+		CullBounds unitBounds;
+		unitBounds.Extents = XMFLOAT3(0.5f, 0.5f, 0.5f);
+		struct Case
+		{
+			XMFLOAT3 Position;
+			bool Visible;
+			const char* Name;
+		};
+		const Case cases[] =
+		{
+			{ { 0.0f, 0.0f, 10.0f }, true, "in front" },
+			{ { 0.0f, 0.0f, -10.0f }, false, "behind" },
+			{ { 20.0f, 0.0f, 10.0f }, false, "right of the frustum" },
+			{ { 0.0f, -20.0f, 10.0f }, false, "below the frustum" },
+			{ { 10.2f, 0.0f, 10.0f }, true, "straddling the right plane" },
+			{ { 0.0f, 0.0f, 100.3f }, true, "straddling the far plane" },
+			{ { 0.0f, 0.0f, 101.0f }, false, "beyond the far plane" },
+			{ { 0.0f, 0.0f, 1.0f }, true, "straddling the near plane" },
+			{ { 0.0f, 0.0f, 0.0f }, false, "closer than the near plane" },
+		};
+		const size_t caseCount = sizeof(cases) / sizeof(cases[0]);
+
+		std::vector<XMFLOAT4X4> worlds;
+		for (const auto& c : cases)
+		{
+			worlds.push_back(MakeWorld(XMMatrixTranslation(c.Position.x, c.Position.y, c.Position.z)));
+		}
+		std::vector<uint32_t> boundsIndices(caseCount, 0);
+		std::vector<uint8_t> visible(caseCount, 0xFF);
+		culler.Cull(worlds.data(), boundsIndices.data(), &unitBounds, 0, caseCount, visible.data());
+		for (size_t i = 0; i < caseCount; i++)
+		{
+			checker.Expect(visible[i] == (cases[i].Visible ? 1 : 0), std::format("box {} is {}", cases[i].Name,
+				cases[i].Visible ? "visible" : "culled"));
+		}
+
+		// 회전한 긴 상자: 중심은 밖이지만 회전 후 AABB가 절두체에 걸친다.
+		CullBounds longBounds;
+		longBounds.Extents = XMFLOAT3(10.0f, 0.1f, 0.1f);
+		const XMFLOAT4X4 rotated = MakeWorld(XMMatrixRotationY(0.25f * XM_PI) * XMMatrixTranslation(-16.0f, 0.0f, 10.0f));
+		const uint32_t zero = 0;
+		uint8_t rotatedVisible = 0;
+		culler.Cull(&rotated, &zero, &longBounds, 0, 1, &rotatedVisible);
+		checker.Expect(rotatedVisible == 1, "rotated long box reaching into the frustum is visible");
+
+		// 병렬 결과는 한 번에 검사한 것과 같아야 한다. (PARALLEL_GRAIN보다 많이)
+		const size_t count = FrustumCuller::PARALLEL_GRAIN * 5 + 3;
+		std::mt19937 random(7);
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		std::vector<XMFLOAT4X4> randomWorlds(count);
+		for (auto& world : randomWorlds)
+		{
+			world = MakeWorld(XMMatrixTranslation(unit(random) * 150.0f, unit(random) * 150.0f, unit(random) * 150.0f));
+		}
+		std::vector<uint32_t> randomIndices(count, 0);
+		std::vector<uint8_t> serial(count);
+		std::vector<uint8_t> parallel(count);
+		JobSystem jobs(4);
+		const size_t serialDrawn = culler.Cull(randomWorlds.data(), randomIndices.data(), &unitBounds, 0, count, serial.data());
+		const size_t parallelDrawn = culler.CullParallel(jobs, randomWorlds.data(), randomIndices.data(), &unitBounds, count, parallel.data());
+		checker.Expect(serialDrawn == parallelDrawn && serial == parallel, "CullParallel matches Cull");
+
+		// 점 하나하나를 절두체 식으로 본 답과 비교한다. 상자 중심이 안쪽이면 반드시 보여야 한다.
+		size_t missed = 0;
+		for (size_t i = 0; i < count; i++)
+		{
+			const float x = randomWorlds[i]._41, y = randomWorlds[i]._42, z = randomWorlds[i]._43;
+			const bool centerInside = z > 1.0f && z < 100.0f && std::fabs(x) < z && std::fabs(y) < z;
+			missed += centerInside && !serial[i] ? 1 : 0;
+		}
+		checker.Expect(missed == 0, std::format("{} boxes with their center inside the frustum were culled", missed));
+
+		return checker.Finish("frustum-test");
+	}
+
+	//--------------------------------------------------------------------------------------
+	// occlusion-test: 벽 하나를 가리는 물체로 그리고 뒤에 숨은 상자와 보이는 상자를 검사
+	//--------------------------------------------------------------------------------------
+
+	// 광선과 삼각형 (Moller-Trumbore). 0 < t < maxT에서 만나면 true
+	bool RayHitsTriangle(const XMFLOAT3& origin, const XMFLOAT3& direction, const XMFLOAT3& a, const XMFLOAT3& b,
+		const XMFLOAT3& c, float maxT)
+	{
+		const XMVECTOR o = XMLoadFloat3(&origin);
+		const XMVECTOR d = XMLoadFloat3(&direction);
+		const XMVECTOR v0 = XMLoadFloat3(&a);
+		const XMVECTOR edge1 = XMVectorSubtract(XMLoadFloat3(&b), v0);
+		const XMVECTOR edge2 = XMVectorSubtract(XMLoadFloat3(&c), v0);
+		const XMVECTOR p = XMVector3Cross(d, edge2);
+		const float determinant = XMVectorGetX(XMVector3Dot(edge1, p));
+		if (std::fabs(determinant) < 1e-9f)
+		{
+			return false;
+		}
+		const float inverse = 1.0f / determinant;
+		const XMVECTOR s = XMVectorSubtract(o, v0);
+		const float u = XMVectorGetX(XMVector3Dot(s, p)) * inverse;
+		if (u < 0.0f || u > 1.0f)
+		{
+			return false;
+		}
+		const XMVECTOR q = XMVector3Cross(s, edge1);
+		const float v = XMVectorGetX(XMVector3Dot(d, q)) * inverse;
+		if (v < 0.0f || u + v > 1.0f)
+		{
+			return false;
+		}
+		const float t = XMVectorGetX(XMVector3Dot(edge2, q)) * inverse;
+		return t > 0.0f && t < maxT;
+	}
+
+	int RunOcclusionTest(const std::vector<std::string>&)
+	{
+		Checker checker;
+
+		// 눈은 원점, +z를 본다. 벽은 z = 20에 x, y가 -10 ~ 10인 얇은 상자
+		const XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f), XMVectorSet(0.0f, 0.0f, 1.0f, 1.0f),
+			XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+		const XMMATRIX viewProjection = view * XMMatrixPerspectiveFovLH(0.5f * XM_PI, 16.0f / 9.0f, 1.0f, 1000.0f);
+		const XMFLOAT4X4 wall = MakeWorld(XMMatrixScaling(20.0f, 20.0f, 0.1f) * XMMatrixTranslation(0.0f, 0.0f, 20.0f));
+
+		OcclusionCuller culler;
+		culler.SetViewProjection(viewProjection);
+		culler.ClearOccluders();
+		culler.AddOccluder(wall, gBoxPositions, sizeof(XMFLOAT3), gBoxIndices, gBoxIndexCount);
+		culler.Render();
+		checker.Expect(culler.GetTriangleCount() > 0, "wall triangles reach the screen");
+
+		CullBounds unitBounds;
+		unitBounds.Extents = XMFLOAT3(0.5f, 0.5f, 0.5f);
+		struct Case
+		{
+			XMFLOAT3 Position;
+			bool Visible;
+			const char* Name;
+		};
+		const Case cases[] =
+		{
+			{ { 0.0f, 0.0f, 40.0f }, false, "straight behind the wall" },
+			{ { 15.0f, 5.0f, 40.0f }, false, "behind the wall, off center" },
+			{ { 0.0f, 0.0f, 10.0f }, true, "in front of the wall" },
+			{ { 25.0f, 0.0f, 40.0f }, true, "beside the wall" },
+			{ { 20.0f, 0.0f, 40.0f }, true, "peeking past the wall edge" },
+			{ { 0.0f, 25.0f, 40.0f }, true, "above the wall" },
+			{ { 0.0f, 0.0f, 0.0f }, true, "around the eye" },
+			{ { 0.0f, 0.0f, -10.0f }, true, "behind the eye (left to frustum culling)" },
+		};
+		for (const auto& c : cases)
+		{
+			const bool visible = culler.IsVisible(MakeWorld(XMMatrixTranslation(c.Position.x, c.Position.y, c.Position.z)), unitBounds);
+			checker.Expect(visible == c.Visible, std::format("box {} is {}", c.Name, c.Visible ? "visible" : "occluded"));
+		}
+
+		// 띠마다 나눠 그린 깊이는 한 번에 그린 것과 같다.
+		const std::vector<float> serialDepth(culler.GetDepth(), culler.GetDepth() + culler.GetWidth() * culler.GetHeight());
+		JobSystem jobs(4);
+		culler.Render(&jobs);
+		checker.Expect(std::equal(serialDepth.begin(), serialDepth.end(), culler.GetDepth()), "parallel Render matches serial Render");
+
+		// 흩어 놓은 상자 중 가려졌다고 한 것은 꼭짓점과 안쪽 점에서 눈으로 쏜 광선이 모두 벽에 막혀야 한다.
+		const size_t count = OcclusionCuller::PARALLEL_GRAIN * 8;
+		std::mt19937 random(3);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		std::vector<XMFLOAT4X4> worlds(count);
+		for (auto& world : worlds)
+		{
+			world = MakeWorld(XMMatrixTranslation((unit(random) - 0.5f) * 80.0f, (unit(random) - 0.5f) * 50.0f, 21.0f + unit(random) * 60.0f));
+		}
+		std::vector<uint32_t> boundsIndices(count, 0);
+		std::vector<uint8_t> serial(count, 1);
+		std::vector<uint8_t> parallel(count, 1);
+		const size_t occluded = culler.Cull(worlds.data(), boundsIndices.data(), &unitBounds, 0, count, serial.data());
+		const size_t parallelOccluded = culler.CullParallel(jobs, worlds.data(), boundsIndices.data(), &unitBounds, count, parallel.data());
+		checker.Expect(occluded == parallelOccluded && serial == parallel, "CullParallel matches Cull");
+		checker.Expect(occluded > 0 && occluded < count, std::format("{} of {} random boxes occluded", occluded, count));
+
+		XMFLOAT3 wallCorners[8];
+		for (int i = 0; i < 8; i++)
+		{
+			XMStoreFloat3(&wallCorners[i], XMVector3Transform(XMLoadFloat3(&gBoxPositions[i]), XMLoadFloat4x4(&wall)));
+		}
+		const XMFLOAT3 eye(0.0f, 0.0f, 0.0f);
+		size_t wronglyOccluded = 0;
+		for (size_t i = 0; i < count; i++)
+		{
+			if (serial[i])
+			{
+				continue;
+			}
+			bool hidden = true;
+			for (int sample = 0; sample < 64 && hidden; sample++)
+			{
+				XMFLOAT3 point(worlds[i]._41 + unit(random) - 0.5f, worlds[i]._42 + unit(random) - 0.5f, worlds[i]._43 + unit(random) - 0.5f);
+				if (sample < 8)
+				{
+					point = XMFLOAT3(worlds[i]._41 + ((sample & 1) ? 0.5f : -0.5f), worlds[i]._42 + ((sample & 2) ? 0.5f : -0.5f),
+						worlds[i]._43 + ((sample & 4) ? 0.5f : -0.5f));
+				}
+				bool blocked = false;
+				for (uint32_t t = 0; t < gBoxIndexCount && !blocked; t += 3)
+				{
+					blocked = RayHitsTriangle(eye, point, wallCorners[gBoxIndices[t]], wallCorners[gBoxIndices[t + 1]],
+						wallCorners[gBoxIndices[t + 2]], 0.999f);
+				}
+				hidden = blocked;
+			}
+			wronglyOccluded += hidden ? 0 : 1;
+		}
+		checker.Expect(wronglyOccluded == 0, std::format("{} occluded boxes are partly visible", wronglyOccluded));
+
+		return checker.Finish("occlusion-test");
+	}
+
+	//--------------------------------------------------------------------------------------
+	// bvh-test: SceneBvh 질의를 모든 물체 AABB를 하나씩 본 답과 비교한다. (빌드 직후, Refit, RefitItem 뒤)
+	//--------------------------------------------------------------------------------------
+
+	// SceneBvh와 같은 판정: 평면 법선 쪽으로 가장 먼 꼭짓점이 평면 밖이면 밖
+	bool BoundsOutsidePlane(const XMFLOAT4& plane, const BvhBounds& bounds)
+	{
+		const float px = plane.x >= 0.0f ? bounds.Max.x : bounds.Min.x;
+		const float py = plane.y >= 0.0f ? bounds.Max.y : bounds.Min.y;
+		const float pz = plane.z >= 0.0f ? bounds.Max.z : bounds.Min.z;
+		return plane.x * px + plane.y * py + plane.z * pz + plane.w < 0.0f;
+	}
+
+	float RayEnterDistance(const BvhBounds& bounds, const XMFLOAT3& origin, const XMFLOAT3& direction, float maxDistance)
+	{
+		const float* lo = &bounds.Min.x;
+		const float* hi = &bounds.Max.x;
+		const float* o = &origin.x;
+		const float* d = &direction.x;
+		float tMin = 0.0f;
+		float tMax = maxDistance;
+		for (int a = 0; a < 3; a++)
+		{
+			float t0 = (lo[a] - o[a]) * (1.0f / d[a]);
+			float t1 = (hi[a] - o[a]) * (1.0f / d[a]);
+			if (t0 > t1)
+			{
+				std::swap(t0, t1);
+			}
+			tMin = std::max(tMin, t0);
+			tMax = std::min(tMax, t1);
+			if (tMin > tMax)
+			{
+				return FLT_MAX;
+			}
+		}
+		return tMin;
+	}
+
+	void CheckBvhQueries(Checker& checker, const SceneBvh& bvh, const std::vector<BvhBounds>& bounds, const char* stage)
+	{
+		std::mt19937 random(99);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		const size_t count = bounds.size();
+		std::vector<uint32_t> items;
+		std::vector<uint32_t> expected;
+
+		FrustumCuller culler;
+		const XMMATRIX proj = XMMatrixPerspectiveFovLH(0.25f * XM_PI, 16.0f / 9.0f, 1.0f, 300.0f);
+		size_t frustumMismatches = 0;
+		for (int i = 0; i < 8; i++)
+		{
+			const float angle = XM_2PI * i / 8;
+			const XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 30.0f, 0.0f, 1.0f),
+				XMVectorSet(cosf(angle), 25.0f, sinf(angle), 1.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+			culler.SetViewProjection(view * proj);
+			items.clear();
+			bvh.QueryFrustum(culler.GetPlanes(), items);
+			expected.clear();
+			for (uint32_t item = 0; item < count; item++)
+			{
+				bool outside = false;
+				for (int p = 0; p < 6 && !outside; p++)
+				{
+					outside = BoundsOutsidePlane(culler.GetPlanes()[p], bounds[item]);
+				}
+				if (!outside)
+				{
+					expected.push_back(item);
+				}
+			}
+			std::sort(items.begin(), items.end());
+			frustumMismatches += items == expected ? 0 : 1;
+		}
+		checker.Expect(frustumMismatches == 0, std::format("{}: {} of 8 frustum queries differ from brute force", stage, frustumMismatches));
+
+		size_t sphereMismatches = 0;
+		for (int i = 0; i < 100; i++)
+		{
+			const XMFLOAT3 center((unit(random) - 0.5f) * 400.0f, 10.0f, (unit(random) - 0.5f) * 400.0f);
+			const float radius = 5.0f + unit(random) * 20.0f;
+			items.clear();
+			bvh.QuerySphere(center, radius, items);
+			expected.clear();
+			for (uint32_t item = 0; item < count; item++)
+			{
+				const float dx = std::clamp(center.x, bounds[item].Min.x, bounds[item].Max.x) - center.x;
+				const float dy = std::clamp(center.y, bounds[item].Min.y, bounds[item].Max.y) - center.y;
+				const float dz = std::clamp(center.z, bounds[item].Min.z, bounds[item].Max.z) - center.z;
+				if (dx * dx + dy * dy + dz * dz <= radius * radius)
+				{
+					expected.push_back(item);
+				}
+			}
+			std::sort(items.begin(), items.end());
+			sphereMismatches += items == expected ? 0 : 1;
+		}
+		checker.Expect(sphereMismatches == 0, std::format("{}: {} of 100 sphere queries differ from brute force", stage, sphereMismatches));
+
+		size_t rayMismatches = 0;
+		for (int i = 0; i < 100; i++)
+		{
+			const XMFLOAT3 origin((unit(random) - 0.5f) * 400.0f, 50.0f, (unit(random) - 0.5f) * 400.0f);
+			XMFLOAT3 direction;
+			XMStoreFloat3(&direction, XMVector3Normalize(XMVectorSet(unit(random) - 0.5f, -0.3f, unit(random) - 0.5f, 0.0f)));
+			float closest = FLT_MAX;
+			for (uint32_t item = 0; item < count; item++)
+			{
+				closest = std::min(closest, RayEnterDistance(bounds[item], origin, direction, 500.0f));
+			}
+			BvhRayHit hit;
+			const bool found = bvh.Raycast(origin, direction, 500.0f, hit);
+			const bool match = found ? hit.Distance == closest && RayEnterDistance(bounds[hit.Item], origin, direction, 500.0f) == closest
+				: closest == FLT_MAX;
+			rayMismatches += match ? 0 : 1;
+		}
+		checker.Expect(rayMismatches == 0, std::format("{}: {} of 100 raycasts differ from brute force", stage, rayMismatches));
+	}
+
+	int RunBvhTest(const std::vector<std::string>&)
+	{
+		Checker checker;
+		// PARALLEL_BUILD_GRAIN보다 많아야 병렬 빌드가 나눠진다.
+		const size_t count = SceneBvh::PARALLEL_BUILD_GRAIN * 3 + 17;
+		std::mt19937 random(5);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		CullBounds meshBounds[2];
+		meshBounds[0].Extents = XMFLOAT3(1.0f, 2.0f, 0.5f);
+		meshBounds[1].Center = XMFLOAT3(0.0f, 1.0f, 0.0f);
+		meshBounds[1].Extents = XMFLOAT3(3.0f, 1.0f, 3.0f);
+
+		std::vector<XMFLOAT4X4> worlds(count);
+		std::vector<uint32_t> meshIds(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			worlds[i] = MakeWorld(XMMatrixRotationY(unit(random) * XM_2PI) *
+				XMMatrixTranslation((unit(random) - 0.5f) * 400.0f, unit(random) * 20.0f, (unit(random) - 0.5f) * 400.0f));
+			meshIds[i] = random() % 2;
+		}
+		std::vector<BvhBounds> bounds(count);
+		ComputeBvhBounds(worlds.data(), meshIds.data(), meshBounds, 0, count, bounds.data());
+
+		JobSystem jobs(4);
+		SceneBvh serialBvh;
+		serialBvh.Build(bounds.data(), count);
+		SceneBvh bvh;
+		bvh.Build(bounds.data(), count, &jobs);
+		checker.Expect(bvh.GetItemCount() == count && serialBvh.GetItemCount() == count, "every item is in the tree");
+		CheckBvhQueries(checker, serialBvh, bounds, "serial build");
+		CheckBvhQueries(checker, bvh, bounds, "parallel build");
+
+		// 모든 물체를 옮기고 Refit
+		for (size_t i = 0; i < count; i++)
+		{
+			worlds[i]._41 += (unit(random) - 0.5f) * 10.0f;
+			worlds[i]._43 += (unit(random) - 0.5f) * 10.0f;
+		}
+		ComputeBvhBounds(worlds.data(), meshIds.data(), meshBounds, 0, count, bounds.data());
+		bvh.Refit(bounds.data(), &jobs);
+		CheckBvhQueries(checker, bvh, bounds, "Refit");
+
+		// 몇 개만 멀리 옮기고 RefitItem
+		for (int i = 0; i < 500; i++)
+		{
+			const uint32_t item = random() % count;
+			worlds[item]._41 = (unit(random) - 0.5f) * 400.0f;
+			worlds[item]._42 += unit(random) * 30.0f;
+			ComputeBvhBounds(worlds.data(), meshIds.data(), meshBounds, item, item + 1, bounds.data());
+			bvh.RefitItem(item, bounds[item]);
+		}
+		CheckBvhQueries(checker, bvh, bounds, "RefitItem");
+
+		return checker.Finish("bvh-test");
+	}
+
+	//--------------------------------------------------------------------------------------
+	// scene-test: SceneStore 구조 버전과 움직인 핸들로 밀집 위치 BVH를 따라가게 한다. (DX12Cube UpdateSceneBvh와 같은 순서)
+	//--------------------------------------------------------------------------------------
+	int RunSceneTest(const std::vector<std::string>&)
+	{
+		Checker checker;
+		std::mt19937 random(11);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		CullBounds meshBounds;
+		meshBounds.Extents = XMFLOAT3(1.0f, 1.0f, 1.0f);
+		auto randomWorld = [&]
+			{
+				return MakeWorld(XMMatrixTranslation((unit(random) - 0.5f) * 400.0f, unit(random) * 20.0f, (unit(random) - 0.5f) * 400.0f));
+			};
+
+		SceneStore scene;
+		std::vector<SceneStore::Handle> handles;
+		for (int i = 0; i < 5000; i++)
+		{
+			handles.push_back(scene.Add(randomWorld(), 0, 0, SceneItemOpaque));
+		}
+
+		SceneBvh bvh;
+		std::vector<BvhBounds> bounds;
+		uint32_t builtVersion = ~0u;
+		size_t rebuilds = 0;
+		auto update = [&]
+			{
+				if (builtVersion != scene.GetStructureVersion())
+				{
+					bounds.resize(scene.GetCount());
+					ComputeBvhBounds(scene.GetWorlds(), scene.GetMeshes(), &meshBounds, 0, scene.GetCount(), bounds.data());
+					bvh.Build(bounds.data(), scene.GetCount());
+					builtVersion = scene.GetStructureVersion();
+					rebuilds++;
+				}
+				else
+				{
+					for (SceneStore::Handle handle : scene.GetMovedHandles())
+					{
+						const size_t index = scene.GetIndex(handle);
+						ComputeBvhBounds(scene.GetWorlds(), scene.GetMeshes(), &meshBounds, index, index + 1, bounds.data());
+						bvh.RefitItem(static_cast<uint32_t>(index), bounds[index]);
+					}
+				}
+				scene.ClearMoved();
+			};
+		update();
+
+		// 움직이기만 하면 다시 만들지 않는다.
+		const uint32_t version = scene.GetStructureVersion();
+		for (int i = 0; i < 300; i++)
+		{
+			scene.SetWorld(handles[random() % handles.size()], randomWorld());
+		}
+		checker.Expect(scene.GetStructureVersion() == version, "SetWorld keeps the structure version");
+		checker.Expect(scene.GetMovedHandles().size() == 300, "SetWorld records moved handles");
+		update();
+		checker.Expect(rebuilds == 1 && scene.GetMovedHandles().empty(), "moves are refit without a rebuild");
+
+		std::vector<BvhBounds> expected(scene.GetCount());
+		ComputeBvhBounds(scene.GetWorlds(), scene.GetMeshes(), &meshBounds, 0, scene.GetCount(), expected.data());
+		CheckBvhQueries(checker, bvh, expected, "after moves");
+
+		// 지우고 더하면 물체 수는 같지만 마지막 물체가 빈 자리로 옮겨 온다.
+		for (int i = 0; i < 50; i++)
+		{
+			const size_t victim = random() % handles.size();
+			scene.SetWorld(handles[victim], randomWorld());
+			scene.Remove(handles[victim]);
+			handles[victim] = scene.Add(randomWorld(), 0, 0, SceneItemOpaque);
+		}
+		checker.Expect(scene.GetCount() == 5000 && scene.GetStructureVersion() != version, "Remove+Add changes the structure version");
+		update();
+		checker.Expect(rebuilds == 2, "structure change rebuilds the BVH");
+		ComputeBvhBounds(scene.GetWorlds(), scene.GetMeshes(), &meshBounds, 0, scene.GetCount(), expected.data());
+		CheckBvhQueries(checker, bvh, expected, "after remove+add");
+
+		return checker.Finish("scene-test");
+	}
+
+	//--------------------------------------------------------------------------------------
+	// bvh-bench: SceneBvh 빌드/리핏/질의 시간. 절두체 질의는 FrustumCuller로 전부 검사한 것과 비교한다.
+	//--------------------------------------------------------------------------------------
+	int RunBvhBench(const std::vector<std::string>& args)
+	{
+		const int count = ParseCount(args, 1000000);
+		const int meshCount = 16;
+		const int queryCount = 1000;
+		const float worldSize = 2000.0f;
+
+		// 크기가 다른 메쉬 몇 개를 넓은 땅 위에 흩어 놓는다. 높이 방향은 얇다.
+		std::mt19937 random(12345);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		std::vector<CullBounds> meshBounds(meshCount);
+		for (auto& bounds : meshBounds)
+		{
+			const float size = 0.5f + unit(random) * 2.0f;
+			bounds.Extents = XMFLOAT3(size, size * (0.5f + unit(random)), size);
+		}
+
+		std::vector<XMFLOAT4X4> worlds(count);
+		std::vector<uint32_t> meshIds(count);
+		for (int i = 0; i < count; i++)
+		{
+			XMMATRIX world = XMMatrixRotationY(unit(random) * XM_2PI) *
+				XMMatrixTranslation((unit(random) - 0.5f) * worldSize, unit(random) * 20.0f, (unit(random) - 0.5f) * worldSize);
+			XMStoreFloat4x4(&worlds[i], world);
+			meshIds[i] = random() % meshCount;
+		}
+
+		JobSystem jobs;
+		std::vector<BvhBounds> bounds(count);
+		auto start = std::chrono::steady_clock::now();
+		jobs.ParallelFor(count, SceneBvh::PARALLEL_BUILD_GRAIN, [&](size_t begin, size_t end)
+			{
+				ComputeBvhBounds(worlds.data(), meshIds.data(), meshBounds.data(), begin, end, bounds.data());
+			});
+		const double boundsSeconds = SecondsSince(start);
+
+		SceneBvh serialBvh;
+		start = std::chrono::steady_clock::now();
+		serialBvh.Build(bounds.data(), count);
+		const double serialBuildSeconds = SecondsSince(start);
+
+		SceneBvh bvh;
+		start = std::chrono::steady_clock::now();
+		bvh.Build(bounds.data(), count, &jobs);
+		const double parallelBuildSeconds = SecondsSince(start);
+
+		Print(std::format("{} items, {} nodes, depth {}, {} threads\n", count, bvh.GetNodeCount(), bvh.GetDepth(), jobs.GetConcurrency()));
+		Print(std::format("  world bounds:   {:8.3f} ms\n", boundsSeconds * 1000.0));
+		Print(std::format("  build serial:   {:8.3f} ms\n", serialBuildSeconds * 1000.0));
+		Print(std::format("  build parallel: {:8.3f} ms ({:.2f}x)\n", parallelBuildSeconds * 1000.0,
+			parallelBuildSeconds > 0.0 ? serialBuildSeconds / parallelBuildSeconds : 0.0));
+
+		// 절두체: 카메라를 땅 위에서 돌려 가며 BVH 질의와 물체별 SIMD 검사를 비교한다.
+		const XMMATRIX proj = XMMatrixPerspectiveFovLH(0.25f * XM_PI, 16.0f / 9.0f, 1.0f, 1000.0f);
+		FrustumCuller culler;
+		std::vector<uint32_t> items;
+		std::vector<uint8_t> visible(count);
+		double bvhFrustumSeconds = 0.0;
+		double flatFrustumSeconds = 0.0;
+		size_t bvhVisible = 0;
+		size_t flatVisible = 0;
+		const int frustumCount = 100;
+		for (int i = 0; i < frustumCount; i++)
+		{
+			const float angle = XM_2PI * i / frustumCount;
+			const XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 30.0f, 0.0f, 1.0f),
+				XMVectorSet(cosf(angle), 25.0f, sinf(angle), 1.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+			culler.SetViewProjection(view * proj);
+
+			items.clear();
+			start = std::chrono::steady_clock::now();
+			bvh.QueryFrustum(culler.GetPlanes(), items);
+			bvhFrustumSeconds += SecondsSince(start);
+			bvhVisible += items.size();
+
+			start = std::chrono::steady_clock::now();
+			flatVisible += culler.CullParallel(jobs, worlds.data(), meshIds.data(), meshBounds.data(), count, visible.data());
+			flatFrustumSeconds += SecondsSince(start);
+		}
+		Print(std::format("  frustum BVH:    {:8.3f} ms / query, {:.0f} items\n", bvhFrustumSeconds * 1000.0 / frustumCount,
+			static_cast<double>(bvhVisible) / frustumCount));
+		Print(std::format("  frustum flat:   {:8.3f} ms / query, {:.0f} items\n", flatFrustumSeconds * 1000.0 / frustumCount,
+			static_cast<double>(flatVisible) / frustumCount));
+		if (bvhVisible != flatVisible)
+		{
+			Print("  warning: BVH and flat culling found different items\n");
+		}
+
+		size_t sphereItems = 0;
+		start = std::chrono::steady_clock::now();
+		for (int i = 0; i < queryCount; i++)
+		{
+			items.clear();
+			const XMFLOAT3 center((unit(random) - 0.5f) * worldSize, 10.0f, (unit(random) - 0.5f) * worldSize);
+			bvh.QuerySphere(center, 20.0f, items);
+			sphereItems += items.size();
+		}
+		const double sphereSeconds = SecondsSince(start);
+		Print(std::format("  sphere r=20:    {:8.4f} ms / query, {:.1f} items\n", sphereSeconds * 1000.0 / queryCount,
+			static_cast<double>(sphereItems) / queryCount));
+
+		int rayHits = 0;
+		start = std::chrono::steady_clock::now();
+		for (int i = 0; i < queryCount; i++)
+		{
+			const XMFLOAT3 origin((unit(random) - 0.5f) * worldSize, 50.0f, (unit(random) - 0.5f) * worldSize);
+			XMFLOAT3 direction;
+			XMStoreFloat3(&direction, XMVector3Normalize(XMVectorSet(unit(random) - 0.5f, -0.2f, unit(random) - 0.5f, 0.0f)));
+			BvhRayHit hit;
+			rayHits += bvh.Raycast(origin, direction, 1000.0f, hit) ? 1 : 0;
+		}
+		const double raySeconds = SecondsSince(start);
+		Print(std::format("  raycast:        {:8.4f} ms / ray, {} of {} hit\n", raySeconds * 1000.0 / queryCount, rayHits, queryCount));
+
+		// 모든 물체가 조금씩 움직인 프레임: 전부 리핏. 몇 개만 움직인 프레임: 물체마다 RefitItem.
+		for (int i = 0; i < count; i++)
+		{
+			worlds[i]._41 += unit(random) - 0.5f;
+			worlds[i]._43 += unit(random) - 0.5f;
+		}
+		jobs.ParallelFor(count, SceneBvh::PARALLEL_BUILD_GRAIN, [&](size_t begin, size_t end)
+			{
+				ComputeBvhBounds(worlds.data(), meshIds.data(), meshBounds.data(), begin, end, bounds.data());
+			});
+		start = std::chrono::steady_clock::now();
+		serialBvh.Refit(bounds.data());
+		const double serialRefitSeconds = SecondsSince(start);
+		start = std::chrono::steady_clock::now();
+		bvh.Refit(bounds.data(), &jobs);
+		const double parallelRefitSeconds = SecondsSince(start);
+		Print(std::format("  refit serial:   {:8.3f} ms\n", serialRefitSeconds * 1000.0));
+		Print(std::format("  refit parallel: {:8.3f} ms\n", parallelRefitSeconds * 1000.0));
+
+		const int movedCount = std::max(1, count / 100);
+		start = std::chrono::steady_clock::now();
+		for (int i = 0; i < movedCount; i++)
+		{
+			const int item = random() % count;
+			worlds[item]._42 += 1.0f;
+			ComputeBvhBounds(worlds.data(), meshIds.data(), meshBounds.data(), item, item + 1, bounds.data());
+			bvh.RefitItem(item, bounds[item]);
+		}
+		const double itemRefitSeconds = SecondsSince(start);
+		Print(std::format("  refit item:     {:8.3f} ms for {} items ({:.0f} ns each)\n", itemRefitSeconds * 1000.0, movedCount,
+			itemRefitSeconds * 1e9 / movedCount));
+		return 0;
+	}
+
+	// 면마다 버텍스 세 개를 따로 만든다. (ObjToTriangles)
+	bool LoadObjTriangles(const std::string& fileName, std::vector<float>& vertices, std::vector<uint32_t>& indices)
+	{
+		if (!ObjToTriangles(ObjParse(std::filesystem::path(fileName).wstring().c_str()), vertices, indices))
+		{
+			Print(std::format("{}: no faces\n", fileName));
+			return false;
+		}
+		return true;
+	}
+
+	//--------------------------------------------------------------------------------------
+	// vcache-report: OBJ 메쉬를 DX12Cube가 올리는 순서로 최적화하면서 단계마다 FIFO 캐시 ACMR/ATVR을 출력
+	//--------------------------------------------------------------------------------------
+	int RunVertexCacheReport(const std::vector<std::string>& args)
+	{
+		uint32_t cacheSize = VERTEX_CACHE_SIZE;
+		std::vector<std::string> files;
+		for (size_t i = 0; i < args.size(); i++)
+		{
+			if (args[i] == "-c" && i + 1 < args.size())
+			{
+				cacheSize = std::max(3u, static_cast<uint32_t>(strtoul(args[++i].c_str(), nullptr, 10)));
+			}
+			else
+			{
+				files.push_back(args[i]);
+			}
+		}
+		if (files.empty())
+		{
+			Print("usage: DxCheck vcache-report [-c cacheSize] file.obj...\n");
+			return 1;
+		}
+
+		const size_t vertexSize = 8 * sizeof(float);
+		for (const auto& file : files)
+		{
+			std::vector<float> vertices;
+			std::vector<uint32_t> indices;
+			if (!LoadObjTriangles(file, vertices, indices))
+			{
+				continue;
+			}
+
+			auto printStage = [&](const char* stage, size_t vertexCount, double seconds)
+			{
+				const auto stats = AnalyzeVertexCache(indices.data(), indices.size(), vertexCount, cacheSize);
+				Print(std::format("  {:<10} ACMR {:.3f}  ATVR {:.3f}  {:8.3f} ms\n", stage, stats.GetAcmr(), stats.GetAtvr(), seconds * 1000.0));
+			};
+
+			Print(std::format("{}: {} triangles, cache {}\n", file, indices.size() / 3, cacheSize));
+			auto start = std::chrono::steady_clock::now();
+			const size_t vertexCount = WeldVertices(vertices.data(), vertices.size() / 8, vertexSize, indices.data(), indices.size());
+			printStage("welded", vertexCount, SecondsSince(start));
+
+			start = std::chrono::steady_clock::now();
+			std::vector<uint32_t> clusters;
+			OptimizeVertexCache(indices.data(), indices.size(), vertexCount, cacheSize, &clusters);
+			printStage("tipsify", vertexCount, SecondsSince(start));
+
+			start = std::chrono::steady_clock::now();
+			OptimizeOverdraw(indices.data(), indices.size(), vertices.data(), vertexSize, vertexCount, clusters, 1.05f, cacheSize);
+			printStage("overdraw", vertexCount, SecondsSince(start));
+
+			start = std::chrono::steady_clock::now();
+			const size_t fetchedCount = OptimizeVertexFetch(vertices.data(), vertexCount, vertexSize, indices.data(), indices.size());
+			printStage("fetch", fetchedCount, SecondsSince(start));
+			Print(std::format("  {} vertices, {} clusters\n", fetchedCount, clusters.size()));
+		}
+		return 0;
+	}
+
+	//--------------------------------------------------------------------------------------
+	// vcache-test: 최적화 단계마다 삼각형이 그대로 남는지와 캐시 효율이 나아지는지 검사한다.
+	// 격자 메쉬를 섞은 것과 인자로 받은 OBJ 파일을 쓴다.
+	//--------------------------------------------------------------------------------------
+
+	// 버텍스 데이터로 본 삼각형 목록. 감는 방향은 지키고 시작 꼭짓점만 맞춘 뒤 정렬한다.
+	std::vector<std::vector<float>> CanonicalTriangles(const std::vector<float>& vertices, const std::vector<uint32_t>& indices)
+	{
+		std::vector<std::vector<float>> triangles;
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			std::vector<float> corners[3];
+			for (int k = 0; k < 3; k++)
+			{
+				corners[k].assign(vertices.begin() + indices[i + k] * 8, vertices.begin() + indices[i + k] * 8 + 8);
+			}
+			const int first = static_cast<int>(std::min_element(corners, corners + 3) - corners);
+			std::vector<float> triangle;
+			for (int k = 0; k < 3; k++)
+			{
+				triangle.insert(triangle.end(), corners[(first + k) % 3].begin(), corners[(first + k) % 3].end());
+			}
+			triangles.push_back(std::move(triangle));
+		}
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	}
+
+	void CheckVertexCacheStages(Checker& checker, const std::string& name, std::vector<float> vertices, std::vector<uint32_t> indices)
+	{
+		const size_t vertexSize = 8 * sizeof(float);
+		const auto original = CanonicalTriangles(vertices, indices);
+
+		const size_t vertexCount = WeldVertices(vertices.data(), vertices.size() / 8, vertexSize, indices.data(), indices.size());
+		vertices.resize(vertexCount * 8);
+		checker.Expect(CanonicalTriangles(vertices, indices) == original, name + ": weld keeps every triangle");
+		const float weldedAcmr = AnalyzeVertexCache(indices.data(), indices.size(), vertexCount).GetAcmr();
+
+		std::vector<uint32_t> clusters;
+		OptimizeVertexCache(indices.data(), indices.size(), vertexCount, VERTEX_CACHE_SIZE, &clusters);
+		checker.Expect(CanonicalTriangles(vertices, indices) == original, name + ": tipsify keeps every triangle");
+		const float tipsifyAcmr = AnalyzeVertexCache(indices.data(), indices.size(), vertexCount).GetAcmr();
+		checker.Expect(tipsifyAcmr <= weldedAcmr, std::format("{}: tipsify ACMR {:.3f} is not worse than {:.3f}", name, tipsifyAcmr, weldedAcmr));
+		checker.Expect(!clusters.empty() && clusters[0] == 0 && std::is_sorted(clusters.begin(), clusters.end()),
+			name + ": clusters start at 0 and ascend");
+
+		OptimizeOverdraw(indices.data(), indices.size(), vertices.data(), vertexSize, vertexCount, clusters, 1.05f);
+		checker.Expect(CanonicalTriangles(vertices, indices) == original, name + ": overdraw keeps every triangle");
+		const float overdrawAcmr = AnalyzeVertexCache(indices.data(), indices.size(), vertexCount).GetAcmr();
+		checker.Expect(overdrawAcmr <= tipsifyAcmr * 1.05f + 1e-4f,
+			std::format("{}: overdraw ACMR {:.3f} stays within 1.05x of {:.3f}", name, overdrawAcmr, tipsifyAcmr));
+
+		const size_t fetchedCount = OptimizeVertexFetch(vertices.data(), vertexCount, vertexSize, indices.data(), indices.size());
+		vertices.resize(fetchedCount * 8);
+		checker.Expect(CanonicalTriangles(vertices, indices) == original, name + ": fetch keeps every triangle");
+		uint32_t nextNew = 0;
+		bool firstUseOrder = true;
+		for (uint32_t index : indices)
+		{
+			firstUseOrder = firstUseOrder && index <= nextNew;
+			nextNew += index == nextNew ? 1 : 0;
+		}
+		checker.Expect(firstUseOrder && nextNew == fetchedCount, name + ": vertices are in first-use order");
+		checker.Expect(AnalyzeVertexCache(indices.data(), indices.size(), fetchedCount).GetAcmr() == overdrawAcmr,
+			name + ": fetch does not change ACMR");
+	}
+
+	int RunVertexCacheTest(const std::vector<std::string>& args)
+	{
+		Checker checker;
+
+		// 64 x 64 격자를 면마다 버텍스를 따로 만들고 삼각형 순서를 섞는다.
+		const int gridSize = 64;
+		std::vector<std::array<uint32_t, 3>> gridTriangles;
+		for (int y = 0; y < gridSize; y++)
+		{
+			for (int x = 0; x < gridSize; x++)
+			{
+				const uint32_t v = y * (gridSize + 1) + x;
+				gridTriangles.push_back({ v, v + gridSize + 1, v + 1 });
+				gridTriangles.push_back({ v + 1, v + gridSize + 1, v + gridSize + 2 });
+			}
+		}
+		std::mt19937 random(21);
+		std::shuffle(gridTriangles.begin(), gridTriangles.end(), random);
+		std::vector<float> vertices;
+		std::vector<uint32_t> indices;
+		for (const auto& triangle : gridTriangles)
+		{
+			for (uint32_t corner : triangle)
+			{
+				const float x = static_cast<float>(corner % (gridSize + 1));
+				const float z = static_cast<float>(corner / (gridSize + 1));
+				indices.push_back(static_cast<uint32_t>(vertices.size() / 8));
+				vertices.insert(vertices.end(), { x, 0.0f, z, 0.0f, 1.0f, 0.0f, x / gridSize, z / gridSize });
+			}
+		}
+		CheckVertexCacheStages(checker, "shuffled grid", vertices, indices);
+
+		// 섞은 격자는 삼각형마다 거의 새 버텍스 세 개를 변환한다. Tipsify 뒤에는 1보다 훨씬 작아야 한다.
+		std::vector<float> welded = vertices;
+		std::vector<uint32_t> optimized = indices;
+		const size_t vertexCount = WeldVertices(welded.data(), welded.size() / 8, 8 * sizeof(float), optimized.data(), optimized.size());
+		const float shuffledAcmr = AnalyzeVertexCache(optimized.data(), optimized.size(), vertexCount).GetAcmr();
+		OptimizeVertexCache(optimized.data(), optimized.size(), vertexCount);
+		const float tipsifyAcmr = AnalyzeVertexCache(optimized.data(), optimized.size(), vertexCount).GetAcmr();
+		checker.Expect(vertexCount == (gridSize + 1) * (gridSize + 1), std::format("grid welds to {} vertices", vertexCount));
+		checker.Expect(shuffledAcmr > 2.0f && tipsifyAcmr < 0.8f,
+			std::format("grid ACMR {:.3f} -> {:.3f} (expected > 2.0 -> < 0.8)", shuffledAcmr, tipsifyAcmr));
+
+		for (const auto& file : args)
+		{
+			if (LoadObjTriangles(file, vertices, indices))
+			{
+				CheckVertexCacheStages(checker, file, vertices, indices);
+			}
+			else
+			{
+				checker.Expect(false, file + " loads");
+			}
+		}
+
+		return checker.Finish("vcache-test");
+	}
+
+	//--------------------------------------------------------------------------------------
+	// simplify-test: UV 이음새가 있는 토러스를 줄여서 접은 웨지가 합쳐지는지(버텍스가 삼각형과 함께 주는지) 검사한다.
+	//--------------------------------------------------------------------------------------
+	// 위치, 노멀, UV. u와 v가 0과 1에서 만나는 두 고리가 이음새다.
+	void BuildSeamTorus(int rings, int sides, std::vector<float>& vertices, std::vector<uint32_t>& indices)
+	{
+		for (int i = 0; i <= rings; i++)
+		{
+			for (int j = 0; j <= sides; j++)
+			{
+				// 이음새 양쪽의 위치가 비트까지 같아야 한 위치로 묶인다.
+				const float u = XM_2PI * (i % rings) / rings;
+				const float v = XM_2PI * (j % sides) / sides;
+				const float radius = 1.0f + 0.35f * cosf(v);
+				vertices.insert(vertices.end(), { radius * cosf(u), radius * sinf(u), 0.35f * sinf(v),
+					cosf(v) * cosf(u), cosf(v) * sinf(u), sinf(v), static_cast<float>(i) / rings, static_cast<float>(j) / sides });
+			}
+		}
+		for (int i = 0; i < rings; i++)
+		{
+			for (int j = 0; j < sides; j++)
+			{
+				const uint32_t a = i * (sides + 1) + j;
+				const uint32_t b = a + sides + 1;
+				indices.insert(indices.end(), { a, b, b + 1, a, b + 1, a + 1 });
+			}
+		}
+	}
+
+	size_t CountPositions(const std::vector<float>& vertices)
+	{
+		std::set<std::tuple<float, float, float>> positions;
+		for (size_t i = 0; i + 2 < vertices.size(); i += 8)
+		{
+			positions.emplace(vertices[i], vertices[i + 1], vertices[i + 2]);
+		}
+		return positions.size();
+	}
+
+	int RunSimplifyTest(const std::vector<std::string>&)
+	{
+		Checker checker;
+		std::vector<float> vertices;
+		std::vector<uint32_t> indices;
+		BuildSeamTorus(60, 60, vertices, indices);
+		const float attributeWeights[] = { 1.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+		const auto lods = BuildMeshLods(vertices.data(), vertices.size() / 8, 5, attributeWeights, indices.data(), indices.size(), 4);
+		checker.Expect(lods.size() == 4, std::format("{} of 4 LODs built", lods.size()));
+
+		size_t previousTriangles = indices.size() / 3;
+		float previousError = 0.0f;
+		for (size_t lod = 0; lod < lods.size(); lod++)
+		{
+			const auto& mesh = lods[lod];
+			const size_t triangles = mesh.Indices.size() / 3;
+			const size_t vertexCount = mesh.Vertices.size() / 8;
+			const size_t positions = CountPositions(mesh.Vertices);
+			Print(std::format("  LOD{}: {} triangles, {} vertices on {} positions, error {:.5f}\n", lod + 1, triangles, vertexCount, positions, mesh.Error));
+			checker.Expect(triangles <= previousTriangles * (1.0f - MIN_LOD_REDUCTION), std::format("LOD{} has fewer triangles", lod + 1));
+			checker.Expect(mesh.Error >= previousError, std::format("LOD{} error does not shrink", lod + 1));
+			// 닫힌 토러스는 오일러 표수가 0이라 위치 수가 삼각형의 절반이다. (다양체가 유지되는지)
+			checker.Expect(positions * 2 == triangles, std::format("LOD{}: {} positions for {} triangles of a closed torus", lod + 1, positions, triangles));
+			// 이음새 두 고리에서만 위치가 둘로 나뉜다. 웨지를 합치지 않으면 위치마다 버텍스가 여럿 남는다.
+			checker.Expect(vertexCount <= positions * 5 / 4, std::format("LOD{}: {} vertices on {} positions", lod + 1, vertexCount, positions));
+			previousTriangles = triangles;
+			previousError = mesh.Error;
+		}
+
+		return checker.Finish("simplify-test");
+	}
+
+	//--------------------------------------------------------------------------------------
+	// drawqueue-test: 기수 정렬을 std::stable_sort와 비교하고, 불투명/반투명 키가 그리는 순서를 검사한다.
+	//--------------------------------------------------------------------------------------
+	bool SortsLikeStableSort(DrawQueue& queue)
+	{
+		std::vector<DrawQueueEntry> expected = queue.GetEntries();
+		std::stable_sort(expected.begin(), expected.end(), [](const DrawQueueEntry& a, const DrawQueueEntry& b) { return a.Key < b.Key; });
+		queue.Sort();
+		const auto& entries = queue.GetEntries();
+		return std::equal(entries.begin(), entries.end(), expected.begin(), expected.end(),
+			[](const DrawQueueEntry& a, const DrawQueueEntry& b) { return a.Key == b.Key && a.Index == b.Index; });
+	}
+
+	int RunDrawQueueTest(const std::vector<std::string>&)
+	{
+		Checker checker;
+		std::mt19937_64 random(41);
+		DrawQueue queue;
+
+		// 무작위 키. 같은 키도 섞어서 안정 정렬인지 본다.
+		for (size_t count : { 2u, 3u, 255u, 1000u, 20000u })
+		{
+			queue.Clear();
+			for (uint32_t i = 0; i < count; i++)
+			{
+				queue.Add(i % 7 == 0 && i > 0 ? queue.GetEntries()[random() % i].Key : random(), i);
+			}
+			checker.Expect(SortsLikeStableSort(queue), std::format("{} random keys sort like std::stable_sort", count));
+		}
+
+		// 한 바이트만 다른 키는 그 바이트 한 패스만 돈다.
+		const uint64_t base = random();
+		for (unsigned byte = 0; byte < 8; byte++)
+		{
+			queue.Clear();
+			for (uint32_t i = 0; i < 5000; i++)
+			{
+				queue.Add((base & ~(0xFFull << (byte * 8))) | ((random() & 0xFF) << (byte * 8)), i);
+			}
+			checker.Expect(SortsLikeStableSort(queue), std::format("keys differing only in byte {} sort like std::stable_sort", byte));
+			checker.Expect(queue.GetLastSortPasses() == 1, std::format("keys differing only in byte {} take 1 pass ({})", byte, queue.GetLastSortPasses()));
+		}
+
+		queue.Clear();
+		for (uint32_t i = 0; i < 100; i++)
+		{
+			queue.Add(base, i);
+		}
+		checker.Expect(SortsLikeStableSort(queue) && queue.GetLastSortPasses() == 0, "identical keys keep their order with no passes");
+
+		// 불투명(패스 0)과 반투명(패스 1)을 섞어 넣는다.
+		struct Draw
+		{
+			uint32_t Pass, Pipeline, Material, Mesh;
+			float Depth;
+		};
+		std::vector<Draw> draws(4000);
+		std::uniform_real_distribution<float> depth(0.1f, 1000.0f);
+		queue.Clear();
+		for (uint32_t i = 0; i < draws.size(); i++)
+		{
+			auto& draw = draws[i];
+			draw = { static_cast<uint32_t>(random() % 2), static_cast<uint32_t>(random() % 4), static_cast<uint32_t>(random() % 12),
+				static_cast<uint32_t>(random() % 6), depth(random) };
+			queue.Add(draw.Pass == 0 ? DrawSortKey::MakeFrontToBack(draw.Pass, draw.Pipeline, draw.Material, draw.Mesh, draw.Depth)
+				: DrawSortKey::MakeBackToFront(draw.Pass, draw.Pipeline, draw.Material, draw.Mesh, draw.Depth), i);
+		}
+		queue.Sort();
+
+		const auto& entries = queue.GetEntries();
+		int passOrder = 0;
+		int opaqueRegroups = 0;
+		int opaqueDepthOrder = 0;
+		int transparentDepthOrder = 0;
+		std::set<std::tuple<uint32_t, uint32_t>> closedGroups;
+		for (size_t i = 1; i < entries.size(); i++)
+		{
+			const Draw& previous = draws[entries[i - 1].Index];
+			const Draw& current = draws[entries[i].Index];
+			passOrder += current.Pass < previous.Pass ? 1 : 0;
+			if (current.Pass != previous.Pass)
+			{
+				continue;
+			}
+			if (current.Pass == 0)
+			{
+				// PSO 구간 안에 재질 구간이 한 번씩만 나와야 한다. (PSO, 재질)이 끝났다가 다시 나오면 묶이지 않은 것
+				const auto previousGroup = std::make_tuple(previous.Pipeline, previous.Material);
+				const auto currentGroup = std::make_tuple(current.Pipeline, current.Material);
+				if (previousGroup != currentGroup)
+				{
+					closedGroups.insert(previousGroup);
+					opaqueRegroups += closedGroups.count(currentGroup) ? 1 : 0;
+				}
+				// 같은 PSO/재질/메쉬 안에서는 가까운 것부터 (키에 들어간 깊이 정밀도로)
+				else if (current.Mesh == previous.Mesh && DrawSortKey::QuantizeDepth(current.Depth) < DrawSortKey::QuantizeDepth(previous.Depth))
+				{
+					opaqueDepthOrder++;
+				}
+			}
+			else
+			{
+				transparentDepthOrder += DrawSortKey::QuantizeDepth(current.Depth) > DrawSortKey::QuantizeDepth(previous.Depth) ? 1 : 0;
+			}
+		}
+		checker.Expect(passOrder == 0, std::format("{} draws come before an earlier pass", passOrder));
+		checker.Expect(opaqueRegroups == 0, std::format("opaque draws group by PSO then material ({} groups split)", opaqueRegroups));
+		checker.Expect(opaqueDepthOrder == 0, std::format("{} opaque draws of one PSO/material/mesh are not front to back", opaqueDepthOrder));
+		checker.Expect(transparentDepthOrder == 0, std::format("{} transparent draws are not back to front", transparentDepthOrder));
+
+		return checker.Finish("drawqueue-test");
+	}
+
+	//--------------------------------------------------------------------------------------
+	// registry-test: ResourceRegistry 세대 핸들. 지운 뒤 옛 핸들, 자리 재사용, 다시 넣은 이름 찾기, ForEach
+	//--------------------------------------------------------------------------------------
+	int RunRegistryTest(const std::vector<std::string>&)
+	{
+		Checker checker;
+		ResourceRegistry<int> registry;
+		using Handle = ResourceRegistry<int>::Handle;
+
+		const Handle grass = registry.Add("grass.dds", 1);
+		const Handle fence = registry.Add("WireFence.dds", 2);
+		const Handle water = registry.Add("water.dds", 3);
+		checker.Expect(registry.GetCount() == 3 && registry.IsValid(grass) && registry.IsValid(fence) && registry.IsValid(water), "three entries are valid");
+		checker.Expect(registry.Intern("WireFence.dds") == fence && registry.Find("WireFence.dds") == fence, "Intern and Find return the existing handle");
+		checker.Expect(registry.Add("water.dds", 4) == water && registry[water] == 4, "Add with an existing name replaces the value");
+		checker.Expect(!registry.Find("missing.dds").IsValid() && !registry.IsValid(Handle()), "unknown names and default handles are invalid");
+
+		// 지운 핸들은 자리를 다시 써도 옛 핸들로 찾을 수 없다.
+		registry.Remove(fence);
+		checker.Expect(!registry.IsValid(fence) && registry.Get(fence) == nullptr, "a removed handle is stale");
+		checker.Expect(!registry.Find("WireFence.dds").IsValid() && registry.GetCount() == 2, "a removed name is not found");
+		registry.Remove(fence);
+		checker.Expect(registry.GetCount() == 2, "removing a stale handle does nothing");
+
+		const Handle bricks = registry.Add("bricks.dds", 5);
+		checker.Expect(bricks.Index == fence.Index && bricks.Generation != fence.Generation, "the freed slot is reused with a new generation");
+		checker.Expect(!registry.IsValid(fence) && registry.Get(fence) == nullptr, "the stale handle stays invalid after reuse");
+		checker.Expect(registry.IsValid(bricks) && registry[bricks] == 5 && registry.GetName(bricks) == "bricks.dds", "the new handle reads the new entry");
+
+		// 지웠던 이름을 다시 넣으면 Find가 새 핸들을 준다.
+		const Handle fenceAgain = registry.Intern("WireFence.dds");
+		checker.Expect(registry.Find("WireFence.dds") == fenceAgain && fenceAgain != fence, "Find returns the re-inserted handle");
+		checker.Expect(registry[fenceAgain] == 0, "a re-inserted name starts from the default value");
+
+		// ForEach는 빈 자리를 건너뛰고 배열 순서로 돈다.
+		registry.Remove(grass);
+		std::vector<std::string> visited;
+		bool handlesMatch = true;
+		registry.ForEach([&](Handle handle, int& value)
+			{
+				visited.push_back(registry.GetName(handle));
+				handlesMatch &= registry.IsValid(handle) && &registry[handle] == &value;
+			});
+		const std::vector<std::string> expected = { "bricks.dds", "water.dds", "WireFence.dds" };
+		checker.Expect(visited == expected, std::format("ForEach visits {} live entries in slot order", visited.size()));
+		checker.Expect(handlesMatch, "ForEach passes valid handles for the values it visits");
+
+		// 여러 번 지우고 다시 넣어도 옛 핸들은 하나도 살아나지 않는다.
+		std::vector<Handle> stale;
+		std::mt19937 random(44);
+		std::vector<Handle> live;
+		for (int i = 0; i < 2000; i++)
+		{
+			if (!live.empty() && random() % 2)
+			{
+				const size_t pick = random() % live.size();
+				registry.Remove(live[pick]);
+				stale.push_back(live[pick]);
+				live.erase(live.begin() + pick);
+			}
+			else
+			{
+				live.push_back(registry.Add(std::format("texture{}", i), i));
+			}
+		}
+		const bool staleInvalid = std::none_of(stale.begin(), stale.end(), [&](Handle handle) { return registry.IsValid(handle); });
+		const bool liveValid = std::all_of(live.begin(), live.end(), [&](Handle handle) { return registry.IsValid(handle); });
+		checker.Expect(staleInvalid && liveValid, std::format("{} stale handles stay invalid and {} live handles stay valid", stale.size(), live.size()));
+		checker.Expect(registry.GetCount() == live.size() + 3, "GetCount follows adds and removes");
+
+		return checker.Finish("registry-test");
+	}
+
+	//--------------------------------------------------------------------------------------
+	// allocator-test: RangeAllocator 할당/해제/합치기와 ResourceHeapAllocator 4KB 정렬, 블록 놓기
+	//--------------------------------------------------------------------------------------
+	void CheckRangeAllocator(Checker& checker)
+	{
+		RangeAllocator ranges;
+		ranges.Reset(1000);
+		const uint64_t a = ranges.Allocate(100);
+		const uint64_t b = ranges.Allocate(100);
+		const uint64_t c = ranges.Allocate(100);
+		checker.Expect(a == 0 && b == 100 && c == 200 && ranges.GetUsed() == 300, "first-fit allocates from the front");
+		checker.Expect(ranges.Allocate(701) == RangeAllocator::INVALID_OFFSET && ranges.Allocate(0) == RangeAllocator::INVALID_OFFSET,
+			"a range larger than the free space and a zero size fail");
+
+		// 가운데를 놓으면 빈 구간이 둘, 앞을 놓으면 가운데와 합쳐지고, 마지막을 놓으면 하나로 돌아간다.
+		ranges.Free(b, 100);
+		checker.Expect(ranges.GetFreeRangeCount() == 2 && ranges.GetLargestFreeRange() == 700, "freeing the middle leaves two free ranges");
+		ranges.Free(a, 100);
+		checker.Expect(ranges.GetFreeRangeCount() == 2 && ranges.GetLargestFreeRange() == 700 && ranges.Allocate(200) == 0,
+			"freeing the front coalesces with the next free range");
+		ranges.Free(0, 200);
+		ranges.Free(c, 100);
+		checker.Expect(ranges.GetFreeRangeCount() == 1 && ranges.GetLargestFreeRange() == 1000 && ranges.IsEmpty(),
+			"freeing the last range coalesces with both neighbours");
+
+		// 정렬 때문에 앞에 남은 부분은 빈 구간으로 남고, 다음 작은 할당이 그 틈을 쓴다.
+		ranges.Reset(1024);
+		const uint64_t unaligned = ranges.Allocate(10);
+		const uint64_t aligned = ranges.Allocate(16, 64);
+		checker.Expect(unaligned == 0 && aligned == 64 && ranges.GetFreeRangeCount() == 2 && ranges.GetUsed() == 26,
+			"alignment padding stays free");
+		checker.Expect(ranges.Allocate(20) == 10, "first-fit reuses the alignment gap");
+		checker.Expect(ranges.Allocate(8, 512) == 512, "a larger alignment skips to the next aligned offset");
+
+		// 섞어서 잡고 놓아도 다 놓으면 처음 한 구간으로 돌아간다.
+		std::mt19937 random(36);
+		std::vector<std::pair<uint64_t, uint64_t>> live;
+		ranges.Reset(1 << 20);
+		int overlaps = 0;
+		for (int i = 0; i < 4000; i++)
+		{
+			if (!live.empty() && random() % 3 == 0)
+			{
+				const size_t pick = random() % live.size();
+				ranges.Free(live[pick].first, live[pick].second);
+				live.erase(live.begin() + pick);
+				continue;
+			}
+			const uint64_t size = 1 + random() % 3000;
+			const uint64_t alignment = 1ull << (random() % 9);
+			const uint64_t offset = ranges.Allocate(size, alignment);
+			if (offset == RangeAllocator::INVALID_OFFSET)
+			{
+				continue;
+			}
+			overlaps += offset % alignment != 0 ? 1 : 0;
+			for (const auto& other : live)
+			{
+				overlaps += offset < other.first + other.second && other.first < offset + size ? 1 : 0;
+			}
+			live.emplace_back(offset, size);
+		}
+		checker.Expect(overlaps == 0, std::format("{} random allocations overlap or are misaligned", overlaps));
+		for (const auto& range : live)
+		{
+			ranges.Free(range.first, range.second);
+		}
+		checker.Expect(ranges.IsEmpty() && ranges.GetFreeRangeCount() == 1 && ranges.GetLargestFreeRange() == 1 << 20,
+			"freeing every random allocation coalesces back to one range");
+	}
+
+	// 힙을 세기만 하는 가짜 ID3D12Heap
+	class FakeHeap final : public ID3D12Heap
+	{
+	public:
+		FakeHeap(const D3D12_HEAP_DESC& desc, int& liveHeaps) : mDesc(desc), mLiveHeaps(liveHeaps) { mLiveHeaps++; }
+		~FakeHeap() { mLiveHeaps--; }
+
+		HRESULT STDMETHODCALLTYPE QueryInterface(REFIID, void** object) override { *object = nullptr; return E_NOINTERFACE; }
+		ULONG STDMETHODCALLTYPE AddRef() override { return ++mRefCount; }
+		ULONG STDMETHODCALLTYPE Release() override
+		{
+			const ULONG count = --mRefCount;
+			if (!count)
+			{
+				delete this;
+			}
+			return count;
+		}
+		HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID, UINT*, void*) override { return E_NOTIMPL; }
+		HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID, UINT, const void*) override { return E_NOTIMPL; }
+		HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID, const IUnknown*) override { return E_NOTIMPL; }
+		HRESULT STDMETHODCALLTYPE SetName(LPCWSTR) override { return E_NOTIMPL; }
+		HRESULT STDMETHODCALLTYPE GetDevice(REFIID, void** device) override { *device = nullptr; return E_NOTIMPL; }
+		D3D12_HEAP_DESC STDMETHODCALLTYPE GetDesc() override { return mDesc; }
+
+	private:
+		D3D12_HEAP_DESC mDesc;
+		int& mLiveHeaps;
+		ULONG mRefCount = 1;
+	};
+
+	// ResourceHeapAllocator가 부르는 것만 흉내 내는 가짜 장치
+	// GetResourceAllocationInfo: RGBA8 한 밉으로 크기를 셈. 64KB 안에 드는 일반 텍스쳐만 4KB 정렬을 받아 주고 나머지는 64KB
+	// CreatePlacedResource: 리소스는 만들지 않고(nullptr) 놓인 자리와 desc만 기록한다.
+	class FakeHeapDevice final : public ID3D12Device
+	{
+	public:
+		struct Placement
+		{
+			ID3D12Heap* Heap;
+			UINT64 Offset;
+			D3D12_RESOURCE_DESC Desc;
+		};
+
+		int LiveHeaps = 0;
+		std::vector<D3D12_HEAP_DESC> HeapDescs;
+		std::vector<UINT64> QueriedAlignments;
+		std::vector<Placement> Placements;
+
+		D3D12_RESOURCE_ALLOCATION_INFO STDMETHODCALLTYPE GetResourceAllocationInfo(UINT, UINT, const D3D12_RESOURCE_DESC* descs) override
+		{
+			const D3D12_RESOURCE_DESC& desc = descs[0];
+			QueriedAlignments.push_back(desc.Alignment);
+			const UINT64 bytes = desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER ? desc.Width : desc.Width * desc.Height * 4;
+			const bool renderTarget = (desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)) != 0;
+			const UINT64 alignment = desc.Alignment == D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT && !renderTarget
+				&& bytes <= D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT ? D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT : D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+			return { (bytes + alignment - 1) & ~(alignment - 1), alignment };
+		}
+
+		HRESULT STDMETHODCALLTYPE CreateHeap(const D3D12_HEAP_DESC* desc, REFIID, void** heap) override
+		{
+			HeapDescs.push_back(*desc);
+			*heap = static_cast<ID3D12Heap*>(new FakeHeap(*desc, LiveHeaps));
+			return S_OK;
+		}
+
+		HRESULT STDMETHODCALLTYPE CreatePlacedResource(ID3D12Heap* heap, UINT64 offset, const D3D12_RESOURCE_DESC* desc,
+			D3D12_RESOURCE_STATES, const D3D12_CLEAR_VALUE*, REFIID, void** resource) override
+		{
+			Placements.push_back({ heap, offset, *desc });
+			*resource = nullptr;
+			return S_OK;
+		}
+
+		HRESULT STDMETHODCALLTYPE QueryInterface(REFIID, void** object) override { *object = nullptr; return E_NOINTERFACE; }
+		ULONG STDMETHODCALLTYPE AddRef() override { return 1; }
+		ULONG STDMETHODCALLTYPE Release() override { return 1; }
+		HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID, UINT*, void*) override { return E_NOTIMPL; }
+		HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID, UINT, const void*) override { return E_NOTIMPL; }
+		HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID, const IUnknown*) override { return E_NOTIMPL; }
+		HRESULT STDMETHODCALLTYPE SetName(LPCWSTR) override { return E_NOTIMPL; }
+		UINT STDMETHODCALLTYPE GetNodeCount() override { return 1; }
+		HRESULT STDMETHODCALLTYPE CreateCommandQueue(const D3D12_COMMAND_QUEUE_DESC*, REFIID, void**) override { return E_NOTIMPL; }
+		HRESULT STDMETHODCALLTYPE CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE, REFIID, void**) override { return E_NOTIMPL; }
+		HRESULT STDMETHODCALLTYPE CreateGraphicsPipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC*, REFIID, void**) override { return E_NOTIMPL; }
+		HRESULT STDMETHODCALLTYPE CreateComputePipelineState(const D3D12_COMPUTE_PIPELINE_STATE_DESC*, REFIID, void**) override { return E_NOTIMPL; }
+		HRESULT STDMETHODCALLTYPE CreateCommandList(UINT, D3D12_COMMAND_LIST_TYPE, ID3D12CommandAllocator*, ID3D12PipelineState*, REFIID, void**) override { return E_NOTIMPL; }
+		HRESULT STDMETHODCALLTYPE CheckFeatureSupport(D3D12_FEATURE, void*, UINT) override { return E_NOTIMPL; }
+		HRESULT STDMETHODCALLTYPE CreateDescriptorHeap(const D3D12_DESCRIPTOR_HEAP_DESC*, REFIID, void**) override { return E_NOTIMPL; }
+		UINT STDMETHODCALLTYPE GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE) override { return 0; }
+		HRESULT STDMETHODCALLTYPE CreateRootSignature(UINT, const void*, SIZE_T, REFIID, void**) override { return E_NOTIMPL; }
+		void STDMETHODCALLTYPE CreateConstantBufferView(const D3D12_CONSTANT_BUFFER_VIEW_DESC*, D3D12_CPU_DESCRIPTOR_HANDLE) override {}
+		void STDMETHODCALLTYPE CreateShaderResourceView(ID3D12Resource*, const D3D12_SHADER_RESOURCE_VIEW_DESC*, D3D12_CPU_DESCRIPTOR_HANDLE) override {}
+		void STDMETHODCALLTYPE CreateUnorderedAccessView(ID3D12Resource*, ID3D12Resource*, const D3D12_UNORDERED_ACCESS_VIEW_DESC*, D3D12_CPU_DESCRIPTOR_HANDLE) override {}
+		void STDMETHODCALLTYPE CreateRenderTargetView(ID3D12Resource*, const D3D12_RENDER_TARGET_VIEW_DESC*, D3D12_CPU_DESCRIPTOR_HANDLE) override {}
+		void STDMETHODCALLTYPE CreateDepthStencilView(ID3D12Resource*, const D3D12_DEPTH_STENCIL_VIEW_DESC*, D3D12_CPU_DESCRIPTOR_HANDLE) override {}
+		void STDMETHODCALLTYPE CreateSampler(const D3D12_SAMPLER_DESC*, D3D12_CPU_DESCRIPTOR_HANDLE) override {}
+		void STDMETHODCALLTYPE CopyDescriptors(UINT, const D3D12_CPU_DESCRIPTOR_HANDLE*, const UINT*, UINT, const D3D12_CPU_DESCRIPTOR_HANDLE*, const UINT*, D3D12_DESCRIPTOR_HEAP_TYPE) override {}
+		void STDMETHODCALLTYPE CopyDescriptorsSimple(UINT, D3D12_CPU_DESCRIPTOR_HANDLE, D3D12_CPU_DESCRIPTOR_HANDLE, D3D12_DESCRIPTOR_HEAP_TYPE) override {}
+		D3D12_HEAP_PROPERTIES STDMETHODCALLTYPE GetCustomHeapProperties(UINT, D3D12_HEAP_TYPE) override { return {}; }
+		HRESULT STDMETHODCALLTYPE CreateCommittedResource(const D3D12_HEAP_PROPERTIES*, D3D12_HEAP_FLAGS, const D3D12_RESOURCE_DESC*, D3D12_RESOURCE_STATES, const D3D12_CLEAR_VALUE*, REFIID, void**) override { return E_NOTIMPL; }
+		HRESULT STDMETHODCALLTYPE CreateReservedResource(const D3D12_RESOURCE_DESC*, D3D12_RESOURCE_STATES, const D3D12_CLEAR_VALUE*, REFIID, void**) override { return E_NOTIMPL; }
+		HRESULT STDMETHODCALLTYPE CreateSharedHandle(ID3D12DeviceChild*, const SECURITY_ATTRIBUTES*, DWORD, LPCWSTR, HANDLE*) override { return E_NOTIMPL; }
+		HRESULT STDMETHODCALLTYPE OpenSharedHandle(HANDLE, REFIID, void**) override { return E_NOTIMPL; }
+		HRESULT STDMETHODCALLTYPE OpenSharedHandleByName(LPCWSTR, DWORD, HANDLE*) override { return E_NOTIMPL; }
+		HRESULT STDMETHODCALLTYPE MakeResident(UINT, ID3D12Pageable* const*) override { return E_NOTIMPL; }
+		HRESULT STDMETHODCALLTYPE Evict(UINT, ID3D12Pageable* const*) override { return E_NOTIMPL; }
+		HRESULT STDMETHODCALLTYPE CreateFence(UINT64, D3D12_FENCE_FLAGS, REFIID, void**) override { return E_NOTIMPL; }
+		HRESULT STDMETHODCALLTYPE GetDeviceRemovedReason() override { return S_OK; }
+		void STDMETHODCALLTYPE GetCopyableFootprints(const D3D12_RESOURCE_DESC*, UINT, UINT, UINT64, D3D12_PLACED_SUBRESOURCE_FOOTPRINT*, UINT*, UINT64*, UINT64*) override {}
+		HRESULT STDMETHODCALLTYPE CreateQueryHeap(const D3D12_QUERY_HEAP_DESC*, REFIID, void**) override { return E_NOTIMPL; }
+		HRESULT STDMETHODCALLTYPE SetStablePowerState(BOOL) override { return E_NOTIMPL; }
+		HRESULT STDMETHODCALLTYPE CreateCommandSignature(const D3D12_COMMAND_SIGNATURE_DESC*, ID3D12RootSignature*, REFIID, void**) override { return E_NOTIMPL; }
+		void STDMETHODCALLTYPE GetResourceTiling(ID3D12Resource*, UINT*, D3D12_PACKED_MIP_INFO*, D3D12_TILE_SHAPE*, UINT*, UINT, D3D12_SUBRESOURCE_TILING*) override {}
+		LUID STDMETHODCALLTYPE GetAdapterLuid() override { return {}; }
+	};
+
+	D3D12_RESOURCE_DESC MakeTextureDesc(UINT64 width, UINT height, D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_NONE, UINT sampleCount = 1)
+	{
+		D3D12_RESOURCE_DESC desc = {};
+		desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+		desc.Width = width;
+		desc.Height = height;
+		desc.DepthOrArraySize = 1;
+		desc.MipLevels = 1;
+		desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		desc.SampleDesc.Count = sampleCount;
+		desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+		desc.Flags = flags;
+		return desc;
+	}
+
+	D3D12_RESOURCE_DESC MakeBufferDesc(UINT64 bytes)
+	{
+		D3D12_RESOURCE_DESC desc = {};
+		desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+		desc.Width = bytes;
+		desc.Height = 1;
+		desc.DepthOrArraySize = 1;
+		desc.MipLevels = 1;
+		desc.SampleDesc.Count = 1;
+		desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+		return desc;
+	}
+
+	void CheckSmallTextureAlignment(Checker& checker)
+	{
+		const UINT64 KB = 1024;
+		FakeHeapDevice device;
+		ResourceHeapAllocator allocator;
+		allocator.Initialize(&device, 1024 * KB);
+
+		// 64KB 안에 드는 텍스쳐는 4KB 정렬을 한 번 묻고 그대로 쓴다.
+		D3D12_RESOURCE_DESC small = MakeTextureDesc(64, 64);
+		D3D12_RESOURCE_ALLOCATION_INFO info = allocator.GetAllocationInfo(small);
+		checker.Expect(info.Alignment == 4 * KB && info.SizeInBytes == 16 * KB && small.Alignment == 4 * KB,
+			"a 16KB texture gets 4KB alignment");
+		checker.Expect(device.QueriedAlignments == std::vector<UINT64>{ 4 * KB }, "the small texture is queried once");
+
+		// 장치가 4KB를 거절하면 Alignment를 0으로 되돌리고 다시 묻는다.
+		device.QueriedAlignments.clear();
+		D3D12_RESOURCE_DESC large = MakeTextureDesc(256, 256);
+		info = allocator.GetAllocationInfo(large);
+		checker.Expect(info.Alignment == 64 * KB && info.SizeInBytes == 256 * KB && large.Alignment == 0,
+			"a 256KB texture falls back to 64KB alignment with desc.Alignment reset to 0");
+		checker.Expect(device.QueriedAlignments == std::vector<UINT64>{ 4 * KB, 0 }, "the fallback asks again with the default alignment");
+
+		// 렌더 타겟, MSAA, 버퍼는 4KB를 시도하지 않는다.
+		device.QueriedAlignments.clear();
+		D3D12_RESOURCE_DESC renderTarget = MakeTextureDesc(64, 64, D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
+		D3D12_RESOURCE_DESC multisampled = MakeTextureDesc(32, 32, D3D12_RESOURCE_FLAG_NONE, 4);
+		D3D12_RESOURCE_DESC buffer = MakeBufferDesc(1000);
+		allocator.GetAllocationInfo(renderTarget);
+		allocator.GetAllocationInfo(multisampled);
+		info = allocator.GetAllocationInfo(buffer);
+		checker.Expect(device.QueriedAlignments == std::vector<UINT64>{ 0, 0, 0 } && info.Alignment == 64 * KB,
+			"render targets, MSAA textures and buffers use the default alignment");
+
+		// CreatePlacedResource에는 정렬이 정해진 desc가 가고, 작은 텍스쳐는 4KB 간격으로 붙는다.
+		Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+		HeapAllocation first, second, third;
+		checker.Expect(SUCCEEDED(allocator.CreateResource(MakeTextureDesc(64, 64), D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COMMON, nullptr, resource, first))
+			&& SUCCEEDED(allocator.CreateResource(MakeTextureDesc(16, 16), D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COMMON, nullptr, resource, second))
+			&& SUCCEEDED(allocator.CreateResource(MakeTextureDesc(256, 256), D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COMMON, nullptr, resource, third)),
+			"three textures are placed");
+		checker.Expect(device.Placements.size() == 3 && first.Heap == second.Heap && second.Heap == third.Heap, "the textures share one heap");
+		if (device.Placements.size() == 3)
+		{
+			checker.Expect(device.Placements[0].Offset == 0 && device.Placements[1].Offset == 16 * KB && device.Placements[2].Offset == 64 * KB,
+				std::format("small textures pack at 4KB and the large one starts at 64KB ({}, {}, {})",
+					device.Placements[0].Offset, device.Placements[1].Offset, device.Placements[2].Offset));
+			checker.Expect(device.Placements[0].Desc.Alignment == 4 * KB && device.Placements[1].Desc.Alignment == 4 * KB && device.Placements[2].Desc.Alignment == 0,
+				"placed descs carry 4KB alignment only for small textures");
+		}
+		checker.Expect(device.HeapDescs.size() == 1 && device.HeapDescs[0].Flags == D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES,
+			"textures go to a non-RT/DS texture heap");
+		allocator.Free(first);
+		allocator.Free(second);
+		allocator.Free(third);
+	}
+
+	void CheckHeapBlockRelease(Checker& checker)
+	{
+		const UINT64 KB = 1024;
+		const UINT64 blockSize = 1024 * KB;
+		FakeHeapDevice device;
+		ResourceHeapAllocator allocator;
+		allocator.Initialize(&device, blockSize);
+		Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+		auto create = [&](UINT64 bytes, HeapAllocation& allocation)
+		{
+			return SUCCEEDED(allocator.CreateResource(MakeBufferDesc(bytes), D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, resource, allocation));
+		};
+
+		// 블록보다 큰 버퍼는 딱 맞는 블록을 따로 만들고, 비면 마지막 블록이어도 놓는다.
+		HeapAllocation oversized;
+		checker.Expect(create(3 * blockSize, oversized) && device.HeapDescs.size() == 1 && device.HeapDescs[0].SizeInBytes == 3 * blockSize,
+			"an oversized buffer gets its own block of its size");
+		checker.Expect(device.HeapDescs.size() == 1 && device.HeapDescs[0].Flags == D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS
+			&& device.HeapDescs[0].Properties.Type == D3D12_HEAP_TYPE_UPLOAD, "buffers go to a buffer-only upload heap");
+		allocator.Free(oversized);
+		checker.Expect(device.LiveHeaps == 0 && allocator.GetStats().Pools[0].BlockCount == 0 && !oversized.IsValid(),
+			"an empty oversized block is released");
+
+		// 블록 둘을 채운 뒤 두 번째를 비우면 놓고, 첫 번째는 마지막 블록이라 남긴다.
+		HeapAllocation a, b, c, d;
+		checker.Expect(create(256 * KB, a) && create(256 * KB, b) && create(512 * KB, c) && create(512 * KB, d), "four buffers are placed");
+		checker.Expect(device.LiveHeaps == 2 && a.Heap == b.Heap && b.Heap == c.Heap && d.Heap != c.Heap && a.BlockIndex == 0 && d.BlockIndex == 1,
+			"the fourth buffer opens a second block and the released slot is reused");
+		allocator.Free(d);
+		checker.Expect(device.LiveHeaps == 1 && allocator.GetStats().Pools[0].BlockCount == 1, "an empty block is released while another block is live");
+
+		// 같은 블록 안에서 이웃한 구간을 놓으면 합쳐져서 더 큰 할당이 새 블록 없이 들어간다.
+		allocator.Free(b);
+		allocator.Free(a);
+		ResourceHeapPoolStats stats = allocator.GetStats().Pools[0];
+		checker.Expect(stats.FreeRangeCount == 1 && stats.LargestFreeRange == 512 * KB && stats.UsedBytes == 512 * KB,
+			std::format("freed neighbours coalesce ({} free ranges, largest {} KB)", stats.FreeRangeCount, stats.LargestFreeRange / KB));
+		HeapAllocation e;
+		checker.Expect(create(512 * KB, e) && e.Heap == c.Heap && e.Offset == 0 && device.HeapDescs.size() == 3,
+			"a 512KB buffer fits the coalesced range without a new heap");
+
+		allocator.Free(c);
+		allocator.Free(e);
+		stats = allocator.GetStats().Pools[0];
+		checker.Expect(device.LiveHeaps == 1 && stats.BlockCount == 1 && stats.AllocationCount == 0 && stats.UsedBytes == 0 && stats.ReservedBytes == blockSize,
+			"the last empty block is kept for reuse");
+
+		// RT/DS 블록은 4MB에 맞춘다.
+		HeapAllocation depth;
+		allocator.CreateResource(MakeTextureDesc(64, 64, D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL), D3D12_HEAP_TYPE_DEFAULT,
+			D3D12_RESOURCE_STATE_DEPTH_WRITE, nullptr, resource, depth);
+		checker.Expect(device.HeapDescs.back().Flags == D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES
+			&& device.HeapDescs.back().SizeInBytes == D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT
+			&& device.HeapDescs.back().Alignment == D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT, "RT/DS blocks are 4MB aligned");
+		allocator.Free(depth);
+
+		allocator.Release();
+		checker.Expect(device.LiveHeaps == 0, "Release drops every heap");
+	}
+
+	int RunAllocatorTest(const std::vector<std::string>&)
+	{
+		Checker checker;
+		CheckRangeAllocator(checker);
+		CheckSmallTextureAlignment(checker);
+		CheckHeapBlockRelease(checker);
+		return checker.Finish("allocator-test");
+	}
+
+	//--------------------------------------------------------------------------------------
+	// memcpy-test: d3dx12.h의 MemcpyToUploadHeap/MemcpySubresource를 행마다 memcpy한 결과와 바이트 단위로 비교
+	// 정렬되지 않은 포인터, 홀수 행 간격, RowSizeInBytes < RowPitch, 행/슬라이스가 빽빽한 경우(한 번에 복사)를 섞는다.
+	//--------------------------------------------------------------------------------------
+	struct SubresourceCopyCase
+	{
+		size_t RowSize = 0;
+		UINT NumRows = 0;
+		UINT NumSlices = 0;
+		size_t DestRowPitch = 0;
+		size_t DestSlicePitch = 0;
+		size_t SrcRowPitch = 0;
+		size_t SrcSlicePitch = 0;
+		size_t DestOffset = 0;
+		size_t SrcOffset = 0;
+	};
+
+	// 행 간격과 슬라이스 간격은 양쪽이 따로 빽빽하거나(빈 곳 0) 홀수 바이트만큼 빈 곳이 있다.
+	SubresourceCopyCase MakeSubresourceCopyCase(std::mt19937& random)
+	{
+		auto padding = [&](uint32_t limit) { return random() % 2 ? 0 : 1 + 2 * (random() % limit); };
+
+		SubresourceCopyCase copyCase;
+		// 가끔 64바이트 스트리밍 루프를 여러 번 도는 긴 행
+		copyCase.RowSize = random() % 4 == 0 ? 1000 + random() % 3000 : 1 + random() % 200;
+		copyCase.NumRows = 1 + random() % 9;
+		copyCase.NumSlices = 1 + random() % 3;
+		copyCase.DestRowPitch = copyCase.RowSize + padding(18);
+		copyCase.SrcRowPitch = copyCase.RowSize + padding(18);
+		copyCase.DestSlicePitch = copyCase.DestRowPitch * copyCase.NumRows + padding(14);
+		copyCase.SrcSlicePitch = copyCase.SrcRowPitch * copyCase.NumRows + padding(14);
+		copyCase.DestOffset = random() % 16;
+		copyCase.SrcOffset = random() % 16;
+		return copyCase;
+	}
+
+	// 복사한 뒤의 대상 버퍼 전체가 행마다 memcpy한 것과 같은지. 행 사이 빈 곳은 건드리면 안 된다.
+	bool CopiesLikeMemcpy(const SubresourceCopyCase& copyCase, bool subresourceInfo, std::mt19937& random)
+	{
+		const size_t srcBytes = copyCase.SrcOffset + copyCase.SrcSlicePitch * copyCase.NumSlices;
+		const size_t destBytes = copyCase.DestOffset + copyCase.DestSlicePitch * copyCase.NumSlices + 16;
+		std::vector<BYTE> src(srcBytes);
+		for (auto& value : src)
+		{
+			value = static_cast<BYTE>(random());
+		}
+		std::vector<BYTE> expected(destBytes, 0xCD);
+		std::vector<BYTE> actual(destBytes, 0xCD);
+
+		for (UINT z = 0; z < copyCase.NumSlices; z++)
+		{
+			for (UINT y = 0; y < copyCase.NumRows; y++)
+			{
+				memcpy(expected.data() + copyCase.DestOffset + copyCase.DestSlicePitch * z + copyCase.DestRowPitch * y,
+					src.data() + copyCase.SrcOffset + copyCase.SrcSlicePitch * z + copyCase.SrcRowPitch * y, copyCase.RowSize);
+			}
+		}
+
+		const D3D12_MEMCPY_DEST dest = { actual.data() + copyCase.DestOffset, copyCase.DestRowPitch, copyCase.DestSlicePitch };
+		if (subresourceInfo)
+		{
+			const D3D12_SUBRESOURCE_INFO info = { copyCase.SrcOffset, static_cast<UINT>(copyCase.SrcRowPitch), static_cast<UINT>(copyCase.SrcSlicePitch) };
+			MemcpySubresource(&dest, src.data(), &info, copyCase.RowSize, copyCase.NumRows, copyCase.NumSlices);
+		}
+		else
+		{
+			const D3D12_SUBRESOURCE_DATA data = { src.data() + copyCase.SrcOffset, static_cast<LONG_PTR>(copyCase.SrcRowPitch),
+				static_cast<LONG_PTR>(copyCase.SrcSlicePitch) };
+			MemcpySubresource(&dest, &data, copyCase.RowSize, copyCase.NumRows, copyCase.NumSlices);
+		}
+		return actual == expected;
+	}
+
+	int RunMemcpyTest(const std::vector<std::string>&)
+	{
+		Checker checker;
+		std::mt19937 random(31);
+
+		// 대상 정렬 16가지 x 원본 정렬 16가지 x 크기 0~200 (머리/16바이트/64바이트/꼬리 경계 모두)
+		int uploadFailures = 0;
+		std::vector<BYTE> src(256 + 16);
+		for (auto& value : src)
+		{
+			value = static_cast<BYTE>(random());
+		}
+		for (size_t destOffset = 0; destOffset < 16; destOffset++)
+		{
+			for (size_t srcOffset = 0; srcOffset < 16; srcOffset++)
+			{
+				for (size_t bytes = 0; bytes <= 200; bytes++)
+				{
+					alignas(16) BYTE actual[256 + 32];
+					alignas(16) BYTE expected[256 + 32];
+					memset(actual, 0xCD, sizeof(actual));
+					memset(expected, 0xCD, sizeof(expected));
+					memcpy(expected + destOffset, src.data() + srcOffset, bytes);
+					MemcpyToUploadHeap(actual + destOffset, src.data() + srcOffset, bytes);
+					uploadFailures += memcmp(actual, expected, sizeof(actual)) != 0 ? 1 : 0;
+				}
+			}
+		}
+		MemcpyToUploadHeapFence();
+		checker.Expect(uploadFailures == 0, std::format("{} MemcpyToUploadHeap copies differ from memcpy", uploadFailures));
+
+		// 두 MemcpySubresource 오버로드 모두. 한쪽만 빽빽한 배치는 한 번에 복사하면 안 된다.
+		for (const bool subresourceInfo : { false, true })
+		{
+			int failures = 0;
+			for (int i = 0; i < 2000; i++)
+			{
+				failures += CopiesLikeMemcpy(MakeSubresourceCopyCase(random), subresourceInfo, random) ? 0 : 1;
+			}
+			checker.Expect(failures == 0, std::format("{} {} copies differ from row memcpy", failures,
+				subresourceInfo ? "D3D12_SUBRESOURCE_INFO" : "D3D12_SUBRESOURCE_DATA"));
+		}
+
+		return checker.Finish("memcpy-test");
+	}
+
+	//--------------------------------------------------------------------------------------
+	// bcdecode-test: 손으로 만든 BC1/BC7 블록을 스펙대로 계산한 텍셀과 비교하고, SIMD와 스칼라 경로가 같은지 확인
+	//--------------------------------------------------------------------------------------
+	struct BCReferenceBlock
+	{
+		const char* Name;
+		DXGI_FORMAT Format;
+		std::array<uint8_t, 16> Block;
+		std::array<uint8_t, 64> Texels;
+	};
+
+	// 끝점은 565 -> 888 비트 복제로 늘린 뒤 보간해도, 5/6비트에서 보간한 뒤 늘려도 같은 값이 나오게 골랐다.
+	const BCReferenceBlock gBCReferenceBlocks[] =
+	{
+		// color0(0x0000) <= color1(0x8418)이면 3색 모드: c0, c1, (c0 + c1) / 2, 투명한 검정. 각 행의 인덱스는 0, 1, 2, 3
+		{ "BC1 3-color", DXGI_FORMAT_BC1_UNORM,
+			{ 0x00, 0x00, 0x18, 0x84, 0xE4, 0xE4, 0xE4, 0xE4 },
+			{
+				0, 0, 0, 255,  132, 130, 198, 255,  66, 65, 99, 255,  0, 0, 0, 0,
+				0, 0, 0, 255,  132, 130, 198, 255,  66, 65, 99, 255,  0, 0, 0, 0,
+				0, 0, 0, 255,  132, 130, 198, 255,  66, 65, 99, 255,  0, 0, 0, 0,
+				0, 0, 0, 255,  132, 130, 198, 255,  66, 65, 99, 255,  0, 0, 0, 0,
+			} },
+		// 두 끝점이 같아도 3색 모드다.
+		{ "BC1 3-color (color0 == color1)", DXGI_FORMAT_BC1_UNORM,
+			{ 0x18, 0x84, 0x18, 0x84, 0xE4, 0xE4, 0xE4, 0xE4 },
+			{
+				132, 130, 198, 255,  132, 130, 198, 255,  132, 130, 198, 255,  0, 0, 0, 0,
+				132, 130, 198, 255,  132, 130, 198, 255,  132, 130, 198, 255,  0, 0, 0, 0,
+				132, 130, 198, 255,  132, 130, 198, 255,  132, 130, 198, 255,  0, 0, 0, 0,
+				132, 130, 198, 255,  132, 130, 198, 255,  132, 130, 198, 255,  0, 0, 0, 0,
+			} },
+		// color0(0xC7FF) > color1(0x0000)이면 4색 모드: c0, c1, (2c0 + c1) / 3, (c0 + 2c1) / 3. 행마다 인덱스를 돌린다.
+		{ "BC1 4-color", DXGI_FORMAT_BC1_UNORM,
+			{ 0xFF, 0xC7, 0x00, 0x00, 0xE4, 0x39, 0x4E, 0x93 },
+			{
+				198, 255, 255, 255,  0, 0, 0, 255,  132, 170, 170, 255,  66, 85, 85, 255,
+				0, 0, 0, 255,  132, 170, 170, 255,  66, 85, 85, 255,  198, 255, 255, 255,
+				132, 170, 170, 255,  66, 85, 85, 255,  198, 255, 255, 255,  0, 0, 0, 255,
+				66, 85, 85, 255,  198, 255, 255, 255,  0, 0, 0, 255,  132, 170, 170, 255,
+			} },
+		// 모드 0, 분할 1 (기준 픽셀 0, 3, 8), 끝점 RGB444 + 끝점마다 P 비트, 3비트 인덱스 (기준 픽셀은 2비트)
+		// 세 번째 기준 픽셀이 마지막 픽셀이 아니어야 그 한 비트를 덜 읽는지 드러난다.
+		// 끝점: (0,0,0)/(255,255,255), (255,8,8)/(0,247,0), (82,165,49)/(206,41,156)
+		{ "BC7 mode 0", DXGI_FORMAT_BC7_UNORM,
+			{ 0x03, 0xFE, 0xA1, 0x18, 0x1E, 0x5E, 0x05, 0x1E, 0x60, 0xD2, 0x24, 0x9A, 0xF5, 0x77, 0x39, 0xE5 },
+			{
+				0, 0, 0, 255,  36, 36, 36, 255,  72, 72, 72, 255,  147, 109, 5, 255,
+				147, 147, 147, 255,  183, 183, 183, 255,  36, 213, 1, 255,  0, 247, 0, 255,
+				134, 113, 94, 255,  189, 58, 141, 255,  72, 180, 2, 255,  108, 146, 3, 255,
+				134, 113, 94, 255,  117, 130, 79, 255,  99, 148, 64, 255,  0, 247, 0, 255,
+			} },
+		// 모드 6, RGBA7777 + P 비트(0, 1), 4비트 인덱스 0..15. 끝점 (0,254,20,254)/(255,1,201,255)
+		{ "BC7 mode 6", DXGI_FORMAT_BC7_UNORM,
+			{ 0x40, 0xC0, 0xFF, 0x0F, 0x50, 0x90, 0xFF, 0x7F, 0x11, 0x32, 0x54, 0x76, 0x98, 0xBA, 0xDC, 0xFE },
+			{
+				0, 254, 20, 254,  16, 238, 31, 254,  36, 218, 45, 254,  52, 203, 57, 254,
+				68, 187, 68, 254,  84, 171, 79, 254,  104, 151, 94, 254,  120, 135, 105, 254,
+				135, 120, 116, 255,  151, 104, 127, 255,  171, 84, 142, 255,  187, 68, 153, 255,
+				203, 52, 164, 255,  219, 37, 176, 255,  239, 17, 190, 255,  255, 1, 201, 255,
+			} },
+	};
+
+	int RunBCDecodeTest(const std::vector<std::string>&)
+	{
+		Checker checker;
+		const bool simdAvailable = IsBCDecodeSimdAvailable();
+
+		for (const auto& reference : gBCReferenceBlocks)
+		{
+			std::array<uint8_t, 64> texels = {};
+			const bool decoded = DecodeBCBlock(reference.Format, reference.Block.data(), texels.data());
+			int wrongTexels = 0;
+			for (int i = 0; i < 16; i++)
+			{
+				wrongTexels += memcmp(&texels[i * 4], &reference.Texels[i * 4], 4) != 0 ? 1 : 0;
+			}
+			checker.Expect(decoded && wrongTexels == 0, std::format("{}: {} texels differ from the reference", reference.Name, wrongTexels));
+
+			// 면 단위로 풀면 BC1은 SIMD 경로를 탄다. 둘 다 같은 텍셀이어야 한다.
+			for (const bool simd : { false, true })
+			{
+				SetBCDecodeSimdEnabled(simd);
+				std::array<uint8_t, 64> surfaceTexels = {};
+				const BCSurface surface = { reference.Block.data(), GetBCBlockBytes(reference.Format), 4, 4, surfaceTexels.data(), 16 };
+				checker.Expect(DecodeBCSurface(reference.Format, surface) && surfaceTexels == reference.Texels,
+					std::format("{}: DecodeBCSurface ({}) matches the reference", reference.Name, simd && simdAvailable ? "SIMD" : "scalar"));
+			}
+		}
+
+		// 무작위 블록에서도 SIMD와 스칼라 경로가 같게 풀어야 한다. 가장자리가 잘리는 크기로 행 간격 처리도 같이 본다.
+		const DXGI_FORMAT formats[] = { DXGI_FORMAT_BC1_UNORM, DXGI_FORMAT_BC2_UNORM, DXGI_FORMAT_BC3_UNORM, DXGI_FORMAT_BC4_UNORM,
+			DXGI_FORMAT_BC4_SNORM, DXGI_FORMAT_BC5_UNORM, DXGI_FORMAT_BC5_SNORM, DXGI_FORMAT_BC7_UNORM };
+		std::mt19937 random(29);
+		const uint32_t width = 37;
+		const uint32_t height = 23;
+		for (const DXGI_FORMAT format : formats)
+		{
+			const size_t sourceRowPitch = ((width + 3) / 4) * GetBCBlockBytes(format);
+			std::vector<uint8_t> source(sourceRowPitch * ((height + 3) / 4));
+			for (auto& value : source)
+			{
+				value = static_cast<uint8_t>(random());
+			}
+			std::vector<uint8_t> scalar(width * height * 4);
+			std::vector<uint8_t> simd(width * height * 4);
+			SetBCDecodeSimdEnabled(false);
+			const bool scalarDecoded = DecodeBCSurface(format, { source.data(), sourceRowPitch, width, height, scalar.data(), width * 4 });
+			SetBCDecodeSimdEnabled(true);
+			const bool simdDecoded = DecodeBCSurface(format, { source.data(), sourceRowPitch, width, height, simd.data(), width * 4 });
+			checker.Expect(scalarDecoded && simdDecoded && scalar == simd, std::format("DXGI format {}: SIMD and scalar decodes match", static_cast<int>(format)));
+		}
+		SetBCDecodeSimdEnabled(true);
+
+		return checker.Finish("bcdecode-test");
+	}
+
+	//--------------------------------------------------------------------------------------
+	// bcencode-test: 합성 이미지(그라디언트 + 잡음)를 압축했다가 BCDecoder로 풀어서 형식/품질마다 PSNR 하한을 확인
+	//--------------------------------------------------------------------------------------
+	// 부드러운 그라디언트 위에 작은 잡음. opaque가 아니면 알파도 그라디언트
+	std::vector<uint8_t> MakeGradientNoiseImage(uint32_t width, uint32_t height, bool opaque, uint32_t seed)
+	{
+		std::mt19937 random(seed);
+		std::vector<uint8_t> rgba(width * height * 4);
+		for (uint32_t y = 0; y < height; y++)
+		{
+			for (uint32_t x = 0; x < width; x++)
+			{
+				const int noise = static_cast<int>(random() % 17) - 8;
+				uint8_t* pixel = &rgba[(y * width + x) * 4];
+				pixel[0] = static_cast<uint8_t>(std::clamp(static_cast<int>(x * 255 / (width - 1)) + noise, 0, 255));
+				pixel[1] = static_cast<uint8_t>(std::clamp(static_cast<int>(y * 255 / (height - 1)) - noise, 0, 255));
+				pixel[2] = static_cast<uint8_t>(std::clamp(static_cast<int>((x + y) * 127 / (width + height - 2)) + 64 + noise / 2, 0, 255));
+				pixel[3] = opaque ? 255 : static_cast<uint8_t>(std::clamp(static_cast<int>((width - 1 - x + y) * 255 / (width + height - 2)) + noise, 0, 255));
+			}
+		}
+		return rgba;
+	}
+
+	double ComputePsnr(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b, int channels)
+	{
+		double squaredError = 0.0;
+		size_t count = 0;
+		for (size_t i = 0; i < a.size(); i += 4)
+		{
+			for (int c = 0; c < channels; c++)
+			{
+				const double difference = static_cast<double>(a[i + c]) - b[i + c];
+				squaredError += difference * difference;
+				count++;
+			}
+		}
+		const double mse = squaredError / count;
+		return mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : 99.0;
+	}
+
+	int RunBCEncodeTest(const std::vector<std::string>&)
+	{
+		Checker checker;
+		JobSystem jobs;
+
+		struct EncodeCase
+		{
+			const char* Name;
+			DXGI_FORMAT Format;
+			BC7Quality Quality;
+			bool Opaque;
+			// RGB, 알파 PSNR 하한(dB). 측정값보다 0.3dB쯤 낮게 잡아서 끝점 양자화의 반올림이 틀어지는 정도도 걸린다. 알파가 그대로 나오면 ComputePsnr는 99를 돌려준다.
+			double RgbFloor;
+			double AlphaFloor;
+		};
+		const EncodeCase cases[] =
+		{
+			{ "BC1", DXGI_FORMAT_BC1_UNORM, BC7Quality::Normal, true, 38.0, 99.0 },
+			{ "BC3", DXGI_FORMAT_BC3_UNORM, BC7Quality::Normal, false, 38.0, 50.3 },
+			{ "BC7 fast", DXGI_FORMAT_BC7_UNORM, BC7Quality::Fast, false, 39.2, 37.3 },
+			{ "BC7 normal", DXGI_FORMAT_BC7_UNORM, BC7Quality::Normal, false, 39.2, 43.8 },
+			{ "BC7 high", DXGI_FORMAT_BC7_UNORM, BC7Quality::High, false, 39.2, 44.5 },
+			{ "BC7 normal opaque", DXGI_FORMAT_BC7_UNORM, BC7Quality::Normal, true, 44.1, 99.0 },
+		};
+
+		// 블록 경계에 걸치지 않는 가장자리도 채우는지 보려고 4의 배수가 아닌 크기
+		const uint32_t width = 94;
+		const uint32_t height = 62;
+		const uint32_t blocksWide = (width + 3) / 4;
+		const uint32_t blocksHigh = (height + 3) / 4;
+		for (const auto& encodeCase : cases)
+		{
+			const std::vector<uint8_t> source = MakeGradientNoiseImage(width, height, encodeCase.Opaque, 30);
+			const size_t blockBytes = GetBCBlockBytes(encodeCase.Format);
+			std::vector<uint8_t> blocks(blocksWide * blocksHigh * blockBytes);
+			std::vector<uint8_t> decoded(width * height * 4);
+
+			BCEncodeOptions options;
+			options.Quality = encodeCase.Quality;
+			const BCEncodeSurface surface = { source.data(), width * 4, width, height, blocks.data(), blocksWide * blockBytes };
+			const bool encoded = EncodeBCSurfaces(&jobs, encodeCase.Format, &surface, 1, options);
+			const bool decodedOk = DecodeBCSurface(encodeCase.Format, { blocks.data(), blocksWide * blockBytes, width, height, decoded.data(), width * 4 });
+
+			const double rgbPsnr = ComputePsnr(source, decoded, 3);
+			std::vector<uint8_t> sourceAlpha(source.size());
+			std::vector<uint8_t> decodedAlpha(decoded.size());
+			for (size_t i = 0; i < source.size(); i += 4)
+			{
+				sourceAlpha[i] = source[i + 3];
+				decodedAlpha[i] = decoded[i + 3];
+			}
+			const double alphaPsnr = ComputePsnr(sourceAlpha, decodedAlpha, 1);
+			Print(std::format("  {}: RGB {:.2f} dB, alpha {:.2f} dB\n", encodeCase.Name, rgbPsnr, alphaPsnr));
+
+			checker.Expect(encoded && decodedOk, std::format("{}: encodes and decodes", encodeCase.Name));
+			checker.Expect(rgbPsnr >= encodeCase.RgbFloor, std::format("{}: RGB PSNR {:.2f} dB >= {:.1f} dB", encodeCase.Name, rgbPsnr, encodeCase.RgbFloor));
+			checker.Expect(alphaPsnr >= encodeCase.AlphaFloor, std::format("{}: alpha PSNR {:.2f} dB >= {:.1f} dB", encodeCase.Name, alphaPsnr, encodeCase.AlphaFloor));
+
+			// 병렬로 압축해도 호출 스레드에서 압축한 것과 같은 블록이 나와야 한다.
+			std::vector<uint8_t> serialBlocks(blocks.size());
+			const BCEncodeSurface serialSurface = { source.data(), width * 4, width, height, serialBlocks.data(), blocksWide * blockBytes };
+			checker.Expect(EncodeBCSurfaces(nullptr, encodeCase.Format, &serialSurface, 1, options) && serialBlocks == blocks,
+				std::format("{}: parallel and serial encodes match", encodeCase.Name));
+		}
+
+		return checker.Finish("bcencode-test");
+	}
+
+	//--------------------------------------------------------------------------------------
+	// residency-test: TextureResidencyManager를 여러 프레임에 걸쳐 돌린다.
+	// 오래 안 쓴 순서로 내리기, mEvictAfterFrames 전에는 밉만 자르기, 예산 90% 아래에서만 되살리기, 내려간 텍스쳐를 쓰면 다시 읽기
+	//--------------------------------------------------------------------------------------
+	std::string DescribeRequests(const std::vector<TextureResidencyRequest>& requests)
+	{
+		static const char* actionNames[] = { "Reload", "DropMip", "RestoreMip", "Evict" };
+		std::string text;
+		for (const auto& request : requests)
+		{
+			text += std::format("{}{} {} (skip {}, max {})", text.empty() ? "" : ", ",
+				actionNames[static_cast<int>(request.Action)], request.Name, request.SkippedMips, request.MaxSize);
+		}
+		return text.empty() ? "nothing" : text;
+	}
+
+	int RunResidencyTest(const std::vector<std::string>&)
+	{
+		Checker checker;
+		using Action = TextureResidencyAction;
+		auto isRequest = [](const TextureResidencyRequest& request, const char* name, Action action, uint32_t skippedMips, size_t maxSize)
+			{
+				return request.Name == name && request.Action == action && request.SkippedMips == skippedMips && request.MaxSize == maxSize;
+			};
+
+		// 예산 500바이트에 400바이트짜리 셋. 10프레임 이상 안 쓴 것은 오래된 것부터 내린다.
+		// grass는 300x200(NPOT)을 밉 하나 잘라서 올린 상태
+		TextureResidencyManager residency(500);
+		residency.SetEvictAfterFrames(10);
+		residency.OnTextureLoaded("grass.dds", 400, 300, 200, 9, 1, 0);
+		residency.OnTextureLoaded("fence.dds", 400, 256, 256, 9, 0, 0);
+		residency.OnTextureLoaded("water.dds", 400, 256, 256, 9, 0, 0);
+		residency.MarkUsed("fence.dds", 1);
+		residency.MarkUsed("water.dds", 30);
+
+		auto requests = residency.CollectRequests(30);
+		checker.Expect(requests.size() == 2 && isRequest(requests[0], "grass.dds", Action::Evict, 1, 0) && isRequest(requests[1], "fence.dds", Action::Evict, 0, 0),
+			std::format("over budget evicts the least recently used first, then stops: {}", DescribeRequests(requests)));
+		residency.OnTextureEvicted("grass.dds");
+		residency.OnTextureEvicted("fence.dds");
+		auto stats = residency.GetStats();
+		checker.Expect(stats.ResidentBytes == 400 && stats.ResidentCount == 1 && stats.EvictedCount == 2 && stats.Evictions == 2,
+			std::format("evicted textures leave the resident total ({} bytes, {} resident)", stats.ResidentBytes, stats.ResidentCount));
+		checker.Expect(!residency.IsResident("grass.dds") && residency.IsResident("water.dds"), "IsResident follows OnTextureEvicted");
+
+		// 내려간 텍스쳐를 다시 쓰면 잘렸던 밉 그대로(원본 300x200 기준) 다시 읽는다. 요청은 한 번만 나온다.
+		residency.SetBudget(1000);
+		residency.MarkUsed("water.dds", 31);
+		requests = residency.CollectRequests(31);
+		checker.Expect(requests.empty(), std::format("using resident textures requests nothing: {}", DescribeRequests(requests)));
+		// 다시 읽을 크기까지 예산에 넣어서 같은 프레임에 다른 텍스쳐의 밉을 자른다.
+		residency.SetBudget(700);
+		residency.MarkUsed("grass.dds", 32);
+		requests = residency.CollectRequests(32);
+		checker.Expect(requests.size() == 2 && isRequest(requests[0], "grass.dds", Action::Reload, 1, 150) && isRequest(requests[1], "water.dds", Action::DropMip, 1, 128),
+			std::format("MarkUsed on an evicted texture requests a reload at its skipped mip and counts it against the budget: {}", DescribeRequests(requests)));
+		requests = residency.CollectRequests(33);
+		checker.Expect(requests.empty(), std::format("a reload is requested once: {}", DescribeRequests(requests)));
+		residency.SetBudget(1000);
+		residency.OnTextureLoaded("grass.dds", 400, 300, 200, 9, 1, 33);
+		checker.Expect(residency.IsResident("grass.dds") && residency.GetStats().Reloads == 1, "OnTextureLoaded makes the reloaded texture resident");
+
+		// 다시 넘치면 10프레임 안에 쓴 것은 내리지 않고 오래된 것부터 상위 밉을 하나씩 자른다.
+		residency.OnTextureLoaded("fence.dds", 400, 256, 256, 9, 0, 34);
+		residency.MarkUsed("water.dds", 35);
+		requests = residency.CollectRequests(40);
+		checker.Expect(requests.size() == 1 && isRequest(requests[0], "grass.dds", Action::DropMip, 2, 75),
+			std::format("textures used within the evict window drop a mip instead: {}", DescribeRequests(requests)));
+		residency.OnTextureLoaded("grass.dds", 100, 300, 200, 9, 2, 40);
+		requests = residency.CollectRequests(43);
+		checker.Expect(requests.empty(), std::format("nothing is restored while the budget is more than 90% full: {}", DescribeRequests(requests)));
+		residency.SetBudget(850);
+		requests = residency.CollectRequests(44);
+		checker.Expect(requests.size() == 1 && isRequest(requests[0], "fence.dds", Action::Evict, 0, 0),
+			std::format("a texture unused for exactly the evict window is evicted instead of cut: {}", DescribeRequests(requests)));
+		stats = residency.GetStats();
+		checker.Expect(stats.MipDrops == 2 && stats.Evictions == 3 && stats.MipRestores == 0,
+			std::format("counters: {} drops, {} evictions, {} restores", stats.MipDrops, stats.Evictions, stats.MipRestores));
+
+		// 되살리기는 최근에 쓴 것부터, 되살린 뒤(상위 밉은 약 3배)가 예산의 90% 이하일 때만
+		TextureResidencyManager restore(1000);
+		restore.OnTextureLoaded("old.dds", 75, 512, 512, 10, 1, 0);
+		restore.OnTextureLoaded("recent.dds", 225, 512, 512, 10, 2, 5);
+		requests = restore.CollectRequests(5);
+		checker.Expect(requests.empty(),
+			std::format("300 + 3 * 225 bytes is above 90% of the budget, and the older texture is not tried: {}", DescribeRequests(requests)));
+		restore.OnTextureEvicted("old.dds");
+		requests = restore.CollectRequests(6);
+		checker.Expect(requests.size() == 1 && isRequest(requests[0], "recent.dds", Action::RestoreMip, 1, 256),
+			std::format("225 + 3 * 225 bytes is exactly 90% and restores one mip: {}", DescribeRequests(requests)));
+		restore.OnTextureLoaded("recent.dds", 226, 512, 512, 10, 2, 6);
+		requests = restore.CollectRequests(7);
+		checker.Expect(requests.empty(), std::format("one byte more stays cut: {}", DescribeRequests(requests)));
+		restore.OnTextureLoaded("old.dds", 50, 512, 512, 10, 1, 0);
+		restore.OnTextureLoaded("recent.dds", 100, 512, 512, 10, 2, 8);
+		requests = restore.CollectRequests(8);
+		checker.Expect(requests.size() == 1 && isRequest(requests[0], "recent.dds", Action::RestoreMip, 1, 256),
+			std::format("with room for both, only the most recently used texture is restored: {}", DescribeRequests(requests)));
+
+		// 예산을 넘었던 프레임에는 내리고 나서 자리가 남아도 되살리지 않는다.
+		restore.SetEvictAfterFrames(10);
+		restore.OnTextureLoaded("sky.dds", 2000, 1024, 1024, 1, 0, 1);
+		requests = restore.CollectRequests(20);
+		checker.Expect(requests.size() == 2 && isRequest(requests[0], "old.dds", Action::Evict, 1, 0) && isRequest(requests[1], "sky.dds", Action::Evict, 0, 0),
+			std::format("an over-budget frame only evicts: {}", DescribeRequests(requests)));
+
+		// 늦게 끝난 읽기가 마지막 사용 프레임을 되돌리지 않는다.
+		TextureResidencyManager late(100);
+		late.SetEvictAfterFrames(10);
+		late.OnTextureLoaded("grass.dds", 400, 256, 256, 9, 0, 0);
+		late.MarkUsed("grass.dds", 20);
+		late.OnTextureLoaded("grass.dds", 400, 256, 256, 9, 0, 15);
+		requests = late.CollectRequests(29);
+		checker.Expect(requests.size() == 1 && isRequest(requests[0], "grass.dds", Action::DropMip, 1, 128),
+			std::format("a load for an older frame keeps the later MarkUsed frame: {}", DescribeRequests(requests)));
+
+		return checker.Finish("residency-test");
+	}
+
+	//--------------------------------------------------------------------------------------
+	// vquant-test: half 변환(모든 비트 패턴, 짝수 반올림, 넘침, NaN), 팔면체 노멀 오차, QuantizeVertices 한도 검사
+	//--------------------------------------------------------------------------------------
+	bool IsHalfNaN(uint16_t half)
+	{
+		return (half & 0x7C00) == 0x7C00 && (half & 0x3FF) != 0;
+	}
+
+	void CheckHalfConversion(Checker& checker)
+	{
+		// 모든 half는 float로 갔다가 그대로 돌아와야 한다. NaN은 부호를 지킨 NaN이면 된다.
+		int roundTripFailures = 0;
+		for (uint32_t half = 0; half <= 0xFFFF; half++)
+		{
+			const uint16_t back = FloatToHalf(HalfToFloat(static_cast<uint16_t>(half)));
+			const bool ok = IsHalfNaN(static_cast<uint16_t>(half)) ? IsHalfNaN(back) && (back & 0x8000) == (half & 0x8000) : back == half;
+			roundTripFailures += ok ? 0 : 1;
+		}
+		checker.Expect(roundTripFailures == 0, std::format("{} half bit patterns do not round-trip", roundTripFailures));
+
+		// 이웃한 두 half의 한가운데는 짝수 쪽, 조금 위아래는 가까운 쪽으로 (비정규화 수와 지수 경계 포함)
+		int tieFailures = 0;
+		for (uint16_t half = 0; half < 0x7BFF; half++)
+		{
+			const float low = HalfToFloat(half);
+			const float high = HalfToFloat(static_cast<uint16_t>(half + 1));
+			const float middle = (low + high) * 0.5f;
+			const uint16_t even = (half & 1) ? static_cast<uint16_t>(half + 1) : half;
+			tieFailures += FloatToHalf(middle) == even ? 0 : 1;
+			tieFailures += FloatToHalf(-middle) == (even | 0x8000) ? 0 : 1;
+			tieFailures += FloatToHalf(std::nextafter(middle, 0.0f)) == half ? 0 : 1;
+			tieFailures += FloatToHalf(std::nextafter(middle, HUGE_VALF)) == half + 1 ? 0 : 1;
+		}
+		checker.Expect(tieFailures == 0, std::format("{} ties or near-ties round the wrong way", tieFailures));
+
+		// 가장 작은 비정규화 수의 절반은 0으로, 그보다 크면 가장 작은 비정규화 수로
+		checker.Expect(FloatToHalf(ldexpf(1.0f, -25)) == 0x0000, "2^-25 rounds to zero (tie to even)");
+		checker.Expect(FloatToHalf(std::nextafter(ldexpf(1.0f, -25), 1.0f)) == 0x0001, "just above 2^-25 rounds to the smallest subnormal");
+		checker.Expect(FloatToHalf(-ldexpf(1.0f, -30)) == 0x8000, "tiny negative values keep the sign");
+		// 65504가 가장 큰 half. 65520(65504와 65536의 가운데)부터는 무한대
+		checker.Expect(FloatToHalf(65504.0f) == 0x7BFF, "65504 is the largest finite half");
+		checker.Expect(FloatToHalf(std::nextafter(65520.0f, 0.0f)) == 0x7BFF, "just below 65520 stays finite");
+		checker.Expect(FloatToHalf(65520.0f) == 0x7C00, "65520 rounds to infinity");
+		checker.Expect(FloatToHalf(-1e6f) == 0xFC00, "large negative values become -infinity");
+		checker.Expect(FloatToHalf(HUGE_VALF) == 0x7C00 && FloatToHalf(-HUGE_VALF) == 0xFC00, "infinities are kept");
+		checker.Expect(FloatToHalf(std::numeric_limits<float>::quiet_NaN()) == 0x7E00, "NaN becomes a quiet half NaN");
+		checker.Expect(HalfToFloat(0x7C00) == HUGE_VALF && std::isnan(HalfToFloat(0x7E01)), "half infinity and NaN decode");
+	}
+
+	// 노멀만 다른 버텍스를 양자화해서 복원한 노멀과의 가장 큰 각도 (도)
+	float MaxNormalErrorDegrees(const std::vector<std::array<float, 3>>& normals, bool& exactAxes)
+	{
+		std::vector<float> vertices;
+		for (const auto& normal : normals)
+		{
+			vertices.insert(vertices.end(), { 0.0f, 0.0f, 0.0f, normal[0], normal[1], normal[2], 0.0f, 0.0f });
+		}
+		std::vector<PackedVertex> packed;
+		VertexQuantization quantization;
+		VertexQuantizationError error;
+		QuantizeVertices(vertices.data(), normals.size(), VertexErrorLimits(), packed, quantization, error);
+
+		double maxDegrees = 0.0;
+		exactAxes = true;
+		for (size_t i = 0; i < normals.size(); i++)
+		{
+			float decoded[8];
+			DecodePackedVertex(packed[i], quantization, decoded);
+			const double length = std::sqrt(static_cast<double>(normals[i][0]) * normals[i][0]
+				+ static_cast<double>(normals[i][1]) * normals[i][1] + static_cast<double>(normals[i][2]) * normals[i][2]);
+			double dot = 0.0;
+			for (int a = 0; a < 3; a++)
+			{
+				dot += decoded[3 + a] * normals[i][a] / length;
+			}
+			maxDegrees = std::max(maxDegrees, std::acos(std::clamp(dot, -1.0, 1.0)) * 180.0 / XM_PI);
+			for (int a = 0; a < 3; a++)
+			{
+				exactAxes &= fabsf(normals[i][a]) != 1.0f || decoded[3 + a] == normals[i][a];
+			}
+		}
+		return static_cast<float>(maxDegrees);
+	}
+
+	void CheckOctahedralNormals(Checker& checker)
+	{
+		const float limit = VertexErrorLimits().NormalDegrees;
+		// 구 전체를 위도/경도로 훑는다. 위쪽(z >= 0)과 아래쪽(접히는 쪽)을 따로 잰다.
+		std::vector<std::array<float, 3>> upper;
+		std::vector<std::array<float, 3>> lower;
+		const int latitudes = 181;
+		const int longitudes = 360;
+		for (int i = 0; i < latitudes; i++)
+		{
+			const float theta = XM_PI * i / (latitudes - 1);
+			for (int j = 0; j < longitudes; j++)
+			{
+				const float phi = XM_2PI * (j + 0.37f) / longitudes;
+				const std::array<float, 3> normal = { sinf(theta) * cosf(phi), sinf(theta) * sinf(phi), cosf(theta) };
+				(normal[2] >= 0.0f ? upper : lower).push_back(normal);
+			}
+		}
+		// 접는 선(|x| + |y| = 1) 바로 아래위와 대각선
+		for (int i = 0; i < 64; i++)
+		{
+			const float phi = XM_2PI * i / 64;
+			for (float z : { 1e-4f, -1e-4f, -0.01f, -0.99f })
+			{
+				const float r = sqrtf(1.0f - z * z);
+				(z >= 0.0f ? upper : lower).push_back({ r * cosf(phi), r * sinf(phi), z });
+			}
+		}
+
+		bool exactAxes = true;
+		const float upperDegrees = MaxNormalErrorDegrees(upper, exactAxes);
+		const float lowerDegrees = MaxNormalErrorDegrees(lower, exactAxes);
+		checker.Expect(upperDegrees <= limit, std::format("z >= 0 normals within {} deg (max {:.4f})", limit, upperDegrees));
+		checker.Expect(lowerDegrees <= limit, std::format("folded z < 0 normals within {} deg (max {:.4f})", limit, lowerDegrees));
+
+		const std::vector<std::array<float, 3>> axes =
+		{
+			{ 1.0f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f },
+		};
+		const float axisDegrees = MaxNormalErrorDegrees(axes, exactAxes);
+		checker.Expect(exactAxes, std::format("the six axes decode exactly (max {:.4f} deg)", axisDegrees));
+	}
+
+	int RunVertexQuantizationTest(const std::vector<std::string>& args)
+	{
+		Checker checker;
+		CheckHalfConversion(checker);
+		CheckOctahedralNormals(checker);
+
+		for (const auto& file : args)
+		{
+			std::vector<float> vertices;
+			std::vector<uint32_t> indices;
+			if (!LoadObjTriangles(file, vertices, indices))
+			{
+				checker.Expect(false, file + " loads");
+				continue;
+			}
+
+			const size_t vertexCount = vertices.size() / 8;
+			std::vector<PackedVertex> packed;
+			VertexQuantization quantization;
+			VertexQuantizationError error;
+			checker.Expect(QuantizeVertices(vertices.data(), vertexCount, VertexErrorLimits(), packed, quantization, error),
+				std::format("{} packs within the limits (position {:.6f}, normal {:.4f} deg, uv {:.6f})", file,
+					error.Position, error.NormalDegrees, error.Tex));
+			checker.Expect(packed.size() == vertexCount, file + " packs every vertex");
+
+			// half로 1/4096 안에 들어오지 않는 UV는 거절해야 한다. (2048 ~ 4096 사이 half 간격은 2)
+			for (float tex : { 3000.3f, 1e5f })
+			{
+				auto outOfRange = vertices;
+				outOfRange[6] = tex;
+				checker.Expect(!QuantizeVertices(outOfRange.data(), vertexCount, VertexErrorLimits(), packed, quantization, error),
+					std::format("{} with a uv of {} is rejected", file, tex));
+			}
+		}
+
+		return checker.Finish("vquant-test");
+	}
+
+	//--------------------------------------------------------------------------------------
+	// footprint-test: footprint-check 기록과 ComputeCopyableFootprints를 비교한다.
+	// 지금 기록은 합성 기록이라 장치 검증이 아니다. 하드웨어에서 DxTool footprint-check --record로 다시 기록해야 한다.
+	// 기록의 케이스 목록이 BuildFootprintCases와 달라지면 다시 기록하라고 실패한다.
+	//--------------------------------------------------------------------------------------
+	int RunFootprintTest(const std::vector<std::string>& args)
+	{
+		if (args.empty())
+		{
+			Print("usage: DxCheck footprint-test record.txt\n");
+			return 1;
+		}
+
+		Checker checker;
+		std::ifstream file(args[0]);
+		checker.Expect(file.good(), args[0] + " opens");
+		const auto cases = BuildFootprintCases();
+		size_t index = 0;
+		FootprintCase footprintCase;
+		FootprintResult expected;
+		while (ReadFootprintRecord(file, footprintCase, expected))
+		{
+			const std::string description = DescribeFootprintCase(footprintCase);
+			checker.Expect(index < cases.size() && DescribeFootprintCase(cases[index]) == description,
+				std::format("record case {} ({}) is case {} of BuildFootprintCases", index, description, index));
+			const std::string difference = CompareFootprints(expected, ComputeFootprintOnCPU(footprintCase));
+			checker.Expect(difference.empty(), std::format("{}: {}", description, difference));
+			index++;
+		}
+		checker.Expect(file.eof(), std::format("{} parses to the end (stopped after case {})", args[0], index));
+		checker.Expect(index == cases.size(), std::format("{} cases recorded, BuildFootprintCases has {}", index, cases.size()));
+		return checker.Finish("footprint-test");
+	}
+
+	//--------------------------------------------------------------------------------------
+	// occlusion-bench: 건물 상자와 땅을 가리는 물체로 그리고 작은 물체가 얼마나 가려지는지와 시간을 잰다.
+	//--------------------------------------------------------------------------------------
+	int RunOcclusionBench(const std::vector<std::string>& args)
+	{
+		const int count = ParseCount(args, 100000);
+		const int buildingCount = 64;
+		const int frames = 30;
+		const float citySize = 400.0f;
+
+		const XMFLOAT3 groundPositions[] =
+		{
+			{ -citySize, 0.0f, -citySize }, { -citySize, 0.0f, +citySize }, { +citySize, 0.0f, +citySize }, { +citySize, 0.0f, -citySize },
+		};
+		const uint16_t groundIndices[] = { 0, 1, 2, 0, 2, 3 };
+
+		std::mt19937 random(12345);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		std::vector<XMFLOAT4X4> buildings(buildingCount);
+		for (auto& building : buildings)
+		{
+			const float width = 10.0f + unit(random) * 30.0f;
+			const float height = 10.0f + unit(random) * 60.0f;
+			building = MakeWorld(XMMatrixScaling(width, height, width) *
+				XMMatrixTranslation((unit(random) - 0.5f) * citySize, height * 0.5f, (unit(random) - 0.5f) * citySize));
+		}
+		const XMFLOAT4X4 identity = MakeWorld(XMMatrixIdentity());
+
+		// 작은 물체는 땅 위와 땅 밑(지하)에 흩어 놓는다.
+		CullBounds itemBounds;
+		itemBounds.Extents = XMFLOAT3(0.5f, 0.5f, 0.5f);
+		std::vector<XMFLOAT4X4> worlds(count);
+		std::vector<uint32_t> boundsIndices(count, 0);
+		for (auto& world : worlds)
+		{
+			world = MakeWorld(XMMatrixTranslation((unit(random) - 0.5f) * citySize,
+				(unit(random) - 0.2f) * 40.0f, (unit(random) - 0.5f) * citySize));
+		}
+
+		JobSystem jobs;
+		OcclusionCuller culler;
+		FrustumCuller frustum;
+		const XMMATRIX proj = XMMatrixPerspectiveFovLH(0.25f * XM_PI, 16.0f / 9.0f, 1.0f, 1000.0f);
+		std::vector<uint8_t> visible(count);
+
+		double serialRenderSeconds = 0.0;
+		double parallelRenderSeconds = 0.0;
+		double testSeconds = 0.0;
+		size_t framed = 0;
+		size_t occluded = 0;
+		size_t triangles = 0;
+		for (int frame = 0; frame < frames; frame++)
+		{
+			// 사람 눈높이에서 도시를 한 바퀴 돌아본다.
+			const float angle = XM_2PI * frame / frames;
+			const XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 2.0f, 0.0f, 1.0f),
+				XMVectorSet(cosf(angle), 2.0f, sinf(angle), 1.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+			culler.SetViewProjection(view * proj);
+			frustum.SetViewProjection(view * proj);
+
+			culler.ClearOccluders();
+			culler.AddOccluder(identity, groundPositions, sizeof(XMFLOAT3), groundIndices, 6);
+			for (const auto& building : buildings)
+			{
+				culler.AddOccluder(building, gBoxPositions, sizeof(XMFLOAT3), gBoxIndices, gBoxIndexCount);
+			}
+
+			auto start = std::chrono::steady_clock::now();
+			culler.Render();
+			serialRenderSeconds += SecondsSince(start);
+			start = std::chrono::steady_clock::now();
+			culler.Render(&jobs);
+			parallelRenderSeconds += SecondsSince(start);
+			triangles += culler.GetTriangleCount();
+
+			framed += frustum.CullParallel(jobs, worlds.data(), boundsIndices.data(), &itemBounds, count, visible.data());
+			start = std::chrono::steady_clock::now();
+			occluded += culler.CullParallel(jobs, worlds.data(), boundsIndices.data(), &itemBounds, count, visible.data());
+			testSeconds += SecondsSince(start);
+		}
+
+		Print(std::format("{} items, {} buildings, {}x{} depth buffer, {} frames, {} threads\n", count, buildingCount,
+			culler.GetWidth(), culler.GetHeight(), frames, jobs.GetConcurrency()));
+		Print(std::format("  rasterize serial:   {:8.3f} ms / frame, {:.0f} triangles\n", serialRenderSeconds * 1000.0 / frames,
+			static_cast<double>(triangles) / frames));
+		Print(std::format("  rasterize parallel: {:8.3f} ms / frame\n", parallelRenderSeconds * 1000.0 / frames));
+		Print(std::format("  test:               {:8.3f} ms / frame ({:.1f} ns / item)\n", testSeconds * 1000.0 / frames,
+			framed ? testSeconds * 1e9 / framed : 0.0));
+		Print(std::format("  in frustum {:.0f}, occluded {:.0f} ({:.1f}%) per frame\n", static_cast<double>(framed) / frames,
+			static_cast<double>(occluded) / frames, framed ? occluded * 100.0 / framed : 0.0));
+		return 0;
+	}
+
+	struct Command
+	{
+		const char* Name;
+		const char* Usage;
+		int (*Run)(const std::vector<std::string>& args);
+	};
+
+	const Command gCommands[] =
+	{
+		{ "jobs-test", "   check JobSystem counters, nested ParallelFor and per-batch exceptions", RunJobsTest },
+		{ "frustum-test", "   check FrustumCuller against boxes with known visibility", RunFrustumTest },
+		{ "occlusion-test", "   check OcclusionCuller against a wall with known hidden and visible boxes", RunOcclusionTest },
+		{ "bvh-test", "   check SceneBvh frustum/sphere/ray queries against brute force after build and refit", RunBvhTest },
+		{ "scene-test", "   check that SceneStore structure versions and moved handles keep a dense-index BVH in sync", RunSceneTest },
+		{ "bvh-bench", "[count]   report SceneBvh build, refit and frustum/sphere/ray query times", RunBvhBench },
+		{ "vcache-test", "[files.obj...]   check that each optimization stage keeps the triangles and improves the FIFO cache", RunVertexCacheTest },
+		{ "vcache-report", "[-c cacheSize] files.obj...   optimize index/vertex order and report FIFO cache ACMR/ATVR per stage", RunVertexCacheReport },
+		{ "simplify-test", "   check that simplifying a torus with UV seams merges wedges as triangles are collapsed", RunSimplifyTest },
+		{ "drawqueue-test", "   check the radix sort against std::stable_sort and the opaque/transparent draw order", RunDrawQueueTest },
+		{ "registry-test", "   check ResourceRegistry generational handles, slot reuse, Find and ForEach", RunRegistryTest },
+		{ "allocator-test", "   check RangeAllocator coalescing and ResourceHeapAllocator 4KB alignment and block release on a fake device", RunAllocatorTest },
+		{ "memcpy-test", "   compare d3dx12.h MemcpyToUploadHeap/MemcpySubresource with row-by-row memcpy byte for byte", RunMemcpyTest },
+		{ "bcdecode-test", "   decode hand-built BC1 (3-/4-color) and BC7 (mode 0/6) blocks against reference texels, compare SIMD and scalar", RunBCDecodeTest },
+		{ "bcencode-test", "   round-trip a gradient/noise image through BC1/BC3/BC7 and check per-format PSNR floors", RunBCEncodeTest },
+		{ "residency-test", "   drive TextureResidencyManager across frames and check evict order, mip drops, restores and reloads", RunResidencyTest },
+		{ "vquant-test", "[files.obj...]   check half conversion, octahedral normals and QuantizeVertices error limits", RunVertexQuantizationTest },
+		{ "footprint-test", "record.txt   compare ComputeCopyableFootprints against a footprint-check --record file", RunFootprintTest },
+		{ "occlusion-bench", "[count]   rasterize occluders on the CPU and report occluded items and timings", RunOcclusionBench },
+	};
+
+	void PrintUsage()
+	{
+		Print("usage: DxCheck <command> [args...]\n");
+		for (const auto& command : gCommands)
+		{
+			Print(std::format("  {} {}\n", command.Name, command.Usage));
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	std::vector<std::string> args(argv + 2, argv + argc);
+	for (const auto& command : gCommands)
+	{
+		if (command.Name == std::string(argv[1]))
+		{
+			return command.Run(args);
+		}
+	}
+
+	PrintUsage();
+	return 1;
+}
@@ -0,0 +1,1368 @@
+﻿#include <Windows.h>
+#include <wincodec.h>
+#include <wrl/client.h>
+#include <DirectXMath.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "DDSTextureLoader.h"
+#include "JobSystem.h"
+#include "BCDecoder.h"
+#include "BCEncoder.h"
+#include "DDSWriter.h"
+#include "CopyableFootprints.h"
+#include "FootprintRecord.h"
+#include "CookedTexture.h"
+#include "ResourceHeapAllocator.h"
+#include "DrawQueue.h"
+#include "SceneStore.h"
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+#include "VertexQuantization.h"
+#include "objparser.h"
+
+#pragma comment(lib, "d3d12.lib")
+#pragma comment(lib, "dxguid.lib")
+#pragma comment(lib, "windowscodecs.lib")
+
+using Microsoft::WRL::ComPtr;
+
+// DX12Cube에서 쓰는 모듈을 창 없이 실행하고 측정하는 명령줄 도구
+// GPU와 Windows가 필요 없는 검사와 측정은 리눅스에서도 빌드하는 DxCheck에 있다. (루트 CMakeLists.txt)
+// 사용법:
+//   DxTool <명령> [인자...]
+//   DxTool bcdecode-bench [파일.dds ...]
+//   DxTool bcencode [-f bc1|bc3|bc7] [-q fast|normal|high] [-o 폴더] [--no-mips] 파일...
+//   DxTool bcencode-bench [파일.dds ...]
+//   DxTool upload-bench [파일.dds ...]
+//   DxTool footprint-check [--record 파일 | --compare 파일]
+//   DxTool cook 파일.dds...
+//   DxTool heap-bench [개수]
+//   DxTool scene-bench [개수]
+//   DxTool simplify 파일.obj [LOD 수]
+//   DxTool vquant-report 파일.obj...
+
+namespace
+{
+	void Print(const std::wstring& text)
+	{
+		fputws(text.c_str(), stdout);
+	}
+
+	// ASCII만 담은 문자열 (FootprintRecord 설명 등)
+	std::wstring Widen(const std::string& text)
+	{
+		return std::wstring(text.begin(), text.end());
+	}
+
+	double SecondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	//--------------------------------------------------------------------------------------
+	// bcdecode-bench: DDS 밉 체인 전체를 CPU에서 풀면서 MP/s 측정
+	//--------------------------------------------------------------------------------------
+	int RunBCDecodeBench(const std::vector<std::wstring>& args)
+	{
+		std::vector<std::wstring> fileNames = args;
+		if (fileNames.empty())
+		{
+			fileNames = { L"..\\DX12Cube\\bricks.dds", L"..\\DX12Cube\\water.dds" };
+		}
+
+		const int iterations = 20;
+		JobSystem jobs;
+
+		Print(std::format(L"SIMD(SSE4.1): {}, threads: {}\n", IsBCDecodeSimdAvailable() ? L"yes" : L"no", jobs.GetConcurrency()));
+
+		for (const auto& fileName : fileNames)
+		{
+			std::unique_ptr<uint8_t[]> ddsData;
+			size_t ddsDataSize = 0;
+			DirectX::DDS_TEXTURE_DATA12 textureData;
+			HRESULT hr = DirectX::LoadDDSFileData12(fileName.c_str(), ddsData, ddsDataSize);
+			if (SUCCEEDED(hr))
+			{
+				hr = DirectX::PrepareDDSTextureData12(std::move(ddsData), ddsDataSize, 0, textureData);
+			}
+			if (FAILED(hr))
+			{
+				Print(std::format(L"{}: failed to load (0x{:08x})\n", fileName, static_cast<unsigned>(hr)));
+				return 1;
+			}
+			if (!IsBCDecodeSupported(textureData.format))
+			{
+				Print(std::format(L"{}: not a BC texture (format {})\n", fileName, static_cast<int>(textureData.format)));
+				continue;
+			}
+
+			// 배열/3D는 측정 대상이 아니므로 첫 번째 밉 체인만 푼다.
+			std::vector<std::vector<uint8_t>> pixels(textureData.mipCount);
+			std::vector<BCSurface> surfaces(textureData.mipCount);
+			for (size_t i = 0; i < textureData.mipCount; i++)
+			{
+				BCSurface& surface = surfaces[i];
+				surface.Width = static_cast<uint32_t>(std::max<size_t>(textureData.width >> i, 1));
+				surface.Height = static_cast<uint32_t>(std::max<size_t>(textureData.height >> i, 1));
+				surface.Source = static_cast<const uint8_t*>(textureData.initData[i].pData);
+				surface.SourceRowPitch = static_cast<size_t>(textureData.initData[i].RowPitch);
+				pixels[i].resize(static_cast<size_t>(surface.Width) * surface.Height * 4);
+				surface.Destination = pixels[i].data();
+				surface.DestinationRowPitch = surface.Width * 4;
+			}
+
+			Print(std::format(L"{}: {}x{}, {} mips, format {}\n", fileName, textureData.width, textureData.height,
+				textureData.mipCount, static_cast<int>(textureData.format)));
+
+			struct Variant
+			{
+				const wchar_t* Name;
+				bool Simd;
+				bool Parallel;
+			};
+			const Variant variants[] =
+			{
+				{ L"scalar, 1 thread", false, false },
+				{ L"simd, 1 thread", true, false },
+				{ L"scalar, jobs", false, true },
+				{ L"simd, jobs", true, true },
+			};
+
+			for (const auto& variant : variants)
+			{
+				if (variant.Simd && !IsBCDecodeSimdAvailable())
+				{
+					continue;
+				}
+				SetBCDecodeSimdEnabled(variant.Simd);
+
+				// 가장 빠른 회차를 쓴다. (첫 회차는 캐시/페이지 폴트 때문에 느리다)
+				BCDecodeStats best;
+				for (int i = 0; i < iterations; i++)
+				{
+					BCDecodeStats stats;
+					DecodeBCSurfaces(variant.Parallel ? &jobs : nullptr, textureData.format, surfaces.data(), surfaces.size(), &stats);
+					if (i == 0 || stats.Seconds < best.Seconds)
+					{
+						best = stats;
+					}
+				}
+
+				Print(std::format(L"  {:18}: {:8.1f} MP/s ({:.3f} ms, {} blocks)\n", variant.Name,
+					best.GetMegaPixelsPerSecond(), best.Seconds * 1000.0, best.Blocks));
+			}
+			SetBCDecodeSimdEnabled(true);
+		}
+
+		return 0;
+	}
+
+	// RGBA8 이미지 한 장
+	struct Image
+	{
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+		std::vector<uint8_t> Pixels;
+	};
+
+	// png/jpg/bmp/tga(WIC가 읽는 형식)를 RGBA8로 읽는다.
+	bool LoadImageWIC(const std::wstring& fileName, Image& image)
+	{
+		ComPtr<IWICImagingFactory> factory;
+		if (FAILED(CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&factory))))
+		{
+			return false;
+		}
+
+		ComPtr<IWICBitmapDecoder> decoder;
+		ComPtr<IWICBitmapFrameDecode> frame;
+		ComPtr<IWICFormatConverter> converter;
+		if (FAILED(factory->CreateDecoderFromFilename(fileName.c_str(), nullptr, GENERIC_READ, WICDecodeMetadataCacheOnDemand, &decoder))
+			|| FAILED(decoder->GetFrame(0, &frame))
+			|| FAILED(factory->CreateFormatConverter(&converter))
+			|| FAILED(converter->Initialize(frame.Get(), GUID_WICPixelFormat32bppRGBA, WICBitmapDitherTypeNone, nullptr, 0.0, WICBitmapPaletteTypeCustom))
+			|| FAILED(converter->GetSize(&image.Width, &image.Height)))
+		{
+			return false;
+		}
+
+		image.Pixels.resize(static_cast<size_t>(image.Width) * image.Height * 4);
+		return SUCCEEDED(converter->CopyPixels(nullptr, image.Width * 4, static_cast<UINT>(image.Pixels.size()), image.Pixels.data()));
+	}
+
+	// DDS의 0번 밉을 RGBA8로 읽는다. BC면 CPU에서 풀고, RGBA8/BGRA8은 그대로 쓴다.
+	bool LoadImageDDS(const std::wstring& fileName, Image& image)
+	{
+		std::unique_ptr<uint8_t[]> ddsData;
+		size_t ddsDataSize = 0;
+		DirectX::DDS_TEXTURE_DATA12 textureData;
+		if (FAILED(DirectX::LoadDDSFileData12(fileName.c_str(), ddsData, ddsDataSize))
+			|| FAILED(DirectX::PrepareDDSTextureData12(std::move(ddsData), ddsDataSize, 0, textureData))
+			|| FAILED(DirectX::DecompressDDSTextureData12(textureData)))
+		{
+			return false;
+		}
+
+		const bool bgra = textureData.format == DXGI_FORMAT_B8G8R8A8_UNORM || textureData.format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
+		const bool rgba = textureData.format == DXGI_FORMAT_R8G8B8A8_UNORM || textureData.format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+		if (!bgra && !rgba)
+		{
+			return false;
+		}
+
+		image.Width = static_cast<uint32_t>(textureData.width);
+		image.Height = static_cast<uint32_t>(textureData.height);
+		image.Pixels.resize(static_cast<size_t>(image.Width) * image.Height * 4);
+		const auto& top = textureData.initData[0];
+		for (uint32_t y = 0; y < image.Height; y++)
+		{
+			const uint8_t* src = static_cast<const uint8_t*>(top.pData) + y * static_cast<size_t>(top.RowPitch);
+			uint8_t* dst = image.Pixels.data() + static_cast<size_t>(y) * image.Width * 4;
+			memcpy(dst, src, static_cast<size_t>(image.Width) * 4);
+			if (bgra)
+			{
+				for (uint32_t x = 0; x < image.Width; x++)
+				{
+					std::swap(dst[x * 4 + 0], dst[x * 4 + 2]);
+				}
+			}
+		}
+		return true;
+	}
+
+	bool LoadImageFile(const std::wstring& fileName, Image& image)
+	{
+		std::wstring extension = std::filesystem::path(fileName).extension().wstring();
+		std::transform(extension.begin(), extension.end(), extension.begin(), towlower);
+		return extension == L".dds" ? LoadImageDDS(fileName, image) : LoadImageWIC(fileName, image);
+	}
+
+	// 2x2 박스 필터로 다음 밉을 만든다. 홀수 크기에서는 마지막 행/열을 한 번 더 쓴다.
+	Image Downsample(const Image& source)
+	{
+		Image result;
+		result.Width = std::max(source.Width / 2, 1u);
+		result.Height = std::max(source.Height / 2, 1u);
+		result.Pixels.resize(static_cast<size_t>(result.Width) * result.Height * 4);
+		for (uint32_t y = 0; y < result.Height; y++)
+		{
+			const uint32_t y0 = std::min(y * 2, source.Height - 1);
+			const uint32_t y1 = std::min(y * 2 + 1, source.Height - 1);
+			for (uint32_t x = 0; x < result.Width; x++)
+			{
+				const uint32_t x0 = std::min(x * 2, source.Width - 1);
+				const uint32_t x1 = std::min(x * 2 + 1, source.Width - 1);
+				const uint8_t* p00 = &source.Pixels[(static_cast<size_t>(y0) * source.Width + x0) * 4];
+				const uint8_t* p01 = &source.Pixels[(static_cast<size_t>(y0) * source.Width + x1) * 4];
+				const uint8_t* p10 = &source.Pixels[(static_cast<size_t>(y1) * source.Width + x0) * 4];
+				const uint8_t* p11 = &source.Pixels[(static_cast<size_t>(y1) * source.Width + x1) * 4];
+				uint8_t* dst = &result.Pixels[(static_cast<size_t>(y) * result.Width + x) * 4];
+				for (int c = 0; c < 4; c++)
+				{
+					dst[c] = static_cast<uint8_t>((p00[c] + p01[c] + p10[c] + p11[c] + 2) / 4);
+				}
+			}
+		}
+		return result;
+	}
+
+	size_t GetBlockBytes(DXGI_FORMAT format)
+	{
+		return format == DXGI_FORMAT_BC1_UNORM ? 8 : 16;
+	}
+
+	// 밉 체인 전체를 한 번의 EncodeBCSurfaces 호출로 압축한다. (작은 밉까지 같이 나눠서 스레드가 놀지 않게)
+	std::vector<std::vector<uint8_t>> EncodeMipChain(JobSystem& jobs, DXGI_FORMAT format, const std::vector<Image>& mips,
+		const BCEncodeOptions& options, BCEncodeStats* stats)
+	{
+		std::vector<std::vector<uint8_t>> blocks(mips.size());
+		std::vector<BCEncodeSurface> surfaces(mips.size());
+		for (size_t i = 0; i < mips.size(); i++)
+		{
+			const size_t rowPitch = ((mips[i].Width + 3) / 4) * GetBlockBytes(format);
+			blocks[i].resize(rowPitch * ((mips[i].Height + 3) / 4));
+			surfaces[i] = { mips[i].Pixels.data(), static_cast<size_t>(mips[i].Width) * 4, mips[i].Width, mips[i].Height,
+				blocks[i].data(), rowPitch };
+		}
+		EncodeBCSurfaces(&jobs, format, surfaces.data(), surfaces.size(), options, stats);
+		return blocks;
+	}
+
+	// 압축한 블록을 BCDecoder로 다시 풀어서 원본과 비교한 PSNR(dB). RGB와 알파를 따로 계산한다.
+	void MeasurePSNR(DXGI_FORMAT format, const Image& source, const std::vector<uint8_t>& blocks, double& rgbPSNR, double& alphaPSNR)
+	{
+		std::vector<uint8_t> decoded(source.Pixels.size());
+		BCSurface surface = { blocks.data(), ((source.Width + 3) / 4) * GetBlockBytes(format), source.Width, source.Height,
+			decoded.data(), static_cast<size_t>(source.Width) * 4 };
+		DecodeBCSurfaces(nullptr, format, &surface, 1);
+
+		double rgbError = 0.0;
+		double alphaError = 0.0;
+		for (size_t i = 0; i < decoded.size(); i += 4)
+		{
+			for (int c = 0; c < 3; c++)
+			{
+				const double d = static_cast<double>(decoded[i + c]) - source.Pixels[i + c];
+				rgbError += d * d;
+			}
+			const double d = static_cast<double>(decoded[i + 3]) - source.Pixels[i + 3];
+			alphaError += d * d;
+		}
+
+		const double pixels = static_cast<double>(decoded.size() / 4);
+		auto toPSNR = [](double mse) { return mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : 99.0; };
+		rgbPSNR = toPSNR(rgbError / (pixels * 3));
+		alphaPSNR = toPSNR(alphaError / pixels);
+	}
+
+	bool ParseFormat(const std::wstring& name, DXGI_FORMAT& format)
+	{
+		if (name == L"bc1") { format = DXGI_FORMAT_BC1_UNORM; return true; }
+		if (name == L"bc3") { format = DXGI_FORMAT_BC3_UNORM; return true; }
+		if (name == L"bc7") { format = DXGI_FORMAT_BC7_UNORM; return true; }
+		return false;
+	}
+
+	bool ParseQuality(const std::wstring& name, BC7Quality& quality)
+	{
+		if (name == L"fast") { quality = BC7Quality::Fast; return true; }
+		if (name == L"normal") { quality = BC7Quality::Normal; return true; }
+		if (name == L"high") { quality = BC7Quality::High; return true; }
+		return false;
+	}
+
+	//--------------------------------------------------------------------------------------
+	// bcencode: 이미지 파일을 밉 체인을 포함한 BC DDS로 변환
+	//--------------------------------------------------------------------------------------
+	int RunBCEncode(const std::vector<std::wstring>& args)
+	{
+		DXGI_FORMAT format = DXGI_FORMAT_BC7_UNORM;
+		BCEncodeOptions options;
+		std::filesystem::path outputDirectory;
+		bool generateMips = true;
+		std::vector<std::wstring> fileNames;
+
+		for (size_t i = 0; i < args.size(); i++)
+		{
+			const bool hasValue = i + 1 < args.size();
+			if ((args[i] == L"-f" && hasValue && ParseFormat(args[i + 1], format))
+				|| (args[i] == L"-q" && hasValue && ParseQuality(args[i + 1], options.Quality)))
+			{
+				i++;
+			}
+			else if (args[i] == L"-o" && hasValue)
+			{
+				outputDirectory = args[++i];
+			}
+			else if (args[i] == L"--no-mips")
+			{
+				generateMips = false;
+			}
+			else if (!args[i].empty() && args[i][0] == L'-')
+			{
+				Print(std::format(L"unknown option: {}\n", args[i]));
+				return 1;
+			}
+			else
+			{
+				fileNames.push_back(args[i]);
+			}
+		}
+		if (fileNames.empty())
+		{
+			Print(L"no input files\n");
+			return 1;
+		}
+
+		JobSystem jobs;
+		BCEncodeStats total;
+		int failures = 0;
+		for (const auto& fileName : fileNames)
+		{
+			std::vector<Image> mips(1);
+			if (!LoadImageFile(fileName, mips[0]))
+			{
+				Print(std::format(L"{}: failed to load\n", fileName));
+				failures++;
+				continue;
+			}
+			while (generateMips && (mips.back().Width > 1 || mips.back().Height > 1))
+			{
+				mips.push_back(Downsample(mips.back()));
+			}
+
+			std::filesystem::path outputPath = outputDirectory.empty() ? std::filesystem::path(fileName).parent_path() : outputDirectory;
+			outputPath /= std::filesystem::path(fileName).stem();
+			outputPath += L".dds";
+			std::error_code ec;
+			if (std::filesystem::equivalent(outputPath, fileName, ec))
+			{
+				Print(std::format(L"{}: output would overwrite the input, use -o\n", fileName));
+				failures++;
+				continue;
+			}
+
+			BCEncodeStats stats;
+			const auto blocks = EncodeMipChain(jobs, format, mips, options, &stats);
+			if (!SaveDDSFile(outputPath, format, mips[0].Width, mips[0].Height, blocks))
+			{
+				Print(std::format(L"{}: failed to write\n", outputPath.wstring()));
+				failures++;
+				continue;
+			}
+
+			double rgbPSNR = 0.0;
+			double alphaPSNR = 0.0;
+			MeasurePSNR(format, mips[0], blocks[0], rgbPSNR, alphaPSNR);
+			Print(std::format(L"{} -> {}: {}x{}, {} mips, {:.1f} MP/s, PSNR rgb {:.2f} dB / alpha {:.2f} dB\n", fileName,
+				outputPath.wstring(), mips[0].Width, mips[0].Height, mips.size(), stats.GetMegaPixelsPerSecond(), rgbPSNR, alphaPSNR));
+
+			total.Blocks += stats.Blocks;
+			total.Pixels += stats.Pixels;
+			total.Seconds += stats.Seconds;
+		}
+
+		Print(std::format(L"{} files, {} failed, {:.1f} MP/s overall\n", fileNames.size(), failures, total.GetMegaPixelsPerSecond()));
+		return failures ? 1 : 0;
+	}
+
+	//--------------------------------------------------------------------------------------
+	// bcencode-bench: 포맷/품질별 압축 속도(MP/s)와 PSNR 측정
+	//--------------------------------------------------------------------------------------
+	int RunBCEncodeBench(const std::vector<std::wstring>& args)
+	{
+		std::vector<std::wstring> fileNames = args;
+		if (fileNames.empty())
+		{
+			fileNames = { L"..\\DX12Cube\\bricks.dds", L"..\\DX12Cube\\water.dds", L"..\\DX12Cube\\grass.dds" };
+		}
+
+		struct Variant
+		{
+			const wchar_t* Name;
+			DXGI_FORMAT Format;
+			BC7Quality Quality;
+		};
+		const Variant variants[] =
+		{
+			{ L"bc1", DXGI_FORMAT_BC1_UNORM, BC7Quality::Normal },
+			{ L"bc3", DXGI_FORMAT_BC3_UNORM, BC7Quality::Normal },
+			{ L"bc7 fast", DXGI_FORMAT_BC7_UNORM, BC7Quality::Fast },
+			{ L"bc7 normal", DXGI_FORMAT_BC7_UNORM, BC7Quality::Normal },
+			{ L"bc7 high", DXGI_FORMAT_BC7_UNORM, BC7Quality::High },
+		};
+
+		JobSystem jobs;
+		Print(std::format(L"threads: {}\n", jobs.GetConcurrency()));
+
+		for (const auto& fileName : fileNames)
+		{
+			// 원본은 0번 밉만 쓴다. BC DDS를 원본으로 쓰면 이미 한 번 압축된 이미지라 PSNR이 실제보다 높게 나온다.
+			std::vector<Image> mips(1);
+			if (!LoadImageFile(fileName, mips[0]))
+			{
+				Print(std::format(L"{}: failed to load\n", fileName));
+				return 1;
+			}
+			Print(std::format(L"{}: {}x{}\n", fileName, mips[0].Width, mips[0].Height));
+
+			for (const auto& variant : variants)
+			{
+				BCEncodeOptions options;
+				options.Quality = variant.Quality;
+
+				BCEncodeStats stats;
+				const auto blocks = EncodeMipChain(jobs, variant.Format, mips, options, &stats);
+
+				double rgbPSNR = 0.0;
+				double alphaPSNR = 0.0;
+				MeasurePSNR(variant.Format, mips[0], blocks[0], rgbPSNR, alphaPSNR);
+				Print(std::format(L"  {:12}: {:8.2f} MP/s, PSNR rgb {:6.2f} dB, alpha {:6.2f} dB\n", variant.Name,
+					stats.GetMegaPixelsPerSecond(), rgbPSNR, alphaPSNR));
+			}
+		}
+
+		return 0;
+	}
+
+	//--------------------------------------------------------------------------------------
+	// upload-bench: 밉 체인을 업로드 힙에 복사하는 속도 측정 (UpdateSubresources의 CPU 쪽)
+	//--------------------------------------------------------------------------------------
+
+	// 예전 d3dx12.h의 MemcpySubresource: 한 줄에 memcpy 한 번
+	void CopyRowByRow(const D3D12_MEMCPY_DEST& dest, const D3D12_SUBRESOURCE_DATA& src, SIZE_T rowSize, UINT numRows, UINT numSlices)
+	{
+		for (UINT z = 0; z < numSlices; z++)
+		{
+			BYTE* destSlice = static_cast<BYTE*>(dest.pData) + dest.SlicePitch * z;
+			const BYTE* srcSlice = static_cast<const BYTE*>(src.pData) + src.SlicePitch * z;
+			for (UINT y = 0; y < numRows; y++)
+			{
+				memcpy(destSlice + dest.RowPitch * y, srcSlice + src.RowPitch * y, rowSize);
+			}
+		}
+	}
+
+	int RunUploadBench(const std::vector<std::wstring>& args)
+	{
+		std::vector<std::wstring> fileNames = args;
+		if (fileNames.empty())
+		{
+			fileNames = { L"..\\DX12Cube\\bricks.dds", L"..\\DX12Cube\\water.dds", L"..\\DX12Cube\\grass.dds" };
+		}
+
+		ComPtr<ID3D12Device> device;
+		if (FAILED(D3D12CreateDevice(nullptr, D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&device))))
+		{
+			Print(L"failed to create a D3D12 device\n");
+			return 1;
+		}
+
+		// UpdateSubresourcesParallel이 복사 명령을 기록할 리스트. 실행하지 않고 반복마다 비운다.
+		ComPtr<ID3D12CommandAllocator> commandAllocator;
+		ComPtr<ID3D12GraphicsCommandList> commandList;
+		if (FAILED(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&commandAllocator)))
+			|| FAILED(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, commandAllocator.Get(), nullptr, IID_PPV_ARGS(&commandList)))
+			|| FAILED(commandList->Close()))
+		{
+			Print(L"failed to create a command list\n");
+			return 1;
+		}
+
+		const int iterations = 50;
+		JobSystem jobs;
+		Print(std::format(L"streaming stores: {}, threads: {}\n", D3DX12_STREAMING_MEMCPY ? L"yes" : L"no", jobs.GetConcurrency()));
+
+		auto parallelFor = [&](UINT count, auto&& body)
+		{
+			jobs.ParallelFor(count, 1, [&](size_t first, size_t last)
+			{
+				for (; first < last; first++)
+				{
+					body(static_cast<UINT>(first));
+				}
+			});
+		};
+
+		for (const auto& fileName : fileNames)
+		{
+			std::unique_ptr<uint8_t[]> ddsData;
+			size_t ddsDataSize = 0;
+			DirectX::DDS_TEXTURE_DATA12 textureData;
+			HRESULT hr = DirectX::LoadDDSFileData12(fileName.c_str(), ddsData, ddsDataSize);
+			if (SUCCEEDED(hr))
+			{
+				hr = DirectX::PrepareDDSTextureData12(std::move(ddsData), ddsDataSize, 0, textureData);
+			}
+			if (FAILED(hr) || textureData.resDim != D3D12_RESOURCE_DIMENSION_TEXTURE2D)
+			{
+				Print(std::format(L"{}: failed to load or not a 2D texture\n", fileName));
+				continue;
+			}
+
+			// CreateDDSTextureFromData12와 같은 리소스 설명
+			const UINT16 arraySize = static_cast<UINT16>(textureData.depth > 1 ? textureData.depth : textureData.arraySize);
+			const auto desc = CD3DX12_RESOURCE_DESC::Tex2D(textureData.format, textureData.width, static_cast<UINT>(textureData.height),
+				arraySize, static_cast<UINT16>(textureData.mipCount));
+			const UINT numSubresources = arraySize * static_cast<UINT>(textureData.mipCount);
+
+			std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts(numSubresources);
+			std::vector<UINT> numRows(numSubresources);
+			std::vector<UINT64> rowSizes(numSubresources);
+			UINT64 requiredSize = 0;
+			device->GetCopyableFootprints(&desc, 0, numSubresources, 0, layouts.data(), numRows.data(), rowSizes.data(), &requiredSize);
+
+			// 실제 업로드와 같은 쓰기 결합(write-combined) 메모리에 쓴다.
+			ComPtr<ID3D12Resource> uploadBuffer;
+			ComPtr<ID3D12Resource> texture;
+			const auto uploadHeapProp = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+			const auto defaultHeapProp = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+			const auto bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(requiredSize);
+			BYTE* mapped = nullptr;
+			if (FAILED(device->CreateCommittedResource(&uploadHeapProp, D3D12_HEAP_FLAG_NONE, &bufferDesc,
+				D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&uploadBuffer)))
+				|| FAILED(device->CreateCommittedResource(&defaultHeapProp, D3D12_HEAP_FLAG_NONE, &desc,
+					D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&texture)))
+				|| FAILED(uploadBuffer->Map(0, nullptr, reinterpret_cast<void**>(&mapped))))
+			{
+				Print(std::format(L"{}: failed to create the upload buffer or texture\n", fileName));
+				return 1;
+			}
+
+			UINT64 copyBytes = 0;
+			UINT packedCount = 0;
+			for (UINT i = 0; i < numSubresources; i++)
+			{
+				copyBytes += rowSizes[i] * numRows[i] * layouts[i].Footprint.Depth;
+				if (rowSizes[i] == layouts[i].Footprint.RowPitch && static_cast<UINT64>(textureData.initData[i].RowPitch) == rowSizes[i])
+				{
+					packedCount++;
+				}
+			}
+			Print(std::format(L"{}: {}x{}, {} subresources ({} with packed rows), {} KB\n", fileName, textureData.width,
+				textureData.height, numSubresources, packedCount, copyBytes / 1024));
+
+			auto copySubresource = [&](UINT i, bool rowByRow)
+			{
+				const D3D12_MEMCPY_DEST dest = { mapped + layouts[i].Offset, layouts[i].Footprint.RowPitch,
+					SIZE_T(layouts[i].Footprint.RowPitch) * numRows[i] };
+				if (rowByRow)
+				{
+					CopyRowByRow(dest, textureData.initData[i], static_cast<SIZE_T>(rowSizes[i]), numRows[i], layouts[i].Footprint.Depth);
+				}
+				else
+				{
+					MemcpySubresource(&dest, &textureData.initData[i], static_cast<SIZE_T>(rowSizes[i]), numRows[i], layouts[i].Footprint.Depth);
+				}
+			};
+
+			struct Variant
+			{
+				const wchar_t* Name;
+				bool RowByRow;
+				bool Parallel;
+			};
+			const Variant variants[] =
+			{
+				{ L"row memcpy", true, false },
+				{ L"MemcpySubresource", false, false },
+				{ L"UpdateSubresourcesParallel", false, true },
+			};
+
+			for (const auto& variant : variants)
+			{
+				double best = 0.0;
+				for (int iteration = 0; iteration < iterations; iteration++)
+				{
+					if (variant.Parallel)
+					{
+						commandAllocator->Reset();
+						commandList->Reset(commandAllocator.Get(), nullptr);
+					}
+
+					const auto start = std::chrono::steady_clock::now();
+					if (variant.Parallel)
+					{
+						// 맵/언맵과 CopyTextureRegion 기록까지 실제 업로드 경로 그대로 잰다.
+						const UINT64 uploaded = UpdateSubresourcesParallel(commandList.Get(), texture.Get(), uploadBuffer.Get(), 0, numSubresources,
+							requiredSize, layouts.data(), numRows.data(), rowSizes.data(), textureData.initData.get(), parallelFor);
+						if (uploaded != requiredSize)
+						{
+							Print(std::format(L"{}: UpdateSubresourcesParallel failed\n", fileName));
+							return 1;
+						}
+					}
+					else
+					{
+						for (UINT i = 0; i < numSubresources; i++)
+						{
+							copySubresource(i, variant.RowByRow);
+						}
+					}
+					const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+					if (iteration == 0 || seconds < best)
+					{
+						best = seconds;
+					}
+
+					if (variant.Parallel)
+					{
+						commandList->Close();
+					}
+				}
+
+				Print(std::format(L"  {:26}: {:8.2f} GB/s ({:.3f} ms)\n", variant.Name,
+					copyBytes / best / (1024.0 * 1024.0 * 1024.0), best * 1000.0));
+			}
+
+			uploadBuffer->Unmap(0, nullptr);
+		}
+
+		return 0;
+	}
+
+	//--------------------------------------------------------------------------------------
+	// footprint-check: ComputeCopyableFootprints(CPU)와 ID3D12Device::GetCopyableFootprints 비교
+	// 하드웨어에서 --record DxTool/footprint-record.txt로 합성 기록을 장치 기록으로 바꾼다. DxCheck footprint-test(ctest)가 그 파일을 읽는다.
+	//--------------------------------------------------------------------------------------
+	FootprintResult ComputeFootprintOnDevice(ID3D12Device* device, const FootprintCase& footprintCase)
+	{
+		FootprintResult result;
+		result.Layouts.resize(footprintCase.SubresourceCount);
+		result.NumRows.resize(footprintCase.SubresourceCount);
+		result.RowSizes.resize(footprintCase.SubresourceCount);
+		device->GetCopyableFootprints(&footprintCase.Desc, 0, footprintCase.SubresourceCount, footprintCase.BaseOffset,
+			result.Layouts.data(), result.NumRows.data(), result.RowSizes.data(), &result.TotalBytes);
+		return result;
+	}
+
+	int RunFootprintCheck(const std::vector<std::wstring>& args)
+	{
+		std::wstring recordPath;
+		std::wstring comparePath;
+		if (args.size() == 2 && args[0] == L"--record")
+		{
+			recordPath = args[1];
+		}
+		else if (args.size() == 2 && args[0] == L"--compare")
+		{
+			comparePath = args[1];
+		}
+		else if (!args.empty())
+		{
+			Print(L"usage: DxTool footprint-check [--record file | --compare file]\n");
+			return 1;
+		}
+
+		int checked = 0;
+		int mismatches = 0;
+		auto check = [&](const FootprintCase& footprintCase, const FootprintResult& expected)
+		{
+			checked++;
+			const std::string difference = CompareFootprints(expected, ComputeFootprintOnCPU(footprintCase));
+			if (!difference.empty())
+			{
+				mismatches++;
+				Print(std::format(L"mismatch: {}\n  {}\n", Widen(DescribeFootprintCase(footprintCase)), Widen(difference)));
+			}
+		};
+
+		// 기록된 장치 결과와 비교 (장치 없이 실행 가능)
+		if (!comparePath.empty())
+		{
+			std::ifstream file{ std::filesystem::path(comparePath) };
+			if (!file)
+			{
+				Print(std::format(L"{}: failed to open\n", comparePath));
+				return 1;
+			}
+
+			FootprintCase footprintCase;
+			FootprintResult expected;
+			while (ReadFootprintRecord(file, footprintCase, expected))
+			{
+				check(footprintCase, expected);
+			}
+			Print(std::format(L"{} recorded cases, {} mismatches\n", checked, mismatches));
+			return mismatches || checked == 0 ? 1 : 0;
+		}
+
+		ComPtr<ID3D12Device> device;
+		if (FAILED(D3D12CreateDevice(nullptr, D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&device))))
+		{
+			Print(L"failed to create a D3D12 device\n");
+			return 1;
+		}
+
+		std::ofstream recordFile;
+		if (!recordPath.empty())
+		{
+			recordFile.open(std::filesystem::path(recordPath), std::ios::trunc);
+			if (!recordFile)
+			{
+				Print(std::format(L"{}: failed to open\n", recordPath));
+				return 1;
+			}
+		}
+
+		for (const auto& footprintCase : BuildFootprintCases())
+		{
+			// plane 수도 장치와 같은지 확인
+			D3D12_FEATURE_DATA_FORMAT_INFO formatInfo = { footprintCase.Desc.Format, 0 };
+			if (footprintCase.Desc.Dimension != D3D12_RESOURCE_DIMENSION_BUFFER
+				&& SUCCEEDED(device->CheckFeatureSupport(D3D12_FEATURE_FORMAT_INFO, &formatInfo, sizeof(formatInfo)))
+				&& formatInfo.PlaneCount != GetCopyablePlaneCount(footprintCase.Desc.Format))
+			{
+				mismatches++;
+				Print(std::format(L"mismatch: format {} has {} planes (cpu {})\n", static_cast<int>(footprintCase.Desc.Format),
+					formatInfo.PlaneCount, GetCopyablePlaneCount(footprintCase.Desc.Format)));
+			}
+
+			const FootprintResult expected = ComputeFootprintOnDevice(device.Get(), footprintCase);
+			if (recordFile.is_open())
+			{
+				WriteFootprintRecord(recordFile, footprintCase, expected);
+			}
+			check(footprintCase, expected);
+		}
+
+		Print(std::format(L"{} cases, {} mismatches\n", checked, mismatches));
+		return mismatches ? 1 : 0;
+	}
+
+	//--------------------------------------------------------------------------------------
+	// cook: DDS 옆에 업로드 배치로 다시 쓴 .cooked 파일을 만든다
+	//--------------------------------------------------------------------------------------
+	int RunCook(const std::vector<std::wstring>& args)
+	{
+		if (args.empty())
+		{
+			Print(L"usage: DxTool cook files.dds...\n");
+			return 1;
+		}
+
+		int failures = 0;
+		for (const auto& fileName : args)
+		{
+			std::unique_ptr<uint8_t[]> ddsData;
+			size_t ddsDataSize = 0;
+			DirectX::DDS_TEXTURE_DATA12 textureData;
+			HRESULT hr = DirectX::LoadDDSFileData12(fileName.c_str(), ddsData, ddsDataSize);
+			if (SUCCEEDED(hr))
+			{
+				hr = DirectX::PrepareDDSTextureData12(std::move(ddsData), ddsDataSize, 0, textureData);
+			}
+			if (FAILED(hr))
+			{
+				Print(std::format(L"{}: failed to load (0x{:08x})\n", fileName, static_cast<unsigned>(hr)));
+				failures++;
+				continue;
+			}
+
+			const std::filesystem::path cookedPath = GetCookedTexturePath(fileName);
+			hr = WriteCookedTexture(cookedPath, fileName, textureData);
+			if (FAILED(hr))
+			{
+				Print(std::format(L"{}: failed to cook (0x{:08x})\n", fileName, static_cast<unsigned>(hr)));
+				failures++;
+				continue;
+			}
+
+			// 다시 열어서 헤더 확인
+			CookedTextureHeader header;
+			if (OpenCookedTexture(cookedPath, fileName, header) != S_OK)
+			{
+				Print(std::format(L"{}: cooked file does not verify\n", cookedPath.wstring()));
+				failures++;
+				continue;
+			}
+
+			Print(std::format(L"{}: {}x{} mips {} -> payload {} bytes (dds {} bytes)\n", cookedPath.wstring(),
+				header.Width, header.Height, header.MipLevels, header.PayloadSize, header.SourceSize));
+		}
+		return failures ? 1 : 0;
+	}
+
+	//--------------------------------------------------------------------------------------
+	// heap-bench: committed 리소스와 ResourceHeapAllocator의 placed 리소스 생성 시간 비교
+	//--------------------------------------------------------------------------------------
+	int RunHeapBench(const std::vector<std::wstring>& args)
+	{
+		int count = 2000;
+		if (!args.empty())
+		{
+			count = std::max(1, static_cast<int>(wcstol(args[0].c_str(), nullptr, 10)));
+		}
+
+		ComPtr<ID3D12Device> device;
+		if (FAILED(D3D12CreateDevice(nullptr, D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&device))))
+		{
+			Print(L"failed to create a D3D12 device\n");
+			return 1;
+		}
+
+		// 작은 텍스쳐(4KB 정렬 대상)부터 큰 텍스쳐, 버퍼까지 섞는다.
+		std::vector<D3D12_RESOURCE_DESC> descs;
+		for (int i = 0; i < count; i++)
+		{
+			switch (i % 4)
+			{
+			case 0:
+				descs.push_back(CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_BC1_UNORM, 64, 64, 1, 0));
+				break;
+			case 1:
+				descs.push_back(CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R8G8B8A8_UNORM, 256, 256, 1, 0));
+				break;
+			case 2:
+				descs.push_back(CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_BC7_UNORM, 1024, 1024, 1, 0));
+				break;
+			default:
+				descs.push_back(CD3DX12_RESOURCE_DESC::Buffer(64 * 1024 + 256 * (i % 64)));
+				break;
+			}
+		}
+
+		std::vector<ComPtr<ID3D12Resource>> resources(descs.size());
+		auto defaultHeapProp = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+		auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < descs.size(); i++)
+		{
+			if (FAILED(device->CreateCommittedResource(&defaultHeapProp, D3D12_HEAP_FLAG_NONE, &descs[i],
+				D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&resources[i]))))
+			{
+				Print(std::format(L"committed resource {} failed\n", i));
+				return 1;
+			}
+		}
+		const double committedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		UINT64 committedBytes = 0;
+		for (const auto& desc : descs)
+		{
+			committedBytes += device->GetResourceAllocationInfo(0, 1, &desc).SizeInBytes;
+		}
+		resources.assign(descs.size(), nullptr);
+
+		ResourceHeapAllocator allocator;
+		allocator.Initialize(device.Get());
+		std::vector<HeapAllocation> allocations(descs.size());
+		start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < descs.size(); i++)
+		{
+			if (FAILED(allocator.CreateResource(descs[i], D3D12_HEAP_TYPE_DEFAULT, D3D12_RESOURCE_STATE_COMMON, nullptr,
+				resources[i], allocations[i])))
+			{
+				Print(std::format(L"placed resource {} failed\n", i));
+				return 1;
+			}
+		}
+		const double placedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		Print(std::format(L"{} resources\n", descs.size()));
+		Print(std::format(L"  committed: {:8.3f} ms ({:.2f} us each), {:.2f} MB\n", committedSeconds * 1000.0,
+			committedSeconds * 1e6 / descs.size(), committedBytes / (1024.0 * 1024.0)));
+		Print(std::format(L"  placed   : {:8.3f} ms ({:.2f} us each)\n", placedSeconds * 1000.0, placedSeconds * 1e6 / descs.size()));
+		Print(allocator.GetStats().ToString());
+
+		// 절반을 놓아서 조각난 정도를 본다.
+		for (size_t i = 0; i < descs.size(); i += 2)
+		{
+			resources[i] = nullptr;
+			allocator.Free(allocations[i]);
+		}
+		Print(L"after freeing every other resource:\n");
+		Print(allocator.GetStats().ToString());
+
+		resources.clear();
+		for (auto& allocation : allocations)
+		{
+			allocator.Free(allocation);
+		}
+		return 0;
+	}
+
+	//--------------------------------------------------------------------------------------
+	// scene-bench: 물체마다 unique_ptr로 둔 RenderItem과 SceneStore의 프레임당 갱신 비용 비교
+	//--------------------------------------------------------------------------------------
+	struct BenchMaterial
+	{
+		std::string TextureName;
+		uint32_t SortId = 0;
+	};
+
+	struct BenchMesh
+	{
+		uint32_t SortId = 0;
+		uint32_t IndexCount = 0;
+	};
+
+	// 예전 DX12Cube의 RenderItem 모양. 물체마다 따로 할당하고 메쉬/재질은 맵 안을 가리킨다.
+	struct BenchRenderItem
+	{
+		DirectX::XMFLOAT4X4 World;
+		DirectX::XMFLOAT4X4 TexTransform;
+		const BenchMesh* Mesh = nullptr;
+		const BenchMaterial* Material = nullptr;
+		uint32_t Flags = 0;
+	};
+
+	struct BenchInstanceData
+	{
+		DirectX::XMFLOAT4X4 World;
+		DirectX::XMFLOAT4X4 TexTransform;
+	};
+
+	struct SceneBenchTimes
+	{
+		double UpdateSeconds = 0.0;
+		double SortSeconds = 0.0;
+		double InstanceSeconds = 0.0;
+
+		double GetTotalSeconds() const { return UpdateSeconds + SortSeconds + InstanceSeconds; }
+	};
+
+	void PrintSceneBenchTimes(const wchar_t* name, const SceneBenchTimes& times, int frames)
+	{
+		Print(std::format(L"  {}: update {:7.3f} ms, keys+sort {:7.3f} ms, instances {:7.3f} ms, total {:7.3f} ms / frame\n", name,
+			times.UpdateSeconds * 1000.0 / frames, times.SortSeconds * 1000.0 / frames,
+			times.InstanceSeconds * 1000.0 / frames, times.GetTotalSeconds() * 1000.0 / frames));
+	}
+
+	int RunSceneBench(const std::vector<std::wstring>& args)
+	{
+		using namespace DirectX;
+
+		int count = 100000;
+		if (!args.empty())
+		{
+			count = std::max(1, static_cast<int>(wcstol(args[0].c_str(), nullptr, 10)));
+		}
+		const int frames = 30;
+		const int meshCount = 16;
+		const int materialCount = 8;
+
+		std::map<std::string, BenchMesh> meshes;
+		std::map<std::string, BenchMaterial> materials;
+		std::vector<const BenchMesh*> meshTable;
+		std::vector<const BenchMaterial*> materialTable;
+		for (int i = 0; i < meshCount; i++)
+		{
+			auto& mesh = meshes[std::format("mesh{}", i)];
+			mesh.SortId = i;
+			mesh.IndexCount = 36;
+		}
+		for (int i = 0; i < materialCount; i++)
+		{
+			auto& material = materials[std::format("material{}", i)];
+			material.TextureName = std::format("texture{}.dds", i);
+			material.SortId = i;
+		}
+		for (const auto& [name, mesh] : meshes)
+		{
+			meshTable.push_back(&mesh);
+		}
+		for (const auto& [name, material] : materials)
+		{
+			materialTable.push_back(&material);
+		}
+
+		// 같은 장면을 두 가지로 만든다. 예전 쪽은 로드 중 다른 할당이 섞인 것처럼 할당 순서를 섞는다.
+		std::mt19937 random(12345);
+		std::vector<XMFLOAT4X4> startWorlds(count);
+		std::vector<uint32_t> meshIds(count);
+		std::vector<uint32_t> materialIds(count);
+		for (int i = 0; i < count; i++)
+		{
+			XMStoreFloat4x4(&startWorlds[i], XMMatrixTranslation(static_cast<float>(i % 317), 0.0f, static_cast<float>(i / 317)));
+			meshIds[i] = random() % meshCount;
+			materialIds[i] = random() % materialCount;
+		}
+
+		std::vector<int> allocationOrder(count);
+		for (int i = 0; i < count; i++)
+		{
+			allocationOrder[i] = i;
+		}
+		std::shuffle(allocationOrder.begin(), allocationOrder.end(), random);
+
+		std::vector<std::unique_ptr<BenchRenderItem>> renderItems(count);
+		std::vector<std::unique_ptr<std::string>> padding;
+		for (int i : allocationOrder)
+		{
+			auto item = std::make_unique<BenchRenderItem>();
+			item->World = startWorlds[i];
+			XMStoreFloat4x4(&item->TexTransform, XMMatrixIdentity());
+			item->Mesh = meshTable[meshIds[i]];
+			item->Material = materialTable[materialIds[i]];
+			item->Flags = 1;
+			renderItems[i] = std::move(item);
+			padding.push_back(std::make_unique<std::string>(48, 'x'));
+		}
+
+		SceneStore scene;
+		scene.Reserve(count);
+		std::vector<SceneStore::Handle> handles(count);
+		for (int i = 0; i < count; i++)
+		{
+			handles[i] = scene.Add(startWorlds[i], meshIds[i], materialIds[i], SceneItemOpaque);
+		}
+
+		XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 50.0f, -50.0f, 1.0f), XMVectorZero(), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+		std::vector<BenchInstanceData> instances(count);
+		DrawQueue queue;
+		queue.Reserve(count);
+
+		// 한 프레임: 모든 물체를 조금 옮기고, 정렬 키를 만들어 정렬하고, 정렬 순서대로 인스턴스 데이터를 쓴다.
+		SceneBenchTimes aosTimes;
+		uint64_t aosChecksum = 0;
+		for (int frame = 0; frame < frames; frame++)
+		{
+			const float offset = sinf(frame * 0.1f) * 0.01f;
+
+			auto start = std::chrono::steady_clock::now();
+			for (auto& item : renderItems)
+			{
+				item->World._42 += offset;
+			}
+			auto end = std::chrono::steady_clock::now();
+			aosTimes.UpdateSeconds += std::chrono::duration<double>(end - start).count();
+
+			start = end;
+			queue.Clear();
+			for (int i = 0; i < count; i++)
+			{
+				const auto& item = *renderItems[i];
+				const float depth = XMVectorGetZ(XMVector3Transform(XMVectorSet(item.World._41, item.World._42, item.World._43, 0.0f), view));
+				queue.Add(DrawSortKey::MakeFrontToBack(1, 1, item.Material->SortId, item.Mesh->SortId, depth), i);
+			}
+			queue.Sort();
+			end = std::chrono::steady_clock::now();
+			aosTimes.SortSeconds += std::chrono::duration<double>(end - start).count();
+
+			start = end;
+			const auto& entries = queue.GetEntries();
+			for (size_t i = 0; i < entries.size(); i++)
+			{
+				const auto& item = *renderItems[entries[i].Index];
+				XMStoreFloat4x4(&instances[i].World, XMMatrixTranspose(XMLoadFloat4x4(&item.World)));
+				XMStoreFloat4x4(&instances[i].TexTransform, XMMatrixTranspose(XMLoadFloat4x4(&item.TexTransform)));
+			}
+			end = std::chrono::steady_clock::now();
+			aosTimes.InstanceSeconds += std::chrono::duration<double>(end - start).count();
+			aosChecksum += entries.front().Index;
+		}
+
+		SceneBenchTimes soaTimes;
+		uint64_t soaChecksum = 0;
+		for (int frame = 0; frame < frames; frame++)
+		{
+			const float offset = sinf(frame * 0.1f) * 0.01f;
+			const size_t sceneCount = scene.GetCount();
+
+			auto start = std::chrono::steady_clock::now();
+			// SetWorld로만 바꿀 수 있다. (움직인 핸들을 기록하므로 BVH가 따라간다)
+			const XMFLOAT4X4* worlds = scene.GetWorlds();
+			const SceneStore::Handle* sceneHandles = scene.GetHandles();
+			for (size_t i = 0; i < sceneCount; i++)
+			{
+				XMFLOAT4X4 world = worlds[i];
+				world._42 += offset;
+				scene.SetWorld(sceneHandles[i], world);
+			}
+			scene.ClearMoved();
+			auto end = std::chrono::steady_clock::now();
+			soaTimes.UpdateSeconds += std::chrono::duration<double>(end - start).count();
+
+			start = end;
+			const uint32_t* sceneMeshes = scene.GetMeshes();
+			const uint32_t* sceneMaterials = scene.GetMaterials();
+			queue.Clear();
+			for (size_t i = 0; i < sceneCount; i++)
+			{
+				const auto& world = worlds[i];
+				const float depth = XMVectorGetZ(XMVector3Transform(XMVectorSet(world._41, world._42, world._43, 0.0f), view));
+				queue.Add(DrawSortKey::MakeFrontToBack(1, 1, materialTable[sceneMaterials[i]]->SortId, meshTable[sceneMeshes[i]]->SortId, depth),
+					static_cast<uint32_t>(i));
+			}
+			queue.Sort();
+			end = std::chrono::steady_clock::now();
+			soaTimes.SortSeconds += std::chrono::duration<double>(end - start).count();
+
+			start = end;
+			const XMFLOAT4X4* texTransforms = scene.GetTexTransforms();
+			const auto& entries = queue.GetEntries();
+			for (size_t i = 0; i < entries.size(); i++)
+			{
+				const uint32_t index = entries[i].Index;
+				XMStoreFloat4x4(&instances[i].World, XMMatrixTranspose(XMLoadFloat4x4(&worlds[index])));
+				XMStoreFloat4x4(&instances[i].TexTransform, XMMatrixTranspose(XMLoadFloat4x4(&texTransforms[index])));
+			}
+			end = std::chrono::steady_clock::now();
+			soaTimes.InstanceSeconds += std::chrono::duration<double>(end - start).count();
+			soaChecksum += scene.GetHandles()[entries.front().Index];
+		}
+
+		Print(std::format(L"{} items, {} meshes, {} materials, {} frames\n", count, meshCount, materialCount, frames));
+		PrintSceneBenchTimes(L"unique_ptr RenderItem", aosTimes, frames);
+		PrintSceneBenchTimes(L"SceneStore           ", soaTimes, frames);
+		Print(std::format(L"  speedup: {:.2f}x\n", soaTimes.GetTotalSeconds() > 0.0 ? aosTimes.GetTotalSeconds() / soaTimes.GetTotalSeconds() : 0.0));
+		if (aosChecksum != soaChecksum)
+		{
+			Print(L"  warning: the two scenes sorted differently\n");
+		}
+
+		// 물체를 지우고 다시 넣어도 배열은 빈틈없이 유지되고 핸들 번호는 다시 쓴다.
+		const int churn = std::max(1, count / 10);
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < churn; i++)
+		{
+			const int victim = random() % count;
+			scene.Remove(handles[victim]);
+			handles[victim] = scene.Add(startWorlds[victim], meshIds[victim], materialIds[victim], SceneItemOpaque);
+		}
+		const double churnSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		Print(std::format(L"  SceneStore remove+add: {} pairs in {:.3f} ms ({:.1f} ns each), {} items\n", churn, churnSeconds * 1000.0,
+			churnSeconds * 1e9 / churn, scene.GetCount()));
+		return 0;
+	}
+
+	// 면마다 버텍스 세 개를 따로 만든다. (ObjToTriangles)
+	bool LoadObjTriangles(const std::wstring& fileName, std::vector<float>& vertices, std::vector<uint32_t>& indices)
+	{
+		if (!ObjToTriangles(ObjParse(fileName.c_str()), vertices, indices))
+		{
+			Print(std::format(L"{}: no faces\n", fileName));
+			return false;
+		}
+		return true;
+	}
+
+	//--------------------------------------------------------------------------------------
+	// simplify: OBJ 메쉬로 DX12Cube와 같은 LOD 체인을 만들고 단계마다 삼각형 수, 버텍스 수, 오차, 시간을 출력
+	// 버텍스가 위치보다 훨씬 많으면 접을 때 웨지를 합치지 못하고 이음새만 늘린 것이다.
+	//--------------------------------------------------------------------------------------
+	size_t CountPositions(const std::vector<float>& vertices)
+	{
+		std::set<std::tuple<float, float, float>> positions;
+		for (size_t i = 0; i + 2 < vertices.size(); i += 8)
+		{
+			positions.emplace(vertices[i], vertices[i + 1], vertices[i + 2]);
+		}
+		return positions.size();
+	}
+
+	int RunSimplify(const std::vector<std::wstring>& args)
+	{
+		if (args.empty())
+		{
+			Print(L"usage: DxTool simplify file.obj [lods]\n");
+			return 1;
+		}
+		size_t lodCount = 3;
+		if (args.size() > 1)
+		{
+			lodCount = std::max(1, static_cast<int>(wcstol(args[1].c_str(), nullptr, 10)));
+		}
+
+		std::vector<float> vertices;
+		std::vector<uint32_t> indices;
+		if (!LoadObjTriangles(args[0], vertices, indices))
+		{
+			return 1;
+		}
+
+		const float attributeWeights[] = { 1.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+		const auto start = std::chrono::steady_clock::now();
+		const auto lods = BuildMeshLods(vertices.data(), vertices.size() / 8, 5, attributeWeights, indices.data(), indices.size(), lodCount);
+		const double seconds = SecondsSince(start);
+
+		Print(std::format(L"{}: {} triangles, {} vertices on {} positions, {} LODs in {:.3f} ms\n", args[0], indices.size() / 3,
+			vertices.size() / 8, CountPositions(vertices), lods.size(), seconds * 1000.0));
+		for (size_t lod = 0; lod < lods.size(); lod++)
+		{
+			// 넓이가 0이 된 삼각형이 있으면 단순화가 잘못된 것이다.
+			const auto& mesh = lods[lod];
+			size_t degenerate = 0;
+			for (size_t i = 0; i < mesh.Indices.size(); i += 3)
+			{
+				using namespace DirectX;
+				const XMVECTOR a = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&mesh.Vertices[mesh.Indices[i] * 8]));
+				const XMVECTOR b = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&mesh.Vertices[mesh.Indices[i + 1] * 8]));
+				const XMVECTOR c = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&mesh.Vertices[mesh.Indices[i + 2] * 8]));
+				degenerate += XMVectorGetX(XMVector3LengthSq(XMVector3Cross(b - a, c - a))) == 0.0f ? 1 : 0;
+			}
+			const size_t positions = CountPositions(mesh.Vertices);
+			Print(std::format(L"  LOD{}: {:6} triangles, {:6} vertices on {:6} positions ({:.2f} per position), error {:.5f}, {} degenerate\n",
+				lod + 1, mesh.Indices.size() / 3, mesh.Vertices.size() / 8, positions,
+				positions ? static_cast<double>(mesh.Vertices.size() / 8) / positions : 0.0, mesh.Error, degenerate));
+		}
+		return 0;
+	}
+
+	//--------------------------------------------------------------------------------------
+	// vquant-report: OBJ 메쉬를 DX12Cube와 같이 합친 뒤 PackedVertex로 양자화하고 크기와 복원 오차를 출력
+	//--------------------------------------------------------------------------------------
+	int RunVertexQuantizationReport(const std::vector<std::wstring>& args)
+	{
+		if (args.empty())
+		{
+			Print(L"usage: DxTool vquant-report file.obj...\n");
+			return 1;
+		}
+
+		const VertexErrorLimits limits;
+		const size_t vertexSize = 8 * sizeof(float);
+		for (const auto& file : args)
+		{
+			std::vector<float> vertices;
+			std::vector<uint32_t> indices;
+			if (!LoadObjTriangles(file, vertices, indices))
+			{
+				continue;
+			}
+			const size_t vertexCount = WeldVertices(vertices.data(), vertices.size() / 8, vertexSize, indices.data(), indices.size());
+
+			std::vector<PackedVertex> packed;
+			VertexQuantization quantization;
+			VertexQuantizationError error;
+			const auto start = std::chrono::steady_clock::now();
+			const bool withinLimits = QuantizeVertices(vertices.data(), vertexCount, limits, packed, quantization, error);
+			const double seconds = SecondsSince(start);
+
+			Print(std::format(L"{}: {} vertices, {} -> {} bytes ({} -> {} bytes per vertex) in {:.3f} ms\n", file, vertexCount,
+				vertexCount * vertexSize, packed.size() * sizeof(PackedVertex), vertexSize, sizeof(PackedVertex), seconds * 1000.0));
+			Print(std::format(L"  position error {:.6f} (limit {:.6f}, scale {:.4f})\n", error.Position, limits.Position, quantization.PositionScale));
+			Print(std::format(L"  normal error   {:.4f} deg (limit {:.4f})\n", error.NormalDegrees, limits.NormalDegrees));
+			Print(std::format(L"  uv error       {:.6f} (limit {:.6f})\n", error.Tex, limits.Tex));
+			Print(withinLimits ? L"  packed\n" : L"  over limit, DX12Cube keeps float vertices\n");
+		}
+		return 0;
+	}
+
+	struct Command
+	{
+		const wchar_t* Name;
+		const wchar_t* Usage;
+		int (*Run)(const std::vector<std::wstring>& args);
+	};
+
+	const Command gCommands[] =
+	{
+		{ L"bcdecode-bench", L"[file.dds ...]   decode BC mip chains on the CPU, report MP/s", RunBCDecodeBench },
+		{ L"bcencode", L"[-f bc1|bc3|bc7] [-q fast|normal|high] [-o dir] [--no-mips] files...   convert images to BC DDS", RunBCEncode },
+		{ L"bcencode-bench", L"[file.dds ...]   report BC1/BC3/BC7 encode MP/s and PSNR", RunBCEncodeBench },
+		{ L"upload-bench", L"[file.dds ...]   copy mip chains into an upload heap (row memcpy, MemcpySubresource, UpdateSubresourcesParallel), report GB/s", RunUploadBench },
+		{ L"footprint-check", L"[--record file | --compare file]   compare CPU copyable footprints with the device", RunFootprintCheck },
+		{ L"cook", L"files.dds...   write .cooked sidecars laid out for direct upload", RunCook },
+		{ L"heap-bench", L"[count]   compare committed and placed resource creation, report heap fragmentation", RunHeapBench },
+		{ L"scene-bench", L"[count]   compare per-frame update/sort/instance cost of unique_ptr render items and SceneStore", RunSceneBench },
+		{ L"simplify", L"file.obj [lods]   build a quadric-simplified LOD chain and report triangles and error per LOD", RunSimplify },
+		{ L"vquant-report", L"files.obj...   quantize welded vertices to the packed 16-byte format and report size and error", RunVertexQuantizationReport },
+	};
+
+	void PrintUsage()
+	{
+		Print(L"usage: DxTool <command> [args...]\n");
+		for (const auto& command : gCommands)
+		{
+			Print(std::format(L"  {} {}\n", command.Name, command.Usage));
+		}
+	}
+}
+
+int wmain(int argc, wchar_t** argv)
+{
+	if (argc < 2)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	// WIC 이미지 로드용
+	CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+	std::vector<std::wstring> args(argv + 2, argv + argc);
+	for (const auto& command : gCommands)
+	{
+		if (command.Name == std::wstring(argv[1]))
+		{
+			const int result = command.Run(args);
+			CoUninitialize();
+			return result;
+		}
+	}
+
+	PrintUsage();
+	return 1;
+}
@@ -10,6 +10,16 @@
 
 #include "d3d12.h"
 
+// MemcpySubresource writes aligned 16-byte chunks with non-temporal (streaming) stores, which
+// bypass the cache when filling write-combined upload heaps. Define D3DX12_NO_STREAMING_MEMCPY
+// to fall back to plain memcpy, e.g. when copying into cached (readback or CPU) memory.
+#if !defined(D3DX12_NO_STREAMING_MEMCPY) && (defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__))
+#include <emmintrin.h>
+#define D3DX12_STREAMING_MEMCPY 1
+#else
+#define D3DX12_STREAMING_MEMCPY 0
+#endif
+
 #if defined( __cplusplus )
 
 struct CD3DX12_DEFAULT {};
@@ -1975,7 +1985,62 @@ struct CD3DX12_VIEW_INSTANCING_DESC : public D3D12_VIEW_INSTANCING_DESC
 };
 
 //------------------------------------------------------------------------------------------------
-// Row-by-row memcpy
+// memcpy for destinations in upload (write-combined) memory. The 16-byte aligned middle of the
+// range is written with streaming stores; call MemcpyToUploadHeapFence() after the last copy so
+// the stores are visible before the memory is unmapped or handed to another thread.
+inline void MemcpyToUploadHeap(
+    _Out_writes_bytes_(NumBytes) void* pDest,
+    _In_reads_bytes_(NumBytes) const void* pSrc,
+    SIZE_T NumBytes) noexcept
+{
+#if D3DX12_STREAMING_MEMCPY
+    auto pDestBytes = static_cast<BYTE*>(pDest);
+    auto pSrcBytes = static_cast<const BYTE*>(pSrc);
+    const SIZE_T Head = (16 - (reinterpret_cast<SIZE_T>(pDestBytes) & 15)) & 15;
+    if (NumBytes < Head + 16)
+    {
+        memcpy(pDest, pSrc, NumBytes);
+        return;
+    }
+
+    memcpy(pDestBytes, pSrcBytes, Head);
+    pDestBytes += Head;
+    pSrcBytes += Head;
+    NumBytes -= Head;
+
+    for (; NumBytes >= 64; NumBytes -= 64, pDestBytes += 64, pSrcBytes += 64)
+    {
+        const __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrcBytes));
+        const __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrcBytes + 16));
+        const __m128i v2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrcBytes + 32));
+        const __m128i v3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrcBytes + 48));
+        _mm_stream_si128(reinterpret_cast<__m128i*>(pDestBytes), v0);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(pDestBytes + 16), v1);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(pDestBytes + 32), v2);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(pDestBytes + 48), v3);
+    }
+    for (; NumBytes >= 16; NumBytes -= 16, pDestBytes += 16, pSrcBytes += 16)
+    {
+        _mm_stream_si128(reinterpret_cast<__m128i*>(pDestBytes), _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrcBytes)));
+    }
+    memcpy(pDestBytes, pSrcBytes, NumBytes);
+#else
+    memcpy(pDest, pSrc, NumBytes);
+#endif
+}
+
+//------------------------------------------------------------------------------------------------
+inline void MemcpyToUploadHeapFence() noexcept
+{
+#if D3DX12_STREAMING_MEMCPY
+    _mm_sfence();
+#endif
+}
+
+//------------------------------------------------------------------------------------------------
+// Row-by-row memcpy. When rows are tightly packed on both sides (RowPitch == RowSizeInBytes, e.g.
+// small BC mips or 256-byte aligned rows) each slice is one copy, and when the slices are packed
+// too the whole subresource is a single copy.
 inline void MemcpySubresource(
     _In_ const D3D12_MEMCPY_DEST* pDest,
     _In_ const D3D12_SUBRESOURCE_DATA* pSrc,
@@ -1983,21 +2048,37 @@ inline void MemcpySubresource(
     UINT NumRows,
     UINT NumSlices) noexcept
 {
+    const bool RowsPacked = pDest->RowPitch == RowSizeInBytes && pSrc->RowPitch == LONG_PTR(RowSizeInBytes);
+    const SIZE_T SliceSizeInBytes = RowSizeInBytes * NumRows;
+    if (RowsPacked && (NumSlices == 1 ||
+        (pDest->SlicePitch == SliceSizeInBytes && pSrc->SlicePitch == LONG_PTR(SliceSizeInBytes))))
+    {
+        MemcpyToUploadHeap(pDest->pData, pSrc->pData, SliceSizeInBytes * NumSlices);
+        MemcpyToUploadHeapFence();
+        return;
+    }
+
     for (UINT z = 0; z < NumSlices; ++z)
     {
         auto pDestSlice = static_cast<BYTE*>(pDest->pData) + pDest->SlicePitch * z;
         auto pSrcSlice = static_cast<const BYTE*>(pSrc->pData) + pSrc->SlicePitch * LONG_PTR(z);
+        if (RowsPacked)
+        {
+            MemcpyToUploadHeap(pDestSlice, pSrcSlice, SliceSizeInBytes);
+            continue;
+        }
         for (UINT y = 0; y < NumRows; ++y)
         {
-            memcpy(pDestSlice + pDest->RowPitch * y,
-                   pSrcSlice + pSrc->RowPitch * LONG_PTR(y),
-                   RowSizeInBytes);
+            MemcpyToUploadHeap(pDestSlice + pDest->RowPitch * y,
+                pSrcSlice + pSrc->RowPitch * LONG_PTR(y),
+                RowSizeInBytes);
         }
     }
+    MemcpyToUploadHeapFence();
 }
 
 //------------------------------------------------------------------------------------------------
-// Row-by-row memcpy
+// Row-by-row memcpy, collapsing packed rows and slices like the overload above
 inline void MemcpySubresource(
     _In_ const D3D12_MEMCPY_DEST* pDest,
     _In_ const void* pResourceData,
@@ -2006,17 +2087,34 @@ inline void MemcpySubresource(
     UINT NumRows,
     UINT NumSlices) noexcept
 {
+    const bool RowsPacked = pDest->RowPitch == RowSizeInBytes && SIZE_T(pSrc->RowPitch) == RowSizeInBytes;
+    const SIZE_T SliceSizeInBytes = RowSizeInBytes * NumRows;
+    auto pSrcData = static_cast<const BYTE*>(pResourceData) + pSrc->Offset;
+    if (RowsPacked && (NumSlices == 1 ||
+        (pDest->SlicePitch == SliceSizeInBytes && SIZE_T(pSrc->DepthPitch) == SliceSizeInBytes)))
+    {
+        MemcpyToUploadHeap(pDest->pData, pSrcData, SliceSizeInBytes * NumSlices);
+        MemcpyToUploadHeapFence();
+        return;
+    }
+
     for (UINT z = 0; z < NumSlices; ++z)
     {
         auto pDestSlice = static_cast<BYTE*>(pDest->pData) + pDest->SlicePitch * z;
-        auto pSrcSlice = (static_cast<const BYTE*>(pResourceData) + pSrc->Offset) + pSrc->DepthPitch * ULONG_PTR(z);
+        auto pSrcSlice = pSrcData + pSrc->DepthPitch * ULONG_PTR(z);
+        if (RowsPacked)
+        {
+            MemcpyToUploadHeap(pDestSlice, pSrcSlice, SliceSizeInBytes);
+            continue;
+        }
         for (UINT y = 0; y < NumRows; ++y)
         {
-            memcpy(pDestSlice + pDest->RowPitch * y,
+            MemcpyToUploadHeap(pDestSlice + pDest->RowPitch * y,
                 pSrcSlice + pSrc->RowPitch * ULONG_PTR(y),
                 RowSizeInBytes);
         }
     }
+    MemcpyToUploadHeapFence();
 }
 
 //------------------------------------------------------------------------------------------------
@@ -2229,6 +2327,112 @@ inline UINT64 UpdateSubresources(
     return Result;
 }
 
+//------------------------------------------------------------------------------------------------
+// Same as UpdateSubresources above, but the subresource copies are spread over threads.
+// ParallelFor(Count, Body) must call Body(i) once for every i in [0, Count) and return only after
+// all calls have finished, e.g.
+//   [&](UINT Count, auto&& Body) { jobs.ParallelFor(Count, 1, [&](size_t b, size_t e) { for (; b < e; ++b) Body(UINT(b)); }); }
+// All arrays must be populated (e.g. by calling GetCopyableFootprints)
+template <typename TParallelFor>
+inline UINT64 UpdateSubresourcesParallel(
+    _In_ ID3D12GraphicsCommandList* pCmdList,
+    _In_ ID3D12Resource* pDestinationResource,
+    _In_ ID3D12Resource* pIntermediate,
+    _In_range_(0, D3D12_REQ_SUBRESOURCES) UINT FirstSubresource,
+    _In_range_(0, D3D12_REQ_SUBRESOURCES - FirstSubresource) UINT NumSubresources,
+    UINT64 RequiredSize,
+    _In_reads_(NumSubresources) const D3D12_PLACED_SUBRESOURCE_FOOTPRINT* pLayouts,
+    _In_reads_(NumSubresources) const UINT* pNumRows,
+    _In_reads_(NumSubresources) const UINT64* pRowSizesInBytes,
+    _In_reads_(NumSubresources) const D3D12_SUBRESOURCE_DATA* pSrcData,
+    TParallelFor&& ParallelFor)
+{
+    // Minor validation
+    auto IntermediateDesc = pIntermediate->GetDesc();
+    auto DestinationDesc = pDestinationResource->GetDesc();
+    if (IntermediateDesc.Dimension != D3D12_RESOURCE_DIMENSION_BUFFER ||
+        IntermediateDesc.Width < RequiredSize + pLayouts[0].Offset ||
+        RequiredSize > SIZE_T(-1) ||
+        (DestinationDesc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER &&
+            (FirstSubresource != 0 || NumSubresources != 1)))
+    {
+        return 0;
+    }
+    for (UINT i = 0; i < NumSubresources; ++i)
+    {
+        if (pRowSizesInBytes[i] > SIZE_T(-1)) return 0;
+    }
+
+    BYTE* pData;
+    HRESULT hr = pIntermediate->Map(0, nullptr, reinterpret_cast<void**>(&pData));
+    if (FAILED(hr))
+    {
+        return 0;
+    }
+
+    ParallelFor(NumSubresources, [&](UINT i)
+    {
+        D3D12_MEMCPY_DEST DestData = { pData + pLayouts[i].Offset, pLayouts[i].Footprint.RowPitch, SIZE_T(pLayouts[i].Footprint.RowPitch) * SIZE_T(pNumRows[i]) };
+        MemcpySubresource(&DestData, &pSrcData[i], static_cast<SIZE_T>(pRowSizesInBytes[i]), pNumRows[i], pLayouts[i].Footprint.Depth);
+    });
+    pIntermediate->Unmap(0, nullptr);
+
+    if (DestinationDesc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+    {
+        pCmdList->CopyBufferRegion(
+            pDestinationResource, 0, pIntermediate, pLayouts[0].Offset, pLayouts[0].Footprint.Width);
+    }
+    else
+    {
+        for (UINT i = 0; i < NumSubresources; ++i)
+        {
+            CD3DX12_TEXTURE_COPY_LOCATION Dst(pDestinationResource, i + FirstSubresource);
+            CD3DX12_TEXTURE_COPY_LOCATION Src(pIntermediate, pLayouts[i]);
+            pCmdList->CopyTextureRegion(&Dst, 0, 0, 0, &Src, nullptr);
+        }
+    }
+    return RequiredSize;
+}
+
+//------------------------------------------------------------------------------------------------
+// Heap-allocating UpdateSubresourcesParallel implementation
+template <typename TParallelFor>
+inline UINT64 UpdateSubresourcesParallel(
+    _In_ ID3D12GraphicsCommandList* pCmdList,
+    _In_ ID3D12Resource* pDestinationResource,
+    _In_ ID3D12Resource* pIntermediate,
+    UINT64 IntermediateOffset,
+    _In_range_(0, D3D12_REQ_SUBRESOURCES) UINT FirstSubresource,
+    _In_range_(0, D3D12_REQ_SUBRESOURCES - FirstSubresource) UINT NumSubresources,
+    _In_reads_(NumSubresources) const D3D12_SUBRESOURCE_DATA* pSrcData,
+    TParallelFor&& ParallelFor)
+{
+    UINT64 RequiredSize = 0;
+    auto MemToAlloc = static_cast<UINT64>(sizeof(D3D12_PLACED_SUBRESOURCE_FOOTPRINT) + sizeof(UINT) + sizeof(UINT64)) * NumSubresources;
+    if (MemToAlloc > SIZE_MAX)
+    {
+        return 0;
+    }
+    void* pMem = HeapAlloc(GetProcessHeap(), 0, static_cast<SIZE_T>(MemToAlloc));
+    if (pMem == nullptr)
+    {
+        return 0;
+    }
+    auto pLayouts = static_cast<D3D12_PLACED_SUBRESOURCE_FOOTPRINT*>(pMem);
+    auto pRowSizesInBytes = reinterpret_cast<UINT64*>(pLayouts + NumSubresources);
+    auto pNumRows = reinterpret_cast<UINT*>(pRowSizesInBytes + NumSubresources);
+
+    auto Desc = pDestinationResource->GetDesc();
+    ID3D12Device* pDevice = nullptr;
+    pDestinationResource->GetDevice(IID_ID3D12Device, reinterpret_cast<void**>(&pDevice));
+    pDevice->GetCopyableFootprints(&Desc, FirstSubresource, NumSubresources, IntermediateOffset, pLayouts, pNumRows, pRowSizesInBytes, &RequiredSize);
+    pDevice->Release();
+
+    UINT64 Result = UpdateSubresourcesParallel(pCmdList, pDestinationResource, pIntermediate, FirstSubresource, NumSubresources, RequiredSize, pLayouts, pNumRows, pRowSizesInBytes, pSrcData, ParallelFor);
+    HeapFree(GetProcessHeap(), 0, pMem);
+    return Result;
+}
+
 //------------------------------------------------------------------------------------------------
 // Stack-allocating UpdateSubresources implementation
 template <UINT MaxSubresources>